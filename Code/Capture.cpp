@@ -0,0 +1,466 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "Capture.h"
+#include "ThreadPool.h"
+
+#include <string.h>
+#include <chrono>
+
+// payloads are padded so that every record header
+// starts on an 8-byte boundary
+static uint32_t padded_size(uint32_t size)
+{
+	return (size + 7) & ~7u;
+}
+
+CaptureWriter::CaptureWriter()
+{
+	file = nullptr;
+	current_frame = 0;
+	memset(&header, 0, sizeof(header));
+}
+
+CaptureWriter::~CaptureWriter()
+{
+	close();
+}
+
+bool CaptureWriter::open(const char* path)
+{
+	close();
+
+	file = fopen(path, "wb");
+	if (!file)
+		return false;
+
+	// write a placeholder header, the real
+	// one is written when the file is closed
+	header.magic = CAPTURE_MAGIC;
+	header.version = CAPTURE_VERSION;
+	fwrite(&header, sizeof(header), 1, file);
+	return true;
+}
+
+void CaptureWriter::close()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	if (!file)
+		return;
+
+	header.frame_count = current_frame + 1;
+	header.handle_count = handle_ids.size() + 1;
+
+	fseek(file, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, file);
+	fclose(file);
+	file = nullptr;
+}
+
+uint32_t CaptureWriter::handle_id(uint64_t handle)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return handle_id_locked(handle);
+}
+
+uint32_t CaptureWriter::handle_id_locked(uint64_t handle)
+{
+	if (handle == 0)
+		return 0;
+
+	// IDs start at 1, because 0 is VK_NULL_HANDLE
+	std::unordered_map<uint64_t, uint32_t>::iterator found = handle_ids.find(handle);
+	if (found != handle_ids.end())
+		return found->second;
+
+	uint32_t id = (uint32_t)handle_ids.size() + 1;
+	handle_ids[handle] = id;
+	return id;
+}
+
+void CaptureWriter::next_frame()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	current_frame++;
+}
+
+void CaptureWriter::write(uint16_t opcode, uint16_t stream, const void* payload, uint32_t size)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	write_locked(opcode, stream, payload, size);
+}
+
+void CaptureWriter::write_locked(uint16_t opcode, uint16_t stream, const void* payload, uint32_t size)
+{
+	if (!file)
+		return;
+
+	CaptureRecord record = {};
+	record.opcode = opcode;
+	record.stream = stream;
+	record.frame = current_frame;
+	record.size = size;
+
+	static const uint8_t zeros[8] = {};
+	fwrite(&record, sizeof(record), 1, file);
+	fwrite(payload, 1, size, file);
+	fwrite(zeros, 1, padded_size(size) - size, file);
+
+	header.record_count++;
+	if ((uint32_t)stream + 1 > header.stream_count)
+		header.stream_count = (uint32_t)stream + 1;
+}
+
+void CaptureWriter::record_create_instance(VkInstance instance, uint32_t layer_count, char** layers)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	CaptureCreateInstance info = {};
+	info.instance_id = handle_id_locked((uint64_t)(uintptr_t)instance);
+	info.layer_count = layer_count;
+
+	// the layer names go right after the structure,
+	// each with its null terminator
+	std::vector<uint8_t> payload((uint8_t*)&info, (uint8_t*)&info + sizeof(info));
+	for (uint32_t i = 0; i < layer_count; i++)
+		payload.insert(payload.end(), layers[i], layers[i] + strlen(layers[i]) + 1);
+
+	write_locked(CAPTURE_OP_CREATE_INSTANCE, 0, payload.data(), (uint32_t)payload.size());
+}
+
+void CaptureWriter::record_enumerate_physical_devices(VkInstance instance, uint32_t gpu_count, const VkPhysicalDevice* gpus)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	std::vector<uint32_t> payload(2 + gpu_count);
+	payload[0] = handle_id_locked((uint64_t)(uintptr_t)instance);
+	payload[1] = gpu_count;
+	for (uint32_t i = 0; i < gpu_count; i++)
+		payload[2 + i] = handle_id_locked((uint64_t)(uintptr_t)gpus[i]);
+
+	write_locked(CAPTURE_OP_ENUMERATE_PHYSICAL_DEVICES, 0, payload.data(), (uint32_t)(payload.size() * sizeof(uint32_t)));
+}
+
+void CaptureWriter::record_get_physical_device_properties(VkPhysicalDevice gpu)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	CaptureGetPhysicalDeviceProperties info = {};
+	info.gpu_id = handle_id_locked((uint64_t)(uintptr_t)gpu);
+	write_locked(CAPTURE_OP_GET_PHYSICAL_DEVICE_PROPERTIES, 0, &info, sizeof(info));
+}
+
+void CaptureWriter::record_destroy_instance(VkInstance instance)
+{
+	std::lock_guard<std::mutex> guard(lock);
+
+	CaptureDestroyInstance info = {};
+	info.instance_id = handle_id_locked((uint64_t)(uintptr_t)instance);
+	write_locked(CAPTURE_OP_DESTROY_INSTANCE, 0, &info, sizeof(info));
+}
+
+ReplayContext::ReplayContext()
+{
+	count = 0;
+}
+
+void ReplayContext::reset(uint64_t handle_count)
+{
+	count = handle_count;
+	handles.reset(new std::atomic<uint64_t>[count]);
+	for (uint64_t i = 0; i < count; i++)
+		handles[i].store(0, std::memory_order_relaxed);
+}
+
+uint64_t ReplayContext::get(uint32_t id) const
+{
+	if (id >= count)
+		return 0;
+	return handles[id].load(std::memory_order_acquire);
+}
+
+void ReplayContext::set(uint32_t id, uint64_t handle)
+{
+	if (id == 0 || id >= count)
+		return;
+	handles[id].store(handle, std::memory_order_release);
+}
+
+// These are the default handlers, which replay
+// the calls that CaptureWriter knows how to record
+
+static void replay_create_instance(const CaptureRecord* record, const uint8_t* payload, ReplayContext& context)
+{
+	CaptureCreateInstance info;
+	memcpy(&info, payload, sizeof(info));
+
+	// the layer names are used straight out of the
+	// mapped file, as long as they are terminated
+	// before the end of the payload
+	std::vector<const char*> layers;
+	const char* name = (const char*)payload + sizeof(info);
+	const char* end = (const char*)payload + record->size;
+	for (uint32_t i = 0; i < info.layer_count && name < end; i++)
+	{
+		const char* terminator = (const char*)memchr(name, 0, end - name);
+		if (!terminator)
+			break;
+		layers.push_back(name);
+		name = terminator + 1;
+	}
+
+	VkInstanceCreateInfo inst_info = {};
+	inst_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	inst_info.enabledLayerCount = (uint32_t)layers.size();
+	inst_info.ppEnabledLayerNames = layers.data();
+
+	VkInstance instance = VK_NULL_HANDLE;
+	if (vkCreateInstance(&inst_info, NULL, &instance) != VK_SUCCESS)
+		printf("replay: vkCreateInstance failed\n");
+
+	context.set(info.instance_id, (uint64_t)(uintptr_t)instance);
+}
+
+static void replay_enumerate_physical_devices(const CaptureRecord* record, const uint8_t* payload, ReplayContext& context)
+{
+	CaptureEnumeratePhysicalDevices info;
+	memcpy(&info, payload, sizeof(info));
+
+	if (sizeof(info) + (uint64_t)info.gpu_count * sizeof(uint32_t) > record->size)
+		return;
+
+	VkInstance instance = (VkInstance)(uintptr_t)context.get(info.instance_id);
+	if (!instance)
+		return;
+
+	uint32_t live_count = 0;
+	vkEnumeratePhysicalDevices(instance, &live_count, NULL);
+	std::vector<VkPhysicalDevice> live(live_count);
+	vkEnumeratePhysicalDevices(instance, &live_count, live.data());
+
+	// The GPUs are matched up in the order that the driver
+	// gives them to us. If this machine has fewer GPUs than
+	// the one that made the capture, the extras stay null
+	const uint8_t* ids = payload + sizeof(info);
+	for (uint32_t i = 0; i < info.gpu_count && i < live_count; i++)
+	{
+		uint32_t id;
+		memcpy(&id, ids + i * sizeof(uint32_t), sizeof(id));
+		context.set(id, (uint64_t)(uintptr_t)live[i]);
+	}
+}
+
+static void replay_get_physical_device_properties(const CaptureRecord*, const uint8_t* payload, ReplayContext& context)
+{
+	CaptureGetPhysicalDeviceProperties info;
+	memcpy(&info, payload, sizeof(info));
+
+	VkPhysicalDevice gpu = (VkPhysicalDevice)(uintptr_t)context.get(info.gpu_id);
+	if (!gpu)
+		return;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(gpu, &properties);
+}
+
+static void replay_destroy_instance(const CaptureRecord*, const uint8_t* payload, ReplayContext& context)
+{
+	CaptureDestroyInstance info;
+	memcpy(&info, payload, sizeof(info));
+
+	VkInstance instance = (VkInstance)(uintptr_t)context.get(info.instance_id);
+	if (instance)
+		vkDestroyInstance(instance, NULL);
+
+	context.set(info.instance_id, 0);
+}
+
+// every payload is at least this big, so the
+// handlers can read their structure without checking
+static const uint32_t minimum_payload[CAPTURE_OP_COUNT] =
+{
+	0,
+	sizeof(CaptureCreateInstance),
+	sizeof(CaptureEnumeratePhysicalDevices),
+	sizeof(CaptureGetPhysicalDeviceProperties),
+	sizeof(CaptureDestroyInstance),
+};
+
+CaptureReplayer::CaptureReplayer()
+{
+	memset(&header, 0, sizeof(header));
+	memset(handlers, 0, sizeof(handlers));
+
+	handlers[CAPTURE_OP_CREATE_INSTANCE] = replay_create_instance;
+	handlers[CAPTURE_OP_ENUMERATE_PHYSICAL_DEVICES] = replay_enumerate_physical_devices;
+	handlers[CAPTURE_OP_GET_PHYSICAL_DEVICE_PROPERTIES] = replay_get_physical_device_properties;
+	handlers[CAPTURE_OP_DESTROY_INSTANCE] = replay_destroy_instance;
+}
+
+bool CaptureReplayer::open(const char* path)
+{
+	frames.clear();
+	frame_ms.clear();
+
+	if (!file.open(path) || file.size() < sizeof(header))
+		return false;
+
+	memcpy(&header, file.data(), sizeof(header));
+	if (header.magic != CAPTURE_MAGIC || header.version != CAPTURE_VERSION)
+		return false;
+
+	// If the program that made the capture crashed before
+	// closing the file, the header was never filled in.
+	// We can still replay it, every handle ID in the file
+	// takes at least 4 bytes, so that is our upper bound.
+	// A header that asks for more than that is broken, and
+	// we do not make room for handles that cannot be there
+	uint64_t handle_limit = file.size() / sizeof(uint32_t) + 1;
+	uint64_t handle_count = header.handle_count;
+	if (handle_count == 0 || handle_count > handle_limit)
+		handle_count = handle_limit;
+	context.reset(handle_count);
+
+	// The same goes for the frame numbers: a record from a frame
+	// past the end is broken, and we skip it rather than make room
+	// for billions of frames. There can not be more frames than
+	// the file has room for records
+	uint64_t frame_limit = file.size() / sizeof(CaptureRecord) + 1;
+	if (header.frame_count != 0 && header.frame_count < frame_limit)
+		frame_limit = header.frame_count;
+
+	// Walk through every record once, and remember
+	// where it is, grouped by frame and then by stream.
+	// A record that runs past the end of the file was
+	// cut off, so we stop there
+	uint64_t offset = sizeof(header);
+	while (offset + sizeof(CaptureRecord) <= file.size())
+	{
+		CaptureRecord record;
+		memcpy(&record, file.data() + offset, sizeof(record));
+
+		uint64_t next = offset + sizeof(record) + padded_size(record.size);
+		if (offset + sizeof(record) + record.size > file.size())
+			break;
+
+		if (record.opcode < CAPTURE_OP_COUNT && record.size >= minimum_payload[record.opcode] &&
+			record.frame < frame_limit)
+		{
+			if (record.frame >= frames.size())
+				frames.resize(record.frame + 1);
+
+			std::vector<StreamSlice>& slices = frames[record.frame];
+			size_t s = 0;
+			while (s < slices.size() && slices[s].stream != record.stream)
+				s++;
+
+			if (s == slices.size())
+			{
+				slices.push_back(StreamSlice());
+				slices[s].stream = record.stream;
+			}
+
+			slices[s].offsets.push_back(offset);
+		}
+
+		offset = next;
+	}
+
+	return true;
+}
+
+void CaptureReplayer::set_handler(uint16_t opcode, ReplayHandler handler)
+{
+	if (opcode < CAPTURE_OP_COUNT)
+		handlers[opcode] = handler;
+}
+
+void CaptureReplayer::replay_slice(const StreamSlice& slice)
+{
+	for (size_t i = 0; i < slice.offsets.size(); i++)
+	{
+		const uint8_t* at = file.data() + slice.offsets[i];
+
+		CaptureRecord record;
+		memcpy(&record, at, sizeof(record));
+
+		if (handlers[record.opcode])
+			handlers[record.opcode](&record, at + sizeof(record), context);
+	}
+}
+
+void CaptureReplayer::replay(ThreadPool& pool)
+{
+	frame_ms.clear();
+
+	for (size_t f = 0; f < frames.size(); f++)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+		// a frame with one stream does not need
+		// the pool, so skip the hand-off
+		const std::vector<StreamSlice>& slices = frames[f];
+		if (slices.size() == 1)
+		{
+			replay_slice(slices[0]);
+		}
+		else
+		{
+			for (size_t s = 0; s < slices.size(); s++)
+			{
+				const StreamSlice* slice = &slices[s];
+				pool.submit([this, slice] { replay_slice(*slice); });
+			}
+			pool.wait_idle();
+		}
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		frame_ms.push_back(elapsed.count());
+	}
+}
+
+void CaptureReplayer::print_report() const
+{
+	if (frame_ms.empty())
+	{
+		printf("The capture did not contain any frames\n");
+		return;
+	}
+
+	double total = 0;
+	double fastest = frame_ms[0];
+	double slowest = frame_ms[0];
+
+	for (size_t f = 0; f < frame_ms.size(); f++)
+	{
+		printf("frame %u: %zu streams, %.3f ms\n", (uint32_t)f, frames[f].size(), frame_ms[f]);
+
+		total += frame_ms[f];
+		if (frame_ms[f] < fastest) fastest = frame_ms[f];
+		if (frame_ms[f] > slowest) slowest = frame_ms[f];
+	}
+
+	printf("\n%u frames, average %.3f ms, fastest %.3f ms, slowest %.3f ms\n\n",
+		(uint32_t)frame_ms.size(), total / frame_ms.size(), fastest, slowest);
+}
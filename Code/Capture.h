@@ -0,0 +1,219 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+#include "MappedFile.h"
+
+class ThreadPool;
+
+// A capture file is a recording of every Vulkan call that
+// a program makes, so that the calls can be "replayed" later
+// without the original program. The format is built to be
+// mapped straight into memory and read in place:
+//
+//     CaptureFileHeader
+//     CaptureRecord + payload (padded to 8 bytes)
+//     CaptureRecord + payload (padded to 8 bytes)
+//     ...
+//
+// Vulkan handles are pointers that change every time the
+// program runs, so we never store them directly. Instead,
+// every handle gets a small "handle ID" the first time we
+// see it, and payloads store that ID. During replay, the
+// ID is used as an index into a table of the new handles.
+//
+// Every record belongs to a frame and to a "stream". Records
+// in the same stream are replayed in order, while different
+// streams in the same frame are independent of each other
+// (one stream per thread that recorded command buffers), so
+// they can be replayed on multiple threads at the same time.
+
+#define CAPTURE_MAGIC 0x50434B56 // "VKCP"
+#define CAPTURE_VERSION 1
+
+enum CaptureOpcode
+{
+	CAPTURE_OP_CREATE_INSTANCE = 1,
+	CAPTURE_OP_ENUMERATE_PHYSICAL_DEVICES,
+	CAPTURE_OP_GET_PHYSICAL_DEVICE_PROPERTIES,
+	CAPTURE_OP_DESTROY_INSTANCE,
+	CAPTURE_OP_COUNT
+};
+
+struct CaptureFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t stream_count;
+	uint32_t frame_count;
+	uint64_t record_count;
+	uint64_t handle_count;
+};
+
+struct CaptureRecord
+{
+	uint16_t opcode;
+	uint16_t stream;
+	uint32_t frame;
+	uint32_t size;      // size of the payload, not counting padding
+	uint32_t reserved;
+};
+
+// Payload layouts. Handles are stored as handle IDs,
+// and ID zero always means VK_NULL_HANDLE
+
+struct CaptureCreateInstance
+{
+	uint32_t instance_id;
+	uint32_t layer_count;
+	// followed by layer_count null-terminated layer names
+};
+
+struct CaptureEnumeratePhysicalDevices
+{
+	uint32_t instance_id;
+	uint32_t gpu_count;
+	// followed by gpu_count handle IDs
+};
+
+struct CaptureGetPhysicalDeviceProperties
+{
+	uint32_t gpu_id;
+};
+
+struct CaptureDestroyInstance
+{
+	uint32_t instance_id;
+};
+
+// CaptureWriter records calls into a capture file. It can be
+// used from several threads at once, as long as each thread
+// writes into its own stream
+class CaptureWriter
+{
+public:
+	CaptureWriter();
+	~CaptureWriter();
+
+	bool open(const char* path);
+
+	// write the final header and close the file
+	void close();
+
+	// get the handle ID for a handle, giving it
+	// a new ID if we have never seen it before
+	uint32_t handle_id(uint64_t handle);
+
+	// everything recorded after this call belongs to the next frame
+	void next_frame();
+
+	void write(uint16_t opcode, uint16_t stream, const void* payload, uint32_t size);
+
+	// helpers for the calls that the demo makes
+	void record_create_instance(VkInstance instance, uint32_t layer_count, char** layers);
+	void record_enumerate_physical_devices(VkInstance instance, uint32_t gpu_count, const VkPhysicalDevice* gpus);
+	void record_get_physical_device_properties(VkPhysicalDevice gpu);
+	void record_destroy_instance(VkInstance instance);
+
+private:
+	uint32_t handle_id_locked(uint64_t handle);
+	void write_locked(uint16_t opcode, uint16_t stream, const void* payload, uint32_t size);
+
+	FILE* file;
+	std::mutex lock;
+	CaptureFileHeader header;
+	uint32_t current_frame;
+	std::unordered_map<uint64_t, uint32_t> handle_ids;
+};
+
+// ReplayContext translates handle IDs from the capture
+// into the handles that were created during replay. Every
+// ID is only ever written by the one record that created
+// it, so streams can share the table without a lock
+class ReplayContext
+{
+public:
+	ReplayContext();
+
+	void reset(uint64_t handle_count);
+
+	uint64_t get(uint32_t id) const;
+	void set(uint32_t id, uint64_t handle);
+
+private:
+	std::unique_ptr<std::atomic<uint64_t>[]> handles;
+	uint64_t count;
+};
+
+typedef void (*ReplayHandler)(const CaptureRecord* record, const uint8_t* payload, ReplayContext& context);
+
+// CaptureReplayer maps a capture file, builds an index of
+// which records belong to which frame and stream, and then
+// replays the frames one at a time. Inside a frame, every
+// stream is handed to the thread pool, and we wait for all
+// of them to finish before starting the next frame
+class CaptureReplayer
+{
+public:
+	CaptureReplayer();
+
+	// returns false if the file is missing or is not a capture
+	bool open(const char* path);
+
+	// replace the function that replays one type of record
+	void set_handler(uint16_t opcode, ReplayHandler handler);
+
+	void replay(ThreadPool& pool);
+
+	// print the time that every frame took to replay
+	void print_report() const;
+
+	const std::vector<double>& frame_times() const { return frame_ms; }
+
+private:
+	struct StreamSlice
+	{
+		uint16_t stream;
+		std::vector<uint64_t> offsets;
+	};
+
+	void replay_slice(const StreamSlice& slice);
+
+	MappedFile file;
+	CaptureFileHeader header;
+	std::vector<std::vector<StreamSlice>> frames;
+	ReplayHandler handlers[CAPTURE_OP_COUNT];
+	ReplayContext context;
+	std::vector<double> frame_ms;
+};
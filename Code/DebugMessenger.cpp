@@ -0,0 +1,443 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "DebugMessenger.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// each message ID may write this many lines per second,
+// anything over that is only counted
+#define DEBUG_LINES_PER_SECOND 20
+
+// how long the background thread sleeps when there are no messages,
+// normally, and while the window is hidden (see set_background)
+#define DEBUG_IDLE_WAIT_MS 50
+#define DEBUG_BACKGROUND_WAIT_MS 1000
+
+DebugMessenger* DebugMessenger::active = nullptr;
+
+static uint64_t now_us()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// copy a string that might be null, and might be too long
+static void copy_text(char* dst, size_t dst_size, const char* src)
+{
+	if (!src)
+	{
+		dst[0] = 0;
+		return;
+	}
+
+	size_t length = strlen(src);
+	if (length >= dst_size)
+		length = dst_size - 1;
+
+	memcpy(dst, src, length);
+	dst[length] = 0;
+}
+
+// FNV-1a, so that we can tell if two messages are the same
+// without keeping a copy of the previous message around
+static uint64_t hash_message(const DebugMessage& message)
+{
+	uint64_t hash = 14695981039346656037ull;
+	hash = (hash ^ (uint32_t)message.id_number) * 1099511628211ull;
+	for (const char* c = message.text; *c; c++)
+		hash = (hash ^ (uint8_t)*c) * 1099511628211ull;
+	return hash;
+}
+
+static const char* severity_name(uint32_t severity)
+{
+	if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) return "error";
+	if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) return "warning";
+	if (severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT) return "info";
+	return "verbose";
+}
+
+static const char* type_name(uint32_t type)
+{
+	if (type & VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT) return "validation";
+	if (type & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT) return "performance";
+	return "general";
+}
+
+// write a string with quotes around it, escaping
+// anything that is not allowed inside a JSON string
+static void write_json_string(FILE* file, const char* text)
+{
+	fputc('"', file);
+	for (const char* c = text; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			fprintf(file, "\\%c", *c);
+		else if (*c == '\n')
+			fputs("\\n", file);
+		else if ((uint8_t)*c < 0x20)
+			fprintf(file, "\\u%04x", (uint8_t)*c);
+		else
+			fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+DebugMessenger::DebugMessenger()
+{
+	slots = new Slot[slot_count];
+	for (uint32_t i = 0; i < slot_count; i++)
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+
+	enqueue_position.store(0);
+	dequeue_position = 0;
+	dropped_count.store(0);
+	stopping.store(false);
+	idle_wait_ms.store(DEBUG_IDLE_WAIT_MS);
+	log = nullptr;
+
+	last_hash = 0;
+	repeat_count = 0;
+
+	instance = VK_NULL_HANDLE;
+	messenger = VK_NULL_HANDLE;
+	destroy_function = nullptr;
+}
+
+DebugMessenger::~DebugMessenger()
+{
+	destroy();
+	shutdown();
+	delete[] slots;
+}
+
+void DebugMessenger::fill_create_info(VkDebugUtilsMessengerCreateInfoEXT& info)
+{
+	info = {};
+	info.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+	info.messageSeverity =
+		VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+		VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+	info.messageType =
+		VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+		VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+		VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+	info.pfnUserCallback = callback;
+	info.pUserData = this;
+}
+
+void DebugMessenger::start_consumer()
+{
+	if (consumer.joinable())
+		return;
+
+	stopping.store(false);
+	consumer = std::thread(&DebugMessenger::consumer_main, this);
+	active = this;
+}
+
+bool DebugMessenger::create(VkInstance inst, const char* log_path)
+{
+	// the log file is opened before anything else, so that
+	// messages from vkCreateInstance have somewhere to go
+	if (!log && log_path)
+		log = fopen(log_path, "w");
+
+	start_consumer();
+
+	// extension functions are not exported by the loader,
+	// we have to ask the instance for them
+	PFN_vkCreateDebugUtilsMessengerEXT create_function = (PFN_vkCreateDebugUtilsMessengerEXT)
+		vkGetInstanceProcAddr(inst, "vkCreateDebugUtilsMessengerEXT");
+	destroy_function = (PFN_vkDestroyDebugUtilsMessengerEXT)
+		vkGetInstanceProcAddr(inst, "vkDestroyDebugUtilsMessengerEXT");
+
+	if (!create_function || !destroy_function)
+		return false;
+
+	VkDebugUtilsMessengerCreateInfoEXT info;
+	fill_create_info(info);
+
+	if (create_function(inst, &info, NULL, &messenger) != VK_SUCCESS)
+		return false;
+
+	instance = inst;
+	return true;
+}
+
+void DebugMessenger::destroy()
+{
+	if (messenger && destroy_function)
+		destroy_function(instance, messenger, NULL);
+
+	messenger = VK_NULL_HANDLE;
+	instance = VK_NULL_HANDLE;
+}
+
+void DebugMessenger::shutdown()
+{
+	if (consumer.joinable())
+	{
+		stopping.store(true);
+		wake.notify_one();
+		consumer.join();
+	}
+
+	if (log)
+	{
+		fclose(log);
+		log = nullptr;
+	}
+
+	if (active == this)
+		active = nullptr;
+}
+
+VKAPI_ATTR VkBool32 VKAPI_CALL DebugMessenger::callback(
+	VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+	VkDebugUtilsMessageTypeFlagsEXT type,
+	const VkDebugUtilsMessengerCallbackDataEXT* data,
+	void* user_data)
+{
+	// Copy the message and wake the consumer, nothing else.
+	// Returning VK_FALSE tells the layer not to abort the call
+	DebugMessenger* self = (DebugMessenger*)user_data;
+	if (self->push(data, severity, type))
+		self->wake.notify_one();
+
+	return VK_FALSE;
+}
+
+bool DebugMessenger::push(const VkDebugUtilsMessengerCallbackDataEXT* data, uint32_t severity, uint32_t type)
+{
+	// Claim a slot. If the slot's sequence number matches our
+	// position, it is free; if it is behind, the ring is full.
+	// If another thread claimed it first, try the next position
+	uint64_t position = enqueue_position.load(std::memory_order_relaxed);
+	Slot* slot;
+
+	while (true)
+	{
+		slot = &slots[position & (slot_count - 1)];
+		uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+		int64_t difference = (int64_t)(sequence - position);
+
+		if (difference == 0)
+		{
+			if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (difference < 0)
+		{
+			dropped_count.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+		{
+			position = enqueue_position.load(std::memory_order_relaxed);
+		}
+	}
+
+	DebugMessage& message = slot->message;
+	message.timestamp_us = now_us();
+	message.id_number = data->messageIdNumber;
+	message.severity = severity;
+	message.type = type;
+	copy_text(message.id_name, sizeof(message.id_name), data->pMessageIdName);
+	copy_text(message.text, sizeof(message.text), data->pMessage);
+
+	// publish the slot to the consumer
+	slot->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+bool DebugMessenger::pop(DebugMessage& message)
+{
+	Slot& slot = slots[dequeue_position & (slot_count - 1)];
+	if (slot.sequence.load(std::memory_order_acquire) != dequeue_position + 1)
+		return false;
+
+	message = slot.message;
+
+	// hand the slot back to the producers, one lap later
+	slot.sequence.store(dequeue_position + slot_count, std::memory_order_release);
+	dequeue_position++;
+	return true;
+}
+
+void DebugMessenger::set_background(bool background)
+{
+	idle_wait_ms.store(background ? DEBUG_BACKGROUND_WAIT_MS : DEBUG_IDLE_WAIT_MS);
+}
+
+void DebugMessenger::consumer_main()
+{
+	DebugMessage message;
+
+	while (!stopping.load())
+	{
+		bool any = false;
+		while (pop(message))
+		{
+			consume(message);
+			any = true;
+		}
+
+		// when the ring is empty, flush the file and sleep
+		// until the callback wakes us. The timeout covers
+		// a wake-up that arrives right before we wait
+		if (!any)
+		{
+			if (log)
+				fflush(log);
+
+			std::unique_lock<std::mutex> guard(wake_lock);
+			wake.wait_for(guard, std::chrono::milliseconds(idle_wait_ms.load()));
+		}
+	}
+
+	// write whatever arrived while we were stopping
+	while (pop(message))
+		consume(message);
+
+	if (log && repeat_count)
+		fprintf(log, "{\"repeated\":%llu}\n", (unsigned long long)repeat_count);
+
+	if (log)
+		fflush(log);
+}
+
+void DebugMessenger::consume(const DebugMessage& message)
+{
+	std::lock_guard<std::mutex> guard(counter_lock);
+
+	DebugMessageCounter& counter = counter_table[message.id_number];
+	if (counter.received == 0)
+	{
+		counter.id_number = message.id_number;
+		counter.id_name = message.id_name;
+	}
+	counter.received++;
+
+	// the same message again, straight after itself
+	uint64_t hash = hash_message(message);
+	if (hash == last_hash)
+	{
+		counter.duplicates++;
+		repeat_count++;
+		return;
+	}
+
+	// say how many repeats we skipped before moving on
+	if (log && repeat_count)
+		fprintf(log, "{\"repeated\":%llu}\n", (unsigned long long)repeat_count);
+
+	last_hash = hash;
+	repeat_count = 0;
+
+	// each ID gets a one second window with a line budget
+	RateState& rate = rates[message.id_number];
+	if (message.timestamp_us - rate.window_start_us >= 1000000)
+	{
+		rate.window_start_us = message.timestamp_us;
+		rate.lines_in_window = 0;
+	}
+
+	if (rate.lines_in_window >= DEBUG_LINES_PER_SECOND)
+	{
+		counter.rate_limited++;
+		return;
+	}
+
+	rate.lines_in_window++;
+	counter.written++;
+
+	if (log)
+	{
+		fprintf(log, "{\"time_us\":%llu,\"severity\":\"%s\",\"type\":\"%s\",\"id\":%d,\"id_name\":",
+			(unsigned long long)message.timestamp_us, severity_name(message.severity),
+			type_name(message.type), message.id_number);
+		write_json_string(log, message.id_name);
+		fputs(",\"message\":", log);
+		write_json_string(log, message.text);
+		fputs("}\n", log);
+	}
+
+	if (message.severity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+		printf("%s\n\n", message.text);
+}
+
+std::vector<DebugMessageCounter> DebugMessenger::counters()
+{
+	std::lock_guard<std::mutex> guard(counter_lock);
+
+	std::vector<DebugMessageCounter> result;
+	for (std::unordered_map<int32_t, DebugMessageCounter>::iterator i = counter_table.begin(); i != counter_table.end(); ++i)
+		result.push_back(i->second);
+	return result;
+}
+
+void DebugMessenger::print_counters()
+{
+	std::vector<DebugMessageCounter> list = counters();
+	if (list.empty() && dropped() == 0)
+		return;
+
+	printf("Debug messages by ID:\n");
+	for (size_t i = 0; i < list.size(); i++)
+	{
+		printf("  %-48s received %llu, written %llu, duplicates %llu, rate limited %llu\n",
+			list[i].id_name.c_str(),
+			(unsigned long long)list[i].received, (unsigned long long)list[i].written,
+			(unsigned long long)list[i].duplicates, (unsigned long long)list[i].rate_limited);
+	}
+	printf("  dropped because the queue was full: %llu\n\n", (unsigned long long)dropped());
+}
+
+void report_fatal_error(const char* message, const char* error_class)
+{
+	fprintf(stderr, "%s\n%s\n", error_class, message);
+	fflush(stderr);
+
+	// make sure the validation messages that led up
+	// to the error are in the log before we quit
+	if (DebugMessenger::active)
+		DebugMessenger::active->shutdown();
+
+#ifdef _WIN32
+	// without a console, nobody would see the
+	// message, so fall back to a message box
+	if (!GetConsoleWindow())
+		MessageBox(NULL, message, error_class, MB_OK);
+#endif
+
+	exit(1);
+}
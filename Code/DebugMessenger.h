@@ -0,0 +1,180 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// One message from the validation layer or the driver.
+// The text is copied into a fixed-size buffer, so that the
+// callback never has to allocate memory
+struct DebugMessage
+{
+	uint64_t timestamp_us;
+	int32_t id_number;
+	uint32_t severity;  // VkDebugUtilsMessageSeverityFlagBitsEXT
+	uint32_t type;      // VkDebugUtilsMessageTypeFlagsEXT
+	char id_name[64];
+	char text[1024];
+};
+
+// How many times we have seen each message ID.
+// "written" is how many made it into the log, the
+// rest were duplicates or went over the rate limit
+struct DebugMessageCounter
+{
+	int32_t id_number;
+	std::string id_name;
+	uint64_t received;
+	uint64_t written;
+	uint64_t duplicates;
+	uint64_t rate_limited;
+};
+
+// DebugMessenger receives messages through VK_EXT_debug_utils.
+//
+// The validation layer calls our callback on whatever thread made
+// the Vulkan call, and that thread is stuck until the callback
+// returns. Writing to the console from the callback would make
+// every Vulkan call wait on console I/O, so the callback only
+// copies the message into a ring buffer, without taking any locks.
+//
+// A background thread takes messages out of the ring buffer, drops
+// repeats of the message it just wrote, limits how many lines each
+// message ID can write per second, and writes one JSON object per
+// line into the log file. Errors are also printed to the console,
+// since those are the ones a person needs to see right away.
+class DebugMessenger
+{
+public:
+	DebugMessenger();
+	~DebugMessenger();
+
+	// Fill in a create info that can be put in the pNext chain of
+	// VkInstanceCreateInfo, so that messages from vkCreateInstance
+	// and vkDestroyInstance are caught too
+	void fill_create_info(VkDebugUtilsMessengerCreateInfoEXT& info);
+
+	// Start the background thread and register the messenger.
+	// Returns false if the extension functions are missing
+	bool create(VkInstance instance, const char* log_path);
+
+	// Unregister the messenger. This has to happen
+	// before the instance is destroyed
+	void destroy();
+
+	// Write everything that is still in the ring buffer,
+	// and stop the background thread. This should happen
+	// after the instance is destroyed, so that messages
+	// from vkDestroyInstance are written too
+	void shutdown();
+
+	std::vector<DebugMessageCounter> counters();
+
+	// messages thrown away because the ring buffer was full
+	uint64_t dropped() const { return dropped_count.load(); }
+
+	void print_counters();
+
+	// When nobody can see the window, there is nobody to read new
+	// messages either, so the background thread checks for them
+	// much less often. The callback still wakes it up right away
+	void set_background(bool background);
+
+	// the messenger that ERR_EXIT should flush before quitting
+	static DebugMessenger* active;
+
+private:
+	static VKAPI_ATTR VkBool32 VKAPI_CALL callback(
+		VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+		VkDebugUtilsMessageTypeFlagsEXT type,
+		const VkDebugUtilsMessengerCallbackDataEXT* data,
+		void* user_data);
+
+	bool push(const VkDebugUtilsMessengerCallbackDataEXT* data, uint32_t severity, uint32_t type);
+	bool pop(DebugMessage& message);
+
+	void consumer_main();
+	void consume(const DebugMessage& message);
+	void start_consumer();
+	void stop_consumer();
+
+	// The ring buffer. Every slot has a sequence number, which tells
+	// producers and the consumer whose turn it is to use the slot
+	// (this is Dmitry Vyukov's bounded multi-producer queue)
+	struct Slot
+	{
+		std::atomic<uint64_t> sequence;
+		DebugMessage message;
+	};
+
+	static const uint32_t slot_count = 1024;
+	Slot* slots;
+	std::atomic<uint64_t> enqueue_position;
+	uint64_t dequeue_position;
+	std::atomic<uint64_t> dropped_count;
+
+	// consumer thread
+	std::thread consumer;
+	std::mutex wake_lock;
+	std::condition_variable wake;
+	std::atomic<bool> stopping;
+	FILE* log;
+
+	// how long the consumer sleeps when the ring is empty
+	std::atomic<uint32_t> idle_wait_ms;
+
+	// dedup and rate limit state, only used by the consumer
+	uint64_t last_hash;
+	uint64_t repeat_count;
+
+	struct RateState
+	{
+		uint64_t window_start_us;
+		uint32_t lines_in_window;
+	};
+	std::unordered_map<int32_t, RateState> rates;
+
+	// counters are read by other threads, so they get a lock
+	std::mutex counter_lock;
+	std::unordered_map<int32_t, DebugMessageCounter> counter_table;
+
+	VkInstance instance;
+	VkDebugUtilsMessengerEXT messenger;
+	PFN_vkDestroyDebugUtilsMessengerEXT destroy_function;
+};
+
+// Print a fatal error, make sure every queued validation
+// message has been written, and then quit. ERR_EXIT uses this
+void report_fatal_error(const char* message, const char* error_class);
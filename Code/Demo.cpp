@@ -1,672 +1,1667 @@
-/*
-Copyright 2019
-Original authors: Niko Procopi
-Written under the supervision of David I. Schwartz, Ph.D., and
-supported by a professional development seed grant from the B. Thomas
-Golisano College of Computing & Information Sciences
-(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
-This program is free software: you can redistribute it and/or modify
-it under the terms of the GNU General Public License as published by
-the Free Software Foundation, either version 3 of the License, or (at
-your option) any later version.
-
-This program is distributed in the hope that it will be useful, but
-WITHOUT ANY WARRANTY; without even the implied warranty of
-MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
-General Public License for more details.
-<http://www.gnu.org/licenses/>.
-
-Special Thanks to Exzap from Team Cemu,
-he gave me advice on how to optimize Vulkan
-graphics, he is working on a Wii U emulator
-that utilizes Vulkan, see more at http://cemu.info
-*/
-
-#include "Demo.h"
-
-#define _GNU_SOURCE
-#include <stdio.h>
-#include <stdarg.h>
-#include <stdlib.h>
-#include <string.h>
-#include <stdbool.h>
-#include <assert.h>
-#include <signal.h>
-#include <vector>
-#include "Main.h"
-
-// This boolean keeps track of how many times we have executed the
-// "prepare()" function. If we have never used the function before
-// then we know we are initializing the program for the first time,
-// if the boolean is false, then we know the program has already
-// been initialized
-bool firstInit = true;
-
-void Demo::prepare_console()
-{
-	// This line is commented out,
-	// if you uncomment this "freopen" line,
-	// it will redirect all text from the console
-	// window into a text file. Then, nothing will
-	// print to the console window, but it will all
-	// be saved to a file
-
-	// freopen("output.txt", "a+", stdout);
-
-	// If you leave that line commented out ^^
-	// then everything will print to the console
-	// window, just like normal
-
-	// Create Console Window
-	
-	// Allocate memory for the console
-	AllocConsole();
-	
-	// Attatch the console to this process,
-	// so that printf statements from this 
-	// process go into the console
-	AttachConsole(GetCurrentProcessId());
-
-	// looks confusing, but we never need to change it,
-	// basically this redirects all printf, scanf,
-	// cout, and cin to go to the console, rather than
-	// going where it goes by default, which is nowhere
-	FILE *stream;
-	freopen_s(&stream, "conin$", "r", stdin);
-	freopen_s(&stream, "conout$", "w", stdout);
-	freopen_s(&stream, "conout$", "w", stderr);
-	SetConsoleTitle(TEXT("Console window"));
-
-	// Adjust Console Window
-	// This is completely optional
-
-	// Get the console window
-	HWND console = GetConsoleWindow();
-
-	// Move the window to position (0, 0),
-	// resize the window to be 640 x 360 (+40).
-	// The +40 is to account for the title bar
-	MoveWindow(console, 0, 0, 640, 360 + 40, TRUE);
-}
-
-void Demo::prepare_window()
-{
-	// Make the title of the screen "Loading"
-	// while the program loads
-	strncpy(name, "Loading...", APP_NAME_STR_LEN);
-
-	WNDCLASSEX win_class = {};
-
-	// Initialize the window class structure:
-	// The most important detail here is that we
-	// give it the WndProc function from main.cpp,
-	// so that the function can handle our window.
-	// Everything else here sets the icon, the title,
-	// the cursor, thing like that
-	win_class.cbSize = sizeof(WNDCLASSEX);
-	win_class.style = CS_HREDRAW | CS_VREDRAW;
-	win_class.lpfnWndProc = WndProc;
-	win_class.hIcon = LoadIcon(NULL, IDI_APPLICATION);
-	win_class.hCursor = LoadCursor(NULL, IDC_ARROW);
-	win_class.hbrBackground = (HBRUSH)GetStockObject(WHITE_BRUSH);
-	win_class.lpszMenuName = NULL;
-	win_class.lpszClassName = name;
-	win_class.hIconSm = LoadIcon(NULL, IDI_WINLOGO);
-
-	// RegisterClassEx will do waht it sounds like,
-	// it registers the WNDCLASSEX structure, so that
-	// we can use win_class to make a window
-
-	// If the function fails to register win_class
-	// then give an error
-	if (!RegisterClassEx(&win_class))
-	{
-		// It didn't work, so try to give a useful error:
-		printf("Unexpected error trying to start the application!\n");
-		fflush(stdout);
-		exit(1);
-	}
-
-	// Create window with the registered class:
-	RECT wr = { 0, 0, width, height };
-	AdjustWindowRect(&wr, WS_OVERLAPPEDWINDOW, FALSE);
-
-	// We will now create our window
-	// with the function "CreateWindowEx"
-	// Win32 and DirectX 11 have some functions
-	// with a huge ton of parameters. What 
-	// Vulkan does for all functions, and what
-	// DirectX 11 sometimes does, is organize
-	// all parameters into a structure, and then
-	// pass the structure as one parameter
-	window = CreateWindowEx(0,
-		name,            // class name
-		name,            // app name
-		WS_OVERLAPPEDWINDOW |  // window style
-		WS_VISIBLE | WS_SYSMENU,
-
-		// The position (0,0) is the top-left
-		// corner of the screen, which is where
-		// the command prompt is, and the command 
-		// prompt is 640 pixels wide, so lets put
-		// the Vulkan window right next to the console window
-		640, 0,				 // (x,y) position
-		wr.right - wr.left,  // width
-		wr.bottom - wr.top,  // height
-		NULL,                // handle to parent, no parent exists
-
-		// This would give you "File" "Edit" "Help", etc
-		NULL,                // handle to menu, no menu exists
-		(HINSTANCE)0,		 // no hInstance
-		NULL);               // no extra parameters
-
-	// if we failed to make the window
-	// then give an error that the window failed
-	if (!window)
-	{
-		// It didn't work, so try to give a useful error:
-		printf("Cannot create a window in which to draw!\n");
-		fflush(stdout);
-		exit(1);
-	}
-
-	// Window client area size must be at least 1 pixel high, to prevent crash.
-	minsize.x = GetSystemMetrics(SM_CXMINTRACK);
-	minsize.y = GetSystemMetrics(SM_CYMINTRACK) + 1;
-}
-
-void Demo::prepare_instance()
-{
-	// The first thing we need to do, is choose the 
-	// "layers" and "extensions" that we want to use in Vulkan
-	// "Extensions" give us additional features, like ray tracing.
-	// By default, Vulkan does not have support for any type of 
-	// window: not iOS, Android, Windows, Linux, Mac, GLFW, 
-	// or any type of Window, those are all available in different
-	// extensions, which we will be using
-
-	// "Layers" are what they sound like, they sit between
-	// the driver and our code.
-	// if we have no layers, then our code will speak
-	// directly to the Vulkan driver, if we put a layer
-	// between our code and the driver, the code will not be
-	// as fast, but layers can still be very helpful, or even
-	// simplify the programming process
-
-	// In this case, we want the "Khronos Validation Layer".
-	// Just like an HTML validation (which you may have used if you
-	// made a website), the Vulkan validator will check our code for us,
-	// and tell us if it thinks we've made any mistakes. This layer
-	// can be disabled when development of a project is finished
-	char *instance_validation_layer = "VK_LAYER_KHRONOS_validation";
-
-	// our window is not minimized
-	is_minimized = false;
-
-	// We have one validation layer that we want to enable,
-	// but we do not know if the layer is supported on the
-	// computer that is running the software, so lets quickly
-	// find out if it is supported
-
-	// we create a boolean to see if we found the layer
-	VkBool32 validation_found = 0;
-
-	// only enable validation if the validate bool
-	// is true. This boolean was set to true in init().
-	// This is set to true or false by the programmer, it
-	// does not depend on anything. It should be set to true
-	// during development, and set to false when it is time 
-	// to release the software
-	if (validate)
-	{
-		// set the number of instance layers to zero
-		// This is the number of total layers supported by 
-		// our vulkan device, we set it to zero by default
-		uint32_t total_instance_layers = 0;
-
-		// What you are about to see, is something that Vulkan
-		// does a lot, so please make sure you understand this 
-		// before continuing. The function we are about to use is
-		// vkEnumerateInstanceLayerProperties, it takes two parameters,
-		// the first parameter is a pointer to a uint32_t number, and
-		// the other parameter is a pointer to an array
-
-		// if the array is set to null, 
-		// then vkEnumerateInstanceLayerProperties will set the
-		// uint32_t number equal to the total number of layers
-		// that are available.
-
-		// if the array is not set to null,
-		// then vkEnumerateInstanceLayerProperties will fill the
-		// array with elements, the number of elements will be equal
-		// to the uint32_t number given in the first parameter
-
-		// That means we will use vkEnumerateInstanceLayerProperties
-		// two times, the first time will give us the number of
-		// layers, and the second time will give us the array
-
-		// call vkEnumerateInstanceLayerProperties for the 1st time,
-		// get number of instance layers supported by the GPU
-		vkEnumerateInstanceLayerProperties(&total_instance_layers, NULL);
-
-		if (total_instance_layers > 0)
-		{
-			// Create an array that can hold the properties of every layer available
-			// The properties of each layer (VkLayerProperties) will tell us 
-			// the name of the layer, the version, and even a description of the layer
-			VkLayerProperties* instance_layers = new VkLayerProperties[total_instance_layers];
-
-			// call vkEnumerateInstanceLayerProperties for the 2nd time,
-			// get the properties of all instance layers that are available
-			vkEnumerateInstanceLayerProperties(&total_instance_layers, instance_layers);
-
-			// If you did not understand the last three lines, please read the comments again.
-			// This pattern WILL be used several times, maybe over 10 times, throughout the
-			// course of the program
-
-			// out of all the available layers,
-			// check all the layers to see if the Khronos Validation Layer is supported.
-			// We are checking each layer to see if the name of each layer is equal
-			// to the name of the layer we want. If the layer we want is on the list
-			// of supported layers, then we can use the validation layer, which we 
-			// set at the beginning of the function
-			for (uint32_t j = 0; j < total_instance_layers; j++)
-			{
-				// check to see if this layer has the same name as the one we want
-				if (!strcmp(instance_validation_layer, instance_layers[j].layerName))
-				{
-					// we found the validation layer, woo!
-					validation_found = 1;
-					break;
-				}
-			}
-
-			// we set the number of enabled layers to zero.
-			// regardless if we found the validation layer in the 'for'
-			// loop or not, we still have not enabled any layers yet
-			enabled_layer_count = 0;
-
-			// If we found the validation layer
-			if (validation_found)
-			{
-				// then we have one layer that we can enable
-				enabled_layer_count = 1;
-
-				// add our validation layer to the list
-				// of enabled layers. Technically this layer
-				// is still not enabled yet, but it is guarranteed
-				// that it can be enabled successfully, because we
-				// just confirmed that it is supported. Don't worry
-				// though, it will be enabled by the end of this function
-				enabled_layers[0] = instance_validation_layer;
-			}
-
-			// we dont need the full list of instance layers
-			// we can remove it now that we're done with it
-			free(instance_layers);
-		}
-
-		// if we did not find a validation layer,
-		// or, if we did not find any layers at all
-		if (!validation_found || total_instance_layers <= 0)
-		{
-			// Give the user an error that we failed to find the validation layer.
-			// If this error is found, you can fix it by disabling validate
-			// in init()
-			ERR_EXIT(
-				"vkEnumerateInstanceLayerProperties failed to find required validation layer.\n\n"
-				"Please look at the Getting Started guide for additional information.\n",
-				"vkCreateInstance Failure");
-		}
-	}
-
-	// some tutorials will have VkApplicationInfo,
-	// and then that will be put inside the 
-	// structure of VkInstanceCreateInfo. However,
-	// I personally believe that it is a waste of time.
-	// All it does is hold the name of the app, the version,
-	// the name of the engine, and the version, it literally
-	// does not do or change anything in the program, so I 
-	// just ignore it
-
-	// It is time to talk about another pattern that 
-	// will be used in all over the Vulkan program.
-
-	// When we create the structure VkInstanceCreateInfo,
-	// we will give it an "sType" that is ALWAYS equal 
-	// to VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO.
-
-	// Some people wonder "what is the point of having the
-	// ability to change sType if it should always be the 
-	// same anyways?"
-
-	// Here is why: Eventually, we will take our object
-	// of VkInstanceCreateInfo, which in this case is 
-	// called "inst_info", and we will pass it to the
-	// function "vkCreateInstance". When we do that,
-	// we will give it a pointer to inst_info.
-
-	// vkCreateInstance will check to see if the
-	// first four bytes of the pointer is equal to 
-	// VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO. If it
-	// is equal, then that means we passed the correct
-	// pointer to the function, which is "inst_info".
-	// If vkCreateInstance does not see "VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO",
-	// then that means the programmer might have made
-	// a mistake, by giving the wrong poniter to the
-	// vkCreateInstance function, and then the validation
-	// layer will print an error in the command prompt window
-	// that we made a mistake.
-
-	// Therefore, the reason why every Vk---CreateInfo
-	// structure has sType, is to help us make sure that
-	// we are not making mistakes. If you do not understand this
-	// then please read the commments again, this will
-	// be a pattern that is seen throughout the entire tutorial
-
-	// Also, the reason why Vulkan has structures for "create Info",
-	// is so that we can pass the structure as one parameter,
-	// rather than passing all of these variables as seperate
-	// parameters. Some DirectX 11 functions like D3DCreateDeviceAndSwapchain,
-	// have 10 parameters, and Vulkan puts the parameters into a structure,
-	// to make the code look more organized
-
-	// We create an "instance" of Vulkan, so that we can start
-	// using vulkan features, this allows us to use Vulkan commands
-	// that the driver provides
-
-	// create our InstanceCreateInfo, with the necessary sType,
-	// the number of layers we want to enable, the array of layers
-	// that we want to enable, the number of extensions we want to enable,
-	// and the array of extensions that we want to enable.
-	VkInstanceCreateInfo inst_info = {};
-	inst_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-	inst_info.enabledLayerCount = enabled_layer_count;
-	inst_info.ppEnabledLayerNames = (const char *const *)enabled_layers;
-
-	// Attempt to create a Vulkan Instance with the information provided.
-	// We take the value that this returns, so that we can see if the
-	// instance was created correctly
-	VkResult err = vkCreateInstance(&inst_info, NULL, &inst);
-
-	// If the function returns a value of -9,
-	// then the driver is not compatible with Vulkan
-	if (err == VK_ERROR_INCOMPATIBLE_DRIVER)
-	{
-		ERR_EXIT(
-			"Cannot find a compatible Vulkan installable client driver (ICD).\n\n"
-			"Please look at the Getting Started guide for additional information.\n",
-			"vkCreateInstance Failure");
-	}
-
-	// if the function returns a value of -7,
-	// then there is an extension that is not supported
-	// that we tried to enable. This will probably never
-	// happen since we wnt through the necessary checks
-	// earlier in the function
-	else if (err == VK_ERROR_EXTENSION_NOT_PRESENT)
-	{
-		ERR_EXIT(
-			"Cannot find a specified extension library.\n"
-			"Make sure your layers path is set appropriately.\n",
-			"vkCreateInstance Failure");
-	}
-
-	// if any other value is returned that is not zero,
-	// then we got an unknown error
-	else if (err)
-	{
-		ERR_EXIT(
-			"vkCreateInstance failed.\n\n"
-			"Do you have a compatible Vulkan installable client driver (ICD) installed?\n"
-			"Please look at the Getting Started guide for additional information.\n",
-			"vkCreateInstance Failure");
-	}
-}
-
-void Demo::prepare_physical_device()
-{
-	// Now that we have an instance of Vulkan, we need
-	// to determine how many GPUs are available that
-	// can use Vulkan. We will be following the same
-	// pattern as before: get the number of elements,
-	// make an array, give the array to a function, and
-	// the function will fill it with data
-
-	// set the number of GPUs available to zero
-	uint32_t gpu_count = 0;
-
-	// In Vulkan, a PhysicalDevice holds all the information
-	// about a GPU that is in a computer: how much memory it has,
-	// what features it supports, the name of the GPU, the
-	// company that made the GPU, the amount of processors,
-	// literally everything.
-
-	// HOWEVER, the PhysicalDevice only holds information
-	// about the GPU, we cannot use PhysicalDevice to 
-	// give commands to the GPU. For that, we need to 
-	// create a "Device" from the same GPU. The first time
-	// we do this, it will be confusing, but it will 
-	// eventually make sense.
-
-	// use the function vkEnumeratePhysicalDevices to get
-	// the number of GPUs that are present in the computer.
-	// we set the array of VkPhysicalDevice to NULL, so that
-	// the function knows that it is looking for the number 
-	// of GPUs
-	vkEnumeratePhysicalDevices(inst, &gpu_count, NULL);
-
-	// if we found a GPU
-	if (gpu_count > 0)
-	{
-		// Create an array that will hold all PhysicalDevices in the computer
-		VkPhysicalDevice* physical_devices = new VkPhysicalDevice[gpu_count];
-
-		// Pass the array to this function, and then the array
-		// will be filled with data that tells us about every GPU
-		// in the computer that supports Vulkan
-		vkEnumeratePhysicalDevices(inst, &gpu_count, physical_devices);
-
-		// Each PhsyicalDevice be a dedicated graphics card, 
-		// or an integraded graphics chip in a CPU, some devices
-		// support graphics, some only support compute, there are
-		// a lot of different types of GPUs out there that support Vulkan.
-
-		// If someone wanted to, they could do a search to find which GPU
-		// in the list most powerwful, or they could check for different
-		// properties, but for this simple example, just take 
-		// the first on the list, because that is usually best one
-
-		// If you have multiple GPUs in your computer, maybe you have
-		// both a dedicated GPU and a GPU integrated in the CPU,
-		// set your dedicated GPU as your default graphics processor
-		// in the Nvidia Control Panel, or AMD Catalayst, or Intel
-		// Graphics Settings, and then that one will be the first
-		// that shows up in the array
-		gpu = physical_devices[0];
-
-		// we do not need all of the devices anymore, we have
-		// the one that we want
-		free(physical_devices);
-
-		// We want to get properteis from the physical device.
-		// This is completely option, I did it because I feel like it
-		VkPhysicalDeviceProperties features;
-
-		// This gives us the name of the GPU, the number of processors
-		// on the GPU, the amount of memory, the company that made the
-		// GPU, everything there is to know
-		vkGetPhysicalDeviceProperties(gpu, &features);
-
-		// set the title of the window to the name of the GPU,
-		// so that we know we are using the GPU that we want to use
-		SetWindowText(window, features.deviceName);
-
-		printf("We found a GPU, the name of the GPU is:\n");
-		printf("%s\n\n", features.deviceName);
-	}
-
-	// If no GPUs were found, then 
-	// give an error to the user
-	else
-	{
-		ERR_EXIT(
-			"vkEnumeratePhysicalDevices reported zero accessible devices.\n\n"
-			"Do you have a compatible Vulkan installable client driver (ICD) installed?\n"
-			"Please look at the Getting Started guide for additional information.\n",
-			"vkEnumeratePhysicalDevices Failure");
-	}
-
-	// When we created the instance, we chose to use some extensions of the instance,
-	// such as the SURFACE and WIN32 extensions. Now, we will enable extensions from
-	// the PhysicalDevice. These extensions will help us with creating the "swapchain".
-
-	// If a student does not know what a swapchain is, don't worry, the "swapchain" will
-	// be fully explained in the prepare_swapchain() function, explaining what it is 
-	// and why we need it. For now, here is how we enable the swapchain extension.
-
-	// by default, we have not found the swapchain extension (yet)
-	VkBool32 swapchainExtFound = 0;
-
-	// Set the number of enabled_extensions to zero,
-	// and clear the list of extension names. These
-	// are the same variables we used for the instance,
-	// but the instance doesn't need these variables now,
-	// so we will re-use them for a similar purpose
-	enabled_extension_count = 0;
-	memset(extension_names, 0, sizeof(extension_names));
-
-	// By default, there are zero device extensions that exist (that we know of)
-	uint32_t device_extension_count = 0;
-
-	// call this function to find out how many device extensions are available
-	vkEnumerateDeviceExtensionProperties(gpu, NULL, &device_extension_count, NULL);
-
-	// if there are more than zero extensions available,
-	// then look for the extension that we want
-	if (device_extension_count > 0)
-	{
-		// first we make a list that can hold all of the device's extensions
-		VkExtensionProperties* device_extensions = new VkExtensionProperties[device_extension_count];
-
-		// then we call the same function again to get the list of all extensions that are available
-		vkEnumerateDeviceExtensionProperties(gpu, NULL, &device_extension_count, device_extensions);
-
-		// we search through the list to look for the extension that we want,
-		// which in this case, is the swapchain extension
-		for (uint32_t i = 0; i < device_extension_count; i++)
-		{
-			// if we find the swapchain extension on the list of supported extensions
-			if (!strcmp(VK_KHR_SWAPCHAIN_EXTENSION_NAME, device_extensions[i].extensionName))
-			{
-				// set this boolean so we know that we found it
-				swapchainExtFound = 1;
-
-				// add the swapchain to our list of extensions,
-				// and increment the counter for the number of extensions
-				extension_names[enabled_extension_count++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
-			}
-		}
-
-		// we do not need the list of extensions anymore,
-		// now that we have already searched through it,
-		// so we can delete it now
-		free(device_extensions);
-	}
-
-	// if the swapchain was not found, then give an error and let the
-	// user know that the swapchain could not be found
-	if (!swapchainExtFound)
-	{
-		ERR_EXIT("vkEnumerateDeviceExtensionProperties failed to find the " VK_KHR_SWAPCHAIN_EXTENSION_NAME
-			" extension.\n\nDo you have a compatible Vulkan installable client driver (ICD) installed?\n"
-			"Please look at the Getting Started guide for additional information.\n",
-			"vkCreateInstance Failure");
-	}
-}
-
-void Demo::prepare()
-{
-	// We will be calling prepare() multiple times.
-	// Some Vulkan assets only need to be created once, like
-	// the instance, the device, and the queue (i'll explain those soon),
-	// while some things need to be destroyed and rebuilt, like the 
-	// swapchain images (I'll explain those soon).
-
-	// We keep track of a variable called firstInit, to determine
-	// if we have run the prepare() function before. "firstInit"
-	// is initialized as true at the top of Demo.cpp, and it is
-	// set to false after the first initialization is done
-
-	if (firstInit)
-	{
-		// Validation will tell us if our Vulkan code is correct.
-		// Sometimes, our code will execute the way we want it to,
-		// but just becasue the code runs, does not mean the code
-		// is correct. If you've ever used HTML, you may have used
-		// and HTML validator, where your website might look correct,
-		// but the validator will tell you that the code is wrong
-
-		// If you run in Debug mode, no Validator text will appear,
-		// text from Validator will only appear if you are in Release Mode
-
-		// During development, this is a great tool. However, when it is
-		// time to release a software or game, you don't want this running
-		// in the background because it will continue constantly checking for errors
-		// even if there are no errors. So, when you want to release a software or
-		// game, simply set this to false.
-		validate = true;
-
-		// During development, it is good to have a console window.
-		// You can read errors, and write printf statements.
-		// However, if you want to release a software or game, you may
-		// not want a console window. Simply comment out this line to 
-		// disable the console window.
-		prepare_console();
-
-		// set the width and height of the window
-		// literally set this to whatever you want
-		width = 640;
-		height = 360;
-
-		// build the window with the Win32 API. This will look similar to how
-		// a window is created in a DirectX 11/12 engine, and we will use the
-		// WndProc from main.cpp to create the window
-		prepare_window();
-
-		// We create an instance of Vulkan, this allows us to use VUlkan
-		// commands on the CPU, but we will not yet be able to talk to 
-		// the graphics device, that comes later
-		prepare_instance();
-
-		// The physical device gives us all the properties of the GPU
-		// that we want to use to render, such as the name of the GPU,
-		// how much memory it has, what features it supports, etc.
-		// We cannot send commands to the GPU through the PhysicalDevice,
-		// but we can use it to determine what our GPU can do.
-		prepare_physical_device();
-	}
-}
-
-
-Demo::Demo()
-{
-	// Welcome to the Demo constructor
-	// The Demo class will handle the majority
-	// of our code in this tutorial
-
-	// Please look at Demo.h, 
-	// where you can see a list of every variable that
-	// we will use in the Demo class. Every variable
-	// in this class will be fully explained while
-	// we move through the code
-
-	// The first thing we do is initalize the scene
-	prepare();
-}
-
-Demo::~Demo()
-{
-	// Destroy Vulkan Instance
-	vkDestroyInstance(inst, NULL);
-}
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "Demo.h"
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <signal.h>
+#include <vector>
+#include "Main.h"
+#include "Capture.h"
+#include "Inventory.h"
+#include "PciIds.h"
+#include "DriverVersion.h"
+#include "ThreadPool.h"
+#include "StartupGraph.h"
+
+void Demo::prepare_console()
+{
+	// only Windows programs start without a console,
+	// everywhere else we already have a terminal
+#ifdef _WIN32
+	// This line is commented out,
+	// if you uncomment this "freopen" line,
+	// it will redirect all text from the console
+	// window into a text file. Then, nothing will
+	// print to the console window, but it will all
+	// be saved to a file
+
+	// freopen("output.txt", "a+", stdout);
+
+	// If you leave that line commented out ^^
+	// then everything will print to the console
+	// window, just like normal
+
+	// Create Console Window
+	
+	// Allocate memory for the console
+	AllocConsole();
+	
+	// Attatch the console to this process,
+	// so that printf statements from this 
+	// process go into the console
+	AttachConsole(GetCurrentProcessId());
+
+	// looks confusing, but we never need to change it,
+	// basically this redirects all printf, scanf,
+	// cout, and cin to go to the console, rather than
+	// going where it goes by default, which is nowhere
+	FILE *stream;
+	freopen_s(&stream, "conin$", "r", stdin);
+	freopen_s(&stream, "conout$", "w", stdout);
+	freopen_s(&stream, "conout$", "w", stderr);
+	SetConsoleTitle(TEXT("Console window"));
+
+	// Adjust Console Window
+	// This is completely optional
+
+	// Get the console window
+	HWND console = GetConsoleWindow();
+
+	// Move the window to position (0, 0),
+	// resize the window to be 640 x 360 (+40).
+	// The +40 is to account for the title bar
+	MoveWindow(console, 0, 0, 640, 360 + 40, TRUE);
+#endif
+}
+
+void Demo::prepare_window()
+{
+	// Make the title of the screen "Loading"
+	// while the program loads
+	strncpy(name, "Loading...", APP_NAME_STR_LEN);
+
+	// The window itself is made by the platform, look at
+	// PlatformWin32.cpp to see how a window is made with the
+	// Win32 API, or PlatformXcb.cpp for the Linux version
+	if (!platform->create_window(name, width, height))
+	{
+		fflush(stdout);
+		exit(1);
+	}
+}
+
+void Demo::prepare_instance()
+{
+	// The first thing we need to do, is choose the 
+	// "layers" and "extensions" that we want to use in Vulkan
+	// "Extensions" give us additional features, like ray tracing.
+	// By default, Vulkan does not have support for any type of 
+	// window: not iOS, Android, Windows, Linux, Mac, GLFW, 
+	// or any type of Window, those are all available in different
+	// extensions, which we will be using
+
+	// "Layers" are what they sound like, they sit between
+	// the driver and our code.
+	// if we have no layers, then our code will speak
+	// directly to the Vulkan driver, if we put a layer
+	// between our code and the driver, the code will not be
+	// as fast, but layers can still be very helpful, or even
+	// simplify the programming process
+
+	// In this case, we want the "Khronos Validation Layer".
+	// Just like an HTML validation (which you may have used if you
+	// made a website), the Vulkan validator will check our code for us,
+	// and tell us if it thinks we've made any mistakes. This layer
+	// can be disabled when development of a project is finished
+	char *instance_validation_layer = "VK_LAYER_KHRONOS_validation";
+
+	// our window is not minimized
+	is_minimized = false;
+
+	// We have one validation layer that we want to enable,
+	// but we do not know if the layer is supported on the
+	// computer that is running the software, so lets quickly
+	// find out if it is supported
+
+	// we create a boolean to see if we found the layer
+	VkBool32 validation_found = 0;
+
+	// only enable validation if the validate bool
+	// is true. This boolean was set to true in init().
+	// This is set to true or false by the programmer, it
+	// does not depend on anything. It should be set to true
+	// during development, and set to false when it is time 
+	// to release the software
+	if (validate)
+	{
+		// set the number of instance layers to zero
+		// This is the number of total layers supported by 
+		// our vulkan device, we set it to zero by default
+		uint32_t total_instance_layers = 0;
+
+		// What you are about to see, is something that Vulkan
+		// does a lot, so please make sure you understand this 
+		// before continuing. The function we are about to use is
+		// vkEnumerateInstanceLayerProperties, it takes two parameters,
+		// the first parameter is a pointer to a uint32_t number, and
+		// the other parameter is a pointer to an array
+
+		// if the array is set to null, 
+		// then vkEnumerateInstanceLayerProperties will set the
+		// uint32_t number equal to the total number of layers
+		// that are available.
+
+		// if the array is not set to null,
+		// then vkEnumerateInstanceLayerProperties will fill the
+		// array with elements, the number of elements will be equal
+		// to the uint32_t number given in the first parameter
+
+		// That means we will use vkEnumerateInstanceLayerProperties
+		// two times, the first time will give us the number of
+		// layers, and the second time will give us the array
+
+		// call vkEnumerateInstanceLayerProperties for the 1st time,
+		// get number of instance layers supported by the GPU
+		vkEnumerateInstanceLayerProperties(&total_instance_layers, NULL);
+
+		if (total_instance_layers > 0)
+		{
+			// Create an array that can hold the properties of every layer available
+			// The properties of each layer (VkLayerProperties) will tell us 
+			// the name of the layer, the version, and even a description of the layer
+			VkLayerProperties* instance_layers = new VkLayerProperties[total_instance_layers];
+
+			// call vkEnumerateInstanceLayerProperties for the 2nd time,
+			// get the properties of all instance layers that are available
+			vkEnumerateInstanceLayerProperties(&total_instance_layers, instance_layers);
+
+			// If you did not understand the last three lines, please read the comments again.
+			// This pattern WILL be used several times, maybe over 10 times, throughout the
+			// course of the program
+
+			// out of all the available layers,
+			// check all the layers to see if the Khronos Validation Layer is supported.
+			// We are checking each layer to see if the name of each layer is equal
+			// to the name of the layer we want. If the layer we want is on the list
+			// of supported layers, then we can use the validation layer, which we 
+			// set at the beginning of the function
+			for (uint32_t j = 0; j < total_instance_layers; j++)
+			{
+				// check to see if this layer has the same name as the one we want
+				if (!strcmp(instance_validation_layer, instance_layers[j].layerName))
+				{
+					// we found the validation layer, woo!
+					validation_found = 1;
+					break;
+				}
+			}
+
+			// we set the number of enabled layers to zero.
+			// regardless if we found the validation layer in the 'for'
+			// loop or not, we still have not enabled any layers yet
+			enabled_layer_count = 0;
+
+			// If we found the validation layer
+			if (validation_found)
+			{
+				// then we have one layer that we can enable
+				enabled_layer_count = 1;
+
+				// add our validation layer to the list
+				// of enabled layers. Technically this layer
+				// is still not enabled yet, but it is guarranteed
+				// that it can be enabled successfully, because we
+				// just confirmed that it is supported. Don't worry
+				// though, it will be enabled by the end of this function
+				enabled_layers[0] = instance_validation_layer;
+			}
+
+			// we dont need the full list of instance layers
+			// we can remove it now that we're done with it
+			free(instance_layers);
+		}
+
+		// if we did not find a validation layer,
+		// or, if we did not find any layers at all
+		if (!validation_found || total_instance_layers <= 0)
+		{
+			// Give the user an error that we failed to find the validation layer.
+			// If this error is found, you can fix it by disabling validate
+			// in init()
+			ERR_EXIT(
+				"vkEnumerateInstanceLayerProperties failed to find required validation layer.\n\n"
+				"Please look at the Getting Started guide for additional information.\n",
+				"vkCreateInstance Failure");
+		}
+	}
+
+	// By default, the validation layer prints its messages
+	// straight to the console, and the thread that made the
+	// Vulkan call has to wait for the console every time.
+	// The VK_EXT_debug_utils extension lets us receive the
+	// messages ourselves instead. Look at DebugMessenger.h
+	// to see what we do with them
+	enabled_extension_count = 0;
+	debug_messenger = nullptr;
+
+	if (validate)
+	{
+		// The extension can come from the loader, or from the
+		// validation layer itself, so we ask both of them.
+		// This is the same "call twice" pattern as before
+		const char* extension_sources[2] = { NULL, instance_validation_layer };
+
+		for (uint32_t s = 0; s < 2 && !debug_messenger; s++)
+		{
+			uint32_t instance_extension_count = 0;
+			vkEnumerateInstanceExtensionProperties(extension_sources[s], &instance_extension_count, NULL);
+
+			VkExtensionProperties* instance_extensions = new VkExtensionProperties[instance_extension_count];
+			vkEnumerateInstanceExtensionProperties(extension_sources[s], &instance_extension_count, instance_extensions);
+
+			for (uint32_t i = 0; i < instance_extension_count; i++)
+			{
+				if (!strcmp(VK_EXT_DEBUG_UTILS_EXTENSION_NAME, instance_extensions[i].extensionName))
+				{
+					extension_names[enabled_extension_count++] = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
+					debug_messenger = new DebugMessenger();
+					break;
+				}
+			}
+
+			delete[] instance_extensions;
+		}
+	}
+
+	// To show anything in a window, we need a "surface", and
+	// surfaces come from two extensions: VK_KHR_surface, which
+	// is the same everywhere, and one that knows about the
+	// windows of this operating system. The platform tells us
+	// which one that is (see Platform.h)
+	extension_names[enabled_extension_count++] = (char*)VK_KHR_SURFACE_EXTENSION_NAME;
+	extension_names[enabled_extension_count++] = (char*)platform->surface_extension();
+
+	// some tutorials will have VkApplicationInfo,
+	// and then that will be put inside the 
+	// structure of VkInstanceCreateInfo. However,
+	// I personally believe that it is a waste of time.
+	// All it does is hold the name of the app, the version,
+	// the name of the engine, and the version, it literally
+	// does not do or change anything in the program, so I 
+	// just ignore it
+
+	// It is time to talk about another pattern that 
+	// will be used in all over the Vulkan program.
+
+	// When we create the structure VkInstanceCreateInfo,
+	// we will give it an "sType" that is ALWAYS equal 
+	// to VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO.
+
+	// Some people wonder "what is the point of having the
+	// ability to change sType if it should always be the 
+	// same anyways?"
+
+	// Here is why: Eventually, we will take our object
+	// of VkInstanceCreateInfo, which in this case is 
+	// called "inst_info", and we will pass it to the
+	// function "vkCreateInstance". When we do that,
+	// we will give it a pointer to inst_info.
+
+	// vkCreateInstance will check to see if the
+	// first four bytes of the pointer is equal to 
+	// VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO. If it
+	// is equal, then that means we passed the correct
+	// pointer to the function, which is "inst_info".
+	// If vkCreateInstance does not see "VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO",
+	// then that means the programmer might have made
+	// a mistake, by giving the wrong poniter to the
+	// vkCreateInstance function, and then the validation
+	// layer will print an error in the command prompt window
+	// that we made a mistake.
+
+	// Therefore, the reason why every Vk---CreateInfo
+	// structure has sType, is to help us make sure that
+	// we are not making mistakes. If you do not understand this
+	// then please read the commments again, this will
+	// be a pattern that is seen throughout the entire tutorial
+
+	// Also, the reason why Vulkan has structures for "create Info",
+	// is so that we can pass the structure as one parameter,
+	// rather than passing all of these variables as seperate
+	// parameters. Some DirectX 11 functions like D3DCreateDeviceAndSwapchain,
+	// have 10 parameters, and Vulkan puts the parameters into a structure,
+	// to make the code look more organized
+
+	// We create an "instance" of Vulkan, so that we can start
+	// using vulkan features, this allows us to use Vulkan commands
+	// that the driver provides
+
+	// create our InstanceCreateInfo, with the necessary sType,
+	// the number of layers we want to enable, the array of layers
+	// that we want to enable, the number of extensions we want to enable,
+	// and the array of extensions that we want to enable.
+	VkInstanceCreateInfo inst_info = {};
+	inst_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	inst_info.enabledLayerCount = enabled_layer_count;
+	inst_info.ppEnabledLayerNames = (const char *const *)enabled_layers;
+	inst_info.enabledExtensionCount = enabled_extension_count;
+	inst_info.ppEnabledExtensionNames = (const char *const *)extension_names;
+
+	// If we have a debug messenger, we also put its create info
+	// in the "pNext" chain of inst_info. pNext lets us attach extra
+	// structures to any Vulkan structure, and this one makes sure
+	// that messages from vkCreateInstance itself reach us too
+	VkDebugUtilsMessengerCreateInfoEXT messenger_info = {};
+	if (debug_messenger)
+	{
+		debug_messenger->fill_create_info(messenger_info);
+		inst_info.pNext = &messenger_info;
+	}
+
+	// Attempt to create a Vulkan Instance with the information provided.
+	// We take the value that this returns, so that we can see if the
+	// instance was created correctly
+	VkResult err = vkCreateInstance(&inst_info, NULL, &inst);
+
+	// if we are making a capture, write down
+	// that the instance was created successfully
+	if (capture && err == VK_SUCCESS)
+		capture->record_create_instance(inst, enabled_layer_count, enabled_layers);
+
+	// now that the instance exists, the messenger can be registered
+	// for the rest of the program, and its log thread can start
+	if (debug_messenger && err == VK_SUCCESS)
+	{
+		if (!debug_messenger->create(inst, options.debug_log_path.c_str()))
+			printf("Could not create the debug messenger, validation messages will be lost\n");
+	}
+
+	// If the function returns a value of -9,
+	// then the driver is not compatible with Vulkan
+	if (err == VK_ERROR_INCOMPATIBLE_DRIVER)
+	{
+		ERR_EXIT(
+			"Cannot find a compatible Vulkan installable client driver (ICD).\n\n"
+			"Please look at the Getting Started guide for additional information.\n",
+			"vkCreateInstance Failure");
+	}
+
+	// if the function returns a value of -7,
+	// then there is an extension that is not supported
+	// that we tried to enable. This will probably never
+	// happen since we wnt through the necessary checks
+	// earlier in the function
+	else if (err == VK_ERROR_EXTENSION_NOT_PRESENT)
+	{
+		ERR_EXIT(
+			"Cannot find a specified extension library.\n"
+			"Make sure your layers path is set appropriately.\n",
+			"vkCreateInstance Failure");
+	}
+
+	// if any other value is returned that is not zero,
+	// then we got an unknown error
+	else if (err)
+	{
+		ERR_EXIT(
+			"vkCreateInstance failed.\n\n"
+			"Do you have a compatible Vulkan installable client driver (ICD) installed?\n"
+			"Please look at the Getting Started guide for additional information.\n",
+			"vkCreateInstance Failure");
+	}
+}
+
+void Demo::prepare_physical_device()
+{
+	// Now that we have an instance of Vulkan, we need
+	// to determine how many GPUs are available that
+	// can use Vulkan. We will be following the same
+	// pattern as before: get the number of elements,
+	// make an array, give the array to a function, and
+	// the function will fill it with data
+
+	// set the number of GPUs available to zero
+	uint32_t gpu_count = 0;
+
+	// In Vulkan, a PhysicalDevice holds all the information
+	// about a GPU that is in a computer: how much memory it has,
+	// what features it supports, the name of the GPU, the
+	// company that made the GPU, the amount of processors,
+	// literally everything.
+
+	// HOWEVER, the PhysicalDevice only holds information
+	// about the GPU, we cannot use PhysicalDevice to 
+	// give commands to the GPU. For that, we need to 
+	// create a "Device" from the same GPU. The first time
+	// we do this, it will be confusing, but it will 
+	// eventually make sense.
+
+	// use the function vkEnumeratePhysicalDevices to get
+	// the number of GPUs that are present in the computer.
+	// we set the array of VkPhysicalDevice to NULL, so that
+	// the function knows that it is looking for the number 
+	// of GPUs
+	vkEnumeratePhysicalDevices(inst, &gpu_count, NULL);
+
+	// if we found a GPU
+	if (gpu_count > 0)
+	{
+		// Create an array that will hold all PhysicalDevices in the computer
+		VkPhysicalDevice* physical_devices = new VkPhysicalDevice[gpu_count];
+
+		// Pass the array to this function, and then the array
+		// will be filled with data that tells us about every GPU
+		// in the computer that supports Vulkan
+		vkEnumeratePhysicalDevices(inst, &gpu_count, physical_devices);
+
+		if (capture)
+			capture->record_enumerate_physical_devices(inst, gpu_count, physical_devices);
+
+		// Each PhsyicalDevice be a dedicated graphics card, 
+		// or an integraded graphics chip in a CPU, some devices
+		// support graphics, some only support compute, there are
+		// a lot of different types of GPUs out there that support Vulkan.
+
+		// We give every GPU a score, a dedicated graphics card
+		// scores higher than a GPU integrated in the CPU, which
+		// scores higher than a GPU that is really the CPU. Then the
+		// driver rules (DriverRules.h) take points away from GPUs
+		// whose driver is known to be slow or broken, so that we
+		// do not pick a GPU that would give us a bad time.
+
+		// If two GPUs have the same score, we keep the one that
+		// came first, because the driver puts the GPU that you set
+		// as your default graphics processor (in the Nvidia Control
+		// Panel, or AMD Catalayst, or Intel Graphics Settings)
+		// at the start of the array
+		uint32_t best = 0;
+		int32_t best_score = INT32_MIN;
+		for (uint32_t i = 0; i < gpu_count; i++)
+		{
+			VkPhysicalDeviceProperties candidate;
+			vkGetPhysicalDeviceProperties(physical_devices[i], &candidate);
+
+			int32_t score = driver_rules.score_device(candidate);
+			if (score > best_score)
+			{
+				best = i;
+				best_score = score;
+			}
+		}
+		gpu = physical_devices[best];
+
+		// if we were asked for an inventory of every
+		// GPU in the computer, write it now
+		if (!options.inventory_path.empty())
+			write_inventory(physical_devices, gpu_count);
+
+		// we do not need all of the devices anymore, we have
+		// the one that we want
+		delete[] physical_devices;
+
+		// We want to get properteis from the physical device.
+		// This is completely option, I did it because I feel like it
+		VkPhysicalDeviceProperties features;
+
+		// This gives us the name of the GPU, the number of processors
+		// on the GPU, the amount of memory, the company that made the
+		// GPU, everything there is to know
+		vkGetPhysicalDeviceProperties(gpu, &features);
+
+		if (capture)
+			capture->record_get_physical_device_properties(gpu);
+
+		// Everything else there is to know about the GPU goes into
+		// "device_info", look at Inventory.h to see what is in it.
+		// If we were given a device profile with "-profile", we pretend
+		// that the GPU in the profile is the one that we picked, so
+		// every decision after this point is made for that GPU
+		if (!options.profile_path.empty())
+		{
+			if (!load_device_profile(options.profile_path.c_str(), options.profile_device, device_info))
+			{
+				ERR_EXIT("Could not load the device profile given with -profile.\n",
+					"Device Profile Failure");
+			}
+		}
+		else
+		{
+			collect_device_inventory(gpu, device_info);
+		}
+
+		// the title of the window is set to the name of the
+		// GPU later, on the main thread, see Demo::prepare
+
+		if (device_info.simulated)
+			printf("We are simulating a GPU from a profile, the name of the GPU is:\n");
+		else
+			printf("We found a GPU, the name of the GPU is:\n");
+		printf("%s\n", device_info.properties.deviceName);
+
+		// the driver's name for the GPU is not always the name on the
+		// box, so we also print what our own table says about it
+		GpuIdentity identity;
+		if (lookup_gpu_identity(device_info.properties.vendorID, device_info.properties.deviceID, identity))
+			printf("%s %s (%s)\n", identity.vendor ? identity.vendor : "Unknown vendor",
+				identity.name, identity.architecture);
+		else
+			printf("(vendor 0x%04X, device 0x%04X is not in pci_ids.txt)\n",
+				device_info.properties.vendorID, device_info.properties.deviceID);
+
+		// every driver packs its version differently,
+		// so we decode it the way its vendor does
+		printf("Driver version %s\n", driver_version_string(device_info.properties.vendorID,
+			device_info.properties.driverVersion).c_str());
+
+		// tell the user about every rule that applies to
+		// the GPU we picked, so that they know why a
+		// feature is missing, or why we picked another GPU
+		std::vector<const DriverRule*> rules;
+		driver_rules.match(device_info.properties, rules);
+		for (size_t i = 0; i < rules.size(); i++)
+		{
+			if (rules[i]->action == DRIVER_RULE_DISABLE_FEATURE)
+				printf("Not using %s: %s\n", rules[i]->feature.c_str(), rules[i]->reason.c_str());
+			else
+				printf("Warning: %s\n", rules[i]->reason.c_str());
+		}
+		printf("\n");
+	}
+
+	// If no GPUs were found, then 
+	// give an error to the user
+	else
+	{
+		ERR_EXIT(
+			"vkEnumeratePhysicalDevices reported zero accessible devices.\n\n"
+			"Do you have a compatible Vulkan installable client driver (ICD) installed?\n"
+			"Please look at the Getting Started guide for additional information.\n",
+			"vkEnumeratePhysicalDevices Failure");
+	}
+
+	// When we created the instance, we chose to use some extensions of the instance,
+	// such as the SURFACE and WIN32 extensions. Now, we will enable extensions from
+	// the PhysicalDevice. These extensions will help us with creating the "swapchain".
+
+	// If a student does not know what a swapchain is, don't worry, the "swapchain" will
+	// be fully explained in the prepare_swapchain() function, explaining what it is 
+	// and why we need it. For now, here is how we enable the swapchain extension.
+
+	// by default, we have not found the swapchain extension (yet)
+	VkBool32 swapchainExtFound = 0;
+	VkBool32 displayTimingExtFound = 0;
+
+	// Set the number of enabled_extensions to zero,
+	// and clear the list of extension names. These
+	// are the same variables we used for the instance,
+	// but the instance doesn't need these variables now,
+	// so we will re-use them for a similar purpose
+	enabled_extension_count = 0;
+	memset(extension_names, 0, sizeof(extension_names));
+
+	// By default, there are zero device extensions that exist (that we know of)
+	uint32_t device_extension_count = 0;
+
+	// call this function to find out how many device extensions are available
+	vkEnumerateDeviceExtensionProperties(gpu, NULL, &device_extension_count, NULL);
+
+	// if there are more than zero extensions available,
+	// then look for the extension that we want
+	if (device_extension_count > 0)
+	{
+		// first we make a list that can hold all of the device's extensions
+		VkExtensionProperties* device_extensions = new VkExtensionProperties[device_extension_count];
+
+		// then we call the same function again to get the list of all extensions that are available
+		vkEnumerateDeviceExtensionProperties(gpu, NULL, &device_extension_count, device_extensions);
+
+		// we search through the list to look for the extension that we want,
+		// which in this case, is the swapchain extension
+		for (uint32_t i = 0; i < device_extension_count; i++)
+		{
+			// if we find the swapchain extension on the list of supported extensions
+			if (!strcmp(VK_KHR_SWAPCHAIN_EXTENSION_NAME, device_extensions[i].extensionName))
+			{
+				// set this boolean so we know that we found it
+				swapchainExtFound = 1;
+
+				// add the swapchain to our list of extensions,
+				// and increment the counter for the number of extensions
+				extension_names[enabled_extension_count++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+			}
+
+			// the display timing extension tells us when our frames
+			// were really shown, which we only need with "-pace"
+			if (!strcmp(VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME, device_extensions[i].extensionName))
+				displayTimingExtFound = 1;
+		}
+
+		// we do not need the list of extensions anymore,
+		// now that we have already searched through it,
+		// so we can delete it now
+		free(device_extensions);
+	}
+
+	// if the swapchain was not found, then give an error and let the
+	// user know that the swapchain could not be found
+	if (!swapchainExtFound)
+	{
+		ERR_EXIT("vkEnumerateDeviceExtensionProperties failed to find the " VK_KHR_SWAPCHAIN_EXTENSION_NAME
+			" extension.\n\nDo you have a compatible Vulkan installable client driver (ICD) installed?\n"
+			"Please look at the Getting Started guide for additional information.\n",
+			"vkCreateInstance Failure");
+	}
+
+	// Without the extension, or on a GPU where a rule says that it
+	// does not work, the frame pacer uses the CPU clock instead
+	google_display_timing_enabled = false;
+	if (options.pace && displayTimingExtFound &&
+		!driver_rules.feature_disabled(device_info.properties, "display_timing"))
+	{
+		extension_names[enabled_extension_count++] = VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME;
+		google_display_timing_enabled = true;
+	}
+}
+
+void Demo::prepare_device_functionPointers()
+{
+	// Functions that come from device extensions are not exported by
+	// the Vulkan loader, so we ask the device where they are
+	fpGetRefreshCycleDurationGOOGLE = NULL;
+	fpGetPastPresentationTimingGOOGLE = NULL;
+
+	if (google_display_timing_enabled)
+	{
+		fpGetRefreshCycleDurationGOOGLE = (PFN_vkGetRefreshCycleDurationGOOGLE)
+			vkGetDeviceProcAddr(device, "vkGetRefreshCycleDurationGOOGLE");
+		fpGetPastPresentationTimingGOOGLE = (PFN_vkGetPastPresentationTimingGOOGLE)
+			vkGetDeviceProcAddr(device, "vkGetPastPresentationTimingGOOGLE");
+
+		if (!fpGetRefreshCycleDurationGOOGLE || !fpGetPastPresentationTimingGOOGLE)
+			google_display_timing_enabled = false;
+	}
+}
+
+void Demo::prepare_surface()
+{
+	// The surface is how Vulkan sees our window. Every operating
+	// system has its own kind of window, so the platform makes
+	// the surface for us (see Platform.h). With "-platform null"
+	// there is no window at all, and we get a "headless" surface,
+	// which works just like a real one, without a screen
+	VkResult err = platform->create_surface(inst, &surface);
+	if (err != VK_SUCCESS)
+	{
+		ERR_EXIT("Could not create a surface for the window.\n",
+			"vkCreateSurface Failure");
+	}
+}
+
+void Demo::prepare_device_queue()
+{
+	// A GPU has "queue families", and every family has queues that
+	// can do some kinds of work: graphics, compute, or copying memory.
+	// We need a family that can do graphics, so we look through the
+	// families that we already have in device_info (from Inventory.h).
+	// If we are simulating a GPU from a profile, we still have to
+	// ask the real GPU, because the real GPU is the one we talk to
+	uint32_t family_count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(gpu, &family_count, NULL);
+	std::vector<VkQueueFamilyProperties> families(family_count);
+	vkGetPhysicalDeviceQueueFamilyProperties(gpu, &family_count, families.data());
+
+	// The family also has to be able to show images on our
+	// surface. On almost every GPU, the graphics family can
+	graphics_queue_family_index = UINT32_MAX;
+	for (uint32_t i = 0; i < family_count; i++)
+	{
+		VkBool32 can_present = VK_FALSE;
+		vkGetPhysicalDeviceSurfaceSupportKHR(gpu, i, surface, &can_present);
+
+		if ((families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) && can_present)
+		{
+			graphics_queue_family_index = i;
+			break;
+		}
+	}
+
+	if (graphics_queue_family_index == UINT32_MAX)
+	{
+		ERR_EXIT("Could not find a queue family that can do graphics and present to the window.\n",
+			"vkCreateDevice Failure");
+	}
+
+	// We want one queue from that family. Every queue gets a
+	// priority from 0 to 1, which only matters when there is
+	// more than one queue, so 1 is as good as anything
+	float queue_priority = 1.0f;
+
+	VkDeviceQueueCreateInfo queue_info = {};
+	queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queue_info.queueFamilyIndex = graphics_queue_family_index;
+	queue_info.queueCount = 1;
+	queue_info.pQueuePriorities = &queue_priority;
+
+	// The device extensions are the ones we found in
+	// prepare_physical_device, which is the swapchain extension
+	VkDeviceCreateInfo device_info_create = {};
+	device_info_create.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	device_info_create.queueCreateInfoCount = 1;
+	device_info_create.pQueueCreateInfos = &queue_info;
+	device_info_create.enabledExtensionCount = enabled_extension_count;
+	device_info_create.ppEnabledExtensionNames = (const char *const *)extension_names;
+
+	VkResult err = vkCreateDevice(gpu, &device_info_create, NULL, &device);
+	if (err != VK_SUCCESS)
+	{
+		ERR_EXIT("vkCreateDevice failed.\n", "vkCreateDevice Failure");
+	}
+
+	// the queue was made together with the device,
+	// we only have to ask for it
+	vkGetDeviceQueue(device, graphics_queue_family_index, 0, &graphics_queue);
+}
+
+void Demo::prepare_swapchain()
+{
+	swapchain_dirty = false;
+	resize_pending_since_us = 0;
+
+	// First we ask the surface what it can do: how big the
+	// images can be, how many of them we can have, which
+	// formats it can show, and which present modes it has.
+	// This is the same "call twice" pattern as always
+	VkSurfaceCapabilitiesKHR caps;
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(gpu, surface, &caps);
+
+	uint32_t format_count = 0;
+	vkGetPhysicalDeviceSurfaceFormatsKHR(gpu, surface, &format_count, NULL);
+	std::vector<VkSurfaceFormatKHR> formats(format_count);
+	vkGetPhysicalDeviceSurfaceFormatsKHR(gpu, surface, &format_count, formats.data());
+
+	uint32_t mode_count = 0;
+	vkGetPhysicalDeviceSurfacePresentModesKHR(gpu, surface, &mode_count, NULL);
+	std::vector<VkPresentModeKHR> modes(mode_count);
+	vkGetPhysicalDeviceSurfacePresentModesKHR(gpu, surface, &mode_count, modes.data());
+
+	if (formats.empty())
+	{
+		ERR_EXIT("The surface does not support any formats.\n",
+			"vkGetPhysicalDeviceSurfaceFormatsKHR Failure");
+	}
+
+	// Swapchain.h makes the choices, we only ask
+	VkSurfaceFormatKHR surface_format = choose_surface_format(formats);
+	format = surface_format.format;
+	color_space = surface_format.colorSpace;
+	present_mode = choose_present_mode(modes, present_policy);
+	swapchain_extent = choose_extent(caps, (uint32_t)width, (uint32_t)height);
+
+	// A minimized window has no size, and Vulkan does not
+	// let us make images with no size, so we wait until
+	// the window comes back (see render_thread_main)
+	if (swapchain_extent.width == 0 || swapchain_extent.height == 0)
+		return;
+
+	// We only ever clear the images, so we need
+	// to be able to copy into them
+	if (!(caps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT))
+	{
+		ERR_EXIT("The surface cannot be cleared with vkCmdClearColorImage.\n",
+			"vkCreateSwapchainKHR Failure");
+	}
+
+	VkSwapchainCreateInfoKHR swapchain_info = {};
+	swapchain_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+	swapchain_info.surface = surface;
+	swapchain_info.minImageCount = choose_image_count(caps, present_mode, frames.depth());
+	swapchain_info.imageFormat = format;
+	swapchain_info.imageColorSpace = color_space;
+	swapchain_info.imageExtent = swapchain_extent;
+	swapchain_info.imageArrayLayers = 1;
+	swapchain_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	swapchain_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	swapchain_info.presentMode = present_mode;
+	swapchain_info.clipped = VK_TRUE;
+
+	// if the surface does not mind how it is turned,
+	// we leave it the way it is
+	swapchain_info.preTransform = (caps.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR) ?
+		VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR : caps.currentTransform;
+
+	// and we do not want to see through the window
+	// to whatever is behind it, if we can help it
+	VkCompositeAlphaFlagBitsKHR alpha_modes[4] = {
+		VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+		VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR,
+		VK_COMPOSITE_ALPHA_POST_MULTIPLIED_BIT_KHR,
+		VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR,
+	};
+	swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+	for (uint32_t i = 0; i < ARRAY_SIZE(alpha_modes); i++)
+	{
+		if (caps.supportedCompositeAlpha & alpha_modes[i])
+		{
+			swapchain_info.compositeAlpha = alpha_modes[i];
+			break;
+		}
+	}
+
+	// If we already have a swapchain, we hand it to the new one.
+	// The driver can then reuse what it had, and the frames that
+	// are still on their way to the screen from the old swapchain
+	// are allowed to finish, so we never wait for the whole GPU
+	VkSwapchainKHR old_swapchain = swapchain;
+	swapchain_info.oldSwapchain = old_swapchain;
+
+	VkResult err = vkCreateSwapchainKHR(device, &swapchain_info, NULL, &swapchain);
+	if (err != VK_SUCCESS)
+	{
+		ERR_EXIT("vkCreateSwapchainKHR failed.\n", "vkCreateSwapchainKHR Failure");
+	}
+
+	// the old swapchain can not be used any more, but the GPU
+	// might still be using it, see release_retired_swapchains
+	if (old_swapchain != VK_NULL_HANDLE)
+	{
+		RetiredSwapchain retired;
+		retired.swapchain = old_swapchain;
+		retired.retired_at_frame = frames.frames_submitted();
+		retired_swapchains.push_back(retired);
+	}
+
+	// We asked for at least minImageCount images,
+	// but the driver is allowed to give us more
+	uint32_t image_count = 0;
+	vkGetSwapchainImagesKHR(device, swapchain, &image_count, NULL);
+	swapchain_images.resize(image_count);
+	vkGetSwapchainImagesKHR(device, swapchain, &image_count, swapchain_images.data());
+
+	printf("Swapchain: %ux%u, %u images, %s\n\n", swapchain_extent.width, swapchain_extent.height,
+		image_count, present_mode_name(present_mode));
+
+	// A new swapchain starts its pacing again. The display timing
+	// extension can tell us how long one refresh of the screen
+	// takes, otherwise we guess 60 Hz
+	uint64_t refresh_duration = PACER_DEFAULT_REFRESH_NS;
+	if (google_display_timing_enabled)
+	{
+		VkRefreshCycleDurationGOOGLE refresh = {};
+		if (fpGetRefreshCycleDurationGOOGLE(device, swapchain, &refresh) == VK_SUCCESS)
+			refresh_duration = refresh.refreshDuration;
+	}
+	pacer.reset(refresh_duration, google_display_timing_enabled);
+
+	prepared = true;
+}
+
+void Demo::release_retired_swapchains(bool all)
+{
+	// Every frame waits for the frame that used its slot last time,
+	// frames.depth() frames ago (see FrameRing::begin_frame). So once
+	// that many frames have been submitted since a swapchain was
+	// retired, every frame that could have used it is done with it.
+	// Frames that gave up before they submitted do not count, they
+	// all waited for the same fence again
+	for (size_t i = 0; i < retired_swapchains.size();)
+	{
+		if (all || frames.frames_submitted() >= retired_swapchains[i].retired_at_frame + frames.depth())
+		{
+			vkDestroySwapchainKHR(device, retired_swapchains[i].swapchain, NULL);
+			retired_swapchains.erase(retired_swapchains.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+void Demo::delete_resolution_dependencies()
+{
+	// Everything here depends on the size of the window. We only
+	// get here when we are shutting down, a new size rebuilds the
+	// swapchain in prepare_swapchain without any of this. The GPU
+	// might still be using it, so we wait for the GPU first
+	vkDeviceWaitIdle(device);
+	release_retired_swapchains(true);
+
+	if (swapchain != VK_NULL_HANDLE)
+	{
+		vkDestroySwapchainKHR(device, swapchain, NULL);
+		swapchain = VK_NULL_HANDLE;
+	}
+
+	swapchain_images.clear();
+	prepared = false;
+}
+
+void Demo::record_frame(VkCommandBuffer commands, VkImage image)
+{
+	// There is no render pass in this tutorial yet, so drawing a
+	// frame means clearing the image to one color
+	VkClearColorValue clear_color = {};
+	clear_color.float32[0] = 0.2f;
+	clear_color.float32[1] = 0.3f;
+	clear_color.float32[2] = 0.6f;
+	clear_color.float32[3] = 1.0f;
+
+	VkImageSubresourceRange range = {};
+	range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	range.levelCount = 1;
+	range.layerCount = 1;
+
+	// the command buffer is recorded once, submitted once,
+	// and then its pool is reset (see FrameRing.h)
+	VkCommandBufferBeginInfo begin_info = {};
+	begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commands, &begin_info);
+
+	// we do not care what was in the image before,
+	// because we are about to clear all of it
+	VkImageMemoryBarrier to_clear = {};
+	to_clear.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	to_clear.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	to_clear.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	to_clear.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	to_clear.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	to_clear.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	to_clear.image = image;
+	to_clear.subresourceRange = range;
+	vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &to_clear);
+
+	vkCmdClearColorImage(commands, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clear_color, 1, &range);
+
+	// and then the image goes to the screen
+	VkImageMemoryBarrier to_present = to_clear;
+	to_present.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	to_present.dstAccessMask = 0;
+	to_present.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	to_present.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	vkCmdPipelineBarrier(commands, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 1, &to_present);
+
+	vkEndCommandBuffer(commands);
+}
+
+void Demo::draw()
+{
+	uint64_t frame_start = pacer.now();
+
+	// Wait until the GPU is done with the frame that used this
+	// slot last time, frames.depth() frames ago
+	FrameSlot& frame = frames.begin_frame();
+
+	// and now some old swapchain might not be needed any more
+	release_retired_swapchains(false);
+
+	// ask for the next image that we are allowed to draw into,
+	// the semaphore is signaled when it really is free
+	VkResult err = vkAcquireNextImageKHR(device, swapchain, UINT64_MAX,
+		frame.image_acquired, VK_NULL_HANDLE, &current_buffer);
+
+	if (err == VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		// the window changed, and this swapchain
+		// cannot be shown in it any more
+		swapchain_dirty = true;
+		return;
+	}
+	else if (err == VK_SUBOPTIMAL_KHR)
+	{
+		// we can still show this image, so we rebuild
+		// once the window has settled on its new size
+		if (!resize_pending_since_us)
+			resize_pending_since_us = platform_time_us();
+	}
+	else if (err != VK_SUCCESS)
+	{
+		ERR_EXIT("vkAcquireNextImageKHR failed.\n", "vkAcquireNextImageKHR Failure");
+	}
+
+	record_frame(frame.commands, swapchain_images[current_buffer]);
+
+	// the clear has to wait for the image, and the
+	// present has to wait for the clear
+	VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+	VkSubmitInfo submit_info = {};
+	submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submit_info.waitSemaphoreCount = 1;
+	submit_info.pWaitSemaphores = &frame.image_acquired;
+	submit_info.pWaitDstStageMask = &wait_stage;
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers = &frame.commands;
+	submit_info.signalSemaphoreCount = 1;
+	submit_info.pSignalSemaphores = &frame.draw_complete;
+
+	err = vkQueueSubmit(graphics_queue, 1, &submit_info, frames.submit_fence());
+	if (err != VK_SUCCESS)
+	{
+		ERR_EXIT("vkQueueSubmit failed.\n", "vkQueueSubmit Failure");
+	}
+
+	VkPresentInfoKHR present_info = {};
+	present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	present_info.waitSemaphoreCount = 1;
+	present_info.pWaitSemaphores = &frame.draw_complete;
+	present_info.swapchainCount = 1;
+	present_info.pSwapchains = &swapchain;
+	present_info.pImageIndices = &current_buffer;
+
+	// With "-pace", every present gets an ID and the time that
+	// we want it to be shown. With display timing, the driver waits
+	// for that time, and later tells us when each present was really
+	// shown, which is how the pacer knows if it should change the pace
+	VkPresentTimeGOOGLE present_time = {};
+	VkPresentTimesInfoGOOGLE present_times = {};
+	if (options.pace)
+	{
+		if (google_display_timing_enabled)
+		{
+			uint32_t past_count = 0;
+			fpGetPastPresentationTimingGOOGLE(device, swapchain, &past_count, NULL);
+			if (past_count > 0)
+			{
+				std::vector<VkPastPresentationTimingGOOGLE> past(past_count);
+				fpGetPastPresentationTimingGOOGLE(device, swapchain, &past_count, past.data());
+				pacer.update(past.data(), past_count);
+			}
+		}
+
+		present_time = pacer.next_present();
+
+		if (google_display_timing_enabled)
+		{
+			present_times.sType = VK_STRUCTURE_TYPE_PRESENT_TIMES_INFO_GOOGLE;
+			present_times.swapchainCount = 1;
+			present_times.pTimes = &present_time;
+			present_info.pNext = &present_times;
+		}
+	}
+
+	err = vkQueuePresentKHR(graphics_queue, &present_info);
+
+	// Without display timing, the moment that the present comes
+	// back is the closest thing we have to the moment it was shown
+	if (options.pace && !google_display_timing_enabled)
+		pacer.presented(present_time, frame_start);
+
+	frames.end_frame();
+
+	// Out of date means we cannot present to this swapchain at all,
+	// so it is rebuilt straight away. Suboptimal still works, so we
+	// wait for the window to settle, like any other new size
+	if (err == VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		swapchain_dirty = true;
+	}
+	else if (err == VK_SUBOPTIMAL_KHR)
+	{
+		if (!resize_pending_since_us)
+			resize_pending_since_us = platform_time_us();
+	}
+	else if (err != VK_SUCCESS)
+	{
+		ERR_EXIT("vkQueuePresentKHR failed.\n", "vkQueuePresentKHR Failure");
+	}
+}
+
+void Demo::handle_event(const PlatformEvent& event)
+{
+	// When the window changes size, the swapchain has to be
+	// rebuilt to match it, but not for every size that the window
+	// goes through while it is being dragged. We remember when the
+	// size changed, and the render loop waits for it to settle
+	if (event.type == PLATFORM_EVENT_RESIZE)
+	{
+		if (width != (int)event.width || height != (int)event.height)
+			resize_pending_since_us = event.time_us ? event.time_us : platform_time_us();
+
+		width = (int)event.width;
+		height = (int)event.height;
+	}
+
+	// When the window is hidden, we stop drawing, and the debug
+	// messenger checks for messages less often. Everything starts
+	// again by itself when the window comes back
+	else if (event.type == PLATFORM_EVENT_VISIBILITY && is_minimized == event.active)
+	{
+		is_minimized = !event.active;
+		if (debug_messenger)
+			debug_messenger->set_background(is_minimized);
+
+		if (is_minimized)
+		{
+			hidden_since_us = event.time_us;
+			printf("The window is hidden, drawing has stopped\n");
+		}
+		else
+		{
+			printf("The window can be seen again after %.1f seconds, drawing again\n",
+				(event.time_us - hidden_since_us) / 1000000.0);
+
+			// the last frame was a long time ago, so the
+			// pacer should not try to catch up with it
+			pacer.restart();
+		}
+	}
+
+	else if (event.type == PLATFORM_EVENT_FOCUS)
+	{
+		has_focus = event.active;
+	}
+}
+
+void Demo::load_shader_bundle()
+{
+	uint64_t start_us = platform_time_us();
+	if (!shader_bundle.open(options.shader_bundle_path.c_str()))
+	{
+		printf("Could not open the shader bundle %s\n\n", options.shader_bundle_path.c_str());
+		return;
+	}
+
+	// For every shader with variants, the bundle has one entry per
+	// build. We pick the variant for this GPU (or the -profile GPU)
+	// first, and look up the entry whose permutation matches it. The
+	// permutation is made from the same macros that -compile-shaders
+	// used: the ones from -define, and the ones of the build
+	ShaderSource settings;
+	bool has_settings = apply_shader_options(options, settings);
+	ShaderDeviceLimits limits = shader_device_limits(device_info);
+
+	// Only the entries we use get a module, so the SPIR-V of the
+	// other builds is never read from the file. "bundle_modules"
+	// is in the same order as the entries, VK_NULL_HANDLE for one
+	// that is not used or could not be made
+	uint32_t made = 0;
+	bundle_modules.resize(shader_bundle.size(), VK_NULL_HANDLE);
+	for (uint32_t i = 0; i < shader_bundle.size(); i++)
+	{
+		const ShaderBundleEntry& entry = shader_bundle.entry(i);
+		const char* name = shader_bundle.name(entry);
+		const ShaderVariantShader* variants = find_shader_variants(name);
+
+		BundleVariant picked;
+		if (variants)
+		{
+			if (!has_settings)
+				continue;
+
+			select_shader_variant(*variants, limits, picked.variant);
+
+			std::vector<std::pair<std::string, std::string>> macros = settings.macros;
+			shader_variant_macros(*variants, picked.variant.build, macros);
+			if (shader_bundle.find(name, shader_permutation(macros)) != &entry)
+				continue;
+		}
+
+		if (shader_bundle.create_module(device, entry, &bundle_modules[i]) != VK_SUCCESS)
+		{
+			printf("Could not make a module for %s\n", name);
+			continue;
+		}
+		made++;
+
+		if (variants)
+		{
+			picked.module = bundle_modules[i];
+			shader_variants.push_back(picked);
+		}
+	}
+
+	printf("Made %u shader modules from %s in %.2f ms\n\n", made,
+		options.shader_bundle_path.c_str(), (platform_time_us() - start_us) / 1000.0);
+
+	if (!shader_variants.empty())
+		printf("Shader variants for %s:\n", device_info.properties.deviceName);
+	for (size_t i = 0; i < shader_variants.size(); i++)
+	{
+		printf("  ");
+		print_shader_variant(shader_variants[i].variant);
+	}
+	if (!shader_variants.empty())
+		printf("\n");
+}
+
+void Demo::prepare_shaders()
+{
+	if (!options.shader_bundle_path.empty())
+		load_shader_bundle();
+
+	if (!options.watch_shaders)
+		return;
+
+	ShaderSource settings;
+	if (!apply_shader_options(options, settings))
+		return;
+
+	std::vector<ShaderSource> shaders;
+	for (size_t i = 0; i < options.inputs.size(); i++)
+	{
+		ShaderSource source = settings;
+		if (load_shader_source(options.inputs[i].c_str(), source))
+			shaders.push_back(source);
+		else
+			printf("Could not read %s\n", options.inputs[i].c_str());
+	}
+
+	if (!shader_cache.open(options.shader_cache_path.c_str()))
+		printf("Could not use the shader cache in %s\n", options.shader_cache_path.c_str());
+
+	// There is no render pass in this tutorial yet, so there are no
+	// pipelines to build, only shader modules and their layout. A
+	// PipelineBuilder that calls pipeline_cache.create_graphics_pipelines
+	// with set.layout would go here
+	layout_cache.init(device);
+	shader_reloader.start(device, shaders, options.shader_include_dirs, &shader_cache,
+		&layout_cache, PipelineBuilder());
+}
+
+void Demo::render_thread_main()
+{
+	// the device is made here, so that it belongs to this thread,
+	// and so is everything that is made from the device
+	prepare_device_queue();
+	prepare_device_functionPointers();
+
+	// Made once, and used again every few frames, see FrameRing.h
+	uint32_t frame_depth = options.frames_in_flight ? options.frames_in_flight : FRAME_LAG;
+	if (!frames.create(device, graphics_queue_family_index, frame_depth))
+	{
+		ERR_EXIT("Could not create the fences, semaphores, and command buffers for the frames in flight.\n",
+			"vkCreateFence Failure");
+	}
+
+	// The cache file has to come from this GPU, so we check it against
+	// the real GPU, never against a device profile from "-profile"
+	VkPhysicalDeviceProperties gpu_properties;
+	vkGetPhysicalDeviceProperties(gpu, &gpu_properties);
+	if (!pipeline_cache.open(device, gpu_properties, options.pipeline_cache_path.c_str()))
+		printf("Could not create a pipeline cache, pipelines will be built without one\n\n");
+
+	prepare_shaders();
+	prepare_swapchain();
+
+	while (!renderer.stopping())
+	{
+		// take every event that the window thread sent us
+		PlatformEvent event;
+		while (renderer.next_event(event))
+			handle_event(event);
+
+		// Once the window has kept the same size for a little
+		// while, we rebuild the swapchain, unless it ended up the
+		// size that it already was
+		if (resize_pending_since_us && platform_time_us() - resize_pending_since_us >= RESIZE_SETTLE_US)
+		{
+			resize_pending_since_us = 0;
+			if (swapchain_extent.width != (uint32_t)width || swapchain_extent.height != (uint32_t)height)
+				swapchain_dirty = true;
+		}
+
+		if (swapchain_dirty)
+			prepare_swapchain();
+
+		// When nobody can see the window, or it has no size, there
+		// is nothing to draw, so we sleep until the window thread has
+		// something for us, or until a new size has settled. The main
+		// thread is asleep in wait_event too, so a hidden window
+		// costs no CPU and no GPU at all
+		if (is_minimized || swapchain_extent.width == 0 || swapchain_extent.height == 0)
+		{
+			int32_t timeout_ms = PLATFORM_WAIT_FOREVER;
+			if (resize_pending_since_us)
+				timeout_ms = RESIZE_SETTLE_US / 1000;
+			renderer.wait(timeout_ms);
+			continue;
+		}
+
+		// A window that can be seen, but that someone is not using,
+		// does not need every frame we can draw. We draw it at a
+		// slower pace until it has the keyboard again
+		if (!has_focus)
+		{
+			uint64_t since_last_us = platform_time_us() - last_frame_us;
+			if (since_last_us + 1000 < UNFOCUSED_FRAME_US)
+			{
+				renderer.wait((int32_t)((UNFOCUSED_FRAME_US - since_last_us) / 1000));
+				continue;
+			}
+		}
+
+		// When we pace frames with the CPU clock, we sleep until it
+		// is time for the next frame, but an event still wakes us up
+		if (options.pace && !google_display_timing_enabled)
+		{
+			uint64_t wait_ns = pacer.time_until_next_frame();
+			if (wait_ns >= 1000000)
+			{
+				renderer.wait((int32_t)(wait_ns / 1000000));
+				continue;
+			}
+		}
+
+		// a frame only ever sees one set of shaders,
+		// new ones are picked up between frames
+		shader_reloader.swap(frames.frames_submitted(), frames.depth());
+
+		last_frame_us = platform_time_us();
+		draw();
+
+		// let the demo know that this frame is done
+		frame_finished();
+	}
+
+	if (options.pace)
+		pacer.print_stats();
+	frames.print_stats();
+	pipeline_cache.print_stats();
+	layout_cache.print_stats();
+
+	// wait for the GPU to finish everything we gave
+	// it, before we destroy the device that it belongs to
+	delete_resolution_dependencies();
+	frames.destroy();
+
+	// the GPU is idle, so every set of shaders can go
+	shader_reloader.stop();
+	shader_cache.save();
+	layout_cache.destroy();
+	shader_variants.clear();
+	for (size_t i = 0; i < bundle_modules.size(); i++)
+		vkDestroyShaderModule(device, bundle_modules[i], NULL);
+	bundle_modules.clear();
+	shader_bundle.close();
+
+	// save what the driver compiled while we ran, for next time
+	pipeline_cache.save();
+	pipeline_cache.close();
+
+	vkDestroyDevice(device, NULL);
+	device = VK_NULL_HANDLE;
+}
+
+void Demo::write_inventory(VkPhysicalDevice* gpus, uint32_t gpu_count)
+{
+	Inventory inventory;
+	inventory.node = local_node_name();
+
+	// one GPU per thread, a computer with eight GPUs
+	// waits for the slowest GPU rather than for all eight
+	ThreadPool pool(gpu_count);
+	collect_inventory(gpus, gpu_count, inventory.devices, &pool);
+
+	// a file that ends in ".bin" gets the binary format,
+	// anything else gets JSON
+	const std::string& path = options.inventory_path;
+	bool binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+
+	bool written = binary ?
+		write_inventory_binary(path.c_str(), inventory) :
+		write_inventory_json(path.c_str(), inventory);
+
+	if (written)
+		printf("Wrote the inventory of %u GPUs to %s\n\n", gpu_count, path.c_str());
+	else
+		printf("Could not write the inventory to %s\n\n", path.c_str());
+}
+
+void Demo::prepare()
+{
+	// We will be calling prepare() multiple times.
+	// Some Vulkan assets only need to be created once, like
+	// the instance, the device, and the queue (i'll explain those soon),
+	// while some things need to be destroyed and rebuilt, like the 
+	// swapchain images (I'll explain those soon).
+
+	// We keep track of a variable called first_init, to determine
+	// if we have run the prepare() function before. "first_init"
+	// is initialized as true in the Demo constructor, and it is
+	// set to false after the first initialization is done
+
+	if (first_init)
+	{
+		// Validation will tell us if our Vulkan code is correct.
+		// Sometimes, our code will execute the way we want it to,
+		// but just becasue the code runs, does not mean the code
+		// is correct. If you've ever used HTML, you may have used
+		// and HTML validator, where your website might look correct,
+		// but the validator will tell you that the code is wrong
+
+		// If you run in Debug mode, no Validator text will appear,
+		// text from Validator will only appear if you are in Release Mode
+
+		// During development, this is a great tool. However, when it is
+		// time to release a software or game, you don't want this running
+		// in the background because it will continue constantly checking for errors
+		// even if there are no errors. So, when you want to release a software or
+		// game, simply set this to false.
+		validate = true;
+
+		// During development, it is good to have a console window.
+		// You can read errors, and write printf statements.
+		// However, if you want to release a software or game, you may
+		// not want a console window. Simply comment out this line to 
+		// disable the console window.
+		prepare_console();
+
+		// set the width and height of the window
+		// literally set this to whatever you want
+		width = 640;
+		height = 360;
+
+		// Creating the window, creating the instance, and finding
+		// the GPU do not need each other, so we do not wait for
+		// one to finish before starting the next. Each step is a
+		// task in a small graph (see StartupGraph.h), and a task
+		// only waits for the tasks that it really needs
+		StartupGraph startup;
+
+		// build the window. On Windows, this will look similar to how
+		// a window is created in a DirectX 11/12 engine.
+		// The window has to be made on the main thread, because the
+		// main loop in Main.cpp is the one that reads its messages
+		StartupGraph::TaskId window_task = startup.add("window", [this]() { prepare_window(); }, true);
+
+		// We create an instance of Vulkan, this allows us to use VUlkan
+		// commands on the CPU, but we will not yet be able to talk to 
+		// the graphics device, that comes later.
+		// The instance does not need the window, so this runs on
+		// another thread while the main thread makes the window
+		StartupGraph::TaskId instance_task = startup.add("instance", [this]() { prepare_instance(); }, false);
+
+		// The physical device gives us all the properties of the GPU
+		// that we want to use to render, such as the name of the GPU,
+		// how much memory it has, what features it supports, etc.
+		// We cannot send commands to the GPU through the PhysicalDevice,
+		// but we can use it to determine what our GPU can do.
+		StartupGraph::TaskId gpu_task = startup.add("physical device",
+			[this]() { prepare_physical_device(); }, false, { instance_task });
+
+		// This is where the two halves meet: setting the title of the
+		// window needs both the window and the name of the GPU, so it
+		// waits for both. It runs on the main thread, because changing
+		// the title sends a message to the window, and a window only
+		// reads messages on the thread that made it
+		startup.add("window title", [this]() { platform->set_title(device_info.properties.deviceName); },
+			true, { window_task, gpu_task });
+
+		// The surface needs the window and the instance, but
+		// not the GPU, so it can be made while we look for the GPU
+		startup.add("surface", [this]() { prepare_surface(); }, false, { window_task, instance_task });
+
+		// two workers is enough, the main thread
+		// does the window tasks itself
+		ThreadPool pool(2);
+		startup.run(pool);
+		startup.print_timeline();
+
+		// From here on, everything that talks to the GPU
+		// happens on the render thread, starting with the device.
+		// -idle-benchmark measures the CPU that the whole program
+		// uses while the main loop waits, so nothing can be drawing
+		// then, and the render thread is never started
+		if (options.idle_seconds == 0)
+			renderer.start([this]() { render_thread_main(); });
+
+		first_init = false;
+	}
+}
+
+
+void Demo::frame_finished()
+{
+	// The first frame is the one that people wait for when they
+	// start the program, so we measure how long it took to get
+	// here from the moment the Demo was created
+	if (!first_frame_done)
+	{
+		first_frame_done = true;
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - launch_time;
+		printf("Time to first frame: %.2f ms\n\n", elapsed.count());
+	}
+}
+
+Demo::Demo(const Options& options)
+{
+	// Welcome to the Demo constructor
+	// The Demo class will handle the majority
+	// of our code in this tutorial
+
+	// Please look at Demo.h, 
+	// where you can see a list of every variable that
+	// we will use in the Demo class. Every variable
+	// in this class will be fully explained while
+	// we move through the code
+
+	// "Time to first frame" is measured from here
+	launch_time = std::chrono::high_resolution_clock::now();
+	first_frame_done = false;
+
+	this->options = options;
+	debug_messenger = nullptr;
+	first_init = true;
+	device = VK_NULL_HANDLE;
+	graphics_queue = VK_NULL_HANDLE;
+	surface = VK_NULL_HANDLE;
+	swapchain = VK_NULL_HANDLE;
+	swapchain_dirty = false;
+	resize_pending_since_us = 0;
+	has_focus = true;
+	hidden_since_us = 0;
+	last_frame_us = 0;
+	prepared = false;
+	is_minimized = false;
+	current_buffer = 0;
+	google_display_timing_enabled = false;
+	fpGetRefreshCycleDurationGOOGLE = NULL;
+	fpGetPastPresentationTimingGOOGLE = NULL;
+
+	// what we care about most when we show a frame,
+	// see Swapchain.h
+	if (!parse_present_policy(options.present_policy.c_str(), present_policy))
+	{
+		printf("There is no present policy called \"%s\", using \"latency\"\n", options.present_policy.c_str());
+		present_policy = PRESENT_LATENCY;
+	}
+
+	// Pick the platform that will make our window, and
+	// give us its messages, see Platform.h
+	platform = create_platform(options.platform_name.c_str());
+	if (!platform)
+	{
+		printf("There is no platform called \"%s\" in this program\n", options.platform_name.c_str());
+		fflush(stdout);
+		exit(1);
+	}
+
+	// If we were asked to make a capture, open the
+	// capture file before we make any Vulkan calls
+	capture = nullptr;
+	if (!options.capture_path.empty())
+	{
+		capture = new CaptureWriter();
+		if (!capture->open(options.capture_path.c_str()))
+		{
+			printf("Could not open %s to write a capture\n", options.capture_path.c_str());
+			delete capture;
+			capture = nullptr;
+		}
+	}
+
+	// a rules file adds to the built in rules, it does not
+	// replace them, so a bad file only costs us the new rules
+	if (!options.driver_rules_path.empty())
+	{
+		std::string error;
+		if (!driver_rules.load_file(options.driver_rules_path.c_str(), error))
+			printf("Could not load %s: %s\n", options.driver_rules_path.c_str(), error.c_str());
+	}
+
+	// The first thing we do is initalize the scene
+	prepare();
+}
+
+Demo::~Demo()
+{
+	// The render thread destroys the device on its way out,
+	// and the device has to be gone before the instance is
+	renderer.stop();
+	renderer.print_latency();
+
+	// The debug messenger has to be unregistered
+	// before the instance that it belongs to is destroyed
+	if (debug_messenger)
+		debug_messenger->destroy();
+
+	// the surface belongs to the instance too
+	if (surface != VK_NULL_HANDLE)
+		vkDestroySurfaceKHR(inst, surface, NULL);
+
+	// Destroy Vulkan Instance
+	vkDestroyInstance(inst, NULL);
+
+	// write out the last validation messages,
+	// and print how many of each message we got
+	if (debug_messenger)
+	{
+		debug_messenger->shutdown();
+		debug_messenger->print_counters();
+		delete debug_messenger;
+	}
+
+	// finish the capture file, if we were making one
+	if (capture)
+	{
+		capture->record_destroy_instance(inst);
+		capture->close();
+		delete capture;
+	}
+
+	// the window goes last, after everything
+	// that Vulkan made for it is gone
+	delete platform;
+}
@@ -1,107 +1,265 @@
-/*
-Copyright 2019
-Original authors: Niko Procopi
-Written under the supervision of David I. Schwartz, Ph.D., and
-supported by a professional development seed grant from the B. Thomas
-Golisano College of Computing & Information Sciences
-(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
-This program is free software: you can redistribute it and/or modify
-it under the terms of the GNU General Public License as published by
-the Free Software Foundation, either version 3 of the License, or (at
-your option) any later version.
-
-This program is distributed in the hope that it will be useful, but
-WITHOUT ANY WARRANTY; without even the implied warranty of
-MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
-General Public License for more details.
-<http://www.gnu.org/licenses/>.
-
-Special Thanks to Exzap from Team Cemu,
-he gave me advice on how to optimize Vulkan
-graphics, he is working on a Wii U emulator
-that utilizes Vulkan, see more at http://cemu.info
-*/
-
-#pragma once
-
-// This is a simple helper that gives
-// us the size of an array
-#define ARRAY_SIZE(a) (sizeof(a) / sizeof(a[0]))
-
-// This is a simple helper function
-// that allows us to print errors when
-// they happen. We give it a message,
-// and then it makes a box appear that gives
-// the message to the user. We will do this
-// to display all errors
-#define ERR_EXIT(err_msg, err_class)                                             \
-    do {                                                                         \
-        MessageBox(NULL, err_msg, err_class, MB_OK); \
-        exit(1);                                                                 \
-    } while (0)
-
-// Next thing we do is include all of the Vulkan headers
-
-#define APP_NAME_STR_LEN 80
-#include <vulkan/vulkan.h>
-#include <vulkan/vk_sdk_platform.h>
-
-// Allow a maximum of two outstanding presentation operations.
-#define FRAME_LAG 2
-
-class Demo
-{
-public:
-	char name[APP_NAME_STR_LEN];  // Name to put on the window/icon
-	HWND window;                  // hWnd - window handle
-	POINT minsize;                // minimum window size
-
-	VkSurfaceKHR surface;
-	bool prepared;
-	bool is_minimized;
-
-	bool syncd_with_actual_presents;
-	uint64_t refresh_duration;
-	uint64_t refresh_duration_multiplier;
-	uint64_t target_IPD;  // image present duration (inverse of frame rate)
-	uint64_t prev_desired_present_time;
-	uint32_t next_present_id;
-	uint32_t last_early_id;  // 0 if no early images
-	uint32_t last_late_id;   // 0 if no late images
-
-	VkInstance inst;
-	VkPhysicalDevice gpu;
-
-	uint32_t enabled_extension_count;
-	uint32_t enabled_layer_count;
-	char *extension_names[64];
-	char *enabled_layers[64];
-
-	int width, height;
-	VkFormat format;
-	VkColorSpaceKHR color_space;
-
-	VkCommandPool cmd_pool;
-	VkRenderPass render_pass;
-	
-	bool validate;
-	uint32_t current_buffer;
-
-	void prepare_console();
-	void prepare_window();
-	void prepare_instance();
-	void prepare_physical_device();
-	void prepare_instance_functionPointers();
-	void prepare_surface();
-	void prepare_device_queue();
-	void prepare_device_functionPointers();
-	void prepare();
-
-
-	void delete_resolution_dependencies();
-	void run();
-
-	Demo();
-	~Demo();
-};
-
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+// This is a simple helper that gives
+// us the size of an array
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof(a[0]))
+
+// This is a simple helper function
+// that allows us to print errors when
+// they happen. We give it a message,
+// and it prints the message, makes sure
+// the validation log is written, and quits.
+// Look for report_fatal_error in
+// DebugMessenger.cpp to see how it works
+#define ERR_EXIT(err_msg, err_class)                                             \
+    do {                                                                         \
+        report_fatal_error(err_msg, err_class);                                  \
+    } while (0)
+
+// Next thing we do is include all of the Vulkan headers
+
+#define APP_NAME_STR_LEN 80
+#include <vulkan/vulkan.h>
+#include <vulkan/vk_sdk_platform.h>
+#include <chrono>
+
+#include "Options.h"
+#include "DebugMessenger.h"
+#include "Inventory.h"
+#include "DriverRules.h"
+#include "Platform.h"
+#include "RenderThread.h"
+#include "Swapchain.h"
+#include "FramePacer.h"
+#include "FrameRing.h"
+#include "PipelineCache.h"
+#include "ShaderReloader.h"
+#include "LayoutCache.h"
+#include "ShaderBundle.h"
+#include "ShaderVariants.h"
+#include <vector>
+
+class CaptureWriter;
+
+// Allow a maximum of two outstanding presentation operations,
+// unless we are told otherwise with "-frames" (see FrameRing.h)
+#define FRAME_LAG 2
+
+// While the window is being dragged to a new size, we get a
+// new size many times a second. We only rebuild the swapchain
+// once the size has stayed the same for this long
+#define RESIZE_SETTLE_US 50000
+
+// how often we draw a window that can be seen,
+// but that does not have the keyboard (30 times a second)
+#define UNFOCUSED_FRAME_US 33333
+
+class Demo
+{
+public:
+	char name[APP_NAME_STR_LEN];  // Name to put on the window/icon
+
+	// the window, and the messages that come from it,
+	// on whichever operating system we are running on
+	Platform* platform;
+
+	VkSurfaceKHR surface;
+	bool prepared;
+
+	// true when nobody can see the window (it is minimized, or
+	// covered), and false when it has the keyboard. These come
+	// from the platform, see PLATFORM_EVENT_VISIBILITY
+	bool is_minimized;
+	bool has_focus;
+	uint64_t hidden_since_us;
+	uint64_t last_frame_us;
+
+	// Decides when each frame is shown, if we were started
+	// with "-pace", see FramePacer.h. It uses the display
+	// timing extension when the GPU has it, and the CPU
+	// clock when it does not
+	FramePacer pacer;
+	bool google_display_timing_enabled;
+	PFN_vkGetRefreshCycleDurationGOOGLE fpGetRefreshCycleDurationGOOGLE;
+	PFN_vkGetPastPresentationTimingGOOGLE fpGetPastPresentationTimingGOOGLE;
+
+	VkInstance inst;
+	VkPhysicalDevice gpu;
+
+	// The device is how we send commands to "gpu", and the queue
+	// is where the commands go. Both belong to the render thread:
+	// it makes them, uses them, and destroys them
+	VkDevice device;
+	VkQueue graphics_queue;
+	uint32_t graphics_queue_family_index;
+
+	// everything we know about "gpu", or about
+	// the GPU in the device profile, if we were
+	// given one with "-profile"
+	DeviceInventory device_info;
+
+	// known bad GPU and driver combinations, used to
+	// pick "gpu" and to turn off features that are
+	// broken on it (see DriverRules.h)
+	DriverRules driver_rules;
+
+	uint32_t enabled_extension_count;
+	uint32_t enabled_layer_count;
+	char *extension_names[64];
+	char *enabled_layers[64];
+
+	int width, height;
+	VkFormat format;
+	VkColorSpaceKHR color_space;
+
+	// The swapchain is the list of images that take turns being
+	// shown in the window. It belongs to the render thread, and
+	// it is rebuilt whenever the window changes size
+	PresentPolicy present_policy;
+	VkPresentModeKHR present_mode;
+	VkSwapchainKHR swapchain;
+	VkExtent2D swapchain_extent;
+	std::vector<VkImage> swapchain_images;
+
+	// true when the swapchain no longer matches the window
+	bool swapchain_dirty;
+
+	// when the last new size of the window arrived, 0 if the
+	// swapchain has caught up with it (see RESIZE_SETTLE_US)
+	uint64_t resize_pending_since_us;
+
+	// A swapchain that was replaced, but that the GPU might still
+	// be using for a frame in flight. It is destroyed once every
+	// frame that was in flight when it was replaced is done
+	struct RetiredSwapchain
+	{
+		VkSwapchainKHR swapchain;
+		uint64_t retired_at_frame;
+	};
+	std::vector<RetiredSwapchain> retired_swapchains;
+
+	// The fences, semaphores, and command buffers of every frame in
+	// flight. We use them in turns, so the CPU can get a few frames
+	// ahead of the GPU and no further (see FrameRing.h)
+	FrameRing frames;
+
+	// what the driver compiled for our pipelines, kept in a
+	// file so that the next run does not compile them again
+	PipelineCache pipeline_cache;
+
+	// The shaders from "-watch-shaders", compiled in the background,
+	// and again whenever they change (see ShaderReloader.h), and
+	// the layouts that are made from them (see LayoutCache.h)
+	ShaderCache shader_cache;
+	ShaderReloader shader_reloader;
+	LayoutCache layout_cache;
+	void prepare_shaders();
+
+	// The shaders from "-shader-bundle", made into modules at
+	// startup, straight out of the mapped file (see ShaderBundle.h)
+	ShaderBundle shader_bundle;
+	std::vector<VkShaderModule> bundle_modules;
+	void load_shader_bundle();
+
+	// The version of every shader in the bundle that has variants,
+	// picked for this GPU (see ShaderVariants.h), and its module.
+	// A pipeline is made with that module, and with
+	// variant.specialization() in its VkPipelineShaderStageCreateInfo
+	struct BundleVariant
+	{
+		ShaderVariant variant;
+		VkShaderModule module;
+	};
+	std::vector<BundleVariant> shader_variants;
+
+	VkCommandPool cmd_pool;
+	VkRenderPass render_pass;
+	
+	bool validate;
+	uint32_t current_buffer;
+
+	// This boolean keeps track of how many times we have executed the
+	// "prepare()" function. If we have never used the function before
+	// then we know we are initializing the program for the first time,
+	// if the boolean is false, then we know the program has already
+	// been initialized
+	bool first_init;
+
+	// when the Demo was created, and whether we have
+	// finished a frame yet, so that we can tell how
+	// long it took from launch until the first frame
+	std::chrono::high_resolution_clock::time_point launch_time;
+	bool first_frame_done;
+
+	// everything that was given on the command line
+	Options options;
+
+	// the thread that owns the device and draws the frames,
+	// look at RenderThread.h to see why it has its own thread
+	RenderThread renderer;
+
+	// receives messages from the validation layer,
+	// null if validation is off or VK_EXT_debug_utils
+	// is not available
+	DebugMessenger* debug_messenger;
+
+	// records every Vulkan call we make, if the
+	// program was started with "-capture <file>",
+	// otherwise this is null
+	CaptureWriter* capture;
+
+	static void prepare_console();
+	void prepare_window();
+	void prepare_instance();
+	void prepare_physical_device();
+	void write_inventory(VkPhysicalDevice* gpus, uint32_t gpu_count);
+	void prepare_instance_functionPointers();
+	void prepare_surface();
+	void prepare_device_queue();
+	void prepare_device_functionPointers();
+	void prepare_swapchain();
+	void release_retired_swapchains(bool all);
+	void record_frame(VkCommandBuffer commands, VkImage image);
+	void draw();
+	void prepare();
+
+	// called by the render thread at the end of every frame
+	void frame_finished();
+
+	// what the render thread does, from start to finish,
+	// and what it does with each event from the window
+	void render_thread_main();
+	void handle_event(const PlatformEvent& event);
+
+
+	void delete_resolution_dependencies();
+	void run();
+
+	Demo(const Options& options);
+	~Demo();
+};
+
@@ -0,0 +1,215 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "DriverRules.h"
+
+#include <stdlib.h>
+
+#include "DriverVersion.h"
+#include "JsonReader.h"
+#include "MappedFile.h"
+
+// The rules that come with the program. Keep these to things we
+// are sure about, and use a rules file for anything that only
+// matters to one fleet of computers
+struct BuiltinDriverRule
+{
+	uint32_t vendor_id;
+	uint32_t device_min, device_max;
+	const char* driver_min;
+	const char* driver_max;
+	DriverRuleAction action;
+	const char* feature;
+	const char* reason;
+};
+
+static const BuiltinDriverRule builtin_rules[] =
+{
+	{ 0x10005, 0x0000, 0xFFFF, "", "", DRIVER_RULE_SLOW, "",
+		"llvmpipe draws with the CPU" },
+	{ 0x1AE0, 0xC0DE, 0xC0DE, "", "", DRIVER_RULE_SLOW, "",
+		"SwiftShader draws with the CPU" },
+};
+
+bool DriverRule::matches(const VkPhysicalDeviceProperties& properties) const
+{
+	if (properties.vendorID != vendor_id)
+		return false;
+	if (properties.deviceID < device_min || properties.deviceID > device_max)
+		return false;
+
+	// The versions in a rule are written the way the vendor writes
+	// them, so they are turned into that vendor's encoding before
+	// we compare. After that, a plain number comparison is right
+	// for every vendor (see DriverVersion.h)
+	uint32_t raw = properties.driverVersion;
+	uint32_t limit;
+	if (!driver_min.empty() && parse_driver_version(vendor_id, driver_min.c_str(), limit) && raw < limit)
+		return false;
+	if (!driver_max.empty() && parse_driver_version(vendor_id, driver_max.c_str(), limit) && raw >= limit)
+		return false;
+
+	return true;
+}
+
+DriverRules::DriverRules()
+{
+	for (size_t i = 0; i < sizeof(builtin_rules) / sizeof(builtin_rules[0]); i++)
+	{
+		const BuiltinDriverRule& b = builtin_rules[i];
+
+		DriverRule rule;
+		rule.vendor_id = b.vendor_id;
+		rule.device_min = b.device_min;
+		rule.device_max = b.device_max;
+		rule.driver_min = b.driver_min;
+		rule.driver_max = b.driver_max;
+		rule.action = b.action;
+		rule.feature = b.feature;
+		rule.reason = b.reason;
+		rules.push_back(rule);
+	}
+}
+
+// IDs are easier to read in hex, but JSON has no hex numbers,
+// so we take either a number or a string like "0x10DE"
+static uint32_t json_id(const JsonValue& value, uint32_t fallback)
+{
+	if (value.type() == JSON_STRING)
+		return (uint32_t)strtoul(value.as_string().c_str(), NULL, 0);
+	return (uint32_t)value.as_u64(fallback);
+}
+
+bool DriverRules::load_file(const char* path, std::string& error)
+{
+	MappedFile file;
+	if (!file.open(path))
+	{
+		error = std::string("cannot open ") + path;
+		return false;
+	}
+
+	JsonDocument doc;
+	if (!doc.parse((const char*)file.data(), file.size()))
+	{
+		error = doc.error();
+		return false;
+	}
+
+	JsonValue list = doc.root()["rules"];
+	if (list.type() != JSON_ARRAY)
+	{
+		error = "there is no \"rules\" array";
+		return false;
+	}
+
+	// the rules are only added once the whole file has been read,
+	// so a mistake in one rule never leaves half of the file applied
+	std::vector<DriverRule> loaded;
+	for (JsonValue r = list.first_child(); r.valid(); r = r.next())
+	{
+		DriverRule rule;
+		rule.vendor_id = json_id(r["vendor"], 0);
+		rule.device_min = json_id(r["device_min"], 0);
+		rule.device_max = json_id(r["device_max"], 0xFFFFFFFFu);
+		rule.driver_min = r["driver_min"].as_string();
+		rule.driver_max = r["driver_max"].as_string();
+		rule.feature = r["feature"].as_string();
+		rule.reason = r["reason"].as_string();
+
+		std::string action = r["action"].as_string();
+		if (action == "avoid")
+			rule.action = DRIVER_RULE_AVOID;
+		else if (action == "slow")
+			rule.action = DRIVER_RULE_SLOW;
+		else if (action == "disable" && !rule.feature.empty())
+			rule.action = DRIVER_RULE_DISABLE_FEATURE;
+		else
+		{
+			error = "rule " + std::to_string(loaded.size()) + " has no valid \"action\"";
+			return false;
+		}
+
+		// check the versions now, rather than quietly
+		// ignoring them every time the rule is used
+		uint32_t raw;
+		if ((!rule.driver_min.empty() && !parse_driver_version(rule.vendor_id, rule.driver_min.c_str(), raw)) ||
+			(!rule.driver_max.empty() && !parse_driver_version(rule.vendor_id, rule.driver_max.c_str(), raw)))
+		{
+			error = "cannot understand the driver versions of \"" + rule.reason + "\"";
+			return false;
+		}
+
+		loaded.push_back(rule);
+	}
+
+	rules.insert(rules.end(), loaded.begin(), loaded.end());
+	return true;
+}
+
+void DriverRules::match(const VkPhysicalDeviceProperties& properties, std::vector<const DriverRule*>& out) const
+{
+	out.clear();
+	for (size_t i = 0; i < rules.size(); i++)
+		if (rules[i].matches(properties))
+			out.push_back(&rules[i]);
+}
+
+bool DriverRules::feature_disabled(const VkPhysicalDeviceProperties& properties, const char* feature) const
+{
+	for (size_t i = 0; i < rules.size(); i++)
+	{
+		if (rules[i].action == DRIVER_RULE_DISABLE_FEATURE &&
+			rules[i].feature == feature && rules[i].matches(properties))
+			return true;
+	}
+	return false;
+}
+
+int32_t DriverRules::score_device(const VkPhysicalDeviceProperties& properties) const
+{
+	int32_t score = 0;
+	switch (properties.deviceType)
+	{
+	case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:   score = 1000; break;
+	case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: score = 500; break;
+	case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:    score = 250; break;
+	case VK_PHYSICAL_DEVICE_TYPE_CPU:            score = 100; break;
+	default:                                     score = 50; break;
+	}
+
+	// "slow" is enough to drop a GPU below the next kind of GPU,
+	// "avoid" drops it below every GPU that has no "avoid" rule
+	for (size_t i = 0; i < rules.size(); i++)
+	{
+		if (!rules[i].matches(properties))
+			continue;
+		if (rules[i].action == DRIVER_RULE_AVOID)
+			score -= 100000;
+		else if (rules[i].action == DRIVER_RULE_SLOW)
+			score -= 600;
+	}
+
+	return score;
+}
@@ -0,0 +1,103 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Some combinations of GPU and driver are known to be slow,
+// or to be broken in one feature, or to not have a feature yet.
+// A DriverRule describes one of those combinations: which vendor,
+// which range of device IDs, which range of driver versions, and
+// what we should do about it. The rules are a table, not code, so
+// that a new bad driver only needs a new line (or a line in a rules
+// file given with -driver-rules), and nothing else has to change
+enum DriverRuleAction
+{
+	// do not pick this GPU if there is any other choice
+	DRIVER_RULE_AVOID,
+
+	// this GPU works, but prefer another one of the same kind
+	DRIVER_RULE_SLOW,
+
+	// this GPU is fine, but do not use "feature" on it
+	DRIVER_RULE_DISABLE_FEATURE
+};
+
+struct DriverRule
+{
+	uint32_t vendor_id;
+
+	// device IDs from device_min to device_max, both included
+	uint32_t device_min, device_max;
+
+	// driver versions from driver_min (included) to driver_max (not
+	// included), written the way the vendor writes them ("441.66").
+	// An empty string means there is no limit on that side
+	std::string driver_min, driver_max;
+
+	DriverRuleAction action;
+	std::string feature;
+	std::string reason;
+
+	// true if this rule is about this GPU with this driver
+	bool matches(const VkPhysicalDeviceProperties& properties) const;
+};
+
+class DriverRules
+{
+public:
+	// starts with the rules that are built into the program
+	DriverRules();
+
+	// Add the rules from a JSON file, which looks like this:
+	// { "rules": [ { "vendor": "0x10DE", "device_min": "0x1B80",
+	//   "device_max": "0x1B81", "driver_min": "440.0",
+	//   "driver_max": "441.66", "action": "slow",
+	//   "reason": "..." } ] }
+	// "action" is "avoid", "slow", or "disable" (with "feature").
+	// Leaving out the devices or drivers means "all of them"
+	bool load_file(const char* path, std::string& error);
+
+	// every rule that is about this GPU with this driver
+	void match(const VkPhysicalDeviceProperties& properties, std::vector<const DriverRule*>& out) const;
+
+	// true if a rule says not to use this feature on this GPU
+	bool feature_disabled(const VkPhysicalDeviceProperties& properties, const char* feature) const;
+
+	// How much we want to use this GPU: the kind of GPU gives the
+	// most points (discrete, then integrated, then virtual, then the
+	// CPU), and rules take points away. The GPU with the highest
+	// score is the best choice
+	int32_t score_device(const VkPhysicalDeviceProperties& properties) const;
+
+	const std::vector<DriverRule>& all() const { return rules; }
+
+private:
+	std::vector<DriverRule> rules;
+};
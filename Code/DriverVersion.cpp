@@ -0,0 +1,148 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "DriverVersion.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vulkan/vulkan.h>
+
+#define VENDOR_NVIDIA 0x10DE
+#define VENDOR_INTEL 0x8086
+
+// Intel uses VK_MAKE_VERSION on Linux (the Mesa driver) and its own
+// 18.14 encoding on Windows, and the number alone does not say which
+// computer it came from. Windows versions look like 100.9466, which
+// is far below 1 << 22, while a Mesa version would have to be 0.x.x
+// to be that small, so we use that to tell them apart
+static bool is_intel_windows(uint32_t vendor_id, uint32_t raw)
+{
+	return vendor_id == VENDOR_INTEL && raw < (1u << 22);
+}
+
+DriverVersion decode_driver_version(uint32_t vendor_id, uint32_t raw)
+{
+	DriverVersion v = {};
+
+	if (vendor_id == VENDOR_NVIDIA)
+	{
+		v.major = (raw >> 22) & 0x3FF;
+		v.minor = (raw >> 14) & 0xFF;
+		v.patch = (raw >> 6) & 0xFF;
+		v.build = raw & 0x3F;
+		v.parts = 4;
+	}
+	else if (is_intel_windows(vendor_id, raw))
+	{
+		v.major = raw >> 14;
+		v.minor = raw & 0x3FFF;
+		v.parts = 2;
+	}
+	else
+	{
+		v.major = VK_VERSION_MAJOR(raw);
+		v.minor = VK_VERSION_MINOR(raw);
+		v.patch = VK_VERSION_PATCH(raw);
+		v.parts = 3;
+	}
+
+	return v;
+}
+
+std::string driver_version_string(uint32_t vendor_id, uint32_t raw)
+{
+	DriverVersion v = decode_driver_version(vendor_id, raw);
+
+	// NVIDIA itself only ever shows the first two numbers,
+	// so we do the same unless the others are being used.
+	// Intel minor versions are not padded ("100.9466")
+	char text[64];
+	if (v.parts == 2)
+		snprintf(text, sizeof(text), "%u.%u", v.major, v.minor);
+	else if (v.parts == 4 && v.patch == 0 && v.build == 0)
+		snprintf(text, sizeof(text), "%u.%02u", v.major, v.minor);
+	else if (v.parts == 4)
+		snprintf(text, sizeof(text), "%u.%02u.%u.%u", v.major, v.minor, v.patch, v.build);
+	else
+		snprintf(text, sizeof(text), "%u.%u.%u", v.major, v.minor, v.patch);
+
+	return text;
+}
+
+bool parse_driver_version(uint32_t vendor_id, const char* text, uint32_t& raw)
+{
+	if (!text || !*text)
+		return false;
+
+	if (!strchr(text, '.'))
+	{
+		char* end = nullptr;
+		raw = (uint32_t)strtoul(text, &end, 0);
+		return *end == 0;
+	}
+
+	// two to four numbers with dots between them, and nothing
+	// else: "441.66 beta" is not a version we can compare
+	unsigned int n[4] = {};
+	int parts = 0;
+	const char* c = text;
+	while (true)
+	{
+		if (parts == 4 || !isdigit((unsigned char)*c))
+			return false;
+
+		char* end = nullptr;
+		n[parts++] = (unsigned int)strtoul(c, &end, 10);
+		c = end;
+		if (!*c)
+			break;
+		if (*c != '.')
+			return false;
+		c++;
+	}
+	if (parts < 2)
+		return false;
+
+	if (vendor_id == VENDOR_NVIDIA)
+	{
+		raw = ((n[0] & 0x3FF) << 22) | ((n[1] & 0xFF) << 14) | ((n[2] & 0xFF) << 6) | (n[3] & 0x3F);
+	}
+	else if (vendor_id == VENDOR_INTEL && parts == 2)
+	{
+		// two numbers is how Intel writes Windows versions,
+		// Mesa versions always have three
+		raw = (n[0] << 14) | (n[1] & 0x3FFF);
+	}
+	else
+	{
+		if (parts > 3)
+			return false;
+		raw = VK_MAKE_VERSION(n[0], n[1], n[2]);
+	}
+
+	return true;
+}
@@ -0,0 +1,55 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+// VkPhysicalDeviceProperties::driverVersion is only 32 bits, and
+// Vulkan does not say how a driver should pack its version into it.
+// Most drivers use VK_MAKE_VERSION (10.10.12 bits), but NVIDIA packs
+// four numbers (10.8.8.6 bits, "441.66.0.0"), and Intel on Windows
+// packs two (18.14 bits, "100.9466"). All three keep the most
+// important number in the highest bits, so two versions from the
+// same vendor can still be compared as plain numbers
+struct DriverVersion
+{
+	uint32_t major, minor, patch, build;
+
+	// how many of the numbers above mean something,
+	// 2 for Intel on Windows, 4 for NVIDIA, 3 for everyone else
+	uint32_t parts;
+};
+
+DriverVersion decode_driver_version(uint32_t vendor_id, uint32_t raw);
+
+// "441.66", "100.9466", "1.2.131"...
+std::string driver_version_string(uint32_t vendor_id, uint32_t raw);
+
+// The opposite of driver_version_string: turn a dotted version
+// into the number that this vendor's driver would report. A plain
+// number without dots ("123", "0x7b") is taken as the raw value.
+// Returns false if the text is not a version at all
+bool parse_driver_version(uint32_t vendor_id, const char* text, uint32_t& raw);
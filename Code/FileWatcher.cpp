@@ -0,0 +1,281 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "FileWatcher.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// the folder part of a path, "" for a file in the current folder,
+// and the prefix that goes back in front of every file name
+static void split_folder(const std::string& file, std::string& folder, std::string& prefix)
+{
+	size_t slash = file.find_last_of("/\\");
+	if (slash == std::string::npos)
+	{
+		folder = ".";
+		prefix = "";
+	}
+	else
+	{
+		folder = file.substr(0, slash);
+		prefix = file.substr(0, slash + 1);
+	}
+}
+
+#ifdef _WIN32
+
+// Every folder has a read in flight all the time. When the read
+// finishes, its event is set, and the buffer holds the names
+struct FileWatcher::Folder
+{
+	std::string prefix;
+	HANDLE handle;
+	OVERLAPPED overlapped;
+	DWORD buffer[4096];
+};
+
+static bool start_read(HANDLE handle, OVERLAPPED* overlapped, DWORD* buffer, DWORD size)
+{
+	return ReadDirectoryChangesW(handle, buffer, size, FALSE,
+		FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE,
+		NULL, overlapped, NULL) != 0;
+}
+
+FileWatcher::FileWatcher()
+{
+	wake_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+}
+
+FileWatcher::~FileWatcher()
+{
+	for (size_t i = 0; i < folders.size(); i++)
+	{
+		CancelIoEx(folders[i]->handle, &folders[i]->overlapped);
+		DWORD ignored;
+		GetOverlappedResult(folders[i]->handle, &folders[i]->overlapped, &ignored, TRUE);
+		CloseHandle(folders[i]->overlapped.hEvent);
+		CloseHandle(folders[i]->handle);
+		delete folders[i];
+	}
+	CloseHandle(wake_event);
+}
+
+bool FileWatcher::watch_file_folder(const std::string& file)
+{
+	std::string folder, prefix;
+	split_folder(file, folder, prefix);
+	for (size_t i = 0; i < folders.size(); i++)
+	{
+		if (folders[i]->prefix == prefix)
+			return true;
+	}
+
+	// WaitForMultipleObjects can not wait for more
+	// than 64 things, one of them is the wake event
+	if (folders.size() + 1 >= 64)
+		return false;
+
+	HANDLE handle = CreateFile(folder.c_str(), FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+
+	Folder* watched = new Folder;
+	watched->prefix = prefix;
+	watched->handle = handle;
+	memset(&watched->overlapped, 0, sizeof(watched->overlapped));
+	watched->overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (!start_read(handle, &watched->overlapped, watched->buffer, sizeof(watched->buffer)))
+	{
+		CloseHandle(watched->overlapped.hEvent);
+		CloseHandle(handle);
+		delete watched;
+		return false;
+	}
+
+	folders.push_back(watched);
+	return true;
+}
+
+bool FileWatcher::wait(std::vector<std::string>& changed, int32_t timeout_ms)
+{
+	std::vector<HANDLE> events;
+	events.push_back(wake_event);
+	for (size_t i = 0; i < folders.size(); i++)
+		events.push_back(folders[i]->overlapped.hEvent);
+
+	DWORD result = WaitForMultipleObjects((DWORD)events.size(), events.data(), FALSE,
+		timeout_ms < 0 ? INFINITE : (DWORD)timeout_ms);
+	if (result == WAIT_TIMEOUT)
+		return false;
+	if (result == WAIT_OBJECT_0)
+		return true;
+
+	Folder* folder = folders[result - WAIT_OBJECT_0 - 1];
+	DWORD size = 0;
+	bool ok = GetOverlappedResult(folder->handle, &folder->overlapped, &size, FALSE) != 0;
+	ResetEvent(folder->overlapped.hEvent);
+
+	// Zero bytes means that so much changed that the names did not
+	// fit in the buffer, so we can not tell which files it was
+	const uint8_t* entry = (const uint8_t*)folder->buffer;
+	while (ok && size > 0)
+	{
+		const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)entry;
+		int wide_length = (int)(info->FileNameLength / sizeof(wchar_t));
+		int length = WideCharToMultiByte(CP_UTF8, 0, info->FileName, wide_length, NULL, 0, NULL, NULL);
+		std::string name(length, 0);
+		WideCharToMultiByte(CP_UTF8, 0, info->FileName, wide_length, &name[0], length, NULL, NULL);
+		changed.push_back(folder->prefix + name);
+
+		if (!info->NextEntryOffset)
+			break;
+		entry += info->NextEntryOffset;
+	}
+
+	// and we start listening again for the next change
+	start_read(folder->handle, &folder->overlapped, folder->buffer, sizeof(folder->buffer));
+	return true;
+}
+
+void FileWatcher::wake()
+{
+	SetEvent(wake_event);
+}
+
+#else
+
+// inotify tells us which watch a change came from,
+// and that is how we find the folder
+struct FileWatcher::Folder
+{
+	std::string prefix;
+	int watch;
+};
+
+FileWatcher::FileWatcher()
+{
+	inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (pipe(wake_pipe) != 0)
+		wake_pipe[0] = wake_pipe[1] = -1;
+}
+
+FileWatcher::~FileWatcher()
+{
+	for (size_t i = 0; i < folders.size(); i++)
+		delete folders[i];
+	if (inotify_fd >= 0)
+		close(inotify_fd);
+	if (wake_pipe[0] >= 0)
+	{
+		close(wake_pipe[0]);
+		close(wake_pipe[1]);
+	}
+}
+
+bool FileWatcher::watch_file_folder(const std::string& file)
+{
+	std::string folder, prefix;
+	split_folder(file, folder, prefix);
+	for (size_t i = 0; i < folders.size(); i++)
+	{
+		if (folders[i]->prefix == prefix)
+			return true;
+	}
+
+	if (inotify_fd < 0)
+		return false;
+
+	// written and closed, or renamed into the folder
+	int watch = inotify_add_watch(inotify_fd, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+	if (watch < 0)
+		return false;
+
+	Folder* watched = new Folder;
+	watched->prefix = prefix;
+	watched->watch = watch;
+	folders.push_back(watched);
+	return true;
+}
+
+bool FileWatcher::wait(std::vector<std::string>& changed, int32_t timeout_ms)
+{
+	struct pollfd fds[2] = {};
+	fds[0].fd = inotify_fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = wake_pipe[0];
+	fds[1].events = POLLIN;
+
+	int ready = poll(fds, 2, timeout_ms < 0 ? -1 : timeout_ms);
+	if (ready <= 0)
+		return false;
+
+	if (fds[1].revents & POLLIN)
+	{
+		char drain[64];
+		ssize_t ignored = read(wake_pipe[0], drain, sizeof(drain));
+		(void)ignored;
+	}
+
+	// the events are packed one after the other,
+	// each with its name right behind it
+	alignas(struct inotify_event) char buffer[8192];
+	ssize_t size;
+	while (fds[0].revents & POLLIN && (size = read(inotify_fd, buffer, sizeof(buffer))) > 0)
+	{
+		for (ssize_t offset = 0; offset < size; )
+		{
+			const struct inotify_event* event = (const struct inotify_event*)(buffer + offset);
+			offset += sizeof(struct inotify_event) + event->len;
+			if (!event->len)
+				continue;
+
+			for (size_t i = 0; i < folders.size(); i++)
+			{
+				if (folders[i]->watch == event->wd)
+					changed.push_back(folders[i]->prefix + event->name);
+			}
+		}
+	}
+	return true;
+}
+
+void FileWatcher::wake()
+{
+	char c = 1;
+	ssize_t ignored = write(wake_pipe[1], &c, 1);
+	(void)ignored;
+}
+
+#endif
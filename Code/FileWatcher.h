@@ -0,0 +1,72 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// FileWatcher asks the operating system to tell us when files in a
+// few folders change (inotify on Linux, ReadDirectoryChangesW on
+// Windows), so that we never have to look at the files over and over.
+// We watch folders rather than files, because most editors save by
+// writing a new file and renaming it over the old one, and a watch
+// on the old file would be lost when that happens.
+//
+// One thread calls wait, any thread can call wake
+class FileWatcher
+{
+public:
+	FileWatcher();
+	~FileWatcher();
+
+	// watch the folder that "file" is in, watching
+	// the same folder twice does nothing
+	bool watch_file_folder(const std::string& file);
+
+	// Sleep until a file in a watched folder changes, or until
+	// timeout_ms has passed, or until wake is called. The files
+	// that changed are added to "changed", written the same way
+	// as the path given to watch_file_folder (so "shaders/a.frag"
+	// comes back as "shaders/a.frag"). Returns false on timeout
+	bool wait(std::vector<std::string>& changed, int32_t timeout_ms);
+
+	// make wait return right away
+	void wake();
+
+private:
+	struct Folder;
+	std::vector<Folder*> folders;
+
+#ifdef _WIN32
+	void* wake_event;
+#else
+	int inotify_fd;
+	int wake_pipe[2];
+#endif
+
+	FileWatcher(const FileWatcher&);
+	FileWatcher& operator=(const FileWatcher&);
+};
@@ -0,0 +1,478 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "FleetIndex.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <queue>
+#include <utility>
+
+#include "DriverVersion.h"
+#include "PciIds.h"
+
+// how many records we keep in memory before writing
+// a sorted run to disk (about 56 MB of records)
+#ifndef FLEET_RUN_RECORDS
+#define FLEET_RUN_RECORDS (1u << 20)
+#endif
+
+bool fleet_record_less(const FleetIndexRecord& a, const FleetIndexRecord& b)
+{
+	if (a.vendor_id != b.vendor_id) return a.vendor_id < b.vendor_id;
+	if (a.device_id != b.device_id) return a.device_id < b.device_id;
+	if (a.driver_version != b.driver_version) return a.driver_version < b.driver_version;
+
+	int uuid = memcmp(a.uuid, b.uuid, VK_UUID_SIZE);
+	if (uuid != 0) return uuid < 0;
+
+	if (a.node_offset != b.node_offset) return a.node_offset < b.node_offset;
+	return a.device_index < b.device_index;
+}
+
+FleetIndexBuilder::FleetIndexBuilder(const char* path)
+{
+	output_path = path;
+	total_records = 0;
+	spill_failed = false;
+
+	// offset zero is the empty string
+	strings.push_back(0);
+	string_offsets[""] = 0;
+}
+
+FleetIndexBuilder::~FleetIndexBuilder()
+{
+	for (size_t i = 0; i < run_paths.size(); i++)
+		remove(run_paths[i].c_str());
+}
+
+uint32_t FleetIndexBuilder::intern(const std::string& text)
+{
+	// thousands of nodes have the same GPU,
+	// so every name is only stored once
+	std::unordered_map<std::string, uint32_t>::iterator found = string_offsets.find(text);
+	if (found != string_offsets.end())
+		return found->second;
+
+	uint32_t offset = (uint32_t)strings.size();
+	strings.append(text.c_str(), text.size() + 1);
+	string_offsets[text] = offset;
+	return offset;
+}
+
+bool FleetIndexBuilder::add_inventory(const Inventory& inventory)
+{
+	if (spill_failed)
+		return false;
+
+	uint32_t node = intern(inventory.node);
+
+	for (size_t d = 0; d < inventory.devices.size(); d++)
+	{
+		const DeviceInventory& device = inventory.devices[d];
+
+		FleetIndexRecord record = {};
+		record.vendor_id = device.properties.vendorID;
+		record.device_id = device.properties.deviceID;
+		record.driver_version = device.properties.driverVersion;
+		record.api_version = device.properties.apiVersion;
+		memcpy(record.uuid, device.properties.pipelineCacheUUID, VK_UUID_SIZE);
+		record.node_offset = node;
+
+		// drivers do not agree on how to spell the name of a GPU,
+		// so we prefer our own name when we know the GPU, that way
+		// the same GPU is grouped together no matter which driver
+		// (or which version of a driver) reported it
+		GpuIdentity identity;
+		if (lookup_gpu_identity(device.properties.vendorID, device.properties.deviceID, identity))
+			record.name_offset = intern(identity.name);
+		else
+			record.name_offset = intern(device.properties.deviceName);
+		record.device_index = (uint32_t)d;
+		record.device_type = (uint32_t)device.properties.deviceType;
+
+		for (uint32_t h = 0; h < device.memory.memoryHeapCount; h++)
+		{
+			if (device.memory.memoryHeaps[h].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+				record.device_local_bytes += device.memory.memoryHeaps[h].size;
+		}
+
+		records.push_back(record);
+		total_records++;
+	}
+
+	if (records.size() >= FLEET_RUN_RECORDS)
+		return spill_run();
+	return true;
+}
+
+bool FleetIndexBuilder::add_file(const char* path)
+{
+	if (spill_failed)
+		return false;
+
+	MappedFile file;
+	if (!file.open(path))
+		return false;
+
+	// another index: copy its records, moving
+	// their names into our own string table
+	FleetIndex other;
+	uint32_t magic = 0;
+	memcpy(&magic, file.data(), file.size() < sizeof(magic) ? file.size() : sizeof(magic));
+
+	if (magic == FLEET_INDEX_MAGIC)
+	{
+		file.close();
+		if (!other.open(path))
+			return false;
+
+		for (uint64_t i = 0; i < other.size(); i++)
+		{
+			FleetIndexRecord record = other.records()[i];
+			record.node_offset = intern(other.string(record.node_offset));
+			record.name_offset = intern(other.string(record.name_offset));
+			records.push_back(record);
+			total_records++;
+
+			if (records.size() >= FLEET_RUN_RECORDS && !spill_run())
+				return false;
+		}
+		return true;
+	}
+
+	Inventory inventory;
+	if (!read_inventory(file.data(), file.size(), inventory))
+		return false;
+
+	return add_inventory(inventory);
+}
+
+bool FleetIndexBuilder::spill_run()
+{
+	std::sort(records.begin(), records.end(), fleet_record_less);
+
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".run%u", (uint32_t)run_paths.size());
+	std::string path = output_path + suffix;
+
+	// A run that was cut short (a full disk) is thrown away, and
+	// so are its records, so the builder can not go on: the index
+	// would say it has records that are not in it
+	FILE* file = fopen(path.c_str(), "wb");
+	bool ok = file != NULL;
+	if (file)
+	{
+		ok = fwrite(records.data(), sizeof(FleetIndexRecord), records.size(), file) == records.size();
+		ok = fclose(file) == 0 && ok;
+	}
+
+	records.clear();
+	if (!ok)
+	{
+		remove(path.c_str());
+		spill_failed = true;
+		return false;
+	}
+
+	run_paths.push_back(path);
+	return true;
+}
+
+bool FleetIndexBuilder::write()
+{
+	if (spill_failed)
+		return false;
+
+	std::sort(records.begin(), records.end(), fleet_record_less);
+
+	// Every run is sorted, so the smallest record left over
+	// is always at the front of one of the runs. A priority
+	// queue tells us which run that is
+	std::vector<MappedFile> runs(run_paths.size());
+	std::vector<const FleetIndexRecord*> cursor(run_paths.size() + 1);
+	std::vector<const FleetIndexRecord*> end(run_paths.size() + 1);
+
+	for (size_t r = 0; r < run_paths.size(); r++)
+	{
+		if (!runs[r].open(run_paths[r].c_str()))
+			return false;
+		cursor[r] = (const FleetIndexRecord*)runs[r].data();
+		end[r] = cursor[r] + runs[r].size() / sizeof(FleetIndexRecord);
+	}
+
+	// the records still in memory are the last run
+	cursor[run_paths.size()] = records.data();
+	end[run_paths.size()] = records.data() + records.size();
+
+	typedef std::pair<const FleetIndexRecord*, size_t> Head;
+	struct HeadGreater
+	{
+		bool operator()(const Head& a, const Head& b) const { return fleet_record_less(*b.first, *a.first); }
+	};
+	std::priority_queue<Head, std::vector<Head>, HeadGreater> heads;
+
+	for (size_t r = 0; r < cursor.size(); r++)
+	{
+		if (cursor[r] != end[r])
+			heads.push(Head(cursor[r], r));
+	}
+
+	FILE* file = fopen(output_path.c_str(), "wb");
+	if (!file)
+		return false;
+
+	FleetIndexHeader header = {};
+	header.magic = FLEET_INDEX_MAGIC;
+	header.version = FLEET_INDEX_VERSION;
+	header.record_count = total_records;
+	header.string_table_offset = sizeof(header) + total_records * sizeof(FleetIndexRecord);
+	header.string_table_size = strings.size();
+	fwrite(&header, sizeof(header), 1, file);
+
+	while (!heads.empty())
+	{
+		Head head = heads.top();
+		heads.pop();
+
+		fwrite(head.first, sizeof(FleetIndexRecord), 1, file);
+
+		size_t r = head.second;
+		if (++cursor[r] != end[r])
+			heads.push(Head(cursor[r], r));
+	}
+
+	fwrite(strings.data(), 1, strings.size(), file);
+
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+FleetQuery::FleetQuery()
+{
+	has_vendor = false;
+	has_device = false;
+	has_uuid = false;
+	vendor_id = 0;
+	device_id = 0;
+	memset(uuid, 0, sizeof(uuid));
+	driver_min = 0;
+	driver_max = 0x100000000ull;
+}
+
+bool parse_fleet_query(const char* text, FleetQuery& out, std::string& error)
+{
+	out = FleetQuery();
+	std::vector<std::pair<std::string, std::string> > driver_terms;
+
+	const char* c = text;
+	while (*c)
+	{
+		while (*c == ' ')
+			c++;
+		if (!*c)
+			break;
+
+		const char* term_start = c;
+		while (*c && *c != ' ')
+			c++;
+		std::string term(term_start, c);
+
+		// split the term into name, operator, and value
+		size_t op_start = term.find_first_of("<>=~");
+		if (op_start == std::string::npos || op_start == 0)
+		{
+			error = "cannot understand \"" + term + "\"";
+			return false;
+		}
+
+		size_t op_end = op_start + 1;
+		if (op_end < term.size() && term[op_end] == '=')
+			op_end++;
+
+		std::string name = term.substr(0, op_start);
+		std::string op = term.substr(op_start, op_end - op_start);
+		std::string value = term.substr(op_end);
+
+		if (name == "vendor" && op == "=")
+		{
+			out.has_vendor = true;
+			out.vendor_id = (uint32_t)strtoul(value.c_str(), NULL, 0);
+		}
+		else if (name == "device" && op == "=")
+		{
+			out.has_device = true;
+			out.device_id = (uint32_t)strtoul(value.c_str(), NULL, 0);
+		}
+		else if (name == "uuid" && op == "=" && value.size() == VK_UUID_SIZE * 2)
+		{
+			out.has_uuid = true;
+			for (uint32_t i = 0; i < VK_UUID_SIZE; i++)
+			{
+				unsigned int byte = 0;
+				sscanf(value.c_str() + i * 2, "%2x", &byte);
+				out.uuid[i] = (uint8_t)byte;
+			}
+		}
+		else if (name == "name" && op == "~")
+		{
+			out.name_contains = value;
+		}
+		else if (name == "driver")
+		{
+			// Dotted versions are encoded the way the vendor's driver
+			// encodes them, and the vendor term may come later in the
+			// query, so driver terms are handled after all the others
+			if (op != "<" && op != "<=" && op != ">" && op != ">=" && op != "=")
+			{
+				error = "cannot use \"" + op + "\" with driver";
+				return false;
+			}
+			driver_terms.push_back(std::make_pair(op, value));
+		}
+		else
+		{
+			error = "cannot understand \"" + term + "\"";
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < driver_terms.size(); i++)
+	{
+		const std::string& op = driver_terms[i].first;
+		const std::string& value = driver_terms[i].second;
+
+		// without a vendor, dotted versions use VK_MAKE_VERSION
+		uint32_t version;
+		if (!parse_driver_version(out.has_vendor ? out.vendor_id : 0, value.c_str(), version))
+		{
+			error = "cannot understand the driver version \"" + value + "\"";
+			return false;
+		}
+
+		// every comparison becomes a [min, max) range, in 64 bits,
+		// so one past the biggest version does not wrap around to 0
+		uint64_t after = (uint64_t)version + 1;
+		if (op == "<")       out.driver_max = std::min(out.driver_max, (uint64_t)version);
+		else if (op == "<=") out.driver_max = std::min(out.driver_max, after);
+		else if (op == ">")  out.driver_min = std::max(out.driver_min, after);
+		else if (op == ">=") out.driver_min = std::max(out.driver_min, (uint64_t)version);
+		else
+		{
+			out.driver_min = version;
+			out.driver_max = after;
+		}
+	}
+
+	return true;
+}
+
+bool FleetIndex::open(const char* path)
+{
+	first = nullptr;
+	string_table = nullptr;
+	memset(&header, 0, sizeof(header));
+
+	if (!file.open(path) || file.size() < sizeof(header))
+		return false;
+
+	memcpy(&header, file.data(), sizeof(header));
+	if (header.magic != FLEET_INDEX_MAGIC || header.version != FLEET_INDEX_VERSION)
+		return false;
+
+	// Make sure the file is as big as the header says. Every count
+	// is checked against the file size before we multiply or add
+	// with it, so a broken header can not wrap the sums around
+	if (header.record_count > (file.size() - sizeof(header)) / sizeof(FleetIndexRecord))
+	{
+		memset(&header, 0, sizeof(header));
+		return false;
+	}
+
+	uint64_t records_end = sizeof(header) + header.record_count * sizeof(FleetIndexRecord);
+	if (header.string_table_offset < records_end || header.string_table_offset > file.size() ||
+		header.string_table_size > file.size() - header.string_table_offset || header.string_table_size == 0)
+	{
+		memset(&header, 0, sizeof(header));
+		return false;
+	}
+
+	first = (const FleetIndexRecord*)(file.data() + sizeof(header));
+	string_table = (const char*)file.data() + header.string_table_offset;
+	return true;
+}
+
+const char* FleetIndex::string(uint32_t offset) const
+{
+	if (!string_table || offset >= header.string_table_size)
+		return "";
+	return string_table + offset;
+}
+
+void FleetIndex::query(const FleetQuery& query, std::vector<const FleetIndexRecord*>& out) const
+{
+	const FleetIndexRecord* begin = first;
+	const FleetIndexRecord* end = first + header.record_count;
+
+	// With a vendor (and maybe a device), binary search for
+	// the first record of that kind; every other record of
+	// that kind comes right after it. Without one, we have
+	// to look at everything
+	if (query.has_vendor)
+	{
+		FleetIndexRecord key = {};
+		key.vendor_id = query.vendor_id;
+		key.device_id = query.has_device ? query.device_id : 0;
+		key.driver_version = query.has_device ? (uint32_t)std::min(query.driver_min, (uint64_t)0xFFFFFFFFu) : 0;
+		begin = std::lower_bound(begin, end, key, fleet_record_less);
+	}
+
+	for (const FleetIndexRecord* r = begin; r != end; r++)
+	{
+		if (query.has_vendor && r->vendor_id != query.vendor_id)
+			break;
+		if (query.has_vendor && query.has_device && r->device_id != query.device_id)
+			break;
+
+		// records of one device are sorted by driver,
+		// so nothing after this one can match either
+		if (query.has_vendor && query.has_device && r->driver_version >= query.driver_max)
+			break;
+
+		if (query.has_device && r->device_id != query.device_id)
+			continue;
+		if (r->driver_version < query.driver_min || r->driver_version >= query.driver_max)
+			continue;
+		if (query.has_uuid && memcmp(r->uuid, query.uuid, VK_UUID_SIZE) != 0)
+			continue;
+		if (!query.name_contains.empty() && !strstr(string(r->name_offset), query.name_contains.c_str()))
+			continue;
+
+		out.push_back(r);
+	}
+}
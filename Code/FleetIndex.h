@@ -0,0 +1,158 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Inventory.h"
+#include "MappedFile.h"
+
+// A fleet index collects the inventory files of many computers
+// ("nodes") into one file that can be searched quickly. There
+// is one record for every GPU in every node, sorted by vendor ID,
+// device ID, driver version, and UUID, so that every GPU of one
+// kind sits next to each other in the file:
+//
+//     FleetIndexHeader
+//     FleetIndexRecord[record_count]   (sorted)
+//     string table                     (node and device names)
+//
+// The file is mapped into memory and searched in place, a query
+// is a binary search followed by a short walk through the records
+
+#define FLEET_INDEX_MAGIC 0x58494B56 // "VKIX"
+#define FLEET_INDEX_VERSION 1
+
+struct FleetIndexHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t record_count;
+	uint64_t string_table_offset;
+	uint64_t string_table_size;
+};
+
+struct FleetIndexRecord
+{
+	uint32_t vendor_id;
+	uint32_t device_id;
+	uint32_t driver_version;
+	uint32_t api_version;
+	uint8_t uuid[VK_UUID_SIZE];   // pipelineCacheUUID
+	uint64_t device_local_bytes;
+	uint32_t node_offset;         // into the string table
+	uint32_t name_offset;         // into the string table
+	uint32_t device_index;        // position of the GPU in its node
+	uint32_t device_type;
+};
+
+// sort order of the records in the file
+bool fleet_record_less(const FleetIndexRecord& a, const FleetIndexRecord& b);
+
+// FleetIndexBuilder reads inventory files one at a time, so only
+// one file is ever in memory. The records are small, but with
+// enough of them we write sorted "runs" to temporary files, and
+// merge the runs together at the end, like an external sort
+class FleetIndexBuilder
+{
+public:
+	explicit FleetIndexBuilder(const char* output_path);
+	~FleetIndexBuilder();
+
+	// add every GPU from an inventory (JSON or binary) or
+	// from another fleet index, so indexes can be combined.
+	// Both return false if a run could not be written, and
+	// then nothing more can be added
+	bool add_file(const char* path);
+	bool add_inventory(const Inventory& inventory);
+
+	// merge everything into the index file, this fails
+	// if any run was lost, rather than write an index
+	// that is missing records
+	bool write();
+
+	uint64_t record_count() const { return total_records; }
+
+private:
+	uint32_t intern(const std::string& text);
+	bool spill_run();
+
+	std::string output_path;
+	std::vector<FleetIndexRecord> records;
+	std::vector<std::string> run_paths;
+	std::string strings;
+	std::unordered_map<std::string, uint32_t> string_offsets;
+	uint64_t total_records;
+
+	// a run could not be written, so records are missing
+	bool spill_failed;
+};
+
+// What to look for. Anything that is not set matches every GPU
+struct FleetQuery
+{
+	bool has_vendor, has_device, has_uuid;
+	uint32_t vendor_id, device_id;
+	uint8_t uuid[VK_UUID_SIZE];
+
+	// driver_version must be >= driver_min and < driver_max. These
+	// are 64 bit, so that "<= 0xFFFFFFFF" has a max to go up to
+	uint64_t driver_min, driver_max;
+
+	// only GPUs whose name contains this text
+	std::string name_contains;
+
+	FleetQuery();
+};
+
+// Parse a query like "vendor=0x10de device=0x1e87 driver<441.66".
+// The terms are vendor=, device=, uuid=, name~ and driver with one
+// of < <= > >= =. Driver versions are either plain numbers, as
+// stored by the driver, or dotted versions written the way the
+// vendor writes them ("441.66" for NVIDIA when vendor=0x10de is in
+// the query, see DriverVersion.h), or like 1.2.131 for everyone else
+bool parse_fleet_query(const char* text, FleetQuery& out, std::string& error);
+
+class FleetIndex
+{
+public:
+	bool open(const char* path);
+
+	void query(const FleetQuery& query, std::vector<const FleetIndexRecord*>& out) const;
+
+	const char* string(uint32_t offset) const;
+
+	uint64_t size() const { return header.record_count; }
+	const FleetIndexRecord* records() const { return first; }
+
+private:
+	MappedFile file;
+	FleetIndexHeader header;
+	const FleetIndexRecord* first;
+	const char* string_table;
+};
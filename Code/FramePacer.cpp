@@ -0,0 +1,279 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "FramePacer.h"
+
+#include <stdio.h>
+#include <chrono>
+
+// The driver cannot show an image at exactly the time we ask for,
+// so anything closer than this is "on time"
+#define PACER_MARGIN_NS 2000000ull
+
+// We only go faster after two seconds of presents that could have
+// been earlier, so that one quiet moment does not change the pace.
+// If going faster turns out to be a mistake, we wait twice as long
+// before we try again, up to a minute
+#define PACER_EARLY_WINDOW_NS 2000000000ull
+#define PACER_MAX_EARLY_WINDOW_NS 64000000000ull
+
+static uint64_t steady_clock_ns()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FramePacer::FramePacer()
+{
+	clock = steady_clock_ns;
+	early_adjustments = 0;
+	late_adjustments = 0;
+	reset(PACER_DEFAULT_REFRESH_NS, false);
+}
+
+void FramePacer::reset(uint64_t refresh_duration, bool display_timing)
+{
+	this->display_timing = display_timing;
+	this->refresh_duration = refresh_duration ? refresh_duration : PACER_DEFAULT_REFRESH_NS;
+
+	// a new swapchain starts at the full refresh rate,
+	// with nothing early or late yet
+	syncd_with_actual_presents = false;
+	refresh_duration_multiplier = 1;
+	target_IPD = this->refresh_duration;
+	prev_desired_present_time = 0;
+	next_present_id = 1;
+	last_early_id = 0;
+	last_late_id = 0;
+	early_window = PACER_EARLY_WINDOW_NS;
+	last_change_was_early = false;
+}
+
+void FramePacer::restart()
+{
+	syncd_with_actual_presents = false;
+	prev_desired_present_time = 0;
+	last_early_id = 0;
+	last_late_id = 0;
+}
+
+bool FramePacer::observe(uint32_t present_id, bool could_be_earlier, bool was_late, bool& early, bool& late)
+{
+	if (could_be_earlier)
+	{
+		// This image could have been shown earlier. We do not go
+		// faster until we have seen early presents for two seconds,
+		// so we work out which present that will be, and wait for it
+		if (last_early_id != 0 && present_id >= last_early_id)
+		{
+			early = true;
+			last_early_id = 0;
+		}
+		else if (last_early_id == 0)
+		{
+			last_early_id = present_id + (uint32_t)(early_window / target_IPD);
+		}
+
+		late = false;
+		last_late_id = 0;
+		return false;
+	}
+
+	if (was_late)
+	{
+		// We find out about a late present a few frames after we
+		// made it, and the presents that we made since then are
+		// probably late too. We slow down once for all of them,
+		// not once for each of them
+		if (last_late_id == 0 || last_late_id < present_id)
+		{
+			late = true;
+			last_late_id = next_present_id - 1;
+		}
+
+		early = false;
+		last_early_id = 0;
+		return false;
+	}
+
+	// neither early nor late, so any run of early
+	// or late presents is over
+	early = false;
+	late = false;
+	last_early_id = 0;
+	last_late_id = 0;
+	return true;
+}
+
+void FramePacer::apply(bool early, bool late)
+{
+	if (early && refresh_duration_multiplier > 1)
+	{
+		// two seconds of frames that could have come out
+		// sooner: show one frame every refresh fewer
+		refresh_duration_multiplier--;
+		early_adjustments++;
+		last_change_was_early = true;
+	}
+
+	if (late)
+	{
+		// the frames do not fit in the time we give them:
+		// show one frame every refresh more
+		refresh_duration_multiplier++;
+		late_adjustments++;
+
+		// and if that is because we just sped up,
+		// we wait longer before we speed up again
+		if (last_change_was_early && early_window < PACER_MAX_EARLY_WINDOW_NS)
+			early_window *= 2;
+		last_change_was_early = false;
+	}
+
+	target_IPD = refresh_duration * refresh_duration_multiplier;
+}
+
+void FramePacer::update(const VkPastPresentationTimingGOOGLE* past, uint32_t count)
+{
+	if (count == 0)
+		return;
+
+	bool early = false;
+	bool late = false;
+	bool calibrate_next = false;
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (!syncd_with_actual_presents)
+		{
+			// These are the first real present times of this swapchain.
+			// Our desired times so far were only a guess, so the presents
+			// made with them would all look late. We line up with the
+			// real times instead, and forget about the guesses
+			calibrate_next = true;
+			last_late_id = next_present_id - 1;
+			last_early_id = 0;
+			syncd_with_actual_presents = true;
+			break;
+		}
+
+		// it could have been earlier if the driver could have shown it
+		// at least 2 ms sooner, and it was ready at least 2 ms before that
+		const VkPastPresentationTimingGOOGLE& p = past[i];
+		bool could_be_earlier = p.earliestPresentTime < p.actualPresentTime &&
+			p.actualPresentTime - p.earliestPresentTime >= PACER_MARGIN_NS &&
+			p.presentMargin >= PACER_MARGIN_NS;
+
+		// It was late if it was shown a refresh after we wanted. Once
+		// we are lined up with the real present times, our desired
+		// times land on refreshes too, so anything more than half a
+		// refresh after it was the next refresh, or worse
+		bool was_late = p.actualPresentTime > p.desiredPresentTime + (refresh_duration >> 1);
+
+		if (observe(p.presentID, could_be_earlier, was_late, early, late))
+			calibrate_next = true;
+	}
+
+	apply(early, late);
+
+	// Line our next desired time up with what really happened,
+	// so that small errors in our guesses do not add up. The next
+	// present is "multiple" presents after the last one we heard
+	// about, so it should be shown "multiple" intervals after it
+	if (calibrate_next)
+	{
+		uint64_t multiple = next_present_id - past[count - 1].presentID;
+		prev_desired_present_time = past[count - 1].actualPresentTime + (multiple - 1) * target_IPD;
+	}
+}
+
+uint64_t FramePacer::time_until_next_frame() const
+{
+	// the first frame does not wait for anything
+	if (prev_desired_present_time == 0)
+		return 0;
+
+	uint64_t next = prev_desired_present_time + target_IPD;
+	uint64_t current = now();
+	return next > current ? next - current : 0;
+}
+
+void FramePacer::presented(const VkPresentTimeGOOGLE& present, uint64_t frame_start)
+{
+	uint64_t actual = now();
+	uint64_t work = actual - frame_start;
+
+	// The frame was late if its work did not fit in the time we
+	// gave it, which means the next frame starts after its turn.
+	// It could have been earlier if the work would still fit, with
+	// room to spare, if we showed frames one refresh sooner
+	bool was_late = actual > present.desiredPresentTime + target_IPD;
+	bool could_be_earlier = refresh_duration_multiplier > 1 &&
+		work + PACER_MARGIN_NS <= target_IPD - refresh_duration;
+
+	bool early = false;
+	bool late = false;
+	observe(present.presentID, could_be_earlier, was_late, early, late);
+	apply(early, late);
+
+	// When we are behind, we start again from now, instead of
+	// rushing the next few frames out to catch up
+	if (actual > prev_desired_present_time + target_IPD)
+		prev_desired_present_time = actual - target_IPD;
+}
+
+VkPresentTimeGOOGLE FramePacer::next_present()
+{
+	VkPresentTimeGOOGLE present;
+
+	if (prev_desired_present_time == 0)
+	{
+		// This is the first present of this swapchain. We do not know
+		// where the screen is in its refresh yet, or how long a frame
+		// takes, so we guess halfway between now and the next frame,
+		// and correct the guess once we see real present times.
+		// With the CPU clock, the first frame is simply "now"
+		uint64_t current = now();
+		present.desiredPresentTime = display_timing ? current + (target_IPD >> 1) : current;
+	}
+	else
+	{
+		present.desiredPresentTime = prev_desired_present_time + target_IPD;
+	}
+
+	present.presentID = next_present_id++;
+	prev_desired_present_time = present.desiredPresentTime;
+	return present;
+}
+
+void FramePacer::print_stats() const
+{
+	double refresh_ms = refresh_duration / 1000000.0;
+	double interval_ms = target_IPD / 1000000.0;
+
+	printf("Frame pacing (%s): one frame every %u refresh(es) of %.2f ms, %.1f frames per second\n",
+		display_timing ? "VK_GOOGLE_display_timing" : "CPU clock",
+		(uint32_t)refresh_duration_multiplier, refresh_ms, 1000.0 / interval_ms);
+	printf("  slowed down %u times, sped up %u times\n\n", late_adjustments, early_adjustments);
+}
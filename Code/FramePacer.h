@@ -0,0 +1,129 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+
+#include <vulkan/vulkan.h>
+
+// How long one refresh takes on a 60 Hz screen, in nanoseconds.
+// Without VK_GOOGLE_display_timing we cannot ask the screen,
+// so this is our guess
+#define PACER_DEFAULT_REFRESH_NS 16666667ull
+
+// FramePacer decides when each frame should be shown, so that frames
+// come out at an even pace instead of as fast as the GPU can draw them.
+// The pace is always a whole number of screen refreshes (target_IPD,
+// the "image present duration"). When frames keep coming out late, we
+// show one frame every two refreshes, then every three, and so on.
+// When frames could have come out earlier for two seconds in a row,
+// we go back down.
+//
+// With VK_GOOGLE_display_timing, we give every present a desired
+// time, and the driver tells us later when each one was really shown.
+// Without it, we pace with the CPU clock: the render thread waits
+// until it is time for the next frame, and we treat the moment that
+// vkQueuePresentKHR returns as the moment the frame was shown.
+//
+// The pacer never calls Vulkan and never sleeps by itself, and the
+// clock can be replaced, so it can be tested with made up times
+class FramePacer
+{
+public:
+	// nanoseconds, in the same clock that the
+	// presentation engine uses (steady_clock)
+	typedef std::function<uint64_t()> Clock;
+
+	FramePacer();
+
+	void set_clock(Clock clock) { this->clock = clock; }
+	uint64_t now() const { return clock(); }
+
+	// Start over, for a new swapchain. refresh_duration comes from
+	// vkGetRefreshCycleDurationGOOGLE, or is PACER_DEFAULT_REFRESH_NS
+	void reset(uint64_t refresh_duration, bool display_timing);
+
+	bool uses_display_timing() const { return display_timing; }
+
+	// Start pacing again from the next frame, after a long time
+	// without any frames (like when the window was hidden), but keep
+	// the present IDs counting up, and keep the pace that we found
+	void restart();
+
+	// Display timing: what happened to the presents that we
+	// made earlier, from vkGetPastPresentationTimingGOOGLE
+	void update(const VkPastPresentationTimingGOOGLE* past, uint32_t count);
+
+	// CPU clock: how many nanoseconds to wait before we start the
+	// next frame, 0 if it is already time
+	uint64_t time_until_next_frame() const;
+
+	// CPU clock: the frame that was given "present" has just been
+	// presented, and its work started at "frame_start"
+	void presented(const VkPresentTimeGOOGLE& present, uint64_t frame_start);
+
+	// The ID and desired time for the next present
+	// (a desired time of 0 means "as soon as you can")
+	VkPresentTimeGOOGLE next_present();
+
+	uint64_t interval_ns() const { return target_IPD; }
+	uint32_t early_count() const { return early_adjustments; }
+	uint32_t late_count() const { return late_adjustments; }
+
+	void print_stats() const;
+
+private:
+	// What one present tells us, the same for display timing and
+	// for the CPU clock. Sets "early" once we have seen two seconds
+	// of presents that could have been earlier, and "late" once for
+	// every new run of late presents. Returns true if it was on time
+	bool observe(uint32_t present_id, bool could_be_earlier, bool was_late, bool& early, bool& late);
+
+	// change the pace, if "observe" told us to
+	void apply(bool early, bool late);
+
+	Clock clock;
+	bool display_timing;
+
+	// false until we have seen the first real present time
+	// of this swapchain, which is what we line up with
+	bool syncd_with_actual_presents;
+
+	uint64_t refresh_duration;
+	uint64_t refresh_duration_multiplier;
+	uint64_t target_IPD;  // image present duration (inverse of frame rate)
+	uint64_t prev_desired_present_time;
+	uint32_t next_present_id;
+	uint32_t last_early_id;  // 0 if no early images
+	uint32_t last_late_id;   // 0 if no late images
+
+	// how long presents have to be early before we go faster
+	uint64_t early_window;
+	bool last_change_was_early;
+
+	uint32_t early_adjustments;
+	uint32_t late_adjustments;
+};
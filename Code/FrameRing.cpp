@@ -0,0 +1,168 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "FrameRing.h"
+
+#include <stdio.h>
+
+#include "Platform.h"
+
+FrameRing::FrameRing()
+{
+	device = VK_NULL_HANDLE;
+	current = 0;
+	frame_count = 0;
+	submitted_count = 0;
+	wait_total_us = 0;
+	wait_max_us = 0;
+}
+
+FrameRing::~FrameRing()
+{
+	destroy();
+}
+
+bool FrameRing::create(VkDevice device, uint32_t queue_family_index, uint32_t depth)
+{
+	destroy();
+
+	if (depth < 1)
+		depth = 1;
+	if (depth > FRAME_RING_MAX_DEPTH)
+		depth = FRAME_RING_MAX_DEPTH;
+
+	this->device = device;
+	slots.resize(depth);
+	current = 0;
+
+	// The fences start out signaled, so that the first "depth"
+	// frames do not wait for frames that never happened
+	VkFenceCreateInfo fence_info = {};
+	fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+	VkSemaphoreCreateInfo semaphore_info = {};
+	semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	// TRANSIENT tells the driver that the command buffers
+	// will not live long, they are recorded every frame
+	VkCommandPoolCreateInfo pool_info = {};
+	pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	pool_info.queueFamilyIndex = queue_family_index;
+
+	bool ok = true;
+	for (uint32_t i = 0; i < depth; i++)
+	{
+		FrameSlot& slot = slots[i];
+		slot = FrameSlot();
+
+		ok = ok && vkCreateFence(device, &fence_info, NULL, &slot.fence) == VK_SUCCESS;
+		ok = ok && vkCreateSemaphore(device, &semaphore_info, NULL, &slot.image_acquired) == VK_SUCCESS;
+		ok = ok && vkCreateSemaphore(device, &semaphore_info, NULL, &slot.draw_complete) == VK_SUCCESS;
+		ok = ok && vkCreateCommandPool(device, &pool_info, NULL, &slot.command_pool) == VK_SUCCESS;
+
+		if (ok)
+		{
+			VkCommandBufferAllocateInfo alloc_info = {};
+			alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			alloc_info.commandPool = slot.command_pool;
+			alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			alloc_info.commandBufferCount = 1;
+			ok = vkAllocateCommandBuffers(device, &alloc_info, &slot.commands) == VK_SUCCESS;
+		}
+	}
+
+	// whatever we did make is destroyed again
+	if (!ok)
+		destroy();
+	return ok;
+}
+
+void FrameRing::destroy()
+{
+	// the caller has to make sure the GPU is done with every slot
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		FrameSlot& slot = slots[i];
+		if (slot.fence != VK_NULL_HANDLE)
+			vkDestroyFence(device, slot.fence, NULL);
+		if (slot.image_acquired != VK_NULL_HANDLE)
+			vkDestroySemaphore(device, slot.image_acquired, NULL);
+		if (slot.draw_complete != VK_NULL_HANDLE)
+			vkDestroySemaphore(device, slot.draw_complete, NULL);
+
+		// the command buffer goes away with its pool
+		if (slot.command_pool != VK_NULL_HANDLE)
+			vkDestroyCommandPool(device, slot.command_pool, NULL);
+	}
+
+	slots.clear();
+	current = 0;
+}
+
+FrameSlot& FrameRing::begin_frame()
+{
+	FrameSlot& slot = slots[current];
+
+	// If the GPU is further behind than "depth" frames, this
+	// is where the CPU waits for it
+	uint64_t start_us = platform_time_us();
+	vkWaitForFences(device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+	uint64_t waited_us = platform_time_us() - start_us;
+
+	frame_count++;
+	wait_total_us += waited_us;
+	if (waited_us > wait_max_us)
+		wait_max_us = waited_us;
+
+	// the GPU is done with last time's commands, so
+	// the whole pool can be reused at once
+	vkResetCommandPool(device, slot.command_pool, 0);
+	return slot;
+}
+
+VkFence FrameRing::submit_fence()
+{
+	VkFence fence = slots[current].fence;
+	vkResetFences(device, 1, &fence);
+	return fence;
+}
+
+void FrameRing::end_frame()
+{
+	submitted_count++;
+	current = (current + 1) % (uint32_t)slots.size();
+}
+
+void FrameRing::print_stats() const
+{
+	if (frame_count == 0)
+		return;
+
+	printf("Frames in flight: %u, the CPU waited for the GPU %.3f ms per frame "
+		"on average, %.3f ms at most, over %llu frames\n\n",
+		depth(), wait_total_us / 1000.0 / frame_count, wait_max_us / 1000.0,
+		(unsigned long long)frame_count);
+}
@@ -0,0 +1,109 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// the most frames that we let the CPU get ahead of the GPU
+#define FRAME_RING_MAX_DEPTH 8
+
+// Everything that one frame in flight needs. The CPU fills one
+// slot while the GPU is still working on the ones before it
+struct FrameSlot
+{
+	// signaled by the GPU when it is done with this frame
+	VkFence fence;
+
+	// signaled when the swapchain image is free to draw into,
+	// and when the drawing is done and the image can be shown
+	VkSemaphore image_acquired;
+	VkSemaphore draw_complete;
+
+	// Every slot has its own command pool, so that we can throw away
+	// last time's commands all at once (vkResetCommandPool) instead of
+	// freeing and allocating a command buffer every frame
+	VkCommandPool command_pool;
+	VkCommandBuffer commands;
+};
+
+// FrameRing is a ring of "depth" frame slots that we use in turns.
+// A deeper ring lets the CPU get further ahead of the GPU, which keeps
+// the GPU busy when it is the slow one, but every frame waits longer
+// before it is shown. Depth 1 is the least latency, 2 is the usual
+// choice, and 3 is for when the GPU is doing heavy work and we only
+// care how many frames come out.
+//
+// Everything in the ring is made once, when the device is made, and
+// used again every "depth" frames, so a frame never creates anything
+class FrameRing
+{
+public:
+	FrameRing();
+	~FrameRing();
+
+	// make "depth" slots (1 to FRAME_RING_MAX_DEPTH) for this device,
+	// returns false if Vulkan could not make them
+	bool create(VkDevice device, uint32_t queue_family_index, uint32_t depth);
+	void destroy();
+
+	uint32_t depth() const { return (uint32_t)slots.size(); }
+
+	// How many frames have been submitted (end_frame was called).
+	// A frame that gives up before it submits does not count, it
+	// does not move to the next slot, so it waits for no new fence.
+	// Once this is "depth" more than it was at some point, the fence
+	// of every frame submitted before that point has been waited for
+	uint64_t frames_submitted() const { return submitted_count; }
+
+	// Wait until the GPU is done with the next slot (the one we used
+	// "depth" frames ago), and give it to us with its command buffer
+	// ready to be recorded again. The time the CPU spends waiting
+	// here is what we report in print_stats
+	FrameSlot& begin_frame();
+
+	// The fence to submit the current slot with. It is only reset
+	// here, right before we submit, so that a frame that gives up
+	// before it submits (because the swapchain is out of date) leaves
+	// the fence signaled, and does not make the next frame wait forever
+	VkFence submit_fence();
+
+	// the current slot has been submitted, move on to the next one
+	void end_frame();
+
+	void print_stats() const;
+
+private:
+	VkDevice device;
+	std::vector<FrameSlot> slots;
+	uint32_t current;
+
+	uint64_t frame_count;
+	uint64_t submitted_count;
+	uint64_t wait_total_us;
+	uint64_t wait_max_us;
+};
@@ -0,0 +1,726 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "Inventory.h"
+#include "JsonReader.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <exception>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+const InventoryField limit_fields[] =
+{
+	{ "maxImageDimension1D", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxImageDimension1D), 1 },
+	{ "maxImageDimension2D", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxImageDimension2D), 1 },
+	{ "maxImageDimension3D", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxImageDimension3D), 1 },
+	{ "maxImageDimensionCube", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxImageDimensionCube), 1 },
+	{ "maxImageArrayLayers", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxImageArrayLayers), 1 },
+	{ "maxTexelBufferElements", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxTexelBufferElements), 1 },
+	{ "maxUniformBufferRange", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxUniformBufferRange), 1 },
+	{ "maxStorageBufferRange", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxStorageBufferRange), 1 },
+	{ "maxPushConstantsSize", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxPushConstantsSize), 1 },
+	{ "maxMemoryAllocationCount", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxMemoryAllocationCount), 1 },
+	{ "maxSamplerAllocationCount", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxSamplerAllocationCount), 1 },
+	{ "bufferImageGranularity", FIELD_U64, offsetof(VkPhysicalDeviceLimits, bufferImageGranularity), 1 },
+	{ "sparseAddressSpaceSize", FIELD_U64, offsetof(VkPhysicalDeviceLimits, sparseAddressSpaceSize), 1 },
+	{ "maxBoundDescriptorSets", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxBoundDescriptorSets), 1 },
+	{ "maxPerStageDescriptorSamplers", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxPerStageDescriptorSamplers), 1 },
+	{ "maxPerStageDescriptorUniformBuffers", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxPerStageDescriptorUniformBuffers), 1 },
+	{ "maxPerStageDescriptorStorageBuffers", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxPerStageDescriptorStorageBuffers), 1 },
+	{ "maxPerStageDescriptorSampledImages", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxPerStageDescriptorSampledImages), 1 },
+	{ "maxPerStageDescriptorStorageImages", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxPerStageDescriptorStorageImages), 1 },
+	{ "maxPerStageDescriptorInputAttachments", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxPerStageDescriptorInputAttachments), 1 },
+	{ "maxPerStageResources", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxPerStageResources), 1 },
+	{ "maxDescriptorSetSamplers", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxDescriptorSetSamplers), 1 },
+	{ "maxDescriptorSetUniformBuffers", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxDescriptorSetUniformBuffers), 1 },
+	{ "maxDescriptorSetUniformBuffersDynamic", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxDescriptorSetUniformBuffersDynamic), 1 },
+	{ "maxDescriptorSetStorageBuffers", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxDescriptorSetStorageBuffers), 1 },
+	{ "maxDescriptorSetStorageBuffersDynamic", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxDescriptorSetStorageBuffersDynamic), 1 },
+	{ "maxDescriptorSetSampledImages", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxDescriptorSetSampledImages), 1 },
+	{ "maxDescriptorSetStorageImages", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxDescriptorSetStorageImages), 1 },
+	{ "maxDescriptorSetInputAttachments", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxDescriptorSetInputAttachments), 1 },
+	{ "maxVertexInputAttributes", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxVertexInputAttributes), 1 },
+	{ "maxVertexInputBindings", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxVertexInputBindings), 1 },
+	{ "maxVertexInputAttributeOffset", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxVertexInputAttributeOffset), 1 },
+	{ "maxVertexInputBindingStride", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxVertexInputBindingStride), 1 },
+	{ "maxVertexOutputComponents", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxVertexOutputComponents), 1 },
+	{ "maxTessellationGenerationLevel", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxTessellationGenerationLevel), 1 },
+	{ "maxTessellationPatchSize", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxTessellationPatchSize), 1 },
+	{ "maxTessellationControlPerVertexInputComponents", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxTessellationControlPerVertexInputComponents), 1 },
+	{ "maxTessellationControlPerVertexOutputComponents", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxTessellationControlPerVertexOutputComponents), 1 },
+	{ "maxTessellationControlPerPatchOutputComponents", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxTessellationControlPerPatchOutputComponents), 1 },
+	{ "maxTessellationControlTotalOutputComponents", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxTessellationControlTotalOutputComponents), 1 },
+	{ "maxTessellationEvaluationInputComponents", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxTessellationEvaluationInputComponents), 1 },
+	{ "maxTessellationEvaluationOutputComponents", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxTessellationEvaluationOutputComponents), 1 },
+	{ "maxGeometryShaderInvocations", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxGeometryShaderInvocations), 1 },
+	{ "maxGeometryInputComponents", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxGeometryInputComponents), 1 },
+	{ "maxGeometryOutputComponents", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxGeometryOutputComponents), 1 },
+	{ "maxGeometryOutputVertices", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxGeometryOutputVertices), 1 },
+	{ "maxGeometryTotalOutputComponents", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxGeometryTotalOutputComponents), 1 },
+	{ "maxFragmentInputComponents", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxFragmentInputComponents), 1 },
+	{ "maxFragmentOutputAttachments", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxFragmentOutputAttachments), 1 },
+	{ "maxFragmentDualSrcAttachments", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxFragmentDualSrcAttachments), 1 },
+	{ "maxFragmentCombinedOutputResources", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxFragmentCombinedOutputResources), 1 },
+	{ "maxComputeSharedMemorySize", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxComputeSharedMemorySize), 1 },
+	{ "maxComputeWorkGroupCount", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxComputeWorkGroupCount), 3 },
+	{ "maxComputeWorkGroupInvocations", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxComputeWorkGroupInvocations), 1 },
+	{ "maxComputeWorkGroupSize", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxComputeWorkGroupSize), 3 },
+	{ "subPixelPrecisionBits", FIELD_U32, offsetof(VkPhysicalDeviceLimits, subPixelPrecisionBits), 1 },
+	{ "subTexelPrecisionBits", FIELD_U32, offsetof(VkPhysicalDeviceLimits, subTexelPrecisionBits), 1 },
+	{ "mipmapPrecisionBits", FIELD_U32, offsetof(VkPhysicalDeviceLimits, mipmapPrecisionBits), 1 },
+	{ "maxDrawIndexedIndexValue", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxDrawIndexedIndexValue), 1 },
+	{ "maxDrawIndirectCount", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxDrawIndirectCount), 1 },
+	{ "maxSamplerLodBias", FIELD_F32, offsetof(VkPhysicalDeviceLimits, maxSamplerLodBias), 1 },
+	{ "maxSamplerAnisotropy", FIELD_F32, offsetof(VkPhysicalDeviceLimits, maxSamplerAnisotropy), 1 },
+	{ "maxViewports", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxViewports), 1 },
+	{ "maxViewportDimensions", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxViewportDimensions), 2 },
+	{ "viewportBoundsRange", FIELD_F32, offsetof(VkPhysicalDeviceLimits, viewportBoundsRange), 2 },
+	{ "viewportSubPixelBits", FIELD_U32, offsetof(VkPhysicalDeviceLimits, viewportSubPixelBits), 1 },
+	{ "minMemoryMapAlignment", FIELD_SIZE, offsetof(VkPhysicalDeviceLimits, minMemoryMapAlignment), 1 },
+	{ "minTexelBufferOffsetAlignment", FIELD_U64, offsetof(VkPhysicalDeviceLimits, minTexelBufferOffsetAlignment), 1 },
+	{ "minUniformBufferOffsetAlignment", FIELD_U64, offsetof(VkPhysicalDeviceLimits, minUniformBufferOffsetAlignment), 1 },
+	{ "minStorageBufferOffsetAlignment", FIELD_U64, offsetof(VkPhysicalDeviceLimits, minStorageBufferOffsetAlignment), 1 },
+	{ "minTexelOffset", FIELD_I32, offsetof(VkPhysicalDeviceLimits, minTexelOffset), 1 },
+	{ "maxTexelOffset", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxTexelOffset), 1 },
+	{ "minTexelGatherOffset", FIELD_I32, offsetof(VkPhysicalDeviceLimits, minTexelGatherOffset), 1 },
+	{ "maxTexelGatherOffset", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxTexelGatherOffset), 1 },
+	{ "minInterpolationOffset", FIELD_F32, offsetof(VkPhysicalDeviceLimits, minInterpolationOffset), 1 },
+	{ "maxInterpolationOffset", FIELD_F32, offsetof(VkPhysicalDeviceLimits, maxInterpolationOffset), 1 },
+	{ "subPixelInterpolationOffsetBits", FIELD_U32, offsetof(VkPhysicalDeviceLimits, subPixelInterpolationOffsetBits), 1 },
+	{ "maxFramebufferWidth", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxFramebufferWidth), 1 },
+	{ "maxFramebufferHeight", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxFramebufferHeight), 1 },
+	{ "maxFramebufferLayers", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxFramebufferLayers), 1 },
+	{ "framebufferColorSampleCounts", FIELD_U32, offsetof(VkPhysicalDeviceLimits, framebufferColorSampleCounts), 1 },
+	{ "framebufferDepthSampleCounts", FIELD_U32, offsetof(VkPhysicalDeviceLimits, framebufferDepthSampleCounts), 1 },
+	{ "framebufferStencilSampleCounts", FIELD_U32, offsetof(VkPhysicalDeviceLimits, framebufferStencilSampleCounts), 1 },
+	{ "framebufferNoAttachmentsSampleCounts", FIELD_U32, offsetof(VkPhysicalDeviceLimits, framebufferNoAttachmentsSampleCounts), 1 },
+	{ "maxColorAttachments", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxColorAttachments), 1 },
+	{ "sampledImageColorSampleCounts", FIELD_U32, offsetof(VkPhysicalDeviceLimits, sampledImageColorSampleCounts), 1 },
+	{ "sampledImageIntegerSampleCounts", FIELD_U32, offsetof(VkPhysicalDeviceLimits, sampledImageIntegerSampleCounts), 1 },
+	{ "sampledImageDepthSampleCounts", FIELD_U32, offsetof(VkPhysicalDeviceLimits, sampledImageDepthSampleCounts), 1 },
+	{ "sampledImageStencilSampleCounts", FIELD_U32, offsetof(VkPhysicalDeviceLimits, sampledImageStencilSampleCounts), 1 },
+	{ "storageImageSampleCounts", FIELD_U32, offsetof(VkPhysicalDeviceLimits, storageImageSampleCounts), 1 },
+	{ "maxSampleMaskWords", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxSampleMaskWords), 1 },
+	{ "timestampComputeAndGraphics", FIELD_U32, offsetof(VkPhysicalDeviceLimits, timestampComputeAndGraphics), 1 },
+	{ "timestampPeriod", FIELD_F32, offsetof(VkPhysicalDeviceLimits, timestampPeriod), 1 },
+	{ "maxClipDistances", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxClipDistances), 1 },
+	{ "maxCullDistances", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxCullDistances), 1 },
+	{ "maxCombinedClipAndCullDistances", FIELD_U32, offsetof(VkPhysicalDeviceLimits, maxCombinedClipAndCullDistances), 1 },
+	{ "discreteQueuePriorities", FIELD_U32, offsetof(VkPhysicalDeviceLimits, discreteQueuePriorities), 1 },
+	{ "pointSizeRange", FIELD_F32, offsetof(VkPhysicalDeviceLimits, pointSizeRange), 2 },
+	{ "lineWidthRange", FIELD_F32, offsetof(VkPhysicalDeviceLimits, lineWidthRange), 2 },
+	{ "pointSizeGranularity", FIELD_F32, offsetof(VkPhysicalDeviceLimits, pointSizeGranularity), 1 },
+	{ "lineWidthGranularity", FIELD_F32, offsetof(VkPhysicalDeviceLimits, lineWidthGranularity), 1 },
+	{ "strictLines", FIELD_U32, offsetof(VkPhysicalDeviceLimits, strictLines), 1 },
+	{ "standardSampleLocations", FIELD_U32, offsetof(VkPhysicalDeviceLimits, standardSampleLocations), 1 },
+	{ "optimalBufferCopyOffsetAlignment", FIELD_U64, offsetof(VkPhysicalDeviceLimits, optimalBufferCopyOffsetAlignment), 1 },
+	{ "optimalBufferCopyRowPitchAlignment", FIELD_U64, offsetof(VkPhysicalDeviceLimits, optimalBufferCopyRowPitchAlignment), 1 },
+	{ "nonCoherentAtomSize", FIELD_U64, offsetof(VkPhysicalDeviceLimits, nonCoherentAtomSize), 1 },
+};
+
+const InventoryField sparse_fields[] =
+{
+	{ "residencyStandard2DBlockShape", FIELD_U32, offsetof(VkPhysicalDeviceSparseProperties, residencyStandard2DBlockShape), 1 },
+	{ "residencyStandard2DMultisampleBlockShape", FIELD_U32, offsetof(VkPhysicalDeviceSparseProperties, residencyStandard2DMultisampleBlockShape), 1 },
+	{ "residencyStandard3DBlockShape", FIELD_U32, offsetof(VkPhysicalDeviceSparseProperties, residencyStandard3DBlockShape), 1 },
+	{ "residencyAlignedMipSize", FIELD_U32, offsetof(VkPhysicalDeviceSparseProperties, residencyAlignedMipSize), 1 },
+	{ "residencyNonResidentStrict", FIELD_U32, offsetof(VkPhysicalDeviceSparseProperties, residencyNonResidentStrict), 1 },
+};
+
+const InventoryField feature_fields[] =
+{
+	{ "robustBufferAccess", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, robustBufferAccess), 1 },
+	{ "fullDrawIndexUint32", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, fullDrawIndexUint32), 1 },
+	{ "imageCubeArray", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, imageCubeArray), 1 },
+	{ "independentBlend", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, independentBlend), 1 },
+	{ "geometryShader", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, geometryShader), 1 },
+	{ "tessellationShader", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, tessellationShader), 1 },
+	{ "sampleRateShading", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, sampleRateShading), 1 },
+	{ "dualSrcBlend", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, dualSrcBlend), 1 },
+	{ "logicOp", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, logicOp), 1 },
+	{ "multiDrawIndirect", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, multiDrawIndirect), 1 },
+	{ "drawIndirectFirstInstance", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, drawIndirectFirstInstance), 1 },
+	{ "depthClamp", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, depthClamp), 1 },
+	{ "depthBiasClamp", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, depthBiasClamp), 1 },
+	{ "fillModeNonSolid", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, fillModeNonSolid), 1 },
+	{ "depthBounds", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, depthBounds), 1 },
+	{ "wideLines", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, wideLines), 1 },
+	{ "largePoints", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, largePoints), 1 },
+	{ "alphaToOne", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, alphaToOne), 1 },
+	{ "multiViewport", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, multiViewport), 1 },
+	{ "samplerAnisotropy", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, samplerAnisotropy), 1 },
+	{ "textureCompressionETC2", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, textureCompressionETC2), 1 },
+	{ "textureCompressionASTC_LDR", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, textureCompressionASTC_LDR), 1 },
+	{ "textureCompressionBC", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, textureCompressionBC), 1 },
+	{ "occlusionQueryPrecise", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, occlusionQueryPrecise), 1 },
+	{ "pipelineStatisticsQuery", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, pipelineStatisticsQuery), 1 },
+	{ "vertexPipelineStoresAndAtomics", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, vertexPipelineStoresAndAtomics), 1 },
+	{ "fragmentStoresAndAtomics", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, fragmentStoresAndAtomics), 1 },
+	{ "shaderTessellationAndGeometryPointSize", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderTessellationAndGeometryPointSize), 1 },
+	{ "shaderImageGatherExtended", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderImageGatherExtended), 1 },
+	{ "shaderStorageImageExtendedFormats", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderStorageImageExtendedFormats), 1 },
+	{ "shaderStorageImageMultisample", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderStorageImageMultisample), 1 },
+	{ "shaderStorageImageReadWithoutFormat", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderStorageImageReadWithoutFormat), 1 },
+	{ "shaderStorageImageWriteWithoutFormat", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderStorageImageWriteWithoutFormat), 1 },
+	{ "shaderUniformBufferArrayDynamicIndexing", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderUniformBufferArrayDynamicIndexing), 1 },
+	{ "shaderSampledImageArrayDynamicIndexing", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderSampledImageArrayDynamicIndexing), 1 },
+	{ "shaderStorageBufferArrayDynamicIndexing", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderStorageBufferArrayDynamicIndexing), 1 },
+	{ "shaderStorageImageArrayDynamicIndexing", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderStorageImageArrayDynamicIndexing), 1 },
+	{ "shaderClipDistance", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderClipDistance), 1 },
+	{ "shaderCullDistance", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderCullDistance), 1 },
+	{ "shaderFloat64", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderFloat64), 1 },
+	{ "shaderInt64", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderInt64), 1 },
+	{ "shaderInt16", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderInt16), 1 },
+	{ "shaderResourceResidency", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderResourceResidency), 1 },
+	{ "shaderResourceMinLod", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, shaderResourceMinLod), 1 },
+	{ "sparseBinding", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, sparseBinding), 1 },
+	{ "sparseResidencyBuffer", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, sparseResidencyBuffer), 1 },
+	{ "sparseResidencyImage2D", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, sparseResidencyImage2D), 1 },
+	{ "sparseResidencyImage3D", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, sparseResidencyImage3D), 1 },
+	{ "sparseResidency2Samples", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, sparseResidency2Samples), 1 },
+	{ "sparseResidency4Samples", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, sparseResidency4Samples), 1 },
+	{ "sparseResidency8Samples", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, sparseResidency8Samples), 1 },
+	{ "sparseResidency16Samples", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, sparseResidency16Samples), 1 },
+	{ "sparseResidencyAliased", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, sparseResidencyAliased), 1 },
+	{ "variableMultisampleRate", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, variableMultisampleRate), 1 },
+	{ "inheritedQueries", FIELD_U32, offsetof(VkPhysicalDeviceFeatures, inheritedQueries), 1 },
+};
+
+const uint32_t limit_field_count = sizeof(limit_fields) / sizeof(limit_fields[0]);
+const uint32_t sparse_field_count = sizeof(sparse_fields) / sizeof(sparse_fields[0]);
+const uint32_t feature_field_count = sizeof(feature_fields) / sizeof(feature_fields[0]);
+
+// the core formats are numbered from 1 up to this one,
+// extension formats have much bigger numbers
+#define INVENTORY_LAST_CORE_FORMAT VK_FORMAT_ASTC_12x12_SRGB_BLOCK
+
+void collect_device_inventory(VkPhysicalDevice gpu, DeviceInventory& out)
+{
+	out.simulated = false;
+
+	vkGetPhysicalDeviceProperties(gpu, &out.properties);
+	vkGetPhysicalDeviceFeatures(gpu, &out.features);
+	vkGetPhysicalDeviceMemoryProperties(gpu, &out.memory);
+
+	// the same "call twice" pattern as in Demo.cpp
+	uint32_t count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, NULL);
+	out.queue_families.resize(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(gpu, &count, out.queue_families.data());
+
+	count = 0;
+	vkEnumerateDeviceExtensionProperties(gpu, NULL, &count, NULL);
+	out.extensions.resize(count);
+	vkEnumerateDeviceExtensionProperties(gpu, NULL, &count, out.extensions.data());
+	out.extensions.resize(count);
+
+	// only keep the formats that can be used for something
+	out.formats.clear();
+	for (int f = VK_FORMAT_UNDEFINED + 1; f <= INVENTORY_LAST_CORE_FORMAT; f++)
+	{
+		InventoryFormat format;
+		format.format = (VkFormat)f;
+		vkGetPhysicalDeviceFormatProperties(gpu, format.format, &format.properties);
+
+		if (format.properties.linearTilingFeatures || format.properties.optimalTilingFeatures ||
+			format.properties.bufferFeatures)
+			out.formats.push_back(format);
+	}
+}
+
+// one job of collect_inventory, which keeps
+// an exception instead of letting it leave the worker
+static void collect_device_job(VkPhysicalDevice gpu, DeviceInventory& out, std::exception_ptr& error)
+{
+	try
+	{
+		collect_device_inventory(gpu, out);
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+}
+
+void collect_inventory(const VkPhysicalDevice* gpus, uint32_t gpu_count,
+	std::vector<DeviceInventory>& out, ThreadPool* pool)
+{
+	// Every slot is made before any job starts, so the jobs never
+	// resize the vector, and each job only writes its own slot.
+	// That is what keeps the order the same as the order that
+	// vkEnumeratePhysicalDevices gave us, on every run
+	out.clear();
+	out.resize(gpu_count);
+
+	if (!pool || gpu_count < 2)
+	{
+		for (uint32_t i = 0; i < gpu_count; i++)
+			collect_device_inventory(gpus[i], out[i]);
+		return;
+	}
+
+	// The vkGetPhysicalDevice* queries only read from the GPU that
+	// they are given, and the instance is not changed by any of them,
+	// so different GPUs can be asked at the same time. We never give
+	// two jobs the same GPU, so this is safe even for a driver that
+	// expects each physical device to be used by one thread at a time.
+	//
+	// An exception that leaves a job would end the whole program on
+	// the worker thread, so every job keeps its own, and the first one
+	// is thrown again here, on the thread that asked, once every job
+	// has finished (the jobs point into "out" and "errors")
+	std::vector<std::exception_ptr> errors(gpu_count);
+	try
+	{
+		for (uint32_t i = 0; i < gpu_count; i++)
+		{
+			VkPhysicalDevice gpu = gpus[i];
+			DeviceInventory* slot = &out[i];
+			std::exception_ptr* error = &errors[i];
+			pool->submit([gpu, slot, error]() { collect_device_job(gpu, *slot, *error); });
+		}
+	}
+	catch (...)
+	{
+		pool->wait_idle();
+		throw;
+	}
+	pool->wait_idle();
+
+	for (uint32_t i = 0; i < gpu_count; i++)
+	{
+		if (errors[i])
+			std::rethrow_exception(errors[i]);
+	}
+}
+
+std::string local_node_name()
+{
+	char name[256] = {};
+
+#ifdef _WIN32
+	DWORD length = sizeof(name);
+	if (!GetComputerNameA(name, &length))
+		return "unknown";
+#else
+	if (gethostname(name, sizeof(name) - 1) != 0)
+		return "unknown";
+#endif
+
+	return name;
+}
+
+// write a string for JSON, escaping quotes and control characters
+static void write_json_string(FILE* file, const char* text)
+{
+	fputc('"', file);
+	for (const char* c = text; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			fprintf(file, "\\%c", *c);
+		else if ((uint8_t)*c < 0x20)
+			fprintf(file, "\\u%04x", (uint8_t)*c);
+		else
+			fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+static void write_json_fields(FILE* file, const char* indent, const void* base, const InventoryField* fields, uint32_t field_count)
+{
+	for (uint32_t i = 0; i < field_count; i++)
+	{
+		const InventoryField& field = fields[i];
+		const uint8_t* value = (const uint8_t*)base + field.offset;
+
+		fprintf(file, "%s\"%s\": ", indent, field.name);
+		if (field.count > 1)
+			fputc('[', file);
+
+		for (uint32_t e = 0; e < field.count; e++)
+		{
+			if (e > 0)
+				fputs(", ", file);
+
+			switch (field.type)
+			{
+			case FIELD_U32: fprintf(file, "%u", ((const uint32_t*)value)[e]); break;
+			case FIELD_I32: fprintf(file, "%d", ((const int32_t*)value)[e]); break;
+			case FIELD_U64: fprintf(file, "%llu", (unsigned long long)((const uint64_t*)value)[e]); break;
+			case FIELD_F32: fprintf(file, "%.9g", ((const float*)value)[e]); break;
+			case FIELD_SIZE: fprintf(file, "%llu", (unsigned long long)((const size_t*)value)[e]); break;
+			}
+		}
+
+		if (field.count > 1)
+			fputc(']', file);
+		fputs(i + 1 < field_count ? ",\n" : "\n", file);
+	}
+}
+
+bool write_inventory_json(const char* path, const Inventory& inventory)
+{
+	FILE* file = fopen(path, "w");
+	if (!file)
+		return false;
+
+	fputs("{\n  \"node\": ", file);
+	write_json_string(file, inventory.node.c_str());
+	fputs(",\n  \"devices\": [\n", file);
+
+	for (size_t d = 0; d < inventory.devices.size(); d++)
+	{
+		const DeviceInventory& device = inventory.devices[d];
+		const VkPhysicalDeviceProperties& p = device.properties;
+
+		fprintf(file, "    {\n      \"properties\": {\n");
+		fprintf(file, "        \"apiVersion\": %u,\n", p.apiVersion);
+		fprintf(file, "        \"driverVersion\": %u,\n", p.driverVersion);
+		fprintf(file, "        \"vendorID\": %u,\n", p.vendorID);
+		fprintf(file, "        \"deviceID\": %u,\n", p.deviceID);
+		fprintf(file, "        \"deviceType\": %u,\n", (uint32_t)p.deviceType);
+		fprintf(file, "        \"deviceName\": ");
+		write_json_string(file, p.deviceName);
+
+		fprintf(file, ",\n        \"pipelineCacheUUID\": \"");
+		for (uint32_t i = 0; i < VK_UUID_SIZE; i++)
+			fprintf(file, "%02x", p.pipelineCacheUUID[i]);
+
+		fprintf(file, "\",\n        \"limits\": {\n");
+		write_json_fields(file, "          ", &p.limits, limit_fields, limit_field_count);
+		fprintf(file, "        },\n        \"sparseProperties\": {\n");
+		write_json_fields(file, "          ", &p.sparseProperties, sparse_fields, sparse_field_count);
+		fprintf(file, "        }\n      },\n");
+
+		fprintf(file, "      \"features\": {\n");
+		write_json_fields(file, "        ", &device.features, feature_fields, feature_field_count);
+		fprintf(file, "      },\n");
+
+		fprintf(file, "      \"memory\": {\n        \"heaps\": [");
+		for (uint32_t i = 0; i < device.memory.memoryHeapCount; i++)
+		{
+			fprintf(file, "%s\n          { \"size\": %llu, \"flags\": %u }", i ? "," : "",
+				(unsigned long long)device.memory.memoryHeaps[i].size, device.memory.memoryHeaps[i].flags);
+		}
+		fprintf(file, "\n        ],\n        \"types\": [");
+		for (uint32_t i = 0; i < device.memory.memoryTypeCount; i++)
+		{
+			fprintf(file, "%s\n          { \"propertyFlags\": %u, \"heapIndex\": %u }", i ? "," : "",
+				device.memory.memoryTypes[i].propertyFlags, device.memory.memoryTypes[i].heapIndex);
+		}
+		fprintf(file, "\n        ]\n      },\n");
+
+		fprintf(file, "      \"queueFamilies\": [");
+		for (size_t i = 0; i < device.queue_families.size(); i++)
+		{
+			const VkQueueFamilyProperties& q = device.queue_families[i];
+			fprintf(file, "%s\n        { \"queueFlags\": %u, \"queueCount\": %u, \"timestampValidBits\": %u, "
+				"\"minImageTransferGranularity\": [%u, %u, %u] }", i ? "," : "",
+				q.queueFlags, q.queueCount, q.timestampValidBits, q.minImageTransferGranularity.width,
+				q.minImageTransferGranularity.height, q.minImageTransferGranularity.depth);
+		}
+		fprintf(file, "\n      ],\n");
+
+		fprintf(file, "      \"extensions\": [");
+		for (size_t i = 0; i < device.extensions.size(); i++)
+		{
+			fprintf(file, "%s\n        { \"name\": ", i ? "," : "");
+			write_json_string(file, device.extensions[i].extensionName);
+			fprintf(file, ", \"specVersion\": %u }", device.extensions[i].specVersion);
+		}
+		fprintf(file, "\n      ],\n");
+
+		fprintf(file, "      \"formats\": [");
+		for (size_t i = 0; i < device.formats.size(); i++)
+		{
+			const InventoryFormat& f = device.formats[i];
+			fprintf(file, "%s\n        { \"format\": %u, \"linear\": %u, \"optimal\": %u, \"buffer\": %u }", i ? "," : "",
+				(uint32_t)f.format, f.properties.linearTilingFeatures, f.properties.optimalTilingFeatures,
+				f.properties.bufferFeatures);
+		}
+		fprintf(file, "\n      ]\n    }%s\n", d + 1 < inventory.devices.size() ? "," : "");
+	}
+
+	fputs("  ]\n}\n", file);
+
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+bool write_inventory_binary(const char* path, const Inventory& inventory)
+{
+	FILE* file = fopen(path, "wb");
+	if (!file)
+		return false;
+
+	InventoryFileHeader header = {};
+	header.magic = INVENTORY_MAGIC;
+	header.version = INVENTORY_VERSION;
+	header.device_count = (uint32_t)inventory.devices.size();
+	strncpy(header.node, inventory.node.c_str(), sizeof(header.node) - 1);
+	fwrite(&header, sizeof(header), 1, file);
+
+	for (size_t d = 0; d < inventory.devices.size(); d++)
+	{
+		const DeviceInventory& device = inventory.devices[d];
+
+		InventoryDeviceRecord record = {};
+		record.properties = device.properties;
+		record.features = device.features;
+		record.memory = device.memory;
+		record.queue_family_count = (uint32_t)device.queue_families.size();
+		record.extension_count = (uint32_t)device.extensions.size();
+		record.format_count = (uint32_t)device.formats.size();
+
+		fwrite(&record, sizeof(record), 1, file);
+		fwrite(device.queue_families.data(), sizeof(VkQueueFamilyProperties), device.queue_families.size(), file);
+		fwrite(device.extensions.data(), sizeof(VkExtensionProperties), device.extensions.size(), file);
+		fwrite(device.formats.data(), sizeof(InventoryFormat), device.formats.size(), file);
+	}
+
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+static void read_json_fields(JsonValue object, void* base, const InventoryField* fields, uint32_t field_count)
+{
+	// Fields that are missing from the file keep whatever
+	// value they had, so an older file still loads
+	for (uint32_t i = 0; i < field_count; i++)
+	{
+		const InventoryField& field = fields[i];
+		uint8_t* value = (uint8_t*)base + field.offset;
+
+		JsonValue member = object[field.name];
+		if (!member.valid())
+			continue;
+
+		for (uint32_t e = 0; e < field.count; e++)
+		{
+			JsonValue element = field.count > 1 ? member.at(e) : member;
+			if (!element.valid())
+				break;
+
+			switch (field.type)
+			{
+			case FIELD_U32: ((uint32_t*)value)[e] = (uint32_t)element.as_u64(); break;
+			case FIELD_I32: ((int32_t*)value)[e] = (int32_t)element.as_i64(); break;
+			case FIELD_U64: ((uint64_t*)value)[e] = element.as_u64(); break;
+			case FIELD_F32: ((float*)value)[e] = (float)element.as_double(); break;
+			case FIELD_SIZE: ((size_t*)value)[e] = (size_t)element.as_u64(); break;
+			}
+		}
+	}
+}
+
+static void read_json_device(JsonValue json, DeviceInventory& device)
+{
+	memset(&device.properties, 0, sizeof(device.properties));
+	memset(&device.features, 0, sizeof(device.features));
+	memset(&device.memory, 0, sizeof(device.memory));
+	device.simulated = false;
+
+	JsonValue p = json["properties"];
+	device.properties.apiVersion = (uint32_t)p["apiVersion"].as_u64();
+	device.properties.driverVersion = (uint32_t)p["driverVersion"].as_u64();
+	device.properties.vendorID = (uint32_t)p["vendorID"].as_u64();
+	device.properties.deviceID = (uint32_t)p["deviceID"].as_u64();
+	device.properties.deviceType = (VkPhysicalDeviceType)p["deviceType"].as_u64();
+
+	std::string name = p["deviceName"].as_string();
+	strncpy(device.properties.deviceName, name.c_str(), VK_MAX_PHYSICAL_DEVICE_NAME_SIZE - 1);
+
+	std::string uuid = p["pipelineCacheUUID"].as_string();
+	for (uint32_t i = 0; i < VK_UUID_SIZE && i * 2 + 1 < uuid.size(); i++)
+	{
+		unsigned int byte = 0;
+		sscanf(uuid.c_str() + i * 2, "%2x", &byte);
+		device.properties.pipelineCacheUUID[i] = (uint8_t)byte;
+	}
+
+	read_json_fields(p["limits"], &device.properties.limits, limit_fields, limit_field_count);
+	read_json_fields(p["sparseProperties"], &device.properties.sparseProperties, sparse_fields, sparse_field_count);
+	read_json_fields(json["features"], &device.features, feature_fields, feature_field_count);
+
+	JsonValue memory = json["memory"];
+	for (JsonValue heap = memory["heaps"].first_child(); heap.valid() && device.memory.memoryHeapCount < VK_MAX_MEMORY_HEAPS; heap = heap.next())
+	{
+		VkMemoryHeap& h = device.memory.memoryHeaps[device.memory.memoryHeapCount++];
+		h.size = heap["size"].as_u64();
+		h.flags = (VkMemoryHeapFlags)heap["flags"].as_u64();
+	}
+	for (JsonValue type = memory["types"].first_child(); type.valid() && device.memory.memoryTypeCount < VK_MAX_MEMORY_TYPES; type = type.next())
+	{
+		VkMemoryType& t = device.memory.memoryTypes[device.memory.memoryTypeCount++];
+		t.propertyFlags = (VkMemoryPropertyFlags)type["propertyFlags"].as_u64();
+		t.heapIndex = (uint32_t)type["heapIndex"].as_u64();
+	}
+
+	device.queue_families.clear();
+	for (JsonValue q = json["queueFamilies"].first_child(); q.valid(); q = q.next())
+	{
+		VkQueueFamilyProperties family = {};
+		family.queueFlags = (VkQueueFlags)q["queueFlags"].as_u64();
+		family.queueCount = (uint32_t)q["queueCount"].as_u64();
+		family.timestampValidBits = (uint32_t)q["timestampValidBits"].as_u64();
+
+		JsonValue granularity = q["minImageTransferGranularity"];
+		family.minImageTransferGranularity.width = (uint32_t)granularity.at(0).as_u64();
+		family.minImageTransferGranularity.height = (uint32_t)granularity.at(1).as_u64();
+		family.minImageTransferGranularity.depth = (uint32_t)granularity.at(2).as_u64();
+
+		device.queue_families.push_back(family);
+	}
+
+	device.extensions.clear();
+	for (JsonValue e = json["extensions"].first_child(); e.valid(); e = e.next())
+	{
+		VkExtensionProperties extension = {};
+		std::string extension_name = e["name"].as_string();
+		strncpy(extension.extensionName, extension_name.c_str(), VK_MAX_EXTENSION_NAME_SIZE - 1);
+		extension.specVersion = (uint32_t)e["specVersion"].as_u64();
+		device.extensions.push_back(extension);
+	}
+
+	device.formats.clear();
+	for (JsonValue f = json["formats"].first_child(); f.valid(); f = f.next())
+	{
+		InventoryFormat format = {};
+		format.format = (VkFormat)f["format"].as_u64();
+		format.properties.linearTilingFeatures = (VkFormatFeatureFlags)f["linear"].as_u64();
+		format.properties.optimalTilingFeatures = (VkFormatFeatureFlags)f["optimal"].as_u64();
+		format.properties.bufferFeatures = (VkFormatFeatureFlags)f["buffer"].as_u64();
+		device.formats.push_back(format);
+	}
+}
+
+static bool read_inventory_binary(const uint8_t* data, size_t size, Inventory& out)
+{
+	InventoryFileHeader header;
+	if (size < sizeof(header))
+		return false;
+
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != INVENTORY_MAGIC || header.version != INVENTORY_VERSION)
+		return false;
+
+	header.node[sizeof(header.node) - 1] = 0;
+	out.node = header.node;
+	out.devices.clear();
+
+	size_t offset = sizeof(header);
+	for (uint32_t d = 0; d < header.device_count; d++)
+	{
+		InventoryDeviceRecord record;
+		if (size - offset < sizeof(record))
+			return false;
+		memcpy(&record, data + offset, sizeof(record));
+		offset += sizeof(record);
+
+		uint64_t arrays =
+			(uint64_t)record.queue_family_count * sizeof(VkQueueFamilyProperties) +
+			(uint64_t)record.extension_count * sizeof(VkExtensionProperties) +
+			(uint64_t)record.format_count * sizeof(InventoryFormat);
+		if (size - offset < arrays)
+			return false;
+
+		DeviceInventory device;
+		device.properties = record.properties;
+		device.features = record.features;
+		device.memory = record.memory;
+		device.simulated = false;
+
+		device.queue_families.resize(record.queue_family_count);
+		memcpy(device.queue_families.data(), data + offset, record.queue_family_count * sizeof(VkQueueFamilyProperties));
+		offset += record.queue_family_count * sizeof(VkQueueFamilyProperties);
+
+		device.extensions.resize(record.extension_count);
+		memcpy(device.extensions.data(), data + offset, record.extension_count * sizeof(VkExtensionProperties));
+		offset += record.extension_count * sizeof(VkExtensionProperties);
+
+		device.formats.resize(record.format_count);
+		memcpy(device.formats.data(), data + offset, record.format_count * sizeof(InventoryFormat));
+		offset += record.format_count * sizeof(InventoryFormat);
+
+		out.devices.push_back(device);
+	}
+
+	return true;
+}
+
+bool read_inventory(const uint8_t* data, size_t size, Inventory& out)
+{
+	uint32_t magic = 0;
+	if (size >= sizeof(magic))
+		memcpy(&magic, data, sizeof(magic));
+
+	if (magic == INVENTORY_MAGIC)
+		return read_inventory_binary(data, size, out);
+
+	JsonDocument document;
+	if (!document.parse((const char*)data, size))
+		return false;
+
+	JsonValue root = document.root();
+	out.node = root["node"].as_string();
+	out.devices.clear();
+
+	for (JsonValue device = root["devices"].first_child(); device.valid(); device = device.next())
+	{
+		out.devices.push_back(DeviceInventory());
+		read_json_device(device, out.devices.back());
+	}
+
+	return true;
+}
+
+bool read_inventory_file(const char* path, Inventory& out)
+{
+	MappedFile file;
+	if (!file.open(path))
+		return false;
+
+	return read_inventory(file.data(), file.size(), out);
+}
+
+bool load_device_profile(const char* path, uint32_t device_index, DeviceInventory& out)
+{
+	Inventory inventory;
+	if (!read_inventory_file(path, inventory) || device_index >= inventory.devices.size())
+		return false;
+
+	out = inventory.devices[device_index];
+	out.simulated = true;
+	return true;
+}
@@ -0,0 +1,145 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Everything we can learn about one GPU without creating a
+// device: the properties (name, vendor, limits), the features,
+// the memory heaps, the queue families, the extensions, and
+// what every core format can be used for
+struct InventoryFormat
+{
+	VkFormat format;
+	VkFormatProperties properties;
+};
+
+struct DeviceInventory
+{
+	VkPhysicalDeviceProperties properties;
+	VkPhysicalDeviceFeatures features;
+	VkPhysicalDeviceMemoryProperties memory;
+	std::vector<VkQueueFamilyProperties> queue_families;
+	std::vector<VkExtensionProperties> extensions;
+	std::vector<InventoryFormat> formats;
+
+	// true if this came from a profile file,
+	// rather than from a GPU in this computer
+	bool simulated;
+};
+
+// The inventory of a whole computer ("node")
+struct Inventory
+{
+	std::string node;
+	std::vector<DeviceInventory> devices;
+};
+
+class ThreadPool;
+
+// Ask the driver for everything in DeviceInventory
+void collect_device_inventory(VkPhysicalDevice gpu, DeviceInventory& out);
+
+// The same for every GPU in "gpus", one job per GPU on "pool",
+// or one after another on this thread if "pool" is null.
+// out[i] always belongs to gpus[i], whichever GPU finished first.
+// If a job throws, the exception is thrown again from here
+void collect_inventory(const VkPhysicalDevice* gpus, uint32_t gpu_count,
+	std::vector<DeviceInventory>& out, ThreadPool* pool);
+
+// the name of this computer, used as Inventory::node
+std::string local_node_name();
+
+// Write an inventory as JSON, for people and scripts to read,
+// or as binary, which is smaller and faster to load
+bool write_inventory_json(const char* path, const Inventory& inventory);
+bool write_inventory_binary(const char* path, const Inventory& inventory);
+
+// Read an inventory that was written by either of the
+// functions above. The format is detected automatically
+bool read_inventory(const uint8_t* data, size_t size, Inventory& out);
+bool read_inventory_file(const char* path, Inventory& out);
+
+// Load one device out of an inventory file, to pretend that
+// it is the GPU in this computer. This lets us test device
+// selection and workload sizing for hardware we do not have
+bool load_device_profile(const char* path, uint32_t device_index, DeviceInventory& out);
+
+// The JSON writer and reader both work from these tables,
+// which list every member of the limits, sparse properties
+// and features structures, so the two can never disagree
+enum InventoryFieldType
+{
+	FIELD_U32,
+	FIELD_I32,
+	FIELD_U64,
+	FIELD_F32,
+	FIELD_SIZE
+};
+
+struct InventoryField
+{
+	const char* name;
+	InventoryFieldType type;
+	size_t offset;
+	uint32_t count;  // more than one for arrays, like maxComputeWorkGroupSize[3]
+};
+
+extern const InventoryField limit_fields[];
+extern const uint32_t limit_field_count;
+extern const InventoryField sparse_fields[];
+extern const uint32_t sparse_field_count;
+extern const InventoryField feature_fields[];
+extern const uint32_t feature_field_count;
+
+// Binary inventory files start with this header, followed by one
+// InventoryDeviceRecord per device, each followed by its arrays
+#define INVENTORY_MAGIC 0x56494B56 // "VKIV"
+#define INVENTORY_VERSION 1
+
+struct InventoryFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t device_count;
+	uint32_t reserved;
+	char node[64];
+};
+
+struct InventoryDeviceRecord
+{
+	VkPhysicalDeviceProperties properties;
+	VkPhysicalDeviceFeatures features;
+	VkPhysicalDeviceMemoryProperties memory;
+	uint32_t queue_family_count;
+	uint32_t extension_count;
+	uint32_t format_count;
+	uint32_t reserved;
+};
@@ -0,0 +1,430 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "JsonReader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// objects and arrays inside each other deeper than
+// this are treated as an error, so a broken file
+// cannot make us run out of stack
+#define JSON_MAX_DEPTH 64
+
+JsonDocument::JsonDocument()
+{
+	text = nullptr;
+	size = 0;
+	position = 0;
+}
+
+bool JsonDocument::fail(const char* message)
+{
+	if (error_message.empty())
+	{
+		char buffer[128];
+		snprintf(buffer, sizeof(buffer), "%s at byte %zu", message, position);
+		error_message = buffer;
+	}
+	return false;
+}
+
+void JsonDocument::skip_whitespace()
+{
+	while (position < size && (text[position] == ' ' || text[position] == '\t' ||
+		text[position] == '\n' || text[position] == '\r'))
+		position++;
+}
+
+bool JsonDocument::parse(const char* source, size_t source_size)
+{
+	text = source;
+	size = source_size;
+	position = 0;
+	nodes.clear();
+	error_message.clear();
+
+	// node offsets are 32 bits
+	if (size >= 0xFFFFFFFFu)
+		return fail("file too large");
+
+	// a guess that avoids most reallocations:
+	// there is rarely more than one value per 8 bytes
+	nodes.reserve(size / 8 + 1);
+
+	if (parse_value(0) == JSON_NONE)
+		return fail("invalid value");
+
+	skip_whitespace();
+	if (position != size)
+		return fail("unexpected text after the end");
+
+	return true;
+}
+
+bool JsonDocument::parse_string(uint32_t& start, uint32_t& length)
+{
+	// we are on the opening quote. Escapes are only skipped
+	// here, as_string() decodes them if anybody asks
+	position++;
+	start = (uint32_t)position;
+
+	while (position < size && text[position] != '"')
+	{
+		if (text[position] == '\\')
+			position++;
+		position++;
+	}
+
+	if (position >= size)
+		return fail("unterminated string");
+
+	length = (uint32_t)position - start;
+	position++;
+	return true;
+}
+
+uint32_t JsonDocument::parse_value(uint32_t depth)
+{
+	if (depth > JSON_MAX_DEPTH)
+	{
+		fail("too deeply nested");
+		return JSON_NONE;
+	}
+
+	skip_whitespace();
+	if (position >= size)
+	{
+		fail("unexpected end of file");
+		return JSON_NONE;
+	}
+
+	JsonNode node = {};
+	node.first_child = JSON_NONE;
+	node.next_sibling = JSON_NONE;
+	node.start = (uint32_t)position;
+
+	char c = text[position];
+
+	if (c == '{' || c == '[')
+	{
+		bool is_object = c == '{';
+		char close = is_object ? '}' : ']';
+		node.type = is_object ? JSON_OBJECT : JSON_ARRAY;
+
+		uint32_t index = (uint32_t)nodes.size();
+		nodes.push_back(node);
+		position++;
+
+		uint32_t previous = JSON_NONE;
+		skip_whitespace();
+
+		if (position < size && text[position] == close)
+		{
+			position++;
+			nodes[index].length = (uint32_t)position - node.start;
+			return index;
+		}
+
+		while (true)
+		{
+			uint32_t key_start = 0, key_length = 0;
+
+			if (is_object)
+			{
+				skip_whitespace();
+				if (position >= size || text[position] != '"')
+				{
+					fail("expected a member name");
+					return JSON_NONE;
+				}
+				if (!parse_string(key_start, key_length))
+					return JSON_NONE;
+
+				skip_whitespace();
+				if (position >= size || text[position] != ':')
+				{
+					fail("expected ':'");
+					return JSON_NONE;
+				}
+				position++;
+			}
+
+			uint32_t child = parse_value(depth + 1);
+			if (child == JSON_NONE)
+				return JSON_NONE;
+
+			nodes[child].key_start = key_start;
+			nodes[child].key_length = key_length;
+
+			// link the child onto the end of the list
+			if (previous == JSON_NONE)
+				nodes[index].first_child = child;
+			else
+				nodes[previous].next_sibling = child;
+			previous = child;
+
+			skip_whitespace();
+			if (position < size && text[position] == ',')
+			{
+				position++;
+				continue;
+			}
+			if (position < size && text[position] == close)
+			{
+				position++;
+				break;
+			}
+
+			fail(is_object ? "expected ',' or '}'" : "expected ',' or ']'");
+			return JSON_NONE;
+		}
+
+		nodes[index].length = (uint32_t)position - node.start;
+		return index;
+	}
+
+	if (c == '"')
+	{
+		node.type = JSON_STRING;
+		if (!parse_string(node.start, node.length))
+			return JSON_NONE;
+	}
+	else if (c == '-' || (c >= '0' && c <= '9'))
+	{
+		node.type = JSON_NUMBER;
+		while (position < size && strchr("+-.eE0123456789", text[position]))
+			position++;
+		node.length = (uint32_t)position - node.start;
+	}
+	else if (size - position >= 4 && !memcmp(text + position, "true", 4))
+	{
+		node.type = JSON_BOOL;
+		node.length = 4;
+		position += 4;
+	}
+	else if (size - position >= 5 && !memcmp(text + position, "false", 5))
+	{
+		node.type = JSON_BOOL;
+		node.length = 5;
+		position += 5;
+	}
+	else if (size - position >= 4 && !memcmp(text + position, "null", 4))
+	{
+		node.type = JSON_NULL;
+		node.length = 4;
+		position += 4;
+	}
+	else
+	{
+		fail("unexpected character");
+		return JSON_NONE;
+	}
+
+	nodes.push_back(node);
+	return (uint32_t)nodes.size() - 1;
+}
+
+JsonValue JsonDocument::root() const
+{
+	return JsonValue(this, nodes.empty() ? JSON_NONE : 0);
+}
+
+const JsonNode* JsonValue::node() const
+{
+	return valid() ? &doc->nodes[index] : nullptr;
+}
+
+JsonType JsonValue::type() const
+{
+	return valid() ? (JsonType)node()->type : JSON_NULL;
+}
+
+JsonValue JsonValue::first_child() const
+{
+	return valid() ? JsonValue(doc, node()->first_child) : JsonValue();
+}
+
+JsonValue JsonValue::next() const
+{
+	return valid() ? JsonValue(doc, node()->next_sibling) : JsonValue();
+}
+
+size_t JsonValue::size() const
+{
+	size_t count = 0;
+	for (JsonValue child = first_child(); child.valid(); child = child.next())
+		count++;
+	return count;
+}
+
+bool JsonValue::key_is(const char* name) const
+{
+	if (!valid())
+		return false;
+
+	size_t length = strlen(name);
+	return node()->key_length == length && !memcmp(doc->text + node()->key_start, name, length);
+}
+
+std::string JsonValue::key() const
+{
+	if (!valid())
+		return std::string();
+	return std::string(doc->text + node()->key_start, node()->key_length);
+}
+
+JsonValue JsonValue::operator[](const char* key) const
+{
+	if (type() != JSON_OBJECT)
+		return JsonValue();
+
+	for (JsonValue child = first_child(); child.valid(); child = child.next())
+	{
+		if (child.key_is(key))
+			return child;
+	}
+	return JsonValue();
+}
+
+JsonValue JsonValue::at(size_t position) const
+{
+	JsonValue child = first_child();
+	while (position-- > 0 && child.valid())
+		child = child.next();
+	return child;
+}
+
+// numbers are not null-terminated in the file,
+// so copy them somewhere that is before converting
+static bool copy_number(const char* text, uint32_t length, char* buffer, size_t buffer_size)
+{
+	if (length == 0 || length >= buffer_size)
+		return false;
+	memcpy(buffer, text, length);
+	buffer[length] = 0;
+	return true;
+}
+
+uint64_t JsonValue::as_u64(uint64_t fallback) const
+{
+	char buffer[32];
+	if (type() != JSON_NUMBER || !copy_number(doc->text + node()->start, node()->length, buffer, sizeof(buffer)))
+		return fallback;
+	return strtoull(buffer, NULL, 10);
+}
+
+int64_t JsonValue::as_i64(int64_t fallback) const
+{
+	char buffer[32];
+	if (type() != JSON_NUMBER || !copy_number(doc->text + node()->start, node()->length, buffer, sizeof(buffer)))
+		return fallback;
+	return strtoll(buffer, NULL, 10);
+}
+
+double JsonValue::as_double(double fallback) const
+{
+	char buffer[64];
+	if (type() != JSON_NUMBER || !copy_number(doc->text + node()->start, node()->length, buffer, sizeof(buffer)))
+		return fallback;
+	return strtod(buffer, NULL);
+}
+
+bool JsonValue::as_bool(bool fallback) const
+{
+	if (type() == JSON_BOOL)
+		return node()->length == 4;
+	if (type() == JSON_NUMBER)
+		return as_u64() != 0;
+	return fallback;
+}
+
+static uint32_t hex_digit(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return 0;
+}
+
+std::string JsonValue::as_string(const char* fallback) const
+{
+	if (type() != JSON_STRING)
+		return fallback;
+
+	const char* c = doc->text + node()->start;
+	const char* end = c + node()->length;
+
+	std::string result;
+	result.reserve(node()->length);
+
+	while (c < end)
+	{
+		if (*c != '\\' || c + 1 >= end)
+		{
+			result += *c++;
+			continue;
+		}
+
+		c++;
+		switch (*c)
+		{
+		case 'n': result += '\n'; break;
+		case 't': result += '\t'; break;
+		case 'r': result += '\r'; break;
+		case 'b': result += '\b'; break;
+		case 'f': result += '\f'; break;
+		case 'u':
+		{
+			// \uXXXX, written back out as UTF-8
+			uint32_t code = 0;
+			for (int i = 1; i <= 4 && c + i < end; i++)
+				code = code * 16 + hex_digit(c[i]);
+			c += 4;
+
+			if (code < 0x80)
+			{
+				result += (char)code;
+			}
+			else if (code < 0x800)
+			{
+				result += (char)(0xC0 | (code >> 6));
+				result += (char)(0x80 | (code & 0x3F));
+			}
+			else
+			{
+				result += (char)(0xE0 | (code >> 12));
+				result += (char)(0x80 | ((code >> 6) & 0x3F));
+				result += (char)(0x80 | (code & 0x3F));
+			}
+			break;
+		}
+		default: result += *c; break;
+		}
+		c++;
+	}
+
+	return result;
+}
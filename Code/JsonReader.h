@@ -0,0 +1,133 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// JsonDocument is a small JSON reader made for files that
+// are mapped into memory (see MappedFile.h). It does not copy
+// any strings or numbers out of the file while parsing. It only
+// makes one small node for every value, which remembers where
+// the value is in the text. Numbers and strings are converted
+// later, and only if somebody asks for them.
+
+enum JsonType
+{
+	JSON_NULL,
+	JSON_BOOL,
+	JSON_NUMBER,
+	JSON_STRING,
+	JSON_ARRAY,
+	JSON_OBJECT
+};
+
+#define JSON_NONE 0xFFFFFFFFu
+
+struct JsonNode
+{
+	uint32_t type;
+	uint32_t first_child;   // arrays and objects
+	uint32_t next_sibling;
+	uint32_t key_start;     // object members only
+	uint32_t key_length;
+	uint32_t start;         // where the value is in the text,
+	uint32_t length;        // strings do not include their quotes
+};
+
+class JsonDocument;
+
+// JsonValue is a cheap handle to one node in a document.
+// Asking for something that does not exist gives back an
+// invalid value, and invalid values return the fallback,
+// so lookups can be chained without checking every step
+class JsonValue
+{
+public:
+	JsonValue() : doc(nullptr), index(JSON_NONE) {}
+	JsonValue(const JsonDocument* doc, uint32_t index) : doc(doc), index(index) {}
+
+	bool valid() const { return doc && index != JSON_NONE; }
+	JsonType type() const;
+
+	// object member by name
+	JsonValue operator[](const char* key) const;
+
+	// array element by position
+	JsonValue at(size_t position) const;
+
+	// walk through the children of an array or object
+	JsonValue first_child() const;
+	JsonValue next() const;
+	size_t size() const;
+
+	// the name of this value, if it is an object member
+	std::string key() const;
+	bool key_is(const char* name) const;
+
+	uint64_t as_u64(uint64_t fallback = 0) const;
+	int64_t as_i64(int64_t fallback = 0) const;
+	double as_double(double fallback = 0) const;
+	bool as_bool(bool fallback = false) const;
+	std::string as_string(const char* fallback = "") const;
+
+private:
+	const JsonNode* node() const;
+
+	const JsonDocument* doc;
+	uint32_t index;
+};
+
+class JsonDocument
+{
+public:
+	JsonDocument();
+
+	// Parse "size" bytes of text. The text does not need a
+	// null terminator, and it has to stay alive (and mapped)
+	// for as long as this document is used
+	bool parse(const char* text, size_t size);
+
+	JsonValue root() const;
+
+	// a description of what went wrong, if parse() failed
+	const std::string& error() const { return error_message; }
+
+private:
+	friend class JsonValue;
+
+	uint32_t parse_value(uint32_t depth);
+	bool parse_string(uint32_t& start, uint32_t& length);
+	void skip_whitespace();
+	bool fail(const char* message);
+
+	const char* text;
+	size_t size;
+	size_t position;
+	std::vector<JsonNode> nodes;
+	std::string error_message;
+};
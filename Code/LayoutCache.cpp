@@ -0,0 +1,295 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "LayoutCache.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+// Vulkan only promises that 4 sets can be bound at once
+// (maxBoundDescriptorSets), and no GPU has more than this
+#define MAX_DESCRIPTOR_SETS 32
+
+static bool layout_binding_less(const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b)
+{
+	return a.binding < b.binding;
+}
+
+bool merge_pipeline_layout(const SpirvReflection* const* stages, uint32_t stage_count,
+	PipelineLayoutDesc& out, std::string& error)
+{
+	out.sets.clear();
+	out.push_constants.stageFlags = 0;
+	out.push_constants.offset = 0;
+	out.push_constants.size = 0;
+
+	uint32_t push_end = 0;
+	char message[256];
+
+	for (uint32_t s = 0; s < stage_count; s++)
+	{
+		const SpirvReflection& stage = *stages[s];
+
+		for (size_t b = 0; b < stage.bindings.size(); b++)
+		{
+			const SpirvBinding& binding = stage.bindings[b];
+
+			if (binding.set >= MAX_DESCRIPTOR_SETS)
+			{
+				snprintf(message, sizeof(message), "\"%s\" is in set %u, there can only be %u sets",
+					binding.name.c_str(), binding.set, MAX_DESCRIPTOR_SETS);
+				error = message;
+				return false;
+			}
+
+			// an array without a size needs descriptor
+			// indexing, which we do not turn on
+			if (binding.count == 0)
+			{
+				snprintf(message, sizeof(message), "\"%s\" is an array without a size", binding.name.c_str());
+				error = message;
+				return false;
+			}
+
+			if (out.sets.size() <= binding.set)
+				out.sets.resize(binding.set + 1);
+			std::vector<VkDescriptorSetLayoutBinding>& set = out.sets[binding.set];
+
+			// look for another stage that uses the same binding
+			size_t found = 0;
+			while (found < set.size() && set[found].binding != binding.binding)
+				found++;
+
+			if (found < set.size())
+			{
+				if (set[found].descriptorType != binding.type || set[found].descriptorCount != binding.count)
+				{
+					snprintf(message, sizeof(message), "set %u binding %u (\"%s\") is not the same in every stage",
+						binding.set, binding.binding, binding.name.c_str());
+					error = message;
+					return false;
+				}
+
+				set[found].stageFlags |= stage.stage;
+				continue;
+			}
+
+			VkDescriptorSetLayoutBinding layout_binding = {};
+			layout_binding.binding = binding.binding;
+			layout_binding.descriptorType = binding.type;
+			layout_binding.descriptorCount = binding.count;
+			layout_binding.stageFlags = stage.stage;
+			set.push_back(layout_binding);
+		}
+
+		if (stage.push_constant_size > 0)
+		{
+			uint32_t end = stage.push_constant_offset + stage.push_constant_size;
+			if (out.push_constants.stageFlags == 0)
+				out.push_constants.offset = stage.push_constant_offset;
+			else
+				out.push_constants.offset = std::min(out.push_constants.offset, stage.push_constant_offset);
+
+			push_end = std::max(push_end, end);
+			out.push_constants.stageFlags |= stage.stage;
+		}
+	}
+
+	if (out.push_constants.stageFlags)
+		out.push_constants.size = push_end - out.push_constants.offset;
+
+	// bindings are in order in every set, so that two pipelines
+	// with the same bindings end up with the same key
+	for (size_t s = 0; s < out.sets.size(); s++)
+		std::sort(out.sets[s].begin(), out.sets[s].end(), layout_binding_less);
+
+	return true;
+}
+
+// The keys of our maps are the layouts themselves, written out
+// as a string of 32 bit words. Two layouts with the same contents
+// have the same key, no matter who asked for them
+static void append_word(std::string& key, uint32_t word)
+{
+	key.append((const char*)&word, sizeof(word));
+}
+
+static std::string set_layout_key(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+{
+	std::string key;
+	key.reserve(bindings.size() * 16);
+	for (size_t i = 0; i < bindings.size(); i++)
+	{
+		append_word(key, bindings[i].binding);
+		append_word(key, (uint32_t)bindings[i].descriptorType);
+		append_word(key, bindings[i].descriptorCount);
+		append_word(key, bindings[i].stageFlags);
+	}
+	return key;
+}
+
+static std::string pipeline_layout_key(const PipelineLayoutDesc& desc)
+{
+	std::string key;
+	for (size_t s = 0; s < desc.sets.size(); s++)
+	{
+		append_word(key, (uint32_t)desc.sets[s].size());
+		key += set_layout_key(desc.sets[s]);
+	}
+
+	append_word(key, desc.push_constants.stageFlags);
+	append_word(key, desc.push_constants.offset);
+	append_word(key, desc.push_constants.size);
+	return key;
+}
+
+LayoutCache::LayoutCache()
+{
+	device = VK_NULL_HANDLE;
+	created = 0;
+	reused = 0;
+}
+
+LayoutCache::~LayoutCache()
+{
+	destroy();
+}
+
+void LayoutCache::init(VkDevice device)
+{
+	this->device = device;
+}
+
+void LayoutCache::destroy()
+{
+	std::lock_guard<std::mutex> hold(lock);
+
+	// the pipeline layouts go first, they were made from the set layouts
+	for (std::unordered_map<std::string, PipelineLayoutInfo>::iterator it = pipeline_layouts.begin(); it != pipeline_layouts.end(); ++it)
+		vkDestroyPipelineLayout(device, it->second.layout, NULL);
+	for (std::unordered_map<std::string, VkDescriptorSetLayout>::iterator it = set_layouts.begin(); it != set_layouts.end(); ++it)
+		vkDestroyDescriptorSetLayout(device, it->second, NULL);
+
+	pipeline_layouts.clear();
+	set_layouts.clear();
+}
+
+const PipelineLayoutInfo* LayoutCache::get(const SpirvReflection* const* stages, uint32_t stage_count, std::string& error)
+{
+	PipelineLayoutDesc desc;
+	if (!merge_pipeline_layout(stages, stage_count, desc, error))
+		return NULL;
+	return get(desc, error);
+}
+
+const PipelineLayoutInfo* LayoutCache::get(const PipelineLayoutDesc& desc, std::string& error)
+{
+	std::string key = pipeline_layout_key(desc);
+
+	std::lock_guard<std::mutex> hold(lock);
+	std::unordered_map<std::string, PipelineLayoutInfo>::iterator found = pipeline_layouts.find(key);
+	if (found != pipeline_layouts.end())
+	{
+		reused++;
+		return &found->second;
+	}
+
+	// We hold the lock while we make the layouts, so two threads that
+	// ask for the same new layout at once cannot both make it. Making
+	// a layout is quick, and it only happens once for each layout
+	PipelineLayoutInfo info;
+	info.layout = VK_NULL_HANDLE;
+	for (size_t s = 0; s < desc.sets.size(); s++)
+	{
+		VkDescriptorSetLayout set_layout = find_set_layout(desc.sets[s]);
+		if (set_layout == VK_NULL_HANDLE)
+		{
+			error = "Vulkan could not make a descriptor set layout";
+			return NULL;
+		}
+		info.set_layouts.push_back(set_layout);
+	}
+
+	VkPipelineLayoutCreateInfo layout_info = {};
+	layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layout_info.setLayoutCount = (uint32_t)info.set_layouts.size();
+	layout_info.pSetLayouts = info.set_layouts.data();
+	if (desc.push_constants.size > 0)
+	{
+		layout_info.pushConstantRangeCount = 1;
+		layout_info.pPushConstantRanges = &desc.push_constants;
+	}
+
+	if (vkCreatePipelineLayout(device, &layout_info, NULL, &info.layout) != VK_SUCCESS)
+	{
+		error = "Vulkan could not make a pipeline layout";
+		return NULL;
+	}
+
+	created++;
+	return &(pipeline_layouts[key] = info);
+}
+
+VkDescriptorSetLayout LayoutCache::get_set_layout(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+{
+	std::vector<VkDescriptorSetLayoutBinding> sorted = bindings;
+	std::sort(sorted.begin(), sorted.end(), layout_binding_less);
+
+	std::lock_guard<std::mutex> hold(lock);
+	return find_set_layout(sorted);
+}
+
+VkDescriptorSetLayout LayoutCache::find_set_layout(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+{
+	std::string key = set_layout_key(bindings);
+	std::unordered_map<std::string, VkDescriptorSetLayout>::iterator found = set_layouts.find(key);
+	if (found != set_layouts.end())
+	{
+		reused++;
+		return found->second;
+	}
+
+	VkDescriptorSetLayoutCreateInfo info = {};
+	info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	info.bindingCount = (uint32_t)bindings.size();
+	info.pBindings = bindings.data();
+
+	VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+	if (vkCreateDescriptorSetLayout(device, &info, NULL, &layout) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+
+	created++;
+	set_layouts[key] = layout;
+	return layout;
+}
+
+void LayoutCache::print_stats() const
+{
+	std::lock_guard<std::mutex> hold(lock);
+	if (created == 0)
+		return;
+
+	printf("Made %u descriptor set and pipeline layouts, and handed out the same ones %u more times\n\n",
+		created, reused);
+}
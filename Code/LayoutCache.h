@@ -0,0 +1,114 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "SpirvReflection.h"
+
+// everything a VkPipelineLayout is made from
+struct PipelineLayoutDesc
+{
+	// the bindings of every set, from set 0 to the highest set
+	// that is used. A set that no stage uses has no bindings
+	std::vector<std::vector<VkDescriptorSetLayoutBinding>> sets;
+
+	// one range that covers the push constants of every
+	// stage, with all of their stages. Size 0 if none
+	VkPushConstantRange push_constants;
+};
+
+// Put the reflections of every stage of one pipeline together. A
+// binding that more than one stage uses is only listed once, with all
+// of their stage bits. Returns false, with the reason in "error", if
+// two stages disagree about what a binding is
+bool merge_pipeline_layout(const SpirvReflection* const* stages, uint32_t stage_count,
+	PipelineLayoutDesc& out, std::string& error);
+
+// a pipeline layout, and the set layouts it was made
+// with, which are needed to allocate descriptor sets
+struct PipelineLayoutInfo
+{
+	VkPipelineLayout layout;
+	std::vector<VkDescriptorSetLayout> set_layouts;
+};
+
+// Most pipelines in a program use the same few layouts, so making a new
+// VkDescriptorSetLayout and VkPipelineLayout for every pipeline would
+// give the driver hundreds of copies of the same thing. LayoutCache
+// makes each different layout once, and hands out the same handles to
+// everyone who asks for a layout with the same contents. Because it
+// goes by what the layouts contain, a shader that is reloaded with the
+// same bindings gets the same layout back, and any descriptor sets
+// that were made for it still work.
+//
+// Any thread can ask for layouts. Everything is destroyed together
+// by destroy, so a layout is never destroyed while a pipeline uses it
+class LayoutCache
+{
+public:
+	LayoutCache();
+	~LayoutCache();
+
+	void init(VkDevice device);
+
+	// destroy every layout. The GPU must be done with them
+	void destroy();
+
+	// The layout for a pipeline made from "stages", null (with the reason
+	// in "error") if the stages do not agree, or if Vulkan could not make
+	// it. The pointer stays good until destroy
+	const PipelineLayoutInfo* get(const SpirvReflection* const* stages, uint32_t stage_count, std::string& error);
+	const PipelineLayoutInfo* get(const PipelineLayoutDesc& desc, std::string& error);
+
+	// one set layout on its own
+	VkDescriptorSetLayout get_set_layout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+	void print_stats() const;
+
+private:
+	// the set layout with these bindings (which are in order),
+	// made if we do not have it yet. "lock" must be held
+	VkDescriptorSetLayout find_set_layout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+	VkDevice device;
+
+	// keyed by the contents of each layout, written out as
+	// words (see set_layout_key and pipeline_layout_key)
+	mutable std::mutex lock;
+	std::unordered_map<std::string, VkDescriptorSetLayout> set_layouts;
+	std::unordered_map<std::string, PipelineLayoutInfo> pipeline_layouts;
+
+	// how many layouts we made, and how many times
+	// we gave out a layout that was made already
+	uint32_t created;
+	uint32_t reused;
+};
@@ -1,124 +1,555 @@
-﻿/*
-Copyright 2019
-Original authors: Niko Procopi
-Written under the supervision of David I. Schwartz, Ph.D., and
-supported by a professional development seed grant from the B. Thomas
-Golisano College of Computing & Information Sciences
-(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
-This program is free software: you can redistribute it and/or modify
-it under the terms of the GNU General Public License as published by
-the Free Software Foundation, either version 3 of the License, or (at
-your option) any later version.
-
-This program is distributed in the hope that it will be useful, but
-WITHOUT ANY WARRANTY; without even the implied warranty of
-MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
-General Public License for more details.
-<http://www.gnu.org/licenses/>.
-
-Special Thanks to Exzap from Team Cemu,
-he gave me advice on how to optimize Vulkan
-graphics, he is working on a Wii U emulator
-that utilizes Vulkan, see more at http://cemu.info
-*/
- 
-#include "Demo.h"
-#include "Main.h"
-#include <stdio.h>
-
-// Make this global, so it can be initialized in WinMain
-// and used in WndProc
-Demo* demo;
-
-// keyboard keys
-bool keys[255];
-
-// WndProc is the default function that Windows uses to handle
-// handle a window. We do not need to call this function ourselves,
-// we connect it to the window, and then, the Win32 API calls it 
-// automatically. It gives us window size, what keys are pressed while 
-// using the window, etc
-LRESULT CALLBACK WndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam) 
-{
-	// when the window tries to close
-	// this sets msg.message to WM_QUIT
-	// in the main loop (in WinMain)
-	if (uMsg == WM_CLOSE)
-		PostQuitMessage(0);
-
-	// In the next tutorial, we will add
-	// checks here to let Vulkan know 
-	// when the window is being resized
-
-	// when a key is hit
-	// set a member of the "keys" array to true
-	else if (uMsg == WM_KEYDOWN)
-		keys[(char)wParam] = true;
-
-	// when a key is released
-	// set a member of the "keys" array to false
-	else if (uMsg == WM_KEYUP)
-		keys[(char)wParam] = false;
-
-	// this will be the return statement every time
-	// WndProc is called. Keep in mind, this function is 
-	// called by the Win32 API, it is not called by us
-	// in any of our files of code
-	return (DefWindowProc(hWnd, uMsg, wParam, lParam));
-}
-
-int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR pCmdLine, int nCmdShow) 
-{
-	// First we create demo, the demo's constructor will
-	// do all the initialization for the whole program.
-	// Go to Demo.cpp and look for Demo::Demo to learn
-	// about how this works
-	demo = new Demo();
-
-	// The main loop of our program.
-	// This will repeat infinitely until we tell it to stop
-	while (true)
-	{
-		// MSG is a message that the Window sends to us,
-		// it tell us things like "has the X button in the corner
-		// of the window been it?"
-		MSG msg = {};
-
-		// This function gets a message from the window
-		PeekMessage(&msg, NULL, 0, 0, PM_REMOVE);
-
-		// if the windoww sent us a message that the
-		// X button in the corner of the window has been hit,
-		// or if someone hit the Escape key in the window,
-		// (which is determined in Wnd_Proc), then "break" 
-		// the loop. "break" quites the loop
-		if (msg.message == WM_QUIT || keys[VK_ESCAPE]) break;
-
-		// We are done with the message from this frame,
-		// so now dispatch the message, and allow Win32 to 
-		// look for a new message in the next frame
-		DispatchMessage(&msg);
-
-		// In the next tutorial,
-		// we will call a command
-		// here to draw things
-		// to the window
-	}
-
-	// After the loop is finished, it is time to quit the demo.
-	// This will call demo's deconstructor, and delete everything
-	// that we created in the demo. If we do not delete demo, we 
-	// will have memory leaks. Go to Demo.cpp and look for
-	// Demo::~Demo() to learn about how this works
-	delete demo;
-
-	// This is just a helpful reminder that checks for bugs
-	// when it is time to release software, comment this out
-	printf("\n\nYou just tried to exit the program\n");
-	printf("If any errors occurred while trying to quit,\n");
-	printf("They will show up here\n\n");
-	printf("Click on this black window, and press Spacebar to close it\n\n");
-	system("pause");
-
-	return 0;
-}
+﻿/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+ 
+#include "Demo.h"
+#include "Main.h"
+#include "Capture.h"
+#include "ThreadPool.h"
+#include "FleetIndex.h"
+#include "DriverVersion.h"
+#include "ShaderBatch.h"
+#include "SpirvReflection.h"
+#include "ShaderBundle.h"
+#include "ShaderVariants.h"
+#include "Platform.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <algorithm>
+
+// keyboard keys
+bool keys[256];
+
+// When the program was started by double clicking it, the console
+// closes as soon as we return, so we wait for a key press first
+static void wait_for_key()
+{
+#ifdef _WIN32
+	system("pause");
+#else
+	printf("Press Enter to continue . . .");
+	getchar();
+#endif
+}
+
+// Replay a capture file that was made with "-capture",
+// and print how long every frame took to replay
+int replay_capture(const Options& options)
+{
+	Demo::prepare_console();
+
+	CaptureReplayer replayer;
+	if (!replayer.open(options.replay_path.c_str()))
+	{
+		printf("%s is not a capture file\n", options.replay_path.c_str());
+		if (options.pause_at_exit)
+			wait_for_key();
+		return 1;
+	}
+
+	ThreadPool pool(options.replay_threads);
+	printf("Replaying %s on %u threads\n\n", options.replay_path.c_str(), pool.size());
+
+	replayer.replay(pool);
+	replayer.print_report();
+
+	if (options.pause_at_exit)
+		wait_for_key();
+	return 0;
+}
+
+// Merge inventory files from many computers into one fleet index.
+// Each file is read, added, and forgotten before the next one
+int aggregate_inventories(const Options& options)
+{
+	Demo::prepare_console();
+
+	FleetIndexBuilder builder(options.aggregate_path.c_str());
+	uint32_t files = 0, failed = 0;
+
+	for (size_t i = 0; i < options.inputs.size(); i++)
+	{
+		const std::string& input = options.inputs[i];
+
+		// "@list.txt" is a file with one path on every line,
+		// for when there are too many files for a command line
+		if (input[0] == '@')
+		{
+			FILE* list = fopen(input.c_str() + 1, "r");
+			if (!list)
+			{
+				printf("Could not open the list %s\n", input.c_str() + 1);
+				failed++;
+				continue;
+			}
+
+			char line[4096];
+			while (fgets(line, sizeof(line), list))
+			{
+				line[strcspn(line, "\r\n")] = 0;
+				if (!line[0])
+					continue;
+
+				files++;
+				if (!builder.add_file(line))
+				{
+					printf("Could not read %s\n", line);
+					failed++;
+				}
+			}
+			fclose(list);
+			continue;
+		}
+
+		files++;
+		if (!builder.add_file(input.c_str()))
+		{
+			printf("Could not read %s\n", input.c_str());
+			failed++;
+		}
+	}
+
+	bool written = builder.write();
+	printf("Read %u files (%u failed), %llu GPUs, %s %s\n", files, failed,
+		(unsigned long long)builder.record_count(), written ? "wrote" : "could not write",
+		options.aggregate_path.c_str());
+
+	if (options.pause_at_exit)
+		wait_for_key();
+	return written ? 0 : 1;
+}
+
+// Search a fleet index, and print every GPU that matches
+int query_fleet_index(const Options& options)
+{
+	Demo::prepare_console();
+
+	FleetQuery query;
+	std::string error;
+	FleetIndex index;
+	int result = 1;
+
+	if (!parse_fleet_query(options.query_text.c_str(), query, error))
+	{
+		printf("Bad query: %s\n", error.c_str());
+	}
+	else if (!index.open(options.query_path.c_str()))
+	{
+		printf("%s is not a fleet index\n", options.query_path.c_str());
+	}
+	else
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+		std::vector<const FleetIndexRecord*> matches;
+		index.query(query, matches);
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+		for (size_t i = 0; i < matches.size(); i++)
+		{
+			const FleetIndexRecord* r = matches[i];
+			printf("%s\tgpu %u\t%04x:%04x\tdriver %s\t%s\n", index.string(r->node_offset), r->device_index,
+				r->vendor_id, r->device_id, driver_version_string(r->vendor_id, r->driver_version).c_str(),
+				index.string(r->name_offset));
+		}
+
+		printf("\n%zu of %llu GPUs matched in %.3f ms\n", matches.size(),
+			(unsigned long long)index.size(), elapsed.count());
+		result = 0;
+	}
+
+	if (options.pause_at_exit)
+		wait_for_key();
+	return result;
+}
+
+// Time collect_inventory on every GPU in this computer, first on
+// one thread, then with more and more threads, to see how well
+// probing scales. A computer rarely has more than a couple of GPUs,
+// so this is most useful with the mock driver from the Vulkan SDK
+// (set VK_ICD_FILENAMES to it), which can pretend to have many
+int benchmark_probe(const Options& options)
+{
+	Demo::prepare_console();
+
+	VkInstanceCreateInfo inst_info = {};
+	inst_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+
+	VkInstance inst = VK_NULL_HANDLE;
+	if (vkCreateInstance(&inst_info, NULL, &inst) != VK_SUCCESS)
+	{
+		printf("Could not create a Vulkan instance\n");
+		if (options.pause_at_exit)
+			wait_for_key();
+		return 1;
+	}
+
+	uint32_t gpu_count = 0;
+	vkEnumeratePhysicalDevices(inst, &gpu_count, NULL);
+	std::vector<VkPhysicalDevice> gpus(gpu_count);
+	vkEnumeratePhysicalDevices(inst, &gpu_count, gpus.data());
+
+	uint32_t rounds = options.probe_rounds;
+	printf("Probing %u GPUs, %u rounds each\n\n", gpu_count, rounds);
+	printf("threads\tms per probe\tspeedup\n");
+
+	// the first row is the serial path, with no pool at all
+	double serial_ms = 0;
+	for (uint32_t threads = 1; gpu_count > 0; threads *= 2)
+	{
+		if (threads > gpu_count)
+			threads = gpu_count;
+
+		ThreadPool* pool = threads > 1 ? new ThreadPool(threads) : nullptr;
+		std::vector<DeviceInventory> devices;
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for (uint32_t r = 0; r < rounds; r++)
+			collect_inventory(gpus.data(), gpu_count, devices, pool);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+		double ms = elapsed.count() / rounds;
+		if (threads == 1)
+			serial_ms = ms;
+		printf("%u\t%.3f\t\t%.2fx\n", threads, ms, serial_ms / ms);
+
+		delete pool;
+		if (threads == gpu_count)
+			break;
+	}
+
+	vkDestroyInstance(inst, NULL);
+
+	if (options.pause_at_exit)
+		wait_for_key();
+	return 0;
+}
+
+// true if the shader has a "layout(constant_id = N)" constant,
+// or takes a workgroup size from one ("local_size_x_id = N")
+static bool has_spec_constant(const SpirvReflection& reflection, uint32_t constant_id)
+{
+	for (size_t i = 0; i < reflection.spec_constants.size(); i++)
+	{
+		if (reflection.spec_constants[i].constant_id == constant_id)
+			return true;
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		if (reflection.workgroup_size_spec_id[i] == constant_id)
+			return true;
+	}
+	return false;
+}
+
+// Compile every GLSL file on the command line into a .spv file
+// next to it, on every core. The shader cache skips shaders that
+// did not change (or that include a file that changed), and the
+// shaders given with -critical-shader are started first
+int compile_shaders(const Options& options)
+{
+	Demo::prepare_console();
+
+	ShaderSource settings;
+	if (!apply_shader_options(options, settings))
+	{
+		if (options.pause_at_exit)
+			wait_for_key();
+		return 1;
+	}
+
+	ShaderCache cache;
+	if (!cache.open(options.shader_cache_path.c_str()))
+		printf("Could not use the shader cache in %s, compiling everything\n\n", options.shader_cache_path.c_str());
+
+	// a critical shader that is not in the list of inputs is added to it
+	std::vector<std::string> paths = options.inputs;
+	for (size_t i = 0; i < options.critical_shaders.size(); i++)
+	{
+		if (std::find(paths.begin(), paths.end(), options.critical_shaders[i]) == paths.end())
+			paths.push_back(options.critical_shaders[i]);
+	}
+
+	ShaderBatch batch(&cache, options.shader_include_dirs);
+	uint32_t unreadable = 0;
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		ShaderSource source = settings;
+		if (!load_shader_source(paths[i].c_str(), source))
+		{
+			printf("Could not read %s\n", paths[i].c_str());
+			unreadable++;
+			continue;
+		}
+
+		bool critical = std::find(options.critical_shaders.begin(), options.critical_shaders.end(),
+			paths[i]) != options.critical_shaders.end();
+
+		// A shader with variants (see shader_variants.txt) is compiled
+		// once for every combination of its macros, each into a file
+		// of its own, like reduce.comp.SUBGROUP_SIZE-32.UNROLL-4.spv
+		const ShaderVariantShader* variants = find_shader_variants(paths[i]);
+		if (!variants)
+		{
+			batch.add(source, critical ? 1 : 0, paths[i] + ".spv", std::string());
+			continue;
+		}
+
+		for (uint32_t build = 0; build < variants->build_count; build++)
+		{
+			std::vector<std::pair<std::string, std::string>> macros;
+			shader_variant_macros(*variants, build, macros);
+
+			ShaderSource variant = source;
+			std::string output_path = paths[i];
+			std::string label;
+			for (size_t m = 0; m < macros.size(); m++)
+			{
+				variant.macros.push_back(macros[m]);
+				output_path += "." + macros[m].first + "-" + macros[m].second;
+				label += (m ? " " : "") + macros[m].first + "=" + macros[m].second;
+			}
+			batch.add(variant, critical ? 1 : 0, output_path + ".spv", label);
+		}
+	}
+
+	ThreadPool pool(options.replay_threads);
+	batch.run(pool);
+	batch.print_report();
+	cache.save();
+
+	// the stage of each shader, for the bundle, comes
+	// from its SPIR-V, the same way -reflect finds it
+	ShaderBundleWriter bundle;
+	const std::vector<ShaderJob>& results = batch.results();
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const ShaderOutput& output = results[i].output;
+		if (!output.ok)
+			continue;
+
+		SpirvReflection reflection;
+		std::string error;
+		if (!reflect_spirv(output.spirv.data(), output.spirv.size(), reflection, error))
+		{
+			printf("%s: %s\n", results[i].source.name.c_str(), error.c_str());
+			continue;
+		}
+
+		if (options.reflect_shaders)
+			print_spirv_reflection(results[i].source.name.c_str(), reflection);
+
+		// a spec axis that the shader does not have would
+		// be given to the pipeline, and quietly do nothing
+		const ShaderVariantShader* variants = find_shader_variants(results[i].source.name);
+		for (uint32_t a = 0; variants && a < variants->axis_count; a++)
+		{
+			const ShaderVariantAxis& axis = shader_variant_axis(*variants, a);
+			if (axis.kind == SHADER_AXIS_SPEC && !has_spec_constant(reflection, axis.spec_id))
+			{
+				printf("%s: the axis %s is constant_id %u, which the shader does not have\n",
+					results[i].source.name.c_str(), shader_variant_string(axis.name), axis.spec_id);
+			}
+		}
+
+		bundle.add(results[i].source.name, shader_permutation(results[i].source.macros),
+			reflection.stage, output.spirv);
+	}
+	if (options.reflect_shaders)
+		printf("\n");
+
+	if (!options.shader_bundle_path.empty())
+	{
+		if (bundle.write(options.shader_bundle_path.c_str()))
+			printf("Packed %u shaders (%u different modules) into %s\n\n", bundle.shader_count(),
+				bundle.module_count(), options.shader_bundle_path.c_str());
+		else
+			printf("Could not write %s\n\n", options.shader_bundle_path.c_str());
+	}
+
+	if (options.pause_at_exit)
+		wait_for_key();
+	return batch.failed() || unreadable ? 1 : 0;
+}
+
+// Measure how much CPU the main loop uses while nothing happens.
+// First we spin the way the loop used to, asking for messages
+// over and over without ever waiting (PLATFORM_NO_WAIT), and then
+// we sleep in wait_event the way the main loop does now
+static void benchmark_idle_loop(Platform* platform, uint32_t seconds)
+{
+	printf("Measuring the idle main loop, %u seconds each way\n", seconds);
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		bool spin = pass == 0;
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		double cpu_start = process_cpu_seconds();
+		uint64_t loops = 0;
+
+		while (true)
+		{
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+			double left_ms = seconds * 1000.0 - elapsed.count();
+			if (left_ms <= 0)
+				break;
+
+			PlatformEvent event;
+			platform->wait_event(event, spin ? PLATFORM_NO_WAIT : (int32_t)left_ms + 1);
+			loops++;
+		}
+
+		std::chrono::duration<double> wall = std::chrono::high_resolution_clock::now() - start;
+		double cpu = process_cpu_seconds() - cpu_start;
+		printf("  %-10s %6.1f%% of one core, %llu loop passes\n", spin ? "spinning" : "waiting",
+			100.0 * cpu / wall.count(), (unsigned long long)loops);
+	}
+	printf("\n");
+}
+
+// Everything the program does, on every operating system
+static int run(const Options& options)
+{
+	// When we are asked to replay a capture, we do
+	// not run the demo at all
+	if (!options.replay_path.empty())
+		return replay_capture(options);
+
+	// the fleet tools do not need the demo either
+	if (!options.aggregate_path.empty())
+		return aggregate_inventories(options);
+	if (!options.query_path.empty())
+		return query_fleet_index(options);
+	if (options.probe_rounds > 0)
+		return benchmark_probe(options);
+
+	// neither does compiling shaders
+	if (options.compile_shaders)
+		return compile_shaders(options);
+
+	// First we create demo, the demo's constructor will
+	// do all the initialization for the whole program.
+	// Go to Demo.cpp and look for Demo::Demo to learn
+	// about how this works
+	Demo* demo = new Demo(options);
+	Platform* platform = demo->platform;
+
+	if (options.idle_seconds > 0)
+	{
+		benchmark_idle_loop(platform, options.idle_seconds);
+		delete demo;
+		if (options.pause_at_exit)
+			wait_for_key();
+		return 0;
+	}
+
+	// The main loop of our program.
+	// This will repeat until we tell it to stop
+	bool running = true;
+	while (running)
+	{
+		// wait_event sleeps until the window has something
+		// to tell us, like "the X button in the corner of the
+		// window has been hit". The old loop asked Windows for
+		// a message over and over without ever sleeping, which
+		// kept one CPU core busy doing nothing at all.
+		// Drawing happens on the render thread, so this thread
+		// never has anything to do until the window needs us
+		PlatformEvent event;
+		if (!platform->wait_event(event, PLATFORM_WAIT_FOREVER))
+			continue;
+
+		// if the X button in the corner of the window has
+		// been hit, or if someone hit the Escape key in the
+		// window, then we stop the loop
+		if (event.type == PLATFORM_EVENT_QUIT)
+			running = false;
+
+		// when a key is hit, or released, remember it
+		// in the "keys" array
+		else if (event.type == PLATFORM_EVENT_KEY_DOWN || event.type == PLATFORM_EVENT_KEY_UP)
+		{
+			keys[event.key & 0xFF] = event.type == PLATFORM_EVENT_KEY_DOWN;
+			if (keys[PLATFORM_KEY_ESCAPE])
+				running = false;
+		}
+
+		// Everything else that the window tells us (keys, new
+		// sizes) is passed on to the render thread, which owns
+		// everything that depends on it. This never waits
+		if (event.type != PLATFORM_EVENT_WAKE)
+			demo->renderer.post(event);
+	}
+
+	// After the loop is finished, it is time to quit the demo.
+	// This will call demo's deconstructor, and delete everything
+	// that we created in the demo. If we do not delete demo, we 
+	// will have memory leaks. Go to Demo.cpp and look for
+	// Demo::~Demo() to learn about how this works
+	delete demo;
+
+	// This is just a helpful reminder that checks for bugs
+	// when it is time to release software, comment this out
+	printf("\n\nYou just tried to exit the program\n");
+	printf("If any errors occurred while trying to quit,\n");
+	printf("They will show up here\n\n");
+	printf("Click on this black window, and press Spacebar to close it\n\n");
+	wait_for_key();
+
+	return 0;
+}
+
+#ifdef _WIN32
+
+int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR pCmdLine, int nCmdShow) 
+{
+	// Read the flags that were given on the command line,
+	// look in Options.h to see what they are
+	return run(parse_options(pCmdLine));
+}
+
+#else
+
+int main(int argc, char** argv)
+{
+	// Everywhere else, the command line comes to us already split
+	// into words, so we put it back together the way Windows gives
+	// it to WinMain, with quotes around words that have spaces
+	std::string command_line;
+	for (int i = 1; i < argc; i++)
+	{
+		if (i > 1)
+			command_line += ' ';
+		if (strchr(argv[i], ' '))
+			command_line += std::string("\"") + argv[i] + "\"";
+		else
+			command_line += argv[i];
+	}
+
+	return run(parse_options(command_line.c_str()));
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// MappedFile gives us read-only access to a whole file
+// through the virtual memory system, rather than through
+// fread. The operating system pages the file in on demand,
+// so opening a file that is hundreds of megabytes is instant,
+// and we can point directly into the file's bytes without
+// copying them into a buffer first
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	// Map the file at "path". Returns false if the file
+	// could not be opened, or if it is empty
+	bool open(const char* path);
+
+	// Unmap the file. This is called by the destructor,
+	// so calling it yourself is optional
+	void close();
+
+	const uint8_t* data() const { return bytes; }
+	size_t size() const { return length; }
+	bool is_open() const { return bytes != nullptr; }
+
+private:
+	// copying a mapping would unmap it twice
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+	const uint8_t* bytes;
+	size_t length;
+
+#ifdef _WIN32
+	void* file_handle;
+	void* mapping_handle;
+#else
+	int fd;
+#endif
+};
@@ -0,0 +1,164 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "Options.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+Options::Options()
+{
+	debug_log_path = "debug_messages.jsonl";
+	profile_device = 0;
+	pause_at_exit = true;
+	replay_threads = 0;
+	probe_rounds = 0;
+	idle_seconds = 0;
+	present_policy = "latency";
+	pace = false;
+	frames_in_flight = 0;
+	pipeline_cache_path = "pipeline_cache.bin";
+	compile_shaders = false;
+	watch_shaders = false;
+	shader_cache_path = "shader_cache";
+	shader_optimization = "performance";
+	strip_shaders = false;
+	reflect_shaders = false;
+}
+
+std::vector<std::string> split_command_line(const char* command_line)
+{
+	std::vector<std::string> words;
+	if (!command_line)
+		return words;
+
+	const char* c = command_line;
+	while (*c)
+	{
+		// skip the spaces between words
+		while (*c == ' ' || *c == '\t')
+			c++;
+		if (!*c)
+			break;
+
+		// a word that starts with a quote continues
+		// until the closing quote, so that paths with
+		// spaces in them stay in one piece
+		std::string word;
+		if (*c == '"')
+		{
+			c++;
+			while (*c && *c != '"')
+				word += *c++;
+			if (*c == '"')
+				c++;
+		}
+		else
+		{
+			while (*c && *c != ' ' && *c != '\t')
+				word += *c++;
+		}
+
+		words.push_back(word);
+	}
+
+	return words;
+}
+
+Options parse_options(const char* command_line)
+{
+	Options options;
+	std::vector<std::string> words = split_command_line(command_line);
+
+	for (size_t i = 0; i < words.size(); i++)
+	{
+		// most flags take one value after them
+		bool has_value = i + 1 < words.size();
+		const std::string& flag = words[i];
+
+		if (flag == "-capture" && has_value)
+			options.capture_path = words[++i];
+		else if (flag == "-replay" && has_value)
+			options.replay_path = words[++i];
+		else if (flag == "-log" && has_value)
+			options.debug_log_path = words[++i];
+		else if (flag == "-inventory" && has_value)
+			options.inventory_path = words[++i];
+		else if (flag == "-profile" && has_value)
+			options.profile_path = words[++i];
+		else if (flag == "-profile-device" && has_value)
+			options.profile_device = (uint32_t)strtoul(words[++i].c_str(), NULL, 10);
+		else if (flag == "-driver-rules" && has_value)
+			options.driver_rules_path = words[++i];
+		else if (flag == "-aggregate" && has_value)
+			options.aggregate_path = words[++i];
+		else if (flag == "-query" && i + 2 < words.size())
+		{
+			options.query_path = words[++i];
+			options.query_text = words[++i];
+		}
+		else if (flag == "-probe-benchmark" && has_value)
+			options.probe_rounds = (uint32_t)strtoul(words[++i].c_str(), NULL, 10);
+		else if (flag == "-platform" && has_value)
+			options.platform_name = words[++i];
+		else if (flag == "-idle-benchmark" && has_value)
+			options.idle_seconds = (uint32_t)strtoul(words[++i].c_str(), NULL, 10);
+		else if (flag == "-present" && has_value)
+			options.present_policy = words[++i];
+		else if (flag == "-frames" && has_value)
+			options.frames_in_flight = (uint32_t)strtoul(words[++i].c_str(), NULL, 10);
+		else if (flag == "-pace")
+			options.pace = true;
+		else if (flag == "-pipeline-cache" && has_value)
+			options.pipeline_cache_path = words[++i];
+		else if (flag == "-compile-shaders")
+			options.compile_shaders = true;
+		else if (flag == "-watch-shaders")
+			options.watch_shaders = true;
+		else if (flag == "-shader-cache" && has_value)
+			options.shader_cache_path = words[++i];
+		else if (flag == "-define" && has_value)
+			options.shader_defines.push_back(words[++i]);
+		else if (flag == "-include-dir" && has_value)
+			options.shader_include_dirs.push_back(words[++i]);
+		else if (flag == "-critical-shader" && has_value)
+			options.critical_shaders.push_back(words[++i]);
+		else if (flag == "-shader-opt" && has_value)
+			options.shader_optimization = words[++i];
+		else if (flag == "-shader-bundle" && has_value)
+			options.shader_bundle_path = words[++i];
+		else if (flag == "-strip-shaders")
+			options.strip_shaders = true;
+		else if (flag == "-reflect")
+			options.reflect_shaders = true;
+		else if (flag == "-nopause")
+			options.pause_at_exit = false;
+		else if (flag == "-threads" && has_value)
+			options.replay_threads = (uint32_t)strtoul(words[++i].c_str(), NULL, 10);
+		else if (flag[0] != '-')
+			options.inputs.push_back(flag);
+	}
+
+	return options;
+}
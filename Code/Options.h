@@ -0,0 +1,180 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Options holds everything that can be changed from
+// the command line. WinMain gives us the command line
+// as one long string (main() on Linux rebuilds one), so
+// parse_options splits it into words (respecting
+// "quoted paths") and reads each flag.
+// Anything we do not recognize is ignored.
+struct Options
+{
+	// -capture <file>
+	// record every Vulkan call the demo makes into a capture file
+	std::string capture_path;
+
+	// -replay <file>
+	// replay a capture file instead of running the demo
+	std::string replay_path;
+
+	// -log <file>
+	// where validation messages are written, one JSON object per line
+	std::string debug_log_path;
+
+	// -inventory <file>
+	// write everything we know about every GPU into a file,
+	// as binary if the name ends in ".bin", otherwise as JSON
+	std::string inventory_path;
+
+	// -profile <file>
+	// pretend that a GPU from an inventory file is the
+	// GPU in this computer
+	std::string profile_path;
+
+	// -profile-device <n>
+	// which GPU in the profile to use, the first one by default
+	uint32_t profile_device;
+
+	// -driver-rules <file>
+	// more rules about bad GPU and driver combinations,
+	// on top of the built in ones (see DriverRules.h)
+	std::string driver_rules_path;
+
+	// -aggregate <index file> <inventory files...>
+	// merge many inventory files into one fleet index. An input
+	// written as @list.txt means "every path listed in list.txt"
+	std::string aggregate_path;
+
+	// -query <index file> "<query>"
+	// search a fleet index, see FleetIndex.h for the query terms
+	std::string query_path;
+	std::string query_text;
+
+	// -probe-benchmark <rounds>
+	// time how long it takes to probe every GPU, serially and
+	// in parallel, instead of running the demo
+	uint32_t probe_rounds;
+
+	// -platform <name>
+	// "win32", "xcb", or "null" (no window at all, Ctrl+C
+	// quits), see Platform.h. Empty means the usual one
+	std::string platform_name;
+
+	// -idle-benchmark <seconds>
+	// measure how much CPU the main loop uses while
+	// nothing is happening, then quit
+	uint32_t idle_seconds;
+
+	// -present <policy>
+	// "latency" (the default), "immediate", "power", or "relaxed",
+	// what we care about most when we show a frame (see Swapchain.h)
+	std::string present_policy;
+
+	// -frames <n>
+	// how many frames the CPU can get ahead of the GPU, from 1 (the
+	// least latency) to 8. Zero means the usual (FRAME_LAG in Demo.h)
+	uint32_t frames_in_flight;
+
+	// -pace
+	// show frames at an even pace that the GPU can keep up
+	// with, instead of as soon as they are ready (see FramePacer.h)
+	bool pace;
+
+	// -pipeline-cache <file>
+	// where the pipeline cache is kept between runs (see PipelineCache.h),
+	// "pipeline_cache.bin" if this is not given
+	std::string pipeline_cache_path;
+
+	// -compile-shaders <files...>
+	// compile GLSL files into SPIR-V (each next to its GLSL, with
+	// ".spv" on the end) instead of running the demo
+	bool compile_shaders;
+
+	// -watch-shaders <files...>
+	// compile GLSL files in the background while the demo runs,
+	// and again every time one of them (or a file that one of them
+	// includes) is saved (see ShaderReloader.h)
+	bool watch_shaders;
+
+	// -shader-cache <folder>
+	// where compiled shaders are kept, so that a shader is only
+	// compiled again when it changes (see ShaderCache.h)
+	std::string shader_cache_path;
+
+	// -define NAME or -define NAME=VALUE, can be given many times
+	std::vector<std::string> shader_defines;
+
+	// -include-dir <folder>, can be given many times
+	std::vector<std::string> shader_include_dirs;
+
+	// -critical-shader <file>, can be given many times
+	// compiled before every other shader (see ShaderBatch.h)
+	std::vector<std::string> critical_shaders;
+
+	// -shader-opt <level>
+	// "zero", "size", or "performance" (the default)
+	std::string shader_optimization;
+
+	// -shader-bundle <file>
+	// -compile-shaders packs every shader into this file, and the
+	// demo makes its shader modules from it (see ShaderBundle.h)
+	std::string shader_bundle_path;
+
+	// -strip-shaders
+	// take the debug info out of compiled shaders, and give
+	// them canonical IDs (see SpirvRemap.h)
+	bool strip_shaders;
+
+	// -reflect
+	// print the bindings, push constants, and other inputs that
+	// -compile-shaders finds in each shader (see SpirvReflection.h)
+	bool reflect_shaders;
+
+	// -nopause
+	// do not wait for a key press before closing the console
+	// at the end of -replay, -aggregate, -query, -probe-benchmark,
+	// or -idle-benchmark
+	bool pause_at_exit;
+
+	// every word on the command line that is not a flag
+	std::vector<std::string> inputs;
+
+	// -threads <n>
+	// number of threads for -replay and -compile-shaders,
+	// zero means one per CPU core
+	uint32_t replay_threads;
+
+	Options();
+};
+
+// split a command line into words
+std::vector<std::string> split_command_line(const char* command_line);
+
+Options parse_options(const char* command_line);
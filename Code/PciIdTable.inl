@@ -0,0 +1,135 @@
+// Generated by gen_pci_ids.py from pci_ids.txt, do not edit by hand.
+
+#define PCI_DEVICE_COUNT 41
+#define PCI_BUCKET_COUNT 10
+#define PCI_VENDOR_COUNT 9
+
+static const uint32_t pci_bucket_seeds[PCI_BUCKET_COUNT] =
+{
+	118, 5, 20, 21, 1, 105, 130, 22,
+	133, 859,
+};
+
+static const PciDeviceEntry pci_devices[PCI_DEVICE_COUNT] =
+{
+	{ 0x8086, 0x1912, 1, 17, 90 }, // HD Graphics 530
+	{ 0x10DE, 0x1F08, 22, 39, 75 }, // GeForce RTX 2060
+	{ 0x10DE, 0x1DB1, 46, 67, 70 }, // Tesla V100 SXM2 16GB
+	{ 0x10DE, 0x1EB8, 73, 39, 75 }, // Tesla T4
+	{ 0x10DE, 0x1E87, 82, 39, 75 }, // GeForce RTX 2080
+	{ 0x10DE, 0x1DB4, 99, 67, 70 }, // Tesla V100 PCIe 16GB
+	{ 0x10005, 0x0000, 120, 151, 0 }, // llvmpipe (software rasterizer)
+	{ 0x1002, 0x15DD, 160, 195, 902 }, // Radeon Vega Graphics (Raven Ridge)
+	{ 0x1002, 0x687F, 201, 195, 900 }, // Radeon RX Vega 56/64
+	{ 0x1002, 0x744C, 222, 237, 1100 }, // Radeon RX 7900
+	{ 0x8086, 0x9A49, 244, 274, 120 }, // Iris Xe Graphics (Tiger Lake)
+	{ 0x10DE, 0x2204, 280, 297, 86 }, // GeForce RTX 3090
+	{ 0x10DE, 0x1C82, 304, 324, 61 }, // GeForce GTX 1050 Ti
+	{ 0x10DE, 0x1B80, 331, 324, 61 }, // GeForce GTX 1080
+	{ 0x8086, 0x3E92, 348, 365, 95 }, // UHD Graphics 630
+	{ 0x1002, 0x67DF, 372, 398, 803 }, // Radeon RX 470/480/570/580
+	{ 0x10DE, 0x20B0, 404, 297, 80 }, // A100 SXM4 40GB
+	{ 0x8086, 0x5912, 419, 365, 95 }, // HD Graphics 630
+	{ 0x1002, 0x73BF, 435, 455, 1030 }, // Radeon RX 6800/6900
+	{ 0x8086, 0x9BC5, 462, 365, 95 }, // UHD Graphics 630 (Comet Lake)
+	{ 0x1002, 0x731F, 492, 512, 1010 }, // Radeon RX 5600/5700
+	{ 0x10DE, 0x2484, 519, 297, 86 }, // GeForce RTX 3070
+	{ 0x10DE, 0x1E07, 536, 39, 75 }, // GeForce RTX 2080 Ti
+	{ 0x10DE, 0x2206, 556, 297, 86 }, // GeForce RTX 3080
+	{ 0x1002, 0x73DF, 573, 455, 1031 }, // Radeon RX 6700
+	{ 0x10DE, 0x20F1, 588, 297, 80 }, // A100 PCIe 40GB
+	{ 0x8086, 0x56A0, 603, 612, 125 }, // Arc A770
+	{ 0x8086, 0x3E9B, 619, 365, 95 }, // UHD Graphics 630 (Mobile)
+	{ 0x1002, 0x738C, 645, 660, 908 }, // Instinct MI100
+	{ 0x10DE, 0x13C2, 667, 683, 52 }, // GeForce GTX 970
+	{ 0x10DE, 0x1E04, 536, 39, 75 }, // GeForce RTX 2080 Ti
+	{ 0x10DE, 0x1B06, 691, 324, 61 }, // GeForce GTX 1080 Ti
+	{ 0x10DE, 0x1C03, 711, 324, 61 }, // GeForce GTX 1060 6GB
+	{ 0x8086, 0x8A52, 732, 762, 110 }, // Iris Plus Graphics (Ice Lake)
+	{ 0x1AE0, 0xC0DE, 768, 800, 0 }, // SwiftShader (software renderer)
+	{ 0x8086, 0x4680, 812, 274, 120 }, // UHD Graphics 770
+	{ 0x10DE, 0x1B81, 829, 324, 61 }, // GeForce GTX 1070
+	{ 0x10DE, 0x2684, 846, 863, 89 }, // GeForce RTX 4090
+	{ 0x1002, 0x66AF, 876, 195, 906 }, // Radeon VII
+	{ 0x10DE, 0x17C8, 887, 683, 52 }, // GeForce GTX 980 Ti
+	{ 0x10DE, 0x2503, 906, 297, 86 }, // GeForce RTX 3060
+};
+
+static const PciVendorEntry pci_vendors[PCI_VENDOR_COUNT] =
+{
+	{ 0x1002, 923 }, // AMD
+	{ 0x1010, 927 }, // Imagination
+	{ 0x106B, 939 }, // Apple
+	{ 0x10DE, 945 }, // NVIDIA
+	{ 0x13B5, 952 }, // ARM
+	{ 0x1AE0, 956 }, // Google
+	{ 0x5143, 963 }, // Qualcomm
+	{ 0x8086, 972 }, // Intel
+	{ 0x10005, 978 }, // Mesa
+};
+
+static const char pci_strings[983] =
+{
+	0x00, 0x48, 0x44, 0x20, 0x47, 0x72, 0x61, 0x70, 0x68, 0x69, 0x63, 0x73, 0x20, 0x35, 0x33, 0x30,
+	0x00, 0x47, 0x65, 0x6E, 0x39, 0x00, 0x47, 0x65, 0x46, 0x6F, 0x72, 0x63, 0x65, 0x20, 0x52, 0x54,
+	0x58, 0x20, 0x32, 0x30, 0x36, 0x30, 0x00, 0x54, 0x75, 0x72, 0x69, 0x6E, 0x67, 0x00, 0x54, 0x65,
+	0x73, 0x6C, 0x61, 0x20, 0x56, 0x31, 0x30, 0x30, 0x20, 0x53, 0x58, 0x4D, 0x32, 0x20, 0x31, 0x36,
+	0x47, 0x42, 0x00, 0x56, 0x6F, 0x6C, 0x74, 0x61, 0x00, 0x54, 0x65, 0x73, 0x6C, 0x61, 0x20, 0x54,
+	0x34, 0x00, 0x47, 0x65, 0x46, 0x6F, 0x72, 0x63, 0x65, 0x20, 0x52, 0x54, 0x58, 0x20, 0x32, 0x30,
+	0x38, 0x30, 0x00, 0x54, 0x65, 0x73, 0x6C, 0x61, 0x20, 0x56, 0x31, 0x30, 0x30, 0x20, 0x50, 0x43,
+	0x49, 0x65, 0x20, 0x31, 0x36, 0x47, 0x42, 0x00, 0x6C, 0x6C, 0x76, 0x6D, 0x70, 0x69, 0x70, 0x65,
+	0x20, 0x28, 0x73, 0x6F, 0x66, 0x74, 0x77, 0x61, 0x72, 0x65, 0x20, 0x72, 0x61, 0x73, 0x74, 0x65,
+	0x72, 0x69, 0x7A, 0x65, 0x72, 0x29, 0x00, 0x6C, 0x6C, 0x76, 0x6D, 0x70, 0x69, 0x70, 0x65, 0x00,
+	0x52, 0x61, 0x64, 0x65, 0x6F, 0x6E, 0x20, 0x56, 0x65, 0x67, 0x61, 0x20, 0x47, 0x72, 0x61, 0x70,
+	0x68, 0x69, 0x63, 0x73, 0x20, 0x28, 0x52, 0x61, 0x76, 0x65, 0x6E, 0x20, 0x52, 0x69, 0x64, 0x67,
+	0x65, 0x29, 0x00, 0x47, 0x43, 0x4E, 0x20, 0x35, 0x00, 0x52, 0x61, 0x64, 0x65, 0x6F, 0x6E, 0x20,
+	0x52, 0x58, 0x20, 0x56, 0x65, 0x67, 0x61, 0x20, 0x35, 0x36, 0x2F, 0x36, 0x34, 0x00, 0x52, 0x61,
+	0x64, 0x65, 0x6F, 0x6E, 0x20, 0x52, 0x58, 0x20, 0x37, 0x39, 0x30, 0x30, 0x00, 0x52, 0x44, 0x4E,
+	0x41, 0x20, 0x33, 0x00, 0x49, 0x72, 0x69, 0x73, 0x20, 0x58, 0x65, 0x20, 0x47, 0x72, 0x61, 0x70,
+	0x68, 0x69, 0x63, 0x73, 0x20, 0x28, 0x54, 0x69, 0x67, 0x65, 0x72, 0x20, 0x4C, 0x61, 0x6B, 0x65,
+	0x29, 0x00, 0x58, 0x65, 0x2D, 0x4C, 0x50, 0x00, 0x47, 0x65, 0x46, 0x6F, 0x72, 0x63, 0x65, 0x20,
+	0x52, 0x54, 0x58, 0x20, 0x33, 0x30, 0x39, 0x30, 0x00, 0x41, 0x6D, 0x70, 0x65, 0x72, 0x65, 0x00,
+	0x47, 0x65, 0x46, 0x6F, 0x72, 0x63, 0x65, 0x20, 0x47, 0x54, 0x58, 0x20, 0x31, 0x30, 0x35, 0x30,
+	0x20, 0x54, 0x69, 0x00, 0x50, 0x61, 0x73, 0x63, 0x61, 0x6C, 0x00, 0x47, 0x65, 0x46, 0x6F, 0x72,
+	0x63, 0x65, 0x20, 0x47, 0x54, 0x58, 0x20, 0x31, 0x30, 0x38, 0x30, 0x00, 0x55, 0x48, 0x44, 0x20,
+	0x47, 0x72, 0x61, 0x70, 0x68, 0x69, 0x63, 0x73, 0x20, 0x36, 0x33, 0x30, 0x00, 0x47, 0x65, 0x6E,
+	0x39, 0x2E, 0x35, 0x00, 0x52, 0x61, 0x64, 0x65, 0x6F, 0x6E, 0x20, 0x52, 0x58, 0x20, 0x34, 0x37,
+	0x30, 0x2F, 0x34, 0x38, 0x30, 0x2F, 0x35, 0x37, 0x30, 0x2F, 0x35, 0x38, 0x30, 0x00, 0x47, 0x43,
+	0x4E, 0x20, 0x34, 0x00, 0x41, 0x31, 0x30, 0x30, 0x20, 0x53, 0x58, 0x4D, 0x34, 0x20, 0x34, 0x30,
+	0x47, 0x42, 0x00, 0x48, 0x44, 0x20, 0x47, 0x72, 0x61, 0x70, 0x68, 0x69, 0x63, 0x73, 0x20, 0x36,
+	0x33, 0x30, 0x00, 0x52, 0x61, 0x64, 0x65, 0x6F, 0x6E, 0x20, 0x52, 0x58, 0x20, 0x36, 0x38, 0x30,
+	0x30, 0x2F, 0x36, 0x39, 0x30, 0x30, 0x00, 0x52, 0x44, 0x4E, 0x41, 0x20, 0x32, 0x00, 0x55, 0x48,
+	0x44, 0x20, 0x47, 0x72, 0x61, 0x70, 0x68, 0x69, 0x63, 0x73, 0x20, 0x36, 0x33, 0x30, 0x20, 0x28,
+	0x43, 0x6F, 0x6D, 0x65, 0x74, 0x20, 0x4C, 0x61, 0x6B, 0x65, 0x29, 0x00, 0x52, 0x61, 0x64, 0x65,
+	0x6F, 0x6E, 0x20, 0x52, 0x58, 0x20, 0x35, 0x36, 0x30, 0x30, 0x2F, 0x35, 0x37, 0x30, 0x30, 0x00,
+	0x52, 0x44, 0x4E, 0x41, 0x20, 0x31, 0x00, 0x47, 0x65, 0x46, 0x6F, 0x72, 0x63, 0x65, 0x20, 0x52,
+	0x54, 0x58, 0x20, 0x33, 0x30, 0x37, 0x30, 0x00, 0x47, 0x65, 0x46, 0x6F, 0x72, 0x63, 0x65, 0x20,
+	0x52, 0x54, 0x58, 0x20, 0x32, 0x30, 0x38, 0x30, 0x20, 0x54, 0x69, 0x00, 0x47, 0x65, 0x46, 0x6F,
+	0x72, 0x63, 0x65, 0x20, 0x52, 0x54, 0x58, 0x20, 0x33, 0x30, 0x38, 0x30, 0x00, 0x52, 0x61, 0x64,
+	0x65, 0x6F, 0x6E, 0x20, 0x52, 0x58, 0x20, 0x36, 0x37, 0x30, 0x30, 0x00, 0x41, 0x31, 0x30, 0x30,
+	0x20, 0x50, 0x43, 0x49, 0x65, 0x20, 0x34, 0x30, 0x47, 0x42, 0x00, 0x41, 0x72, 0x63, 0x20, 0x41,
+	0x37, 0x37, 0x30, 0x00, 0x58, 0x65, 0x2D, 0x48, 0x50, 0x47, 0x00, 0x55, 0x48, 0x44, 0x20, 0x47,
+	0x72, 0x61, 0x70, 0x68, 0x69, 0x63, 0x73, 0x20, 0x36, 0x33, 0x30, 0x20, 0x28, 0x4D, 0x6F, 0x62,
+	0x69, 0x6C, 0x65, 0x29, 0x00, 0x49, 0x6E, 0x73, 0x74, 0x69, 0x6E, 0x63, 0x74, 0x20, 0x4D, 0x49,
+	0x31, 0x30, 0x30, 0x00, 0x43, 0x44, 0x4E, 0x41, 0x20, 0x31, 0x00, 0x47, 0x65, 0x46, 0x6F, 0x72,
+	0x63, 0x65, 0x20, 0x47, 0x54, 0x58, 0x20, 0x39, 0x37, 0x30, 0x00, 0x4D, 0x61, 0x78, 0x77, 0x65,
+	0x6C, 0x6C, 0x00, 0x47, 0x65, 0x46, 0x6F, 0x72, 0x63, 0x65, 0x20, 0x47, 0x54, 0x58, 0x20, 0x31,
+	0x30, 0x38, 0x30, 0x20, 0x54, 0x69, 0x00, 0x47, 0x65, 0x46, 0x6F, 0x72, 0x63, 0x65, 0x20, 0x47,
+	0x54, 0x58, 0x20, 0x31, 0x30, 0x36, 0x30, 0x20, 0x36, 0x47, 0x42, 0x00, 0x49, 0x72, 0x69, 0x73,
+	0x20, 0x50, 0x6C, 0x75, 0x73, 0x20, 0x47, 0x72, 0x61, 0x70, 0x68, 0x69, 0x63, 0x73, 0x20, 0x28,
+	0x49, 0x63, 0x65, 0x20, 0x4C, 0x61, 0x6B, 0x65, 0x29, 0x00, 0x47, 0x65, 0x6E, 0x31, 0x31, 0x00,
+	0x53, 0x77, 0x69, 0x66, 0x74, 0x53, 0x68, 0x61, 0x64, 0x65, 0x72, 0x20, 0x28, 0x73, 0x6F, 0x66,
+	0x74, 0x77, 0x61, 0x72, 0x65, 0x20, 0x72, 0x65, 0x6E, 0x64, 0x65, 0x72, 0x65, 0x72, 0x29, 0x00,
+	0x53, 0x77, 0x69, 0x66, 0x74, 0x53, 0x68, 0x61, 0x64, 0x65, 0x72, 0x00, 0x55, 0x48, 0x44, 0x20,
+	0x47, 0x72, 0x61, 0x70, 0x68, 0x69, 0x63, 0x73, 0x20, 0x37, 0x37, 0x30, 0x00, 0x47, 0x65, 0x46,
+	0x6F, 0x72, 0x63, 0x65, 0x20, 0x47, 0x54, 0x58, 0x20, 0x31, 0x30, 0x37, 0x30, 0x00, 0x47, 0x65,
+	0x46, 0x6F, 0x72, 0x63, 0x65, 0x20, 0x52, 0x54, 0x58, 0x20, 0x34, 0x30, 0x39, 0x30, 0x00, 0x41,
+	0x64, 0x61, 0x20, 0x4C, 0x6F, 0x76, 0x65, 0x6C, 0x61, 0x63, 0x65, 0x00, 0x52, 0x61, 0x64, 0x65,
+	0x6F, 0x6E, 0x20, 0x56, 0x49, 0x49, 0x00, 0x47, 0x65, 0x46, 0x6F, 0x72, 0x63, 0x65, 0x20, 0x47,
+	0x54, 0x58, 0x20, 0x39, 0x38, 0x30, 0x20, 0x54, 0x69, 0x00, 0x47, 0x65, 0x46, 0x6F, 0x72, 0x63,
+	0x65, 0x20, 0x52, 0x54, 0x58, 0x20, 0x33, 0x30, 0x36, 0x30, 0x00, 0x41, 0x4D, 0x44, 0x00, 0x49,
+	0x6D, 0x61, 0x67, 0x69, 0x6E, 0x61, 0x74, 0x69, 0x6F, 0x6E, 0x00, 0x41, 0x70, 0x70, 0x6C, 0x65,
+	0x00, 0x4E, 0x56, 0x49, 0x44, 0x49, 0x41, 0x00, 0x41, 0x52, 0x4D, 0x00, 0x47, 0x6F, 0x6F, 0x67,
+	0x6C, 0x65, 0x00, 0x51, 0x75, 0x61, 0x6C, 0x63, 0x6F, 0x6D, 0x6D, 0x00, 0x49, 0x6E, 0x74, 0x65,
+	0x6C, 0x00, 0x4D, 0x65, 0x73, 0x61, 0x00,
+};
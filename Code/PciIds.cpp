@@ -0,0 +1,107 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "PciIds.h"
+
+#include <stddef.h>
+
+// One slot of the perfect hash table. Strings are offsets into
+// pci_strings, so the whole table is plain read-only data with no
+// pointers that would need to be fixed up when the program loads
+struct PciDeviceEntry
+{
+	uint32_t vendor_id;
+	uint32_t device_id;
+	uint32_t name;
+	uint32_t architecture;
+	uint32_t generation;
+};
+
+struct PciVendorEntry
+{
+	uint32_t vendor_id;
+	uint32_t name;
+};
+
+// pci_bucket_seeds, pci_devices, pci_vendors, and pci_strings
+#include "PciIdTable.inl"
+
+// This must give exactly the same answers as pci_hash() in
+// gen_pci_ids.py, otherwise nothing will ever be found
+static uint64_t pci_hash(uint64_t key, uint64_t seed)
+{
+	uint64_t x = key ^ (seed * 0x9E3779B97F4A7C15ull);
+	x = (x ^ (x >> 33)) * 0xFF51AFD7ED558CCDull;
+	x = (x ^ (x >> 33)) * 0xC4CEB9FE1A85EC53ull;
+	return x ^ (x >> 33);
+}
+
+const char* pci_vendor_name(uint32_t vendor_id)
+{
+	// there are only a handful of vendors, and they are
+	// sorted, so a binary search is all we need
+	size_t low = 0;
+	size_t high = PCI_VENDOR_COUNT;
+	while (low < high)
+	{
+		size_t mid = (low + high) / 2;
+		if (pci_vendors[mid].vendor_id < vendor_id)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if (low < PCI_VENDOR_COUNT && pci_vendors[low].vendor_id == vendor_id)
+		return pci_strings + pci_vendors[low].name;
+	return NULL;
+}
+
+bool lookup_gpu_identity(uint32_t vendor_id, uint32_t device_id, GpuIdentity& out)
+{
+	out.vendor = pci_vendor_name(vendor_id);
+	out.name = NULL;
+	out.architecture = NULL;
+	out.generation = 0;
+
+	// Vulkan vendor IDs can be bigger than 16 bits
+	// (VK_VENDOR_ID_MESA is 0x10005), so the key needs
+	// all 32 bits of both IDs
+	uint64_t key = ((uint64_t)vendor_id << 32) | device_id;
+
+	// The first hash picks a bucket, and the seed of that bucket
+	// picks the slot. The generator chose the seeds so that no two
+	// devices share a slot, which means that if the device is in
+	// the table at all, it is in this slot and nowhere else
+	uint32_t bucket = (uint32_t)(pci_hash(key, 0) % PCI_BUCKET_COUNT);
+	uint32_t slot = (uint32_t)(pci_hash(key, pci_bucket_seeds[bucket]) % PCI_DEVICE_COUNT);
+
+	const PciDeviceEntry& entry = pci_devices[slot];
+	if (entry.vendor_id != vendor_id || entry.device_id != device_id)
+		return false;
+
+	out.name = pci_strings + entry.name;
+	out.architecture = pci_strings + entry.architecture;
+	out.generation = entry.generation;
+	return true;
+}
@@ -0,0 +1,53 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// What we know about a GPU from its vendor ID and device ID alone.
+// The driver gives us a name too (deviceName), but every driver
+// spells it differently ("GeForce GTX 1080" on one computer,
+// "NVIDIA GeForce GTX 1080" on another), so we keep our own
+// canonical names, which we can use to group GPUs together
+struct GpuIdentity
+{
+	const char* vendor;			// "NVIDIA", "AMD", "Intel"...
+	const char* name;			// canonical marketing name
+	const char* architecture;	// "Pascal", "RDNA 2", "Gen9.5"...
+
+	// grows with newer hardware from the same vendor:
+	// the SM version for NVIDIA, the GFX IP version for AMD,
+	// and the graphics generation times ten for Intel
+	uint32_t generation;
+};
+
+// Look a GPU up in the table that gen_pci_ids.py builds from
+// pci_ids.txt. Returns false if we have never heard of it, in which
+// case only out.vendor may be filled in (if we know the vendor).
+// Nothing is parsed or allocated, the table is compiled in
+bool lookup_gpu_identity(uint32_t vendor_id, uint32_t device_id, GpuIdentity& out);
+
+// The name of a vendor, or NULL if we do not know it
+const char* pci_vendor_name(uint32_t vendor_id);
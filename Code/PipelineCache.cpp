@@ -0,0 +1,241 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "PipelineCache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "MappedFile.h"
+#include "Platform.h"
+
+// VkPipelineCacheHeaderVersionOne: header size, header version,
+// vendor ID, device ID (four 32 bit numbers), and the UUID
+#define PIPELINE_CACHE_HEADER_SIZE (4 * sizeof(uint32_t) + VK_UUID_SIZE)
+
+bool validate_pipeline_cache_header(const uint8_t* data, size_t size,
+	const VkPhysicalDeviceProperties& properties, std::string& why)
+{
+	if (size < PIPELINE_CACHE_HEADER_SIZE)
+	{
+		why = "the file is too small to have a header";
+		return false;
+	}
+
+	// the header is little endian, like every
+	// computer that this program runs on
+	uint32_t fields[4];
+	memcpy(fields, data, sizeof(fields));
+	uint32_t header_size = fields[0];
+	uint32_t header_version = fields[1];
+	uint32_t vendor_id = fields[2];
+	uint32_t device_id = fields[3];
+	const uint8_t* uuid = data + sizeof(fields);
+
+	if (header_size < PIPELINE_CACHE_HEADER_SIZE || header_size > size)
+		why = "the header size is wrong";
+	else if (header_version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+		why = "the header version is unknown";
+	else if (vendor_id != properties.vendorID || device_id != properties.deviceID)
+		why = "it was made by a different GPU";
+	else if (memcmp(uuid, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		why = "it was made by a different driver";
+	else
+		return true;
+
+	return false;
+}
+
+PipelineCache::PipelineCache()
+{
+	device = VK_NULL_HANDLE;
+	cache = VK_NULL_HANDLE;
+	loaded_bytes = 0;
+	pipeline_count = 0;
+	creation_us = 0;
+}
+
+PipelineCache::~PipelineCache()
+{
+	close();
+}
+
+bool PipelineCache::open(VkDevice device, const VkPhysicalDeviceProperties& properties, const char* path)
+{
+	close();
+
+	this->device = device;
+	this->path = path;
+	loaded_bytes = 0;
+
+	VkPipelineCacheCreateInfo info = {};
+	info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+	// The file is mapped, not read, and the driver copies
+	// what it needs out of it while it makes the cache
+	MappedFile file;
+	if (file.open(path))
+	{
+		std::string why;
+		if (validate_pipeline_cache_header(file.data(), file.size(), properties, why))
+		{
+			info.initialDataSize = file.size();
+			info.pInitialData = file.data();
+		}
+		else
+		{
+			printf("Not using the pipeline cache in %s, because %s\n\n", path, why.c_str());
+		}
+	}
+
+	VkResult err = vkCreatePipelineCache(device, &info, NULL, &cache);
+
+	// The driver checks the data again, and it is allowed to say
+	// no. An empty cache is still better than no cache
+	if (err != VK_SUCCESS && info.initialDataSize)
+	{
+		printf("The driver did not accept the pipeline cache in %s\n\n", path);
+		info.initialDataSize = 0;
+		info.pInitialData = NULL;
+		err = vkCreatePipelineCache(device, &info, NULL, &cache);
+	}
+
+	if (err != VK_SUCCESS)
+	{
+		cache = VK_NULL_HANDLE;
+		return false;
+	}
+
+	loaded_bytes = info.initialDataSize;
+	if (loaded_bytes)
+		printf("Loaded %zu bytes of pipeline cache from %s\n\n", loaded_bytes, path);
+	return true;
+}
+
+VkPipelineCache PipelineCache::create_thread_cache()
+{
+	VkPipelineCacheCreateInfo info = {};
+	info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+	VkPipelineCache thread_cache = VK_NULL_HANDLE;
+	if (vkCreatePipelineCache(device, &info, NULL, &thread_cache) != VK_SUCCESS)
+		return VK_NULL_HANDLE;
+
+	std::lock_guard<std::mutex> hold(lock);
+	thread_caches.push_back(thread_cache);
+	return thread_cache;
+}
+
+void PipelineCache::merge_thread_caches()
+{
+	std::lock_guard<std::mutex> hold(lock);
+	if (thread_caches.empty())
+		return;
+
+	// Every thread has to be finished with its cache by now,
+	// the caches that are merged can not be in use
+	vkMergePipelineCaches(device, cache, (uint32_t)thread_caches.size(), thread_caches.data());
+
+	for (size_t i = 0; i < thread_caches.size(); i++)
+		vkDestroyPipelineCache(device, thread_caches[i], NULL);
+	thread_caches.clear();
+}
+
+bool PipelineCache::save()
+{
+	if (cache == VK_NULL_HANDLE)
+		return false;
+
+	merge_thread_caches();
+
+	// the same "call twice" pattern as always:
+	// first the size, then the data
+	size_t size = 0;
+	if (vkGetPipelineCacheData(device, cache, &size, NULL) != VK_SUCCESS || size == 0)
+		return false;
+
+	std::vector<uint8_t> data(size);
+	if (vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS)
+		return false;
+
+	if (!platform_write_file_atomic(path.c_str(), data.data(), size))
+	{
+		printf("Could not write the pipeline cache to %s\n\n", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+void PipelineCache::close()
+{
+	if (device == VK_NULL_HANDLE)
+		return;
+
+	for (size_t i = 0; i < thread_caches.size(); i++)
+		vkDestroyPipelineCache(device, thread_caches[i], NULL);
+	thread_caches.clear();
+
+	if (cache != VK_NULL_HANDLE)
+		vkDestroyPipelineCache(device, cache, NULL);
+	cache = VK_NULL_HANDLE;
+	device = VK_NULL_HANDLE;
+}
+
+void PipelineCache::record_creation(uint32_t count, uint64_t elapsed_us)
+{
+	std::lock_guard<std::mutex> hold(lock);
+	pipeline_count += count;
+	creation_us += elapsed_us;
+}
+
+VkResult PipelineCache::create_graphics_pipelines(uint32_t count, const VkGraphicsPipelineCreateInfo* infos,
+	VkPipeline* out, VkPipelineCache thread_cache)
+{
+	uint64_t start_us = platform_time_us();
+	VkResult err = vkCreateGraphicsPipelines(device, thread_cache ? thread_cache : cache, count, infos, NULL, out);
+	record_creation(count, platform_time_us() - start_us);
+	return err;
+}
+
+VkResult PipelineCache::create_compute_pipelines(uint32_t count, const VkComputePipelineCreateInfo* infos,
+	VkPipeline* out, VkPipelineCache thread_cache)
+{
+	uint64_t start_us = platform_time_us();
+	VkResult err = vkCreateComputePipelines(device, thread_cache ? thread_cache : cache, count, infos, NULL, out);
+	record_creation(count, platform_time_us() - start_us);
+	return err;
+}
+
+void PipelineCache::print_stats() const
+{
+	std::lock_guard<std::mutex> hold(lock);
+	if (pipeline_count == 0)
+		return;
+
+	// a warm cache should make this much smaller than a
+	// cold one, compare a first run with the second run
+	printf("Built %u pipelines in %.2f ms (%.3f ms each) with a %s pipeline cache\n\n",
+		pipeline_count, creation_us / 1000.0, creation_us / 1000.0 / pipeline_count,
+		loaded_bytes ? "warm" : "cold");
+}
@@ -0,0 +1,107 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Building a pipeline means compiling its shaders for this exact GPU
+// and driver, which can take a long time. A VkPipelineCache remembers
+// what the driver compiled, so that building the same pipeline again
+// is almost free. PipelineCache keeps that cache in a file between
+// runs, so only the very first run pays for it.
+//
+// The driver only understands its own cache data, so the file starts
+// with a header that says which GPU and driver made it (the vendor ID,
+// the device ID, and pipelineCacheUUID, which changes with every driver
+// update). If the header does not match the GPU that we picked, we
+// start with an empty cache rather than hand the driver a file that
+// it cannot use.
+//
+// Threads that build many pipelines at once can each have their own
+// cache (create_thread_cache), so that they never wait for each other,
+// and the thread caches are merged into the main one before we save it
+class PipelineCache
+{
+public:
+	PipelineCache();
+	~PipelineCache();
+
+	// Load the cache file at "path" (if there is one, and if it was made
+	// by this GPU and driver) and make the VkPipelineCache. Returns false
+	// only if Vulkan could not make a cache at all
+	bool open(VkDevice device, const VkPhysicalDeviceProperties& properties, const char* path);
+
+	// merge the thread caches, and write everything to the file.
+	// The old file is replaced in one step, so a crash while
+	// saving never leaves half a cache behind
+	bool save();
+
+	// destroy every cache, without saving
+	void close();
+
+	VkPipelineCache handle() const { return cache; }
+
+	// true if we started with data from the file
+	bool warm() const { return loaded_bytes > 0; }
+
+	// A cache that only one thread uses. It is merged into the main
+	// cache, and destroyed, by merge_thread_caches (or save)
+	VkPipelineCache create_thread_cache();
+	void merge_thread_caches();
+
+	// Build pipelines with the main cache (or "thread_cache"), and
+	// remember how long it took, so we can tell if the cache helped
+	VkResult create_graphics_pipelines(uint32_t count, const VkGraphicsPipelineCreateInfo* infos,
+		VkPipeline* out, VkPipelineCache thread_cache = VK_NULL_HANDLE);
+	VkResult create_compute_pipelines(uint32_t count, const VkComputePipelineCreateInfo* infos,
+		VkPipeline* out, VkPipelineCache thread_cache = VK_NULL_HANDLE);
+
+	void print_stats() const;
+
+private:
+	void record_creation(uint32_t count, uint64_t elapsed_us);
+
+	VkDevice device;
+	VkPipelineCache cache;
+	std::string path;
+	size_t loaded_bytes;
+
+	// the thread caches, and the timing, can
+	// be touched by any thread
+	mutable std::mutex lock;
+	std::vector<VkPipelineCache> thread_caches;
+	uint32_t pipeline_count;
+	uint64_t creation_us;
+};
+
+// Check that cache data starts with a VkPipelineCacheHeaderVersionOne
+// that was made by this GPU and driver. If it was not, "why" says why
+bool validate_pipeline_cache_header(const uint8_t* data, size_t size,
+	const VkPhysicalDeviceProperties& properties, std::string& why);
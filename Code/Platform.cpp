@@ -0,0 +1,376 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "Platform.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <condition_variable>
+#include <mutex>
+#include <atomic>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#endif
+
+// made in PlatformWin32.cpp and PlatformXcb.cpp, when they are built
+#ifdef _WIN32
+Platform* create_win32_platform();
+#endif
+#ifdef VK_USE_PLATFORM_XCB_KHR
+Platform* create_xcb_platform();
+#endif
+
+// The null platform has no window, so there is no X button to
+// close it with. Ctrl+C in the console is how it quits instead: it
+// becomes a PLATFORM_EVENT_QUIT, the same event that closing the
+// window is on the other platforms, so the demo shuts down the
+// usual way. The only other event it can have is a wake() from
+// another thread.
+//
+// On Windows, the console runs our handler on a thread of its own,
+// so it can wake wait_event like any other thread. A POSIX signal
+// handler can not lock anything, so there wait_event sleeps in
+// poll() on a pipe, like the xcb platform does, and the handler
+// only writes a byte into it (write() is safe in a signal handler)
+class NullPlatform : public Platform
+{
+public:
+	NullPlatform();
+	~NullPlatform();
+
+	const char* name() const override { return "null"; }
+
+	bool create_window(const char* title, uint32_t width, uint32_t height) override { return true; }
+	void set_title(const char* title) override {}
+
+	const char* surface_extension() const override { return VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME; }
+
+	VkResult create_surface(VkInstance instance, VkSurfaceKHR* out) override
+	{
+		// headless surfaces are an extension, so the loader
+		// does not give us the function directly
+		PFN_vkCreateHeadlessSurfaceEXT create_headless = (PFN_vkCreateHeadlessSurfaceEXT)
+			vkGetInstanceProcAddr(instance, "vkCreateHeadlessSurfaceEXT");
+		if (!create_headless)
+			return VK_ERROR_EXTENSION_NOT_PRESENT;
+
+		VkHeadlessSurfaceCreateInfoEXT info = {};
+		info.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+		return create_headless(instance, &info, NULL, out);
+	}
+
+	bool wait_event(PlatformEvent& out, int32_t timeout_ms) override;
+	void wake() override;
+
+private:
+#ifdef _WIN32
+	static BOOL WINAPI console_handler(DWORD type);
+
+	std::mutex lock;
+	std::condition_variable wake_signal;
+	bool woken;
+	bool quit;
+#else
+	static void interrupt_handler(int signal);
+
+	// wake() writes WAKE_BYTE, Ctrl+C writes QUIT_BYTE
+	int wake_pipe[2];
+	struct sigaction old_action;
+#endif
+};
+
+#ifdef _WIN32
+
+// the platform that Ctrl+C goes to, there is only ever one
+static std::atomic<NullPlatform*> console_platform(nullptr);
+
+NullPlatform::NullPlatform() : woken(false), quit(false)
+{
+	console_platform = this;
+	SetConsoleCtrlHandler(console_handler, TRUE);
+}
+
+NullPlatform::~NullPlatform()
+{
+	SetConsoleCtrlHandler(console_handler, FALSE);
+	console_platform = nullptr;
+}
+
+BOOL WINAPI NullPlatform::console_handler(DWORD type)
+{
+	NullPlatform* platform = console_platform;
+	if (!platform || (type != CTRL_C_EVENT && type != CTRL_BREAK_EVENT))
+		return FALSE;
+
+	std::lock_guard<std::mutex> hold(platform->lock);
+	platform->quit = true;
+	platform->wake_signal.notify_one();
+	return TRUE;
+}
+
+bool NullPlatform::wait_event(PlatformEvent& out, int32_t timeout_ms)
+{
+	std::unique_lock<std::mutex> hold(lock);
+	if (timeout_ms == PLATFORM_NO_WAIT)
+		;
+	else if (timeout_ms == PLATFORM_WAIT_FOREVER)
+		wake_signal.wait(hold, [this]() { return woken || quit; });
+	else
+		wake_signal.wait_for(hold, std::chrono::milliseconds(timeout_ms), [this]() { return woken || quit; });
+
+	if (!woken && !quit)
+		return false;
+
+	out = PlatformEvent();
+	out.type = quit ? PLATFORM_EVENT_QUIT : PLATFORM_EVENT_WAKE;
+	out.time_us = platform_time_us();
+	if (quit)
+		quit = false;
+	else
+		woken = false;
+	return true;
+}
+
+void NullPlatform::wake()
+{
+	std::lock_guard<std::mutex> hold(lock);
+	woken = true;
+	wake_signal.notify_one();
+}
+
+#else
+
+#define NULL_PLATFORM_WAKE_BYTE 1
+#define NULL_PLATFORM_QUIT_BYTE 2
+
+// where Ctrl+C writes to, -1 when there is no null platform
+static volatile sig_atomic_t interrupt_pipe = -1;
+
+NullPlatform::NullPlatform()
+{
+	wake_pipe[0] = -1;
+	wake_pipe[1] = -1;
+	if (pipe(wake_pipe) == 0)
+	{
+		fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+		fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+	}
+
+	interrupt_pipe = wake_pipe[1];
+	struct sigaction action = {};
+	action.sa_handler = interrupt_handler;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, &old_action);
+}
+
+NullPlatform::~NullPlatform()
+{
+	sigaction(SIGINT, &old_action, NULL);
+	interrupt_pipe = -1;
+
+	if (wake_pipe[0] >= 0)
+		close(wake_pipe[0]);
+	if (wake_pipe[1] >= 0)
+		close(wake_pipe[1]);
+}
+
+void NullPlatform::interrupt_handler(int signal)
+{
+	int saved_errno = errno;
+	char byte = NULL_PLATFORM_QUIT_BYTE;
+	if (interrupt_pipe >= 0)
+	{
+		ssize_t written = write(interrupt_pipe, &byte, 1);
+		(void)written;
+	}
+	errno = saved_errno;
+}
+
+bool NullPlatform::wait_event(PlatformEvent& out, int32_t timeout_ms)
+{
+	// PLATFORM_WAIT_FOREVER and PLATFORM_NO_WAIT
+	// mean the same thing to poll() as they do to us
+	pollfd fd = {};
+	fd.fd = wake_pipe[0];
+	fd.events = POLLIN;
+	if (poll(&fd, 1, timeout_ms) <= 0)
+		return false;
+
+	// many wakes only need one event, but a quit is never lost
+	char drain[64];
+	bool woken = false, quit = false;
+	ssize_t count;
+	while ((count = read(wake_pipe[0], drain, sizeof(drain))) > 0)
+	{
+		woken = true;
+		quit = quit || memchr(drain, NULL_PLATFORM_QUIT_BYTE, (size_t)count) != NULL;
+	}
+	if (!woken)
+		return false;
+
+	out = PlatformEvent();
+	out.type = quit ? PLATFORM_EVENT_QUIT : PLATFORM_EVENT_WAKE;
+	out.time_us = platform_time_us();
+	return true;
+}
+
+void NullPlatform::wake()
+{
+	// write() is safe to call from any thread, and if the pipe is
+	// already full, there is already a wake waiting to be seen
+	char byte = NULL_PLATFORM_WAKE_BYTE;
+	ssize_t written = write(wake_pipe[1], &byte, 1);
+	(void)written;
+}
+
+#endif
+
+Platform* create_platform(const char* name)
+{
+	if (!name)
+		name = "";
+
+	if (!*name)
+	{
+#ifdef _WIN32
+		name = "win32";
+#elif defined(VK_USE_PLATFORM_XCB_KHR)
+		name = getenv("DISPLAY") ? "xcb" : "null";
+#else
+		name = "null";
+#endif
+	}
+
+#ifdef _WIN32
+	if (!strcmp(name, "win32"))
+		return create_win32_platform();
+#endif
+#ifdef VK_USE_PLATFORM_XCB_KHR
+	if (!strcmp(name, "xcb"))
+		return create_xcb_platform();
+#endif
+	if (!strcmp(name, "null"))
+		return new NullPlatform();
+
+	return nullptr;
+}
+
+uint64_t platform_time_us()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool platform_write_file_atomic(const char* path, const void* data, size_t size)
+{
+	// The process ID keeps two copies of the program from
+	// writing into the same temporary file at the same time,
+	// and the counter does the same for two threads
+#ifdef _WIN32
+	unsigned long pid = (unsigned long)GetCurrentProcessId();
+#else
+	unsigned long pid = (unsigned long)getpid();
+#endif
+	static std::atomic<uint32_t> next_temp(0);
+	std::string temp_path = std::string(path) + "." + std::to_string(pid) + "." +
+		std::to_string(next_temp++) + ".tmp";
+
+	FILE* file = fopen(temp_path.c_str(), "wb");
+	if (!file)
+		return false;
+
+	bool ok = size == 0 || fwrite(data, 1, size, file) == size;
+	ok = fflush(file) == 0 && ok;
+
+	// make sure the bytes are on the disk before the new
+	// file takes the place of the old one
+#ifdef _WIN32
+	ok = ok && _commit(_fileno(file)) == 0;
+#else
+	ok = ok && fsync(fileno(file)) == 0;
+#endif
+	ok = fclose(file) == 0 && ok;
+
+	// rename replaces the old file in one step on POSIX,
+	// MoveFileEx does the same on Windows
+#ifdef _WIN32
+	ok = ok && MoveFileEx(temp_path.c_str(), path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	ok = ok && rename(temp_path.c_str(), path) == 0;
+#endif
+
+	if (!ok)
+		remove(temp_path.c_str());
+	return ok;
+}
+
+bool platform_create_directory(const char* path)
+{
+#ifdef _WIN32
+	if (CreateDirectory(path, NULL))
+		return true;
+	return GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+	if (mkdir(path, 0755) == 0)
+		return true;
+	return errno == EEXIST;
+#endif
+}
+
+double process_cpu_seconds()
+{
+#ifdef _WIN32
+	// kernel and user time both come in 100 nanosecond steps
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+		return 0;
+
+	ULARGE_INTEGER k, u;
+	k.LowPart = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+	return (double)(k.QuadPart + u.QuadPart) * 1e-7;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	return (double)usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+		(double)usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+#endif
+}
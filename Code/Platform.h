@@ -0,0 +1,136 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <vulkan/vulkan.h>
+
+// Platform hides the differences between the operating systems
+// that we run on: how a window is made, how its title is set, and
+// how we find out that something happened to it. There is a Win32
+// version (PlatformWin32.cpp), an xcb version for Linux
+// (PlatformXcb.cpp), and a "null" version that has no window at all,
+// for running on a computer without a screen (Platform.cpp).
+
+// Key numbers are the Win32 virtual-key codes on every platform,
+// so "keys[PLATFORM_KEY_ESCAPE]" means the same thing everywhere
+#define PLATFORM_KEY_ESCAPE 0x1B
+
+// wait_event timeouts, in milliseconds
+#define PLATFORM_WAIT_FOREVER -1
+#define PLATFORM_NO_WAIT 0
+
+enum PlatformEventType
+{
+	// the window was closed
+	PLATFORM_EVENT_QUIT,
+
+	// "key" was pressed or released
+	PLATFORM_EVENT_KEY_DOWN,
+	PLATFORM_EVENT_KEY_UP,
+
+	// the window is now "width" by "height" pixels
+	PLATFORM_EVENT_RESIZE,
+
+	// The window can now be seen ("active" is true), or it can
+	// not (it was minimized, or something covers all of it)
+	PLATFORM_EVENT_VISIBILITY,
+
+	// the window now has the keyboard ("active" is true), or it lost it
+	PLATFORM_EVENT_FOCUS,
+
+	// another thread called wake()
+	PLATFORM_EVENT_WAKE
+};
+
+struct PlatformEvent
+{
+	PlatformEventType type;
+	uint32_t key;
+	uint32_t width, height;
+	bool active;
+
+	// when the platform received the event, from platform_time_us
+	uint64_t time_us;
+};
+
+class Platform
+{
+public:
+	virtual ~Platform() {}
+
+	// "win32", "xcb", or "null"
+	virtual const char* name() const = 0;
+
+	virtual bool create_window(const char* title, uint32_t width, uint32_t height) = 0;
+	virtual void set_title(const char* title) = 0;
+
+	// The instance extension that create_surface needs, which
+	// is different on every platform. The null platform uses
+	// VK_EXT_headless_surface, a surface that is never shown
+	virtual const char* surface_extension() const = 0;
+
+	// Make a surface for the window, which is what Vulkan
+	// draws into. The instance has to have surface_extension()
+	virtual VkResult create_surface(VkInstance instance, VkSurfaceKHR* out) = 0;
+
+	// Give back the next event. If there is none, sleep until one
+	// arrives, or until timeout_ms milliseconds have passed (this is
+	// what keeps an idle program from using the CPU). Returns false
+	// if the time ran out first. PLATFORM_NO_WAIT only checks,
+	// and PLATFORM_WAIT_FOREVER never gives up.
+	// This has to be called on the thread that made the window
+	virtual bool wait_event(PlatformEvent& out, int32_t timeout_ms) = 0;
+
+	// Make wait_event return a PLATFORM_EVENT_WAKE as soon as
+	// possible. This is the only function that can be called
+	// from any thread
+	virtual void wake() = 0;
+};
+
+// Make the platform with this name, or the usual one for this
+// computer if the name is empty: Win32 on Windows, xcb on Linux
+// when there is a display, and null otherwise. Returns null if
+// the platform was not built into this program
+Platform* create_platform(const char* name);
+
+// microseconds from a clock that every thread shares,
+// and that never goes backwards
+uint64_t platform_time_us();
+
+// Write a whole file so that nobody ever sees half of it: the bytes go
+// into a temporary file next to "path", which then replaces "path" in
+// one step. If we crash halfway, the old file is still there
+bool platform_write_file_atomic(const char* path, const void* data, size_t size);
+
+// Make a folder, returns true if it is there afterwards,
+// whether or not we were the ones who made it
+bool platform_create_directory(const char* path);
+
+// how much CPU time this process has used, in seconds,
+// counting every thread, used to measure the idle loop
+double process_cpu_seconds();
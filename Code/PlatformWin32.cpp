@@ -0,0 +1,321 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#ifdef _WIN32
+
+#include "Platform.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+
+#include <windows.h>
+
+// a message that only wake() sends, to the thread, not the window
+#define WM_PLATFORM_WAKE (WM_USER + 1)
+
+class Win32Platform : public Platform
+{
+public:
+	Win32Platform();
+	~Win32Platform() override;
+
+	const char* name() const override { return "win32"; }
+
+	bool create_window(const char* title, uint32_t width, uint32_t height) override;
+	void set_title(const char* title) override;
+	const char* surface_extension() const override { return VK_KHR_WIN32_SURFACE_EXTENSION_NAME; }
+	VkResult create_surface(VkInstance instance, VkSurfaceKHR* out) override;
+	bool wait_event(PlatformEvent& out, int32_t timeout_ms) override;
+	void wake() override;
+
+	HWND window;        // hWnd - window handle
+	POINT minsize;      // minimum window size
+	bool minimized;
+
+	// WndProc turns window messages into events, and wait_event
+	// gives them back one at a time
+	void push(PlatformEventType type, uint32_t key = 0, uint32_t width = 0, uint32_t height = 0, bool active = false);
+
+private:
+	std::deque<PlatformEvent> events;
+
+	char class_name[80];
+	DWORD thread_id;
+};
+
+// WndProc is the default function that Windows uses to handle
+// handle a window. We do not need to call this function ourselves,
+// we connect it to the window, and then, the Win32 API calls it 
+// automatically. It gives us window size, what keys are pressed while 
+// using the window, etc
+static LRESULT CALLBACK WndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
+{
+	// CreateWindowEx gives us the Win32Platform in its first message,
+	// and we keep it in the window, so that every message after
+	// that one can find it again
+	if (uMsg == WM_NCCREATE)
+	{
+		CREATESTRUCT* create = (CREATESTRUCT*)lParam;
+		SetWindowLongPtr(hWnd, GWLP_USERDATA, (LONG_PTR)create->lpCreateParams);
+	}
+
+	Win32Platform* platform = (Win32Platform*)GetWindowLongPtr(hWnd, GWLP_USERDATA);
+	if (!platform)
+		return DefWindowProc(hWnd, uMsg, wParam, lParam);
+
+	// when the window tries to close
+	// this sets msg.message to WM_QUIT,
+	// which wait_event turns into PLATFORM_EVENT_QUIT
+	if (uMsg == WM_CLOSE)
+		PostQuitMessage(0);
+
+	// when a key is hit, or released
+	else if (uMsg == WM_KEYDOWN)
+		platform->push(PLATFORM_EVENT_KEY_DOWN, (uint32_t)(wParam & 0xFF));
+	else if (uMsg == WM_KEYUP)
+		platform->push(PLATFORM_EVENT_KEY_UP, (uint32_t)(wParam & 0xFF));
+
+	// when the window changes size. A minimized window
+	// can not be seen, and every other size can
+	else if (uMsg == WM_SIZE)
+	{
+		bool minimized = wParam == SIZE_MINIMIZED;
+		if (minimized != platform->minimized)
+		{
+			platform->minimized = minimized;
+			platform->push(PLATFORM_EVENT_VISIBILITY, 0, 0, 0, !minimized);
+		}
+		platform->push(PLATFORM_EVENT_RESIZE, 0, LOWORD(lParam), HIWORD(lParam));
+	}
+
+	// when the window gets or loses the keyboard
+	else if (uMsg == WM_SETFOCUS)
+		platform->push(PLATFORM_EVENT_FOCUS, 0, 0, 0, true);
+	else if (uMsg == WM_KILLFOCUS)
+		platform->push(PLATFORM_EVENT_FOCUS, 0, 0, 0, false);
+
+	// Window client area size must be at least 1 pixel high, to prevent crash.
+	else if (uMsg == WM_GETMINMAXINFO)
+	{
+		((MINMAXINFO*)lParam)->ptMinTrackSize = platform->minsize;
+		return 0;
+	}
+
+	// this will be the return statement every time
+	// WndProc is called. Keep in mind, this function is 
+	// called by the Win32 API, it is not called by us
+	// in any of our files of code
+	return (DefWindowProc(hWnd, uMsg, wParam, lParam));
+}
+
+Win32Platform::Win32Platform()
+{
+	window = NULL;
+	minsize.x = 0;
+	minsize.y = 0;
+	minimized = false;
+	class_name[0] = 0;
+
+	// wake() posts to this thread, because there
+	// might not be a window yet when it is called
+	thread_id = GetCurrentThreadId();
+}
+
+Win32Platform::~Win32Platform()
+{
+	if (window)
+		DestroyWindow(window);
+}
+
+void Win32Platform::push(PlatformEventType type, uint32_t key, uint32_t width, uint32_t height, bool active)
+{
+	PlatformEvent event;
+	event.type = type;
+	event.key = key;
+	event.width = width;
+	event.height = height;
+	event.active = active;
+	event.time_us = platform_time_us();
+	events.push_back(event);
+}
+
+bool Win32Platform::create_window(const char* title, uint32_t width, uint32_t height)
+{
+	strncpy(class_name, title, sizeof(class_name) - 1);
+
+	WNDCLASSEX win_class = {};
+
+	// Initialize the window class structure:
+	// The most important detail here is that we
+	// give it the WndProc function from above,
+	// so that the function can handle our window.
+	// Everything else here sets the icon, the title,
+	// the cursor, thing like that
+	win_class.cbSize = sizeof(WNDCLASSEX);
+	win_class.style = CS_HREDRAW | CS_VREDRAW;
+	win_class.lpfnWndProc = WndProc;
+	win_class.hIcon = LoadIcon(NULL, IDI_APPLICATION);
+	win_class.hCursor = LoadCursor(NULL, IDC_ARROW);
+	win_class.hbrBackground = (HBRUSH)GetStockObject(WHITE_BRUSH);
+	win_class.lpszMenuName = NULL;
+	win_class.lpszClassName = class_name;
+	win_class.hIconSm = LoadIcon(NULL, IDI_WINLOGO);
+
+	// RegisterClassEx will do waht it sounds like,
+	// it registers the WNDCLASSEX structure, so that
+	// we can use win_class to make a window
+
+	// If the function fails to register win_class
+	// then give an error
+	if (!RegisterClassEx(&win_class))
+	{
+		// It didn't work, so try to give a useful error:
+		printf("Unexpected error trying to start the application!\n");
+		return false;
+	}
+
+	// Window client area size must be at least 1 pixel high, to prevent crash.
+	minsize.x = GetSystemMetrics(SM_CXMINTRACK);
+	minsize.y = GetSystemMetrics(SM_CYMINTRACK) + 1;
+
+	// Create window with the registered class:
+	RECT wr = { 0, 0, (LONG)width, (LONG)height };
+	AdjustWindowRect(&wr, WS_OVERLAPPEDWINDOW, FALSE);
+
+	// We will now create our window
+	// with the function "CreateWindowEx"
+	// Win32 and DirectX 11 have some functions
+	// with a huge ton of parameters. What 
+	// Vulkan does for all functions, and what
+	// DirectX 11 sometimes does, is organize
+	// all parameters into a structure, and then
+	// pass the structure as one parameter
+	window = CreateWindowEx(0,
+		class_name,      // class name
+		title,           // app name
+		WS_OVERLAPPEDWINDOW |  // window style
+		WS_VISIBLE | WS_SYSMENU,
+
+		// The position (0,0) is the top-left
+		// corner of the screen, which is where
+		// the command prompt is, and the command 
+		// prompt is 640 pixels wide, so lets put
+		// the Vulkan window right next to the console window
+		640, 0,				 // (x,y) position
+		wr.right - wr.left,  // width
+		wr.bottom - wr.top,  // height
+		NULL,                // handle to parent, no parent exists
+
+		// This would give you "File" "Edit" "Help", etc
+		NULL,                // handle to menu, no menu exists
+		(HINSTANCE)0,		 // no hInstance
+		this);               // WndProc keeps this, see WM_NCCREATE
+
+	// if we failed to make the window
+	// then give an error that the window failed
+	if (!window)
+	{
+		// It didn't work, so try to give a useful error:
+		printf("Cannot create a window in which to draw!\n");
+		return false;
+	}
+
+	return true;
+}
+
+void Win32Platform::set_title(const char* title)
+{
+	SetWindowText(window, title);
+}
+
+VkResult Win32Platform::create_surface(VkInstance instance, VkSurfaceKHR* out)
+{
+	// Vulkan needs to know which window, and which
+	// program the window belongs to
+	VkWin32SurfaceCreateInfoKHR info = {};
+	info.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
+	info.hinstance = GetModuleHandle(NULL);
+	info.hwnd = window;
+	return vkCreateWin32SurfaceKHR(instance, &info, NULL, out);
+}
+
+bool Win32Platform::wait_event(PlatformEvent& out, int32_t timeout_ms)
+{
+	DWORD start = GetTickCount();
+
+	while (events.empty())
+	{
+		// Handle every message that is already waiting.
+		// DispatchMessage calls WndProc, which adds events
+		MSG msg;
+		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+		{
+			// messages for the thread, rather than the
+			// window, never go through WndProc
+			if (msg.message == WM_QUIT)
+				push(PLATFORM_EVENT_QUIT);
+			else if (msg.message == WM_PLATFORM_WAKE && msg.hwnd == NULL)
+				push(PLATFORM_EVENT_WAKE);
+
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+		}
+
+		if (!events.empty())
+			break;
+
+		// Nothing happened, so we sleep until a message arrives, or
+		// until the time is up. This is the difference from calling
+		// PeekMessage over and over: Windows does not give us the
+		// CPU again until there is something for us to do
+		DWORD wait = INFINITE;
+		if (timeout_ms != PLATFORM_WAIT_FOREVER)
+		{
+			DWORD waited = GetTickCount() - start;
+			if (waited >= (DWORD)timeout_ms)
+				return false;
+			wait = (DWORD)timeout_ms - waited;
+		}
+
+		if (MsgWaitForMultipleObjectsEx(0, NULL, wait, QS_ALLINPUT, MWMO_INPUTAVAILABLE) == WAIT_TIMEOUT)
+			return false;
+	}
+
+	out = events.front();
+	events.pop_front();
+	return true;
+}
+
+void Win32Platform::wake()
+{
+	PostThreadMessage(thread_id, WM_PLATFORM_WAKE, 0, 0);
+}
+
+Platform* create_win32_platform()
+{
+	return new Win32Platform();
+}
+
+#endif
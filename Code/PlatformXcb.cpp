@@ -0,0 +1,364 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#ifdef VK_USE_PLATFORM_XCB_KHR
+
+#include "Platform.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <deque>
+
+#include <xcb/xcb.h>
+
+// the X keycode of Escape on every keyboard layout that X uses
+// today (evdev), we do not need the other keys yet
+#define XCB_KEYCODE_ESCAPE 9
+
+class XcbPlatform : public Platform
+{
+public:
+	XcbPlatform();
+	~XcbPlatform() override;
+
+	const char* name() const override { return "xcb"; }
+
+	bool create_window(const char* title, uint32_t width, uint32_t height) override;
+	void set_title(const char* title) override;
+	const char* surface_extension() const override { return VK_KHR_XCB_SURFACE_EXTENSION_NAME; }
+	VkResult create_surface(VkInstance instance, VkSurfaceKHR* out) override;
+	bool wait_event(PlatformEvent& out, int32_t timeout_ms) override;
+	void wake() override;
+
+	xcb_connection_t* connection;
+	xcb_window_t window;
+
+private:
+	void translate(xcb_generic_event_t* event);
+	void push(PlatformEventType type, uint32_t key = 0, uint32_t width = 0, uint32_t height = 0, bool active = false);
+
+	xcb_screen_t* screen;
+	xcb_atom_t delete_window_atom;
+	uint32_t last_width, last_height;
+
+	// A window can be seen when it is mapped (a minimized window is
+	// unmapped) and not completely covered by other windows
+	bool mapped, obscured, visible;
+	void update_visibility();
+	std::deque<PlatformEvent> events;
+
+	// wake() writes a byte into this pipe, and wait_event watches
+	// it together with the X connection, so one poll() sleeps
+	// until either the X server or another thread wants us
+	int wake_pipe[2];
+};
+
+XcbPlatform::XcbPlatform()
+{
+	connection = nullptr;
+	window = 0;
+	screen = nullptr;
+	delete_window_atom = 0;
+	last_width = 0;
+	last_height = 0;
+	mapped = false;
+	obscured = false;
+	visible = true;
+
+	wake_pipe[0] = -1;
+	wake_pipe[1] = -1;
+	if (pipe(wake_pipe) == 0)
+	{
+		fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+		fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+	}
+}
+
+XcbPlatform::~XcbPlatform()
+{
+	if (connection)
+	{
+		if (window)
+			xcb_destroy_window(connection, window);
+		xcb_disconnect(connection);
+	}
+
+	if (wake_pipe[0] >= 0)
+		close(wake_pipe[0]);
+	if (wake_pipe[1] >= 0)
+		close(wake_pipe[1]);
+}
+
+static xcb_atom_t intern_atom(xcb_connection_t* connection, const char* name)
+{
+	xcb_intern_atom_cookie_t cookie = xcb_intern_atom(connection, 0, (uint16_t)strlen(name), name);
+	xcb_intern_atom_reply_t* reply = xcb_intern_atom_reply(connection, cookie, NULL);
+	if (!reply)
+		return 0;
+
+	xcb_atom_t atom = reply->atom;
+	free(reply);
+	return atom;
+}
+
+bool XcbPlatform::create_window(const char* title, uint32_t width, uint32_t height)
+{
+	int screen_number = 0;
+	connection = xcb_connect(NULL, &screen_number);
+	if (xcb_connection_has_error(connection))
+	{
+		printf("Cannot connect to the X server, is DISPLAY set?\n");
+		xcb_disconnect(connection);
+		connection = nullptr;
+		return false;
+	}
+
+	xcb_screen_iterator_t it = xcb_setup_roots_iterator(xcb_get_setup(connection));
+	for (int i = 0; i < screen_number; i++)
+		xcb_screen_next(&it);
+	screen = it.data;
+
+	window = xcb_generate_id(connection);
+
+	uint32_t value_mask = XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK;
+	uint32_t values[2] = { screen->white_pixel,
+		XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_STRUCTURE_NOTIFY |
+		XCB_EVENT_MASK_VISIBILITY_CHANGE | XCB_EVENT_MASK_FOCUS_CHANGE };
+
+	// the same place as the Win32 window: next to the console
+	xcb_create_window(connection, XCB_COPY_FROM_PARENT, window, screen->root,
+		640, 0, (uint16_t)width, (uint16_t)height, 0,
+		XCB_WINDOW_CLASS_INPUT_OUTPUT, screen->root_visual, value_mask, values);
+
+	// Without this, closing the window would disconnect us from the
+	// X server. With it, the server asks us nicely instead, with a
+	// client message that we turn into PLATFORM_EVENT_QUIT
+	xcb_atom_t protocols = intern_atom(connection, "WM_PROTOCOLS");
+	delete_window_atom = intern_atom(connection, "WM_DELETE_WINDOW");
+	xcb_change_property(connection, XCB_PROP_MODE_REPLACE, window, protocols,
+		XCB_ATOM_ATOM, 32, 1, &delete_window_atom);
+
+	set_title(title);
+	xcb_map_window(connection, window);
+	xcb_flush(connection);
+
+	last_width = width;
+	last_height = height;
+	return true;
+}
+
+void XcbPlatform::set_title(const char* title)
+{
+	xcb_change_property(connection, XCB_PROP_MODE_REPLACE, window, XCB_ATOM_WM_NAME,
+		XCB_ATOM_STRING, 8, (uint32_t)strlen(title), title);
+	xcb_flush(connection);
+}
+
+VkResult XcbPlatform::create_surface(VkInstance instance, VkSurfaceKHR* out)
+{
+	VkXcbSurfaceCreateInfoKHR info = {};
+	info.sType = VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR;
+	info.connection = connection;
+	info.window = window;
+	return vkCreateXcbSurfaceKHR(instance, &info, NULL, out);
+}
+
+void XcbPlatform::push(PlatformEventType type, uint32_t key, uint32_t width, uint32_t height, bool active)
+{
+	PlatformEvent event;
+	event.type = type;
+	event.key = key;
+	event.width = width;
+	event.height = height;
+	event.active = active;
+	event.time_us = platform_time_us();
+	events.push_back(event);
+}
+
+void XcbPlatform::update_visibility()
+{
+	bool now_visible = mapped && !obscured;
+	if (now_visible != visible)
+	{
+		visible = now_visible;
+		push(PLATFORM_EVENT_VISIBILITY, 0, 0, 0, visible);
+	}
+}
+
+void XcbPlatform::translate(xcb_generic_event_t* event)
+{
+	switch (event->response_type & 0x7F)
+	{
+	case XCB_KEY_PRESS:
+	case XCB_KEY_RELEASE:
+	{
+		xcb_key_press_event_t* key = (xcb_key_press_event_t*)event;
+		if (key->detail == XCB_KEYCODE_ESCAPE)
+		{
+			bool down = (event->response_type & 0x7F) == XCB_KEY_PRESS;
+			push(down ? PLATFORM_EVENT_KEY_DOWN : PLATFORM_EVENT_KEY_UP, PLATFORM_KEY_ESCAPE);
+		}
+		break;
+	}
+	case XCB_CONFIGURE_NOTIFY:
+	{
+		// this also comes when the window only moves,
+		// so we only pass it on if the size changed
+		xcb_configure_notify_event_t* configure = (xcb_configure_notify_event_t*)event;
+		if (configure->width != last_width || configure->height != last_height)
+		{
+			last_width = configure->width;
+			last_height = configure->height;
+			push(PLATFORM_EVENT_RESIZE, 0, last_width, last_height);
+		}
+		break;
+	}
+	case XCB_MAP_NOTIFY:
+		mapped = true;
+		update_visibility();
+		break;
+	case XCB_UNMAP_NOTIFY:
+		mapped = false;
+		update_visibility();
+		break;
+	case XCB_VISIBILITY_NOTIFY:
+	{
+		xcb_visibility_notify_event_t* visibility = (xcb_visibility_notify_event_t*)event;
+		obscured = visibility->state == XCB_VISIBILITY_FULLY_OBSCURED;
+		update_visibility();
+		break;
+	}
+	case XCB_FOCUS_IN:
+	case XCB_FOCUS_OUT:
+		push(PLATFORM_EVENT_FOCUS, 0, 0, 0, (event->response_type & 0x7F) == XCB_FOCUS_IN);
+		break;
+	case XCB_CLIENT_MESSAGE:
+	{
+		xcb_client_message_event_t* message = (xcb_client_message_event_t*)event;
+		if (message->data.data32[0] == delete_window_atom)
+			push(PLATFORM_EVENT_QUIT);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+static int64_t monotonic_ms()
+{
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+bool XcbPlatform::wait_event(PlatformEvent& out, int32_t timeout_ms)
+{
+	int64_t deadline = monotonic_ms() + timeout_ms;
+
+	while (events.empty())
+	{
+		// xcb may already have read events from the connection,
+		// and poll() would not know about those, so we take every
+		// event that xcb has before we think about sleeping
+		xcb_generic_event_t* event;
+		while (connection && (event = xcb_poll_for_event(connection)) != NULL)
+		{
+			translate(event);
+			free(event);
+		}
+
+		// empty the wake pipe, many wakes only need one event
+		char drain[64];
+		bool woken = false;
+		while (read(wake_pipe[0], drain, sizeof(drain)) > 0)
+			woken = true;
+		if (woken)
+			push(PLATFORM_EVENT_WAKE);
+
+		if (!events.empty())
+			break;
+
+		if (connection && xcb_connection_has_error(connection))
+		{
+			push(PLATFORM_EVENT_QUIT);
+			break;
+		}
+
+		int wait = -1;
+		if (timeout_ms != PLATFORM_WAIT_FOREVER)
+		{
+			int64_t left = deadline - monotonic_ms();
+			if (left <= 0)
+				return false;
+			wait = (int)left;
+		}
+
+		// sleep until the X server sends something, another
+		// thread calls wake(), or the time is up
+		pollfd fds[2];
+		nfds_t count = 0;
+		fds[count].fd = wake_pipe[0];
+		fds[count].events = POLLIN;
+		count++;
+		if (connection)
+		{
+			xcb_flush(connection);
+			fds[count].fd = xcb_get_file_descriptor(connection);
+			fds[count].events = POLLIN;
+			count++;
+		}
+
+		int ready = poll(fds, count, wait);
+		if (ready == 0)
+			return false;
+		if (ready < 0 && errno != EINTR)
+			return false;
+	}
+
+	out = events.front();
+	events.pop_front();
+	return true;
+}
+
+void XcbPlatform::wake()
+{
+	// write() is safe to call from any thread, and if the pipe is
+	// already full, there is already a wake waiting to be seen
+	char byte = 1;
+	ssize_t written = write(wake_pipe[1], &byte, 1);
+	(void)written;
+}
+
+Platform* create_xcb_platform()
+{
+	return new XcbPlatform();
+}
+
+#endif
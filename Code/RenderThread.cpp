@@ -0,0 +1,129 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "RenderThread.h"
+
+#include <stdio.h>
+
+RenderThread::RenderThread()
+{
+	stop_requested = false;
+	dropped = 0;
+	signalled = false;
+	latency_count = 0;
+	latency_total_us = 0;
+	latency_max_us = 0;
+}
+
+RenderThread::~RenderThread()
+{
+	stop();
+}
+
+void RenderThread::start(std::function<void()> body)
+{
+	stop_requested = false;
+	thread = std::thread(body);
+}
+
+void RenderThread::stop()
+{
+	if (!thread.joinable())
+		return;
+
+	stop_requested.store(true, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> hold(sleep_lock);
+		signalled = true;
+	}
+	sleep_signal.notify_one();
+
+	thread.join();
+}
+
+bool RenderThread::post(const PlatformEvent& event)
+{
+	if (!events.push(event))
+	{
+		dropped++;
+		return false;
+	}
+
+	// The lock is only held for a moment, and only to make
+	// sure the render thread cannot miss this between checking
+	// the queue and going to sleep
+	{
+		std::lock_guard<std::mutex> hold(sleep_lock);
+		signalled = true;
+	}
+	sleep_signal.notify_one();
+	return true;
+}
+
+bool RenderThread::next_event(PlatformEvent& out)
+{
+	if (!events.pop(out))
+		return false;
+
+	uint64_t now = platform_time_us();
+	uint64_t latency = now > out.time_us ? now - out.time_us : 0;
+	latency_count++;
+	latency_total_us += latency;
+	if (latency > latency_max_us)
+		latency_max_us = latency;
+	return true;
+}
+
+void RenderThread::wait(int32_t timeout_ms)
+{
+	std::unique_lock<std::mutex> hold(sleep_lock);
+	if (!events.empty() || stopping())
+	{
+		signalled = false;
+		return;
+	}
+
+	if (timeout_ms == PLATFORM_WAIT_FOREVER)
+		sleep_signal.wait(hold, [this]() { return signalled; });
+	else if (timeout_ms > 0)
+		sleep_signal.wait_for(hold, std::chrono::milliseconds(timeout_ms), [this]() { return signalled; });
+
+	signalled = false;
+}
+
+void RenderThread::print_latency() const
+{
+	if (latency_count == 0)
+	{
+		printf("The render thread did not receive any input\n");
+		return;
+	}
+
+	printf("Input latency (window thread to render thread): %llu events, average %.1f us, worst %llu us",
+		(unsigned long long)latency_count, (double)latency_total_us / latency_count,
+		(unsigned long long)latency_max_us);
+	if (dropped)
+		printf(", %u dropped because the queue was full", dropped.load());
+	printf("\n");
+}
@@ -0,0 +1,93 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Platform.h"
+#include "SpscQueue.h"
+
+// RenderThread is the thread that owns the Vulkan device and
+// its queues, and that will draw every frame. The main thread
+// only reads window messages, and hands the ones that matter
+// to the render thread through a lock-free queue, so a slow
+// message (like dragging the window around) never holds up a
+// frame, and a slow frame never holds up the window.
+//
+// Every event carries the time it arrived (PlatformEvent::time_us),
+// so when the render thread picks it up, we know how long it
+// waited: that is the input latency that we print at the end
+class RenderThread
+{
+public:
+	RenderThread();
+	~RenderThread();
+
+	// Start the thread, which runs "body" until stop() is called.
+	// The body should check stopping() between frames
+	void start(std::function<void()> body);
+
+	// ask the thread to finish, and wait until it has
+	void stop();
+
+	bool stopping() const { return stop_requested.load(std::memory_order_acquire); }
+	bool running() const { return thread.joinable(); }
+
+	// Main thread: give an event to the render thread.
+	// Returns false (and counts it) if the queue is full
+	bool post(const PlatformEvent& event);
+
+	// Render thread: take the next event, if there is one
+	bool next_event(PlatformEvent& out);
+
+	// Render thread: sleep until an event is posted, stop() is
+	// called, or timeout_ms has passed (see PLATFORM_WAIT_FOREVER)
+	void wait(int32_t timeout_ms);
+
+	void print_latency() const;
+
+private:
+	SpscQueue<PlatformEvent, 256> events;
+	std::thread thread;
+	std::atomic<bool> stop_requested;
+	std::atomic<uint32_t> dropped;
+
+	// The queue itself needs no lock, this is only so that the
+	// render thread can sleep when it has nothing to do, and be
+	// woken up when it has
+	std::mutex sleep_lock;
+	std::condition_variable sleep_signal;
+	bool signalled;
+
+	// only touched by the render thread
+	uint64_t latency_count;
+	uint64_t latency_total_us;
+	uint64_t latency_max_us;
+};
@@ -0,0 +1,168 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "ShaderBatch.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+#include "Platform.h"
+
+ShaderBatch::ShaderBatch(ShaderCache* cache, const std::vector<std::string>& include_directories)
+	: cache(cache), include_directories(include_directories), next(0)
+{
+	start_us = 0;
+	wall_ms = 0;
+	thread_count = 0;
+}
+
+void ShaderBatch::add(const ShaderSource& source, int priority, const std::string& output_path,
+	const std::string& variant)
+{
+	ShaderJob job;
+	job.source = source;
+	job.priority = priority;
+	job.output_path = output_path;
+	job.variant = variant;
+	job.compile_ms = 0;
+	job.finished_ms = 0;
+	jobs.push_back(job);
+}
+
+void ShaderBatch::run(ThreadPool& pool)
+{
+	// stable_sort keeps shaders with the same
+	// priority in the order they were added
+	order.resize(jobs.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(),
+		[this](size_t a, size_t b) { return jobs[a].priority > jobs[b].priority; });
+
+	next = 0;
+	start_us = platform_time_us();
+
+	// one worker per thread, each with its own compiler,
+	// and never more workers than there are shaders
+	thread_count = std::min(pool.size(), (uint32_t)jobs.size());
+	for (uint32_t i = 0; i < thread_count; i++)
+		pool.submit([this]() { worker_main(); });
+	pool.wait_idle();
+
+	wall_ms = (platform_time_us() - start_us) / 1000.0;
+}
+
+void ShaderBatch::worker_main()
+{
+	ShaderCompiler compiler(cache, includes, include_directories);
+
+	// each worker writes only into the jobs it took,
+	// so the jobs need no lock
+	for (size_t n = next++; n < order.size(); n = next++)
+	{
+		ShaderJob& job = jobs[order[n]];
+
+		uint64_t job_start_us = platform_time_us();
+		ShaderOutput& out = job.output;
+		if (compiler.compile(job.source, out) && !job.output_path.empty() &&
+			!platform_write_file_atomic(job.output_path.c_str(), out.spirv.data(), out.spirv.size() * sizeof(uint32_t)))
+		{
+			out.ok = false;
+			out.error = "Could not write " + job.output_path + "\n";
+		}
+
+		uint64_t now_us = platform_time_us();
+		job.compile_ms = (now_us - job_start_us) / 1000.0;
+		job.finished_ms = (now_us - start_us) / 1000.0;
+	}
+}
+
+uint32_t ShaderBatch::failed() const
+{
+	uint32_t count = 0;
+	for (size_t i = 0; i < jobs.size(); i++)
+		count += jobs[i].output.ok ? 0 : 1;
+	return count;
+}
+
+void ShaderBatch::print_report() const
+{
+	// in the order they were started, so the
+	// important shaders are at the top
+	double total_ms = 0;
+	uint32_t cached = 0, compiled = 0;
+	uint32_t stripped = 0;
+	size_t unstripped_bytes = 0, stripped_bytes = 0;
+	printf("priority  compile ms   done at ms\n");
+	for (size_t n = 0; n < order.size(); n++)
+	{
+		const ShaderJob& job = jobs[order[n]];
+		total_ms += job.compile_ms;
+		const ShaderOutput& out = job.output;
+
+		// counted the same way as they are shown below, a shader
+		// from the cache whose .spv could not be written failed
+		cached += out.ok && out.from_cache ? 1 : 0;
+		compiled += out.ok && !out.from_cache ? 1 : 0;
+
+		if (out.ok && out.unstripped_bytes)
+		{
+			stripped++;
+			unstripped_bytes += out.unstripped_bytes;
+			stripped_bytes += out.spirv.size() * sizeof(uint32_t);
+		}
+
+		if (!out.ok)
+			printf("%s", out.error.c_str());
+		printf("%8d  %10.2f  %11.2f  %s  %s", job.priority, job.compile_ms, job.finished_ms,
+			!out.ok ? "failed  " : out.from_cache ? "cached  " : "compiled", job.source.name.c_str());
+		if (!job.variant.empty())
+			printf(" [%s]", job.variant.c_str());
+
+		// why a shader was compiled again, usually because
+		// of a file that it (or one of its includes) includes
+		if (out.ok && !out.from_cache && !out.rebuild_reason.empty())
+			printf("  (%s)", out.rebuild_reason.c_str());
+		if (out.ok && !out.strip_warning.empty())
+			printf("  (%s)", out.strip_warning.c_str());
+		printf("\n");
+	}
+
+	// compile time added up over every shader, against the time
+	// that really went by, is how much the threads gave us
+	uint32_t failures = failed();
+	printf("\n%u shaders on %u threads in %.2f ms (%.2f ms of work, %.2fx): "
+		"%u from the cache, %u compiled, %u failed, %u included files read\n",
+		(uint32_t)jobs.size(), thread_count, wall_ms, total_ms, wall_ms > 0 ? total_ms / wall_ms : 0.0,
+		cached, compiled, failures, includes.disk_reads());
+
+	// only the shaders that were compiled this time, the ones
+	// from the cache were stripped when they were compiled
+	if (stripped)
+	{
+		printf("Stripping %u shaders took them from %.1f KB to %.1f KB (%.1f%% smaller)\n", stripped,
+			unstripped_bytes / 1024.0, stripped_bytes / 1024.0,
+			100.0 * (unstripped_bytes - stripped_bytes) / unstripped_bytes);
+	}
+}
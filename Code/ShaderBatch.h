@@ -0,0 +1,99 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "ShaderCompiler.h"
+#include "ThreadPool.h"
+
+// One shader for ShaderBatch to compile, and what happened to it
+struct ShaderJob
+{
+	ShaderSource source;
+
+	// higher numbers are compiled first, so that the shaders
+	// that the first frame needs do not wait behind the rest
+	int priority;
+
+	// where the SPIR-V is written, nothing is written if empty
+	std::string output_path;
+
+	// which variant of the shader this is, for the
+	// report ("UNROLL=4"), empty for most shaders
+	std::string variant;
+
+	ShaderOutput output;
+
+	// how long this shader took, and when it was
+	// done, counting from the start of the batch
+	double compile_ms;
+	double finished_ms;
+};
+
+// ShaderBatch compiles many shaders on every thread of a ThreadPool.
+// Every worker has its own ShaderCompiler (a shaderc::Compiler can
+// not be shared) and takes the next job from one list sorted by
+// priority, so the important shaders are started first no matter
+// how many threads there are, and a slow shader never holds up the
+// jobs behind it on the other threads
+class ShaderBatch
+{
+public:
+	ShaderBatch(ShaderCache* cache, const std::vector<std::string>& include_directories);
+
+	void add(const ShaderSource& source, int priority, const std::string& output_path,
+		const std::string& variant);
+
+	// compile everything, and return when every job is done
+	void run(ThreadPool& pool);
+
+	const std::vector<ShaderJob>& results() const { return jobs; }
+	uint32_t failed() const;
+
+	// the time of every shader, and how much the threads helped
+	void print_report() const;
+
+private:
+	void worker_main();
+
+	ShaderCache* cache;
+	std::vector<std::string> include_directories;
+	std::vector<ShaderJob> jobs;
+
+	// every included file is read once, for all the workers
+	IncludeCache includes;
+
+	// job indices, highest priority first, and
+	// the next one that a worker should take
+	std::vector<size_t> order;
+	std::atomic<size_t> next;
+
+	uint64_t start_us;
+	double wall_ms;
+	uint32_t thread_count;
+};
@@ -0,0 +1,235 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "ShaderBundle.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "Platform.h"
+
+uint64_t shader_permutation(const std::vector<std::pair<std::string, std::string>>& macros)
+{
+	if (macros.empty())
+		return 0;
+
+	std::vector<std::pair<std::string, std::string>> sorted = macros;
+	std::sort(sorted.begin(), sorted.end());
+
+	ShaderHasher hasher;
+	hasher.add("permutation", 11);
+	for (size_t i = 0; i < sorted.size(); i++)
+	{
+		hasher.add(sorted[i].first);
+		hasher.add(sorted[i].second);
+	}
+	return hasher.key().lo;
+}
+
+uint64_t shader_name_hash(const std::string& name)
+{
+	ShaderHasher hasher;
+	hasher.add("name", 4);
+	hasher.add(name);
+	return hasher.key().lo;
+}
+
+void ShaderBundleWriter::add(const std::string& name, uint64_t permutation, VkShaderStageFlagBits stage,
+	const std::vector<uint32_t>& spirv)
+{
+	ShaderKey content = hash_contents(spirv.data(), spirv.size() * sizeof(uint32_t));
+	std::map<ShaderKey, uint32_t>::iterator found = module_index.find(content);
+	if (found == module_index.end())
+	{
+		found = module_index.insert(std::make_pair(content, (uint32_t)modules.size())).first;
+		modules.push_back(spirv);
+	}
+
+	BundledShader shader;
+	shader.name = name;
+	shader.stage = stage;
+	shader.module = found->second;
+	shaders[std::make_pair(std::make_pair(shader_name_hash(name), permutation), name)] = shader;
+}
+
+static uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+bool ShaderBundleWriter::write(const char* path)
+{
+	std::string strings;
+	std::vector<ShaderBundleEntry> entries;
+	std::vector<uint32_t> entry_modules;
+
+	for (std::map<std::pair<std::pair<uint64_t, uint64_t>, std::string>, BundledShader>::const_iterator it = shaders.begin();
+		it != shaders.end(); ++it)
+	{
+		ShaderBundleEntry entry = {};
+		entry.name_hash = it->first.first.first;
+		entry.permutation = it->first.first.second;
+		entry.name_offset = (uint32_t)strings.size();
+		entry.stage = it->second.stage;
+		entry.code_size = modules[it->second.module].size() * sizeof(uint32_t);
+		entries.push_back(entry);
+		entry_modules.push_back(it->second.module);
+
+		strings.append(it->second.name.c_str(), it->second.name.size() + 1);
+	}
+
+	// every module starts on an aligned offset, after the index
+	ShaderBundleHeader header = {};
+	header.magic = SHADER_BUNDLE_MAGIC;
+	header.version = SHADER_BUNDLE_VERSION;
+	header.entry_count = (uint32_t)entries.size();
+	header.module_count = (uint32_t)modules.size();
+	header.string_table_size = strings.size();
+	header.code_offset = align_up(sizeof(header) + entries.size() * sizeof(ShaderBundleEntry) + strings.size(),
+		SHADER_BUNDLE_ALIGNMENT);
+
+	std::vector<uint64_t> module_offsets(modules.size());
+	uint64_t offset = header.code_offset;
+	for (size_t m = 0; m < modules.size(); m++)
+	{
+		module_offsets[m] = offset;
+		offset = align_up(offset + modules[m].size() * sizeof(uint32_t), SHADER_BUNDLE_ALIGNMENT);
+	}
+
+	for (size_t i = 0; i < entries.size(); i++)
+		entries[i].code_offset = module_offsets[entry_modules[i]];
+
+	std::vector<uint8_t> bytes(offset, 0);
+	memcpy(bytes.data(), &header, sizeof(header));
+	if (!entries.empty())
+		memcpy(bytes.data() + sizeof(header), entries.data(), entries.size() * sizeof(ShaderBundleEntry));
+	memcpy(bytes.data() + sizeof(header) + entries.size() * sizeof(ShaderBundleEntry), strings.data(), strings.size());
+	for (size_t m = 0; m < modules.size(); m++)
+		memcpy(bytes.data() + module_offsets[m], modules[m].data(), modules[m].size() * sizeof(uint32_t));
+
+	return platform_write_file_atomic(path, bytes.data(), bytes.size());
+}
+
+ShaderBundle::ShaderBundle()
+{
+	entries = nullptr;
+	strings = nullptr;
+	entry_count = 0;
+}
+
+bool ShaderBundle::open(const char* path)
+{
+	close();
+	if (!file.open(path))
+		return false;
+
+	// Like the shader cache index, every size is checked
+	// before we trust it, the file could have come from anywhere.
+	// The string table size is checked on its own first, so that
+	// adding it to the other sizes can not wrap around
+	ShaderBundleHeader header;
+	if (file.size() < sizeof(header))
+	{
+		close();
+		return false;
+	}
+	memcpy(&header, file.data(), sizeof(header));
+
+	uint64_t entries_size = (uint64_t)header.entry_count * sizeof(ShaderBundleEntry);
+	uint64_t index_size = sizeof(header) + entries_size + header.string_table_size;
+	if (header.magic != SHADER_BUNDLE_MAGIC || header.version != SHADER_BUNDLE_VERSION ||
+		header.string_table_size > file.size() || index_size > file.size() || header.code_offset < index_size || header.code_offset > file.size() ||
+		(header.string_table_size > 0 && file.data()[index_size - 1] != 0))
+	{
+		printf("%s is not a shader bundle we can read\n", path);
+		close();
+		return false;
+	}
+
+	const ShaderBundleEntry* all = (const ShaderBundleEntry*)(file.data() + sizeof(header));
+	for (uint32_t i = 0; i < header.entry_count; i++)
+	{
+		const ShaderBundleEntry& entry = all[i];
+		bool fits = entry.name_offset < header.string_table_size &&
+			entry.code_offset >= header.code_offset && entry.code_offset <= file.size() &&
+			entry.code_offset % sizeof(uint32_t) == 0 &&
+			entry.code_size > 0 && entry.code_size % sizeof(uint32_t) == 0 &&
+			entry.code_size <= file.size() - entry.code_offset;
+		if (!fits)
+		{
+			printf("%s is a broken shader bundle (entry %u)\n", path, i);
+			close();
+			return false;
+		}
+	}
+
+	entries = all;
+	strings = (const char*)(file.data() + sizeof(header) + entries_size);
+	entry_count = header.entry_count;
+	return true;
+}
+
+void ShaderBundle::close()
+{
+	file.close();
+	entries = nullptr;
+	strings = nullptr;
+	entry_count = 0;
+}
+
+static bool entry_before(const ShaderBundleEntry& entry, const std::pair<uint64_t, uint64_t>& key)
+{
+	if (entry.name_hash != key.first)
+		return entry.name_hash < key.first;
+	return entry.permutation < key.second;
+}
+
+const ShaderBundleEntry* ShaderBundle::find(const std::string& name, uint64_t permutation) const
+{
+	// The entries are sorted by their hashes, so we binary search
+	// them, and then check the name, in case two names have the
+	// same hash (they would be next to each other)
+	std::pair<uint64_t, uint64_t> key(shader_name_hash(name), permutation);
+	const ShaderBundleEntry* end = entries + entry_count;
+	for (const ShaderBundleEntry* entry = std::lower_bound(entries, end, key, entry_before);
+		entry != end && entry->name_hash == key.first && entry->permutation == key.second; ++entry)
+	{
+		if (name == strings + entry->name_offset)
+			return entry;
+	}
+	return nullptr;
+}
+
+VkResult ShaderBundle::create_module(VkDevice device, const ShaderBundleEntry& entry, VkShaderModule* module) const
+{
+	// pCode points into the mapping. The driver reads the SPIR-V
+	// while we wait, so the pages that hold it are the only part
+	// of the file that is ever read from the disk
+	VkShaderModuleCreateInfo info = {};
+	info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	info.codeSize = (size_t)entry.code_size;
+	info.pCode = code(entry);
+	return vkCreateShaderModule(device, &info, NULL, module);
+}
@@ -0,0 +1,162 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "MappedFile.h"
+#include "ShaderCache.h"
+
+// A program with hundreds of shaders (and a few versions of each, one
+// per set of macros) would open and read hundreds of small .spv files
+// at startup, and copy every one of them into memory before Vulkan
+// could see it. A shader bundle is all of them packed into one file.
+// We map the file, and vkCreateShaderModule reads each module straight
+// out of the mapping: one open, no reads, and no copies.
+//
+// Shaders are looked up by their name (the path of the GLSL file they
+// were compiled from) and their permutation, a hash of the macros they
+// were compiled with (see shader_permutation). Modules that came out
+// with exactly the same SPIR-V are only stored once, which happens a
+// lot after -strip-shaders gives them canonical IDs.
+//
+// Bundle file layout, every part is mapped and read in place:
+//
+//     ShaderBundleHeader
+//     ShaderBundleEntry[entry_count]     (sorted by name_hash, then permutation)
+//     string table                       (shader names)
+//     SPIR-V of every module, each starting on a
+//     SHADER_BUNDLE_ALIGNMENT boundary
+
+#define SHADER_BUNDLE_MAGIC 0x42534B56 // "VKSB"
+#define SHADER_BUNDLE_VERSION 1
+
+// pCode only has to be 4 byte aligned, we go a little further
+// so that a module never starts in the middle of a cache line
+// that also holds the end of the module before it
+#define SHADER_BUNDLE_ALIGNMENT 64
+
+struct ShaderBundleHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entry_count;
+	uint32_t module_count;
+	uint64_t string_table_size;
+
+	// where the first module starts, from the start of the file
+	uint64_t code_offset;
+};
+
+struct ShaderBundleEntry
+{
+	uint64_t name_hash;
+	uint64_t permutation;
+	uint32_t name_offset;    // into the string table
+	uint32_t stage;          // a VkShaderStageFlagBits
+	uint64_t code_offset;    // from the start of the file
+	uint64_t code_size;      // in bytes
+};
+
+// the hash of a set of macros, 0 for none. The same macros
+// in any order are the same permutation
+uint64_t shader_permutation(const std::vector<std::pair<std::string, std::string>>& macros);
+
+// the hash that entries are sorted and found by
+uint64_t shader_name_hash(const std::string& name);
+
+// Packs compiled shaders into a bundle file, for -compile-shaders
+class ShaderBundleWriter
+{
+public:
+	// Adding a shader with the same name and
+	// permutation again replaces the first one
+	void add(const std::string& name, uint64_t permutation, VkShaderStageFlagBits stage,
+		const std::vector<uint32_t>& spirv);
+
+	// Write the bundle, in one step, so a program that is reading
+	// the old bundle never sees half of a new one
+	bool write(const char* path);
+
+	uint32_t shader_count() const { return (uint32_t)shaders.size(); }
+	uint32_t module_count() const { return (uint32_t)modules.size(); }
+
+private:
+	struct BundledShader
+	{
+		std::string name;
+		VkShaderStageFlagBits stage;
+		uint32_t module;
+	};
+
+	// keyed by (name hash, permutation) and the name, so the
+	// map is already in the order the entries are written in
+	std::map<std::pair<std::pair<uint64_t, uint64_t>, std::string>, BundledShader> shaders;
+
+	// every different SPIR-V, once, and where to find it by its hash
+	std::vector<std::vector<uint32_t>> modules;
+	std::map<ShaderKey, uint32_t> module_index;
+};
+
+// A bundle file, mapped for as long as it is open
+class ShaderBundle
+{
+public:
+	ShaderBundle();
+
+	// Map the bundle at "path", and check every entry in it, so that
+	// nothing later can read past the end of a broken file
+	bool open(const char* path);
+	void close();
+
+	uint32_t size() const { return entry_count; }
+	const ShaderBundleEntry& entry(uint32_t index) const { return entries[index]; }
+
+	// null if the bundle has no such shader
+	const ShaderBundleEntry* find(const std::string& name, uint64_t permutation) const;
+
+	const char* name(const ShaderBundleEntry& entry) const { return strings + entry.name_offset; }
+
+	// The SPIR-V of an entry, inside the mapping
+	const uint32_t* code(const ShaderBundleEntry& entry) const
+	{
+		return (const uint32_t*)(file.data() + entry.code_offset);
+	}
+
+	// make a module from an entry, without copying its SPIR-V
+	VkResult create_module(VkDevice device, const ShaderBundleEntry& entry, VkShaderModule* module) const;
+
+private:
+	MappedFile file;
+	const ShaderBundleEntry* entries;
+	const char* strings;
+	uint32_t entry_count;
+};
@@ -0,0 +1,459 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "ShaderCache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "Platform.h"
+#include "ShaderIncluder.h"
+
+// Two different 64 bit hashes of the same bytes: FNV-1a, and a
+// multiply and shift hash. Together they make the 128 bit key
+ShaderHasher::ShaderHasher()
+{
+	a = 14695981039346656037ull;
+	b = 0x9E3779B97F4A7C15ull;
+	length = 0;
+}
+
+void ShaderHasher::add(const void* data, size_t size)
+{
+	uint64_t size64 = size;
+	const uint8_t* bytes[2] = { (const uint8_t*)&size64, (const uint8_t*)data };
+	size_t sizes[2] = { sizeof(size64), size };
+
+	for (int part = 0; part < 2; part++)
+	{
+		for (size_t i = 0; i < sizes[part]; i++)
+		{
+			uint8_t c = bytes[part][i];
+			a = (a ^ c) * 1099511628211ull;
+			b = (b ^ c) * 0xFF51AFD7ED558CCDull;
+			b ^= b >> 32;
+		}
+	}
+	length += size;
+}
+
+ShaderKey ShaderHasher::key() const
+{
+	// mix each half with the other, so that every
+	// input bit can change every output bit
+	ShaderKey key;
+	uint64_t x = a ^ (b >> 31) ^ length;
+	x *= 0xC4CEB9FE1A85EC53ull;
+	x ^= x >> 33;
+	uint64_t y = b ^ (a << 7);
+	y *= 0xFF51AFD7ED558CCDull;
+	y ^= y >> 29;
+	key.lo = x;
+	key.hi = y;
+	return key;
+}
+
+ShaderSource::ShaderSource()
+{
+	stage = shaderc_glsl_infer_from_source;
+	entry_point = "main";
+	target_env = shaderc_target_env_vulkan;
+	target_env_version = shaderc_env_version_vulkan_1_0;
+	optimization = shaderc_optimization_level_performance;
+	strip = false;
+}
+
+ShaderKey hash_contents(const void* data, size_t size)
+{
+	ShaderHasher hasher;
+	hasher.add("file", 4);
+	hasher.add(data, size);
+	return hasher.key();
+}
+
+ShaderKey ShaderCache::identity_key(const ShaderSource& source, const std::vector<std::string>& include_directories)
+{
+	ShaderHasher hasher;
+	hasher.add((uint32_t)SHADER_CACHE_VERSION);
+
+	// A newer compiler can make different SPIR-V from the same
+	// GLSL. The library only tells us which SPIR-V version it
+	// makes, so the cache folder should be deleted by hand after
+	// updating the Vulkan SDK, like any other build folder
+	unsigned int spv_version = 0, spv_revision = 0;
+	shaderc_get_spv_version(&spv_version, &spv_revision);
+	hasher.add((uint32_t)spv_version);
+	hasher.add((uint32_t)spv_revision);
+
+	hasher.add(source.name);
+	hasher.add((uint32_t)source.stage);
+	hasher.add(source.entry_point);
+	hasher.add((uint32_t)source.target_env);
+	hasher.add(source.target_env_version);
+	hasher.add((uint32_t)source.optimization);
+	hasher.add((uint32_t)source.strip);
+
+	// "-DA -DB" and "-DB -DA" make the same shader, so the
+	// macros are hashed in sorted order
+	std::vector<std::pair<std::string, std::string>> macros = source.macros;
+	std::sort(macros.begin(), macros.end());
+	hasher.add((uint32_t)macros.size());
+	for (size_t i = 0; i < macros.size(); i++)
+	{
+		hasher.add(macros[i].first);
+		hasher.add(macros[i].second);
+	}
+
+	// The same #include <file> can find another file when the
+	// folders change, or only change order, so they are hashed in
+	// the order they are searched
+	hasher.add((uint32_t)include_directories.size());
+	for (size_t i = 0; i < include_directories.size(); i++)
+		hasher.add(include_directories[i]);
+
+	return hasher.key();
+}
+
+// the key of the shader, plus what is in its text and
+// in the included files, this is the name of the SPIR-V
+static ShaderKey object_key(const ShaderKey& identity, const ShaderKey& source_content,
+	const std::vector<ShaderDependency>& dependencies)
+{
+	ShaderHasher hasher;
+	hasher.add(identity);
+	hasher.add(source_content);
+	hasher.add((uint32_t)dependencies.size());
+	for (size_t i = 0; i < dependencies.size(); i++)
+	{
+		hasher.add(dependencies[i].path);
+		hasher.add(dependencies[i].content);
+	}
+	return hasher.key();
+}
+
+ShaderCache::ShaderCache()
+{
+	entries = nullptr;
+	index_dependencies = nullptr;
+	strings = nullptr;
+	entry_count = 0;
+	dependency_count = 0;
+	string_table_size = 0;
+	hit_count = 0;
+	miss_count = 0;
+}
+
+bool ShaderCache::open(const char* directory)
+{
+	this->directory = directory;
+	stored.clear();
+
+	if (!platform_create_directory(directory))
+		return false;
+
+	map_index();
+	return true;
+}
+
+void ShaderCache::map_index()
+{
+	index.close();
+	entries = nullptr;
+	entry_count = 0;
+	dependency_count = 0;
+	string_table_size = 0;
+
+	// No index yet (or a broken one) just means an empty cache.
+	// Every size is checked before we trust it, the file could
+	// have come from anywhere. Each one is checked on its own
+	// before they are added up, so the sum can not wrap around
+	std::string index_path = directory + "/index.bin";
+	if (!index.open(index_path.c_str()))
+		return;
+
+	ShaderCacheIndexHeader header;
+	if (index.size() < sizeof(header))
+	{
+		index.close();
+		return;
+	}
+	memcpy(&header, index.data(), sizeof(header));
+
+	uint64_t entries_size = (uint64_t)header.entry_count * sizeof(ShaderCacheIndexEntry);
+	uint64_t dependencies_size = (uint64_t)header.dependency_count * sizeof(ShaderCacheDependency);
+	if (header.magic != SHADER_CACHE_MAGIC || header.version != SHADER_CACHE_VERSION ||
+		entries_size > index.size() || dependencies_size > index.size() ||
+		header.string_table_size > index.size() ||
+		sizeof(header) + entries_size + dependencies_size + header.string_table_size != index.size())
+	{
+		printf("Ignoring the shader cache index %s, it is not one we can read\n\n", index_path.c_str());
+		index.close();
+		return;
+	}
+
+	entries = (const ShaderCacheIndexEntry*)(index.data() + sizeof(header));
+	index_dependencies = (const ShaderCacheDependency*)((const uint8_t*)entries + entries_size);
+	strings = (const char*)((const uint8_t*)index_dependencies + dependencies_size);
+	entry_count = header.entry_count;
+	dependency_count = header.dependency_count;
+	string_table_size = header.string_table_size;
+}
+
+std::string ShaderCache::object_path(const ShaderKey& key) const
+{
+	char name[40];
+	snprintf(name, sizeof(name), "%016llx%016llx.spv", (unsigned long long)key.hi, (unsigned long long)key.lo);
+	return directory + "/" + name;
+}
+
+const char* ShaderCache::index_string(uint32_t offset) const
+{
+	// an offset that points outside of the string table,
+	// or a string without its zero at the end, is a miss
+	if (offset >= string_table_size || !memchr(strings + offset, 0, (size_t)(string_table_size - offset)))
+		return nullptr;
+	return strings + offset;
+}
+
+bool ShaderCache::read_entry(const ShaderCacheIndexEntry& entry, ShaderCacheRecord& record) const
+{
+	record.source_content = entry.source_content;
+	record.dependencies.clear();
+	if ((uint64_t)entry.first_dependency + entry.dependency_count > dependency_count)
+		return false;
+
+	for (uint32_t i = 0; i < entry.dependency_count; i++)
+	{
+		const ShaderCacheDependency& d = index_dependencies[entry.first_dependency + i];
+		const char* path = index_string(d.path_offset);
+		const char* included_by = index_string(d.included_by_offset);
+		if (!path || !included_by)
+			return false;
+
+		ShaderDependency dependency;
+		dependency.path = path;
+		dependency.included_by = included_by;
+		dependency.content = d.content;
+		record.dependencies.push_back(dependency);
+	}
+	return true;
+}
+
+bool ShaderCache::lookup(const ShaderKey& identity, ShaderCacheRecord& record)
+{
+	// something stored since open is newer than the index
+	{
+		std::lock_guard<std::mutex> hold(lock);
+		std::map<ShaderKey, ShaderCacheRecord>::const_iterator it = stored.find(identity);
+		if (it != stored.end())
+		{
+			record = it->second;
+			return true;
+		}
+	}
+
+	const ShaderCacheIndexEntry* end = entries + entry_count;
+	const ShaderCacheIndexEntry* entry = std::lower_bound(entries, end, identity,
+		[](const ShaderCacheIndexEntry& e, const ShaderKey& key) { return e.identity < key; });
+	if (entry == end || !(entry->identity == identity))
+		return false;
+
+	return read_entry(*entry, record);
+}
+
+void ShaderCache::remember(const ShaderKey& identity, const ShaderCacheRecord& record)
+{
+	std::lock_guard<std::mutex> hold(lock);
+	stored[identity] = record;
+}
+
+bool ShaderCache::find(const ShaderSource& source, const std::vector<std::string>& include_directories,
+	IncludeCache& includes, std::vector<uint32_t>& spirv,
+	std::vector<ShaderDependency>& dependencies, std::string& why)
+{
+	ShaderKey identity = identity_key(source, include_directories);
+	ShaderCacheRecord record;
+	if (!lookup(identity, record))
+	{
+		why = "new";
+		miss_count++;
+		return false;
+	}
+
+	// Hash the shader, and every file it included last time,
+	// as they are now. Many shaders include the same files,
+	// the IncludeCache only reads each of them once. This also
+	// checks the places that had no file last time, a file
+	// that is there now changes from "missing" to its text
+	ShaderCacheRecord now;
+	now.source_content = hash_contents(source.text.data(), source.text.size());
+	now.dependencies = record.dependencies;
+
+	std::vector<std::string> changed;
+	if (!(now.source_content == record.source_content))
+		changed.push_back(source.name);
+	for (size_t i = 0; i < now.dependencies.size(); i++)
+	{
+		std::shared_ptr<const IncludeFile> file = includes.load(now.dependencies[i].path);
+		now.dependencies[i].content = file->content;
+
+		// a file that is included twice is only named once
+		if (!(file->content == record.dependencies[i].content) &&
+			std::find(changed.begin(), changed.end(), file->path) == changed.end())
+			changed.push_back(file->path);
+	}
+
+	// Even when something changed, it might have changed back
+	// to a version that we compiled before (like undoing an edit)
+	MappedFile object;
+	if (!object.open(object_path(object_key(identity, now.source_content, now.dependencies)).c_str()) ||
+		object.size() % sizeof(uint32_t) != 0)
+	{
+		why = changed.empty() ? "the SPIR-V is missing from the cache" : "";
+		for (size_t i = 0; i < changed.size(); i++)
+			why += (i ? ", " : "") + changed[i];
+		if (!changed.empty())
+			why += " changed";
+		miss_count++;
+		return false;
+	}
+
+	spirv.resize(object.size() / sizeof(uint32_t));
+	memcpy(spirv.data(), object.data(), object.size());
+	dependencies = now.dependencies;
+	if (!changed.empty())
+		remember(identity, now);
+	hit_count++;
+	return true;
+}
+
+void ShaderCache::store(const ShaderSource& source, const std::vector<std::string>& include_directories,
+	const std::vector<ShaderDependency>& dependencies, const std::vector<uint32_t>& spirv)
+{
+	ShaderKey identity = identity_key(source, include_directories);
+	ShaderCacheRecord record;
+	record.source_content = hash_contents(source.text.data(), source.text.size());
+	record.dependencies = dependencies;
+
+	// The object file is named after everything that went into
+	// it, so two threads that store the same shader write the
+	// same bytes
+	std::string path = object_path(object_key(identity, record.source_content, dependencies));
+	if (!platform_write_file_atomic(path.c_str(), spirv.data(), spirv.size() * sizeof(uint32_t)))
+	{
+		printf("Could not write %s to the shader cache\n", path.c_str());
+		return;
+	}
+
+	remember(identity, record);
+}
+
+bool ShaderCache::save()
+{
+	std::lock_guard<std::mutex> hold(lock);
+	if (stored.empty())
+		return true;
+
+	// Everything from the old index that was not replaced,
+	// and everything new, sorted by key, is the new index.
+	// The records are copied out, because the old index is
+	// unmapped before the new one takes its place
+	std::map<ShaderKey, ShaderCacheRecord> merged = stored;
+	for (uint32_t i = 0; i < entry_count; i++)
+	{
+		ShaderCacheRecord record;
+		if (!merged.count(entries[i].identity) && read_entry(entries[i], record))
+			merged[entries[i].identity] = record;
+	}
+
+	std::vector<ShaderCacheIndexEntry> new_entries;
+	std::vector<ShaderCacheDependency> new_dependencies;
+	std::string new_strings;
+	std::map<std::string, uint32_t> string_offsets;
+
+	// most shaders include the same few files,
+	// so every path is only stored once
+	auto intern = [&](const std::string& text)
+	{
+		std::map<std::string, uint32_t>::const_iterator found = string_offsets.find(text);
+		if (found == string_offsets.end())
+		{
+			found = string_offsets.insert(std::make_pair(text, (uint32_t)new_strings.size())).first;
+			new_strings.append(text.c_str(), text.size() + 1);
+		}
+		return found->second;
+	};
+
+	for (std::map<ShaderKey, ShaderCacheRecord>::const_iterator it = merged.begin(); it != merged.end(); ++it)
+	{
+		ShaderCacheIndexEntry entry;
+		entry.identity = it->first;
+		entry.source_content = it->second.source_content;
+		entry.first_dependency = (uint32_t)new_dependencies.size();
+		entry.dependency_count = (uint32_t)it->second.dependencies.size();
+		new_entries.push_back(entry);
+
+		for (size_t i = 0; i < it->second.dependencies.size(); i++)
+		{
+			const ShaderDependency& dependency = it->second.dependencies[i];
+			ShaderCacheDependency d;
+			d.path_offset = intern(dependency.path);
+			d.included_by_offset = intern(dependency.included_by);
+			d.content = dependency.content;
+			new_dependencies.push_back(d);
+		}
+	}
+
+	ShaderCacheIndexHeader header = {};
+	header.magic = SHADER_CACHE_MAGIC;
+	header.version = SHADER_CACHE_VERSION;
+	header.entry_count = (uint32_t)new_entries.size();
+	header.dependency_count = (uint32_t)new_dependencies.size();
+	header.string_table_size = new_strings.size();
+
+	std::vector<uint8_t> bytes(sizeof(header));
+	memcpy(bytes.data(), &header, sizeof(header));
+	bytes.insert(bytes.end(), (const uint8_t*)new_entries.data(), (const uint8_t*)(new_entries.data() + new_entries.size()));
+	bytes.insert(bytes.end(), (const uint8_t*)new_dependencies.data(),
+		(const uint8_t*)(new_dependencies.data() + new_dependencies.size()));
+	bytes.insert(bytes.end(), new_strings.begin(), new_strings.end());
+
+	// Windows can not replace a file that is still mapped
+	index.close();
+	entries = nullptr;
+	entry_count = 0;
+
+	std::string index_path = directory + "/index.bin";
+	if (!platform_write_file_atomic(index_path.c_str(), bytes.data(), bytes.size()))
+	{
+		map_index();
+		return false;
+	}
+
+	// everything that was stored is in the new index now
+	stored.clear();
+	map_index();
+	return true;
+}
@@ -0,0 +1,233 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <shaderc/shaderc.h>
+
+#include "MappedFile.h"
+
+class IncludeCache;
+
+// Compiling GLSL into SPIR-V is slow, and it gives the same answer
+// every time for the same input. The shader cache remembers every
+// answer in a folder on the disk, so that a shader is only compiled
+// again when something that goes into it has changed.
+//
+// "Something that goes into it" is the GLSL text, the macros, the
+// stage, the entry point, the target environment, the optimization
+// level, the version of the compiler, the include folders (in order),
+// and the text of every file that the shader included. All of that is hashed into a 128 bit key, and
+// the SPIR-V is stored in a file named after the key:
+//
+//     shader_cache/index.bin                    (see below)
+//     shader_cache/0123456789abcdef....spv      (one per compiled shader)
+//
+// The catch is the includes: we only know which files a shader
+// includes after compiling it. So the index remembers, for every
+// shader (the "identity key": its name and settings, without any
+// text), the hash of its text and which files it included last time,
+// with the hash of each. To look a shader up, we hash the files that
+// are there now (through the IncludeCache, so each file is read once
+// no matter how many shaders include it), and if the SPIR-V for that
+// exact combination is in the folder, we never call the compiler at
+// all. If it is not, the old hashes tell us which file changed.
+// The places where an include was looked for and not found are kept
+// too, as missing files, because a file that is made there later
+// would be included instead of the one we found
+
+// A 128 bit hash. It is not a cryptographic hash, it only has to keep
+// shaders that are different from ever getting the same key by chance
+struct ShaderKey
+{
+	uint64_t lo, hi;
+};
+
+inline bool operator==(const ShaderKey& a, const ShaderKey& b) { return a.lo == b.lo && a.hi == b.hi; }
+inline bool operator<(const ShaderKey& a, const ShaderKey& b) { return a.hi != b.hi ? a.hi < b.hi : a.lo < b.lo; }
+
+// Builds a ShaderKey from pieces. Every piece is hashed with its
+// length, so that "ab" + "c" and "a" + "bc" give different keys
+class ShaderHasher
+{
+public:
+	ShaderHasher();
+
+	void add(const void* data, size_t size);
+	void add(const std::string& text) { add(text.data(), text.size()); }
+	void add(uint32_t value) { add(&value, sizeof(value)); }
+	void add(const ShaderKey& key) { add(&key, sizeof(key)); }
+
+	ShaderKey key() const;
+
+private:
+	uint64_t a, b;
+	uint64_t length;
+};
+
+// Everything the compiler is given for one shader
+struct ShaderSource
+{
+	// the file the GLSL came from, used in error
+	// messages and to find the files it includes
+	std::string name;
+	std::string text;
+
+	shaderc_shader_kind stage;
+	std::string entry_point;
+
+	// #define NAME VALUE, for every pair
+	std::vector<std::pair<std::string, std::string>> macros;
+
+	shaderc_target_env target_env;
+	uint32_t target_env_version;
+	shaderc_optimization_level optimization;
+
+	// take the debug info out of the SPIR-V, and give
+	// it canonical IDs, after compiling (SpirvRemap.h)
+	bool strip;
+
+	ShaderSource();
+};
+
+// One #include of one shader. All of them together are the
+// include graph of the shader: every file, and who included it.
+// A place that was looked in and had no file has the "missing"
+// content of IncludeCache, see ShaderIncluder::GetInclude
+struct ShaderDependency
+{
+	std::string path;
+	std::string included_by;
+	ShaderKey content;
+};
+
+// hash the text of a file (or of a shader)
+ShaderKey hash_contents(const void* data, size_t size);
+
+// Index file layout, every part is mapped and read in place:
+//
+//     ShaderCacheIndexHeader
+//     ShaderCacheIndexEntry[entry_count]            (sorted by identity)
+//     ShaderCacheDependency[dependency_count]
+//     string table                                  (include paths)
+
+#define SHADER_CACHE_MAGIC 0x43534B56 // "VKSC"
+#define SHADER_CACHE_VERSION 3
+
+struct ShaderCacheIndexHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entry_count;
+	uint32_t dependency_count;
+	uint64_t string_table_size;
+};
+
+struct ShaderCacheIndexEntry
+{
+	ShaderKey identity;
+	ShaderKey source_content;
+	uint32_t first_dependency;
+	uint32_t dependency_count;
+};
+
+struct ShaderCacheDependency
+{
+	uint32_t path_offset;         // into the string table
+	uint32_t included_by_offset;  // into the string table
+	ShaderKey content;
+};
+
+// What the index knows about one shader
+struct ShaderCacheRecord
+{
+	ShaderKey source_content;
+	std::vector<ShaderDependency> dependencies;
+};
+
+// find and store can be called from many threads at once,
+// open and save need the cache to themselves
+class ShaderCache
+{
+public:
+	ShaderCache();
+
+	// Use the folder at "directory", it is made if it is not there
+	bool open(const char* directory);
+
+	// Put the SPIR-V for "source" into "spirv", and the files it
+	// includes into "dependencies", if we have it. Returns false if
+	// it has to be compiled, with the reason in "why" (the shader is
+	// new, or which of its files changed since it was compiled)
+	// "include_directories" are the folders it was compiled with
+	bool find(const ShaderSource& source, const std::vector<std::string>& include_directories,
+		IncludeCache& includes, std::vector<uint32_t>& spirv,
+		std::vector<ShaderDependency>& dependencies, std::string& why);
+
+	// Remember the SPIR-V that was compiled from "source",
+	// along with every file that it included
+	void store(const ShaderSource& source, const std::vector<std::string>& include_directories,
+		const std::vector<ShaderDependency>& dependencies, const std::vector<uint32_t>& spirv);
+
+	// write the index, with everything that was stored since open
+	bool save();
+
+	uint32_t hits() const { return hit_count.load(); }
+	uint32_t misses() const { return miss_count.load(); }
+
+	// the key of the name and settings of a shader, and of
+	// the folders its includes are looked for in, without its text
+	static ShaderKey identity_key(const ShaderSource& source, const std::vector<std::string>& include_directories);
+
+private:
+	void map_index();
+	std::string object_path(const ShaderKey& key) const;
+	const char* index_string(uint32_t offset) const;
+	bool read_entry(const ShaderCacheIndexEntry& entry, ShaderCacheRecord& record) const;
+	bool lookup(const ShaderKey& identity, ShaderCacheRecord& record);
+	void remember(const ShaderKey& identity, const ShaderCacheRecord& record);
+
+	std::string directory;
+	MappedFile index;
+	const ShaderCacheIndexEntry* entries;
+	const ShaderCacheDependency* index_dependencies;
+	const char* strings;
+	uint32_t entry_count;
+	uint32_t dependency_count;
+	uint64_t string_table_size;
+
+	// what was stored since open, waiting for save
+	std::mutex lock;
+	std::map<ShaderKey, ShaderCacheRecord> stored;
+	std::atomic<uint32_t> hit_count;
+	std::atomic<uint32_t> miss_count;
+};
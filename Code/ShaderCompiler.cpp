@@ -0,0 +1,166 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "ShaderCompiler.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "MappedFile.h"
+#include "SpirvRemap.h"
+
+ShaderCompiler::ShaderCompiler(ShaderCache* cache, IncludeCache& includes,
+	const std::vector<std::string>& include_directories)
+	: includes(includes), include_directories(include_directories)
+{
+	this->cache = cache;
+
+	// Copies of base_options keep calling this includer,
+	// which lives as long as base_options does
+	base_options.SetIncluder(std::unique_ptr<shaderc::CompileOptions::IncluderInterface>(
+		new ShaderIncluder(includes, this->include_directories, dependencies)));
+}
+
+bool ShaderCompiler::compile(const ShaderSource& source, ShaderOutput& out)
+{
+	out.ok = false;
+	out.from_cache = false;
+	out.rebuild_reason.clear();
+	out.error.clear();
+	out.unstripped_bytes = 0;
+
+	if (cache && cache->find(source, include_directories, includes, out.spirv, out.dependencies, out.rebuild_reason))
+	{
+		out.ok = true;
+		out.from_cache = true;
+		return true;
+	}
+
+	// macros can only be added to options, never taken away,
+	// so every shader starts from a copy of the base options
+	dependencies.clear();
+	shaderc::CompileOptions options(base_options);
+	for (size_t i = 0; i < source.macros.size(); i++)
+		options.AddMacroDefinition(source.macros[i].first, source.macros[i].second);
+	options.SetTargetEnvironment(source.target_env, source.target_env_version);
+	options.SetOptimizationLevel(source.optimization);
+
+	shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(source.text.data(), source.text.size(),
+		source.stage, source.name.c_str(), source.entry_point.c_str(), options);
+
+	// even a shader that failed tells us what it included,
+	// so we know which files to watch for a fix
+	out.dependencies = dependencies;
+	if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+	{
+		out.error = result.GetErrorMessage();
+		return false;
+	}
+
+	out.spirv.assign(result.cbegin(), result.cend());
+
+	// The cache keeps the stripped SPIR-V, so a shader is only
+	// stripped once. Stripping can only fail on SPIR-V that is
+	// broken, and then we keep what shaderc gave us. A module
+	// with an instruction we do not know keeps its own IDs,
+	// and the report says so
+	if (source.strip)
+	{
+		size_t bytes = out.spirv.size() * sizeof(uint32_t);
+		SpirvRemapStats stats;
+		std::string error;
+		if (!remap_spirv(out.spirv, SPIRV_STRIP_DEBUG | SPIRV_CANONICAL_IDS, &stats, error))
+			out.strip_warning = "not stripped: " + error;
+		else
+		{
+			out.unstripped_bytes = bytes;
+			if (!stats.renumbered)
+				out.strip_warning = "IDs not renumbered";
+		}
+	}
+
+	if (cache)
+		cache->store(source, include_directories, dependencies, out.spirv);
+	out.ok = true;
+	return true;
+}
+
+bool load_shader_source(const char* path, ShaderSource& out)
+{
+	MappedFile file;
+	if (!file.open(path))
+		return false;
+
+	out.name = path;
+	out.text.assign((const char*)file.data(), file.size());
+
+	// the same extensions that glslc understands
+	static const struct { const char* extension; shaderc_shader_kind stage; } stages[] =
+	{
+		{ ".vert", shaderc_glsl_vertex_shader },
+		{ ".frag", shaderc_glsl_fragment_shader },
+		{ ".comp", shaderc_glsl_compute_shader },
+		{ ".geom", shaderc_glsl_geometry_shader },
+		{ ".tesc", shaderc_glsl_tess_control_shader },
+		{ ".tese", shaderc_glsl_tess_evaluation_shader },
+	};
+
+	out.stage = shaderc_glsl_infer_from_source;
+	const char* dot = strrchr(path, '.');
+	for (size_t i = 0; dot && i < sizeof(stages) / sizeof(stages[0]); i++)
+	{
+		if (strcmp(dot, stages[i].extension) == 0)
+			out.stage = stages[i].stage;
+	}
+	return true;
+}
+
+// Turn the options into the settings every shader is compiled with
+bool apply_shader_options(const Options& options, ShaderSource& out)
+{
+	for (size_t i = 0; i < options.shader_defines.size(); i++)
+	{
+		const std::string& define = options.shader_defines[i];
+		size_t equals = define.find('=');
+		if (equals == std::string::npos)
+			out.macros.push_back(std::make_pair(define, std::string()));
+		else
+			out.macros.push_back(std::make_pair(define.substr(0, equals), define.substr(equals + 1)));
+	}
+
+	out.strip = options.strip_shaders;
+
+	if (options.shader_optimization == "zero")
+		out.optimization = shaderc_optimization_level_zero;
+	else if (options.shader_optimization == "size")
+		out.optimization = shaderc_optimization_level_size;
+	else if (options.shader_optimization == "performance")
+		out.optimization = shaderc_optimization_level_performance;
+	else
+	{
+		printf("Unknown shader optimization level %s\n", options.shader_optimization.c_str());
+		return false;
+	}
+	return true;
+}
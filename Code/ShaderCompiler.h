@@ -0,0 +1,105 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <shaderc/shaderc.hpp>
+
+#include "Options.h"
+#include "ShaderCache.h"
+#include "ShaderIncluder.h"
+
+// What came out of compiling one shader
+struct ShaderOutput
+{
+	bool ok;
+	std::vector<uint32_t> spirv;
+
+	// the compiler's messages, if it failed
+	std::string error;
+
+	// true if shaderc was skipped, and if it was not,
+	// why the shader had to be compiled (see ShaderCache::find)
+	bool from_cache;
+	std::string rebuild_reason;
+
+	// every #include, and who included it
+	std::vector<ShaderDependency> dependencies;
+
+	// how many bytes of SPIR-V shaderc made, before it was
+	// stripped. 0 if it was not compiled, or not stripped
+	size_t unstripped_bytes;
+
+	// what went wrong stripping it (see SpirvRemap.h), if anything
+	std::string strip_warning;
+
+	ShaderOutput() : ok(false), from_cache(false), unstripped_bytes(0) {}
+};
+
+// ShaderCompiler turns GLSL into SPIR-V with shaderc, and asks the
+// shader cache first, so a shader that has not changed since the
+// last run never reaches shaderc at all. A shaderc::Compiler and its
+// CompileOptions can only be used by one thread at a time, so every
+// thread that compiles shaders needs a ShaderCompiler of its own
+// (they can all share one ShaderCache and one IncludeCache, see
+// ShaderBatch.h)
+class ShaderCompiler
+{
+public:
+	// "cache" can be null, then everything is compiled.
+	// The include folders are looked in for #include <file>,
+	// #include "file" looks next to the file that includes it first
+	ShaderCompiler(ShaderCache* cache, IncludeCache& includes, const std::vector<std::string>& include_directories);
+
+	// Returns false, with the compiler's message in
+	// out.error, if the shader could not be compiled
+	bool compile(const ShaderSource& source, ShaderOutput& out);
+
+private:
+	// the compiler and its options are not made again for every
+	// shader, a copy of base_options gets the settings of one shader
+	shaderc::Compiler compiler;
+	shaderc::CompileOptions base_options;
+	ShaderCache* cache;
+	IncludeCache& includes;
+	std::vector<std::string> include_directories;
+
+	// every file the includer in base_options
+	// handed to shaderc for the current shader
+	std::vector<ShaderDependency> dependencies;
+
+	ShaderCompiler(const ShaderCompiler&);
+	ShaderCompiler& operator=(const ShaderCompiler&);
+};
+
+// Read a GLSL file into "out", and pick the stage from the
+// extension (.vert, .frag, .comp, .geom, .tesc, .tese)
+bool load_shader_source(const char* path, ShaderSource& out);
+
+// Put the macros and the optimization level from the command line
+// (-define, -shader-opt) into "out". Returns false if they are wrong
+bool apply_shader_options(const Options& options, ShaderSource& out);
@@ -0,0 +1,165 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "ShaderIncluder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "MappedFile.h"
+
+IncludeCache::IncludeCache()
+{
+	reads = 0;
+}
+
+std::shared_ptr<const IncludeFile> IncludeCache::load(const std::string& path)
+{
+	{
+		std::lock_guard<std::mutex> hold(lock);
+		std::unordered_map<std::string, std::shared_ptr<const IncludeFile>>::const_iterator it = files.find(path);
+		if (it != files.end())
+			return it->second;
+	}
+
+	// The file is read without the lock, so that threads
+	// reading different files do not wait for each other
+	std::shared_ptr<IncludeFile> file = std::make_shared<IncludeFile>();
+	file->path = path;
+
+	MappedFile mapped;
+	if (mapped.open(path.c_str()))
+	{
+		file->text.assign((const char*)mapped.data(), mapped.size());
+		file->exists = true;
+	}
+	else
+	{
+		// MappedFile does not open empty files,
+		// so we tell "empty" and "missing" apart
+		FILE* check = fopen(path.c_str(), "rb");
+		file->exists = check != NULL;
+		if (check)
+			fclose(check);
+	}
+
+	if (file->exists)
+		file->content = hash_contents(file->text.data(), file->text.size());
+	else
+	{
+		ShaderHasher hasher;
+		hasher.add("missing", 7);
+		file->content = hasher.key();
+	}
+
+	// If another thread read the same file at the same
+	// time, we use its copy, so everyone sees one version
+	std::lock_guard<std::mutex> hold(lock);
+	reads++;
+	std::shared_ptr<const IncludeFile>& slot = files[path];
+	if (!slot)
+		slot = file;
+	return slot;
+}
+
+void IncludeCache::forget(const std::string& path)
+{
+	std::lock_guard<std::mutex> hold(lock);
+	files.erase(path);
+}
+
+// shaderc keeps pointers into the result until it
+// calls ReleaseInclude, the file keeps the text alive
+struct IncludeResult
+{
+	shaderc_include_result result;
+	std::shared_ptr<const IncludeFile> file;
+	std::string error;
+};
+
+ShaderIncluder::ShaderIncluder(IncludeCache& cache, const std::vector<std::string>& directories,
+	std::vector<ShaderDependency>& dependencies)
+	: cache(cache), directories(directories), dependencies(dependencies)
+{
+}
+
+shaderc_include_result* ShaderIncluder::GetInclude(const char* requested_source, shaderc_include_type type,
+	const char* requesting_source, size_t include_depth)
+{
+	// "file" is looked for next to the file that includes it,
+	// and then in the include folders, <file> only in the folders
+	std::vector<std::string> candidates;
+	if (type == shaderc_include_type_relative)
+	{
+		std::string from = requesting_source;
+		size_t slash = from.find_last_of("/\\");
+		candidates.push_back(slash == std::string::npos ? requested_source :
+			from.substr(0, slash + 1) + requested_source);
+	}
+	for (size_t i = 0; i < directories.size(); i++)
+		candidates.push_back(directories[i] + "/" + requested_source);
+
+	// Every place we looked is a dependency, not only the file we
+	// found: a file that appears later in a place we looked first
+	// would be included instead. The missing ones are kept with
+	// the "missing" hash, so the shader cache sees them appear
+	IncludeResult* include = new IncludeResult;
+	for (size_t i = 0; i < candidates.size() && !include->file; i++)
+	{
+		std::shared_ptr<const IncludeFile> file = cache.load(candidates[i]);
+		if (file->exists)
+			include->file = file;
+
+		ShaderDependency dependency;
+		dependency.path = file->path;
+		dependency.included_by = requesting_source;
+		dependency.content = file->content;
+		dependencies.push_back(dependency);
+	}
+
+	// a failed include has an empty name,
+	// and the error message as its content
+	memset(&include->result, 0, sizeof(include->result));
+	if (include->file)
+	{
+		include->result.source_name = include->file->path.c_str();
+		include->result.source_name_length = include->file->path.size();
+		include->result.content = include->file->text.c_str();
+		include->result.content_length = include->file->text.size();
+	}
+	else
+	{
+		include->error = std::string("Could not find ") + requested_source;
+		include->result.source_name = "";
+		include->result.content = include->error.c_str();
+		include->result.content_length = include->error.size();
+	}
+	include->result.user_data = include;
+	return &include->result;
+}
+
+void ShaderIncluder::ReleaseInclude(shaderc_include_result* data)
+{
+	delete (IncludeResult*)data->user_data;
+}
@@ -0,0 +1,94 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <shaderc/shaderc.hpp>
+
+#include "ShaderCache.h"
+
+// One file that a shader can #include, as it was when we read it
+struct IncludeFile
+{
+	std::string path;
+	std::string text;
+	ShaderKey content;
+	bool exists;
+};
+
+// Hundreds of shaders often include the same few files. The
+// IncludeCache reads each file from the disk once, and hands the
+// same text to every shader (and every thread) after that. The
+// shader cache hashes includes through it too, so checking whether
+// a common header changed costs one read, not one read per shader
+class IncludeCache
+{
+public:
+	IncludeCache();
+
+	// the file at "path", from memory if we have read it before
+	std::shared_ptr<const IncludeFile> load(const std::string& path);
+
+	// read "path" from the disk again the next time it is loaded,
+	// for when we know that it changed
+	void forget(const std::string& path);
+
+	uint32_t disk_reads() const { return reads; }
+
+private:
+	std::mutex lock;
+	std::unordered_map<std::string, std::shared_ptr<const IncludeFile>> files;
+	uint32_t reads;
+};
+
+// shaderc calls GetInclude for every #include. We find the file,
+// hand its text to shaderc from the IncludeCache, and write down
+// which file it was and which file included it. That list is the
+// include graph of the shader, the shader cache keeps it so that
+// only shaders whose includes changed are compiled again
+class ShaderIncluder : public shaderc::CompileOptions::IncluderInterface
+{
+public:
+	// #include <file> is looked for in "directories", #include "file"
+	// next to the file that includes it first. Every file that is
+	// found is added to the end of "dependencies", and so is every
+	// place that was looked in before it and had no such file
+	ShaderIncluder(IncludeCache& cache, const std::vector<std::string>& directories,
+		std::vector<ShaderDependency>& dependencies);
+
+	shaderc_include_result* GetInclude(const char* requested_source, shaderc_include_type type,
+		const char* requesting_source, size_t include_depth) override;
+	void ReleaseInclude(shaderc_include_result* data) override;
+
+private:
+	IncludeCache& cache;
+	const std::vector<std::string>& directories;
+	std::vector<ShaderDependency>& dependencies;
+};
@@ -0,0 +1,318 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "ShaderReloader.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+#include "Platform.h"
+#include "ThreadPool.h"
+
+// "./a.frag", "a.frag", and "shaders\a.frag" on Windows are all
+// written the same way here, so that a path from the watcher can
+// be compared with a path from the include graph
+static std::string normalize_path(const std::string& path)
+{
+	std::string out = path;
+	std::replace(out.begin(), out.end(), '\\', '/');
+	while (out.compare(0, 2, "./") == 0)
+		out.erase(0, 2);
+	return out;
+}
+
+ShaderReloader::ShaderReloader()
+	: stopping(false), ready(nullptr)
+{
+	device = VK_NULL_HANDLE;
+	cache = nullptr;
+	next_generation = 1;
+	active = nullptr;
+}
+
+ShaderReloader::~ShaderReloader()
+{
+	stop();
+}
+
+bool ShaderReloader::start(VkDevice device, const std::vector<ShaderSource>& shaders,
+	const std::vector<std::string>& include_directories, ShaderCache* cache,
+	LayoutCache* layouts, PipelineBuilder builder)
+{
+	stop();
+
+	this->device = device;
+	this->shaders = shaders;
+	this->include_directories = include_directories;
+	this->cache = cache;
+	this->layouts = layouts;
+	this->builder = builder;
+	spirv.assign(shaders.size(), std::vector<uint32_t>());
+	reflections.assign(shaders.size(), SpirvReflection());
+	dependencies.assign(shaders.size(), std::vector<ShaderDependency>());
+
+	for (size_t i = 0; i < shaders.size(); i++)
+	{
+		if (!watcher.watch_file_folder(shaders[i].name))
+			printf("Could not watch the folder of %s, it will not be reloaded\n", shaders[i].name.c_str());
+	}
+
+	stopping = false;
+	thread = std::thread([this]() { thread_main(); });
+	return true;
+}
+
+void ShaderReloader::stop()
+{
+	if (thread.joinable())
+	{
+		stopping = true;
+		watcher.wake();
+		thread.join();
+	}
+
+	destroy(ready.exchange(nullptr));
+	destroy(active);
+	active = nullptr;
+	for (size_t i = 0; i < retired.size(); i++)
+		destroy(retired[i].first);
+	retired.clear();
+}
+
+void ShaderReloader::thread_main()
+{
+	// The compiles use half of the cores, the
+	// render thread and the window keep the rest
+	uint32_t cores = std::thread::hardware_concurrency();
+	ThreadPool pool(cores > 2 ? cores / 2 : 1);
+
+	// everything is built once at the start
+	std::vector<size_t> all(shaders.size());
+	for (size_t i = 0; i < all.size(); i++)
+		all[i] = i;
+	build_with(pool, all, platform_time_us());
+
+	while (!stopping)
+	{
+		std::vector<std::string> changed;
+		if (!watcher.wait(changed, PLATFORM_WAIT_FOREVER) || stopping || changed.empty())
+			continue;
+
+		// keep listening until the files have stopped changing
+		uint64_t first_change_us = platform_time_us();
+		while (!stopping && watcher.wait(changed, SHADER_RELOAD_SETTLE_MS))
+		{
+		}
+		if (stopping)
+			break;
+
+		// A shader needs to be compiled again if it changed, or if
+		// anything in its include graph changed. Everything else
+		// keeps the SPIR-V it has
+		std::vector<size_t> affected;
+		for (size_t i = 0; i < shaders.size(); i++)
+		{
+			for (size_t c = 0; c < changed.size(); c++)
+			{
+				std::string path = normalize_path(changed[c]);
+				bool hit = normalize_path(shaders[i].name) == path;
+				for (size_t d = 0; !hit && d < dependencies[i].size(); d++)
+					hit = normalize_path(dependencies[i][d].path) == path;
+
+				if (hit)
+				{
+					affected.push_back(i);
+					break;
+				}
+			}
+		}
+
+		if (!affected.empty())
+			build_with(pool, affected, first_change_us);
+	}
+}
+
+void ShaderReloader::build_with(ThreadPool& pool, const std::vector<size_t>& affected, uint64_t first_change_us)
+{
+	// a shader that has never compiled yet is tried
+	// again too, every set needs all of the shaders
+	std::vector<size_t> changed = affected;
+	for (size_t i = 0; i < shaders.size(); i++)
+	{
+		if (spirv[i].empty() && std::find(changed.begin(), changed.end(), i) == changed.end())
+			changed.push_back(i);
+	}
+
+	// read the shaders again, with the
+	// same settings they had before
+	ShaderBatch batch(cache, include_directories);
+	for (size_t i = 0; i < changed.size(); i++)
+	{
+		ShaderSource& source = shaders[changed[i]];
+		if (!load_shader_source(source.name.c_str(), source))
+			printf("Could not read %s, using the last version of it\n", source.name.c_str());
+		batch.add(source, 0, std::string(), std::string());
+	}
+	batch.run(pool);
+
+	// The include graph is kept even for a shader that failed,
+	// and every folder in it is watched, so fixing a mistake in
+	// an included file is noticed too
+	bool all_ok = true;
+	const std::vector<ShaderJob>& results = batch.results();
+	std::vector<SpirvReflection> changed_reflections(changed.size());
+	for (size_t i = 0; i < changed.size(); i++)
+	{
+		const ShaderOutput& out = results[i].output;
+		dependencies[changed[i]] = out.dependencies;
+		for (size_t d = 0; d < out.dependencies.size(); d++)
+			watcher.watch_file_folder(out.dependencies[d].path);
+
+		if (!out.ok)
+		{
+			printf("%s", out.error.c_str());
+			all_ok = false;
+			continue;
+		}
+
+		std::string error;
+		if (!reflect_spirv(out.spirv.data(), out.spirv.size(), changed_reflections[i], error))
+		{
+			printf("%s: %s\n", shaders[changed[i]].name.c_str(), error.c_str());
+			all_ok = false;
+		}
+	}
+
+	if (!all_ok)
+	{
+		printf("Keeping the shaders that are running now\n\n");
+		return;
+	}
+
+	for (size_t i = 0; i < changed.size(); i++)
+	{
+		spirv[changed[i]] = results[i].output.spirv;
+		reflections[changed[i]] = changed_reflections[i];
+	}
+
+	// A new set has new modules for every shader, not only the ones
+	// that changed. Making a module from SPIR-V is cheap, and it
+	// means that a set never shares anything with another set
+	ShaderSet* set = new ShaderSet;
+	set->generation = next_generation++;
+	set->reflections = reflections;
+	set->layout = NULL;
+	bool ok = true;
+	for (size_t i = 0; i < shaders.size() && ok; i++)
+	{
+		VkShaderModuleCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		info.codeSize = spirv[i].size() * sizeof(uint32_t);
+		info.pCode = spirv[i].data();
+
+		VkShaderModule module = VK_NULL_HANDLE;
+		ok = vkCreateShaderModule(device, &info, NULL, &module) == VK_SUCCESS;
+		if (ok)
+			set->modules.push_back(module);
+	}
+
+	// Every shader of the set shares one layout. If the bindings did
+	// not change, the LayoutCache gives back the layout the last set
+	// had, so descriptor sets made for the old set still work
+	if (ok && layouts)
+	{
+		std::vector<const SpirvReflection*> stages;
+		for (size_t i = 0; i < reflections.size(); i++)
+			stages.push_back(&set->reflections[i]);
+
+		std::string error;
+		set->layout = layouts->get(stages.data(), (uint32_t)stages.size(), error);
+		if (!set->layout)
+			printf("The shaders have no pipeline layout: %s\n", error.c_str());
+	}
+
+	if (ok && builder)
+		ok = builder(device, *set);
+
+	if (!ok)
+	{
+		printf("Could not build the new shaders, keeping the ones that are running now\n\n");
+		destroy(set);
+		return;
+	}
+
+	for (size_t i = 0; i < changed.size(); i++)
+		set->reloaded.push_back(shaders[changed[i]].name);
+	set->build_ms = (platform_time_us() - first_change_us) / 1000.0;
+
+	// if the render thread never took the last set,
+	// nobody has used it, and it can go right away
+	destroy(ready.exchange(set));
+}
+
+bool ShaderReloader::swap(uint64_t frame, uint32_t frames_in_flight)
+{
+	// the frames that were in flight when a set was
+	// replaced are done once "frames_in_flight" more
+	// frames have been submitted
+	for (size_t i = 0; i < retired.size(); )
+	{
+		if (frame >= retired[i].second + frames_in_flight)
+		{
+			destroy(retired[i].first);
+			retired.erase(retired.begin() + i);
+		}
+		else
+			i++;
+	}
+
+	ShaderSet* next = ready.exchange(nullptr);
+	if (!next)
+		return false;
+
+	if (active)
+		retired.push_back(std::make_pair(active, frame));
+	active = next;
+
+	if (active->generation > 1)
+	{
+		printf("Reloaded");
+		for (size_t i = 0; i < active->reloaded.size(); i++)
+			printf(" %s", active->reloaded[i].c_str());
+		printf(" in %.1f ms\n", active->build_ms);
+	}
+	return true;
+}
+
+void ShaderReloader::destroy(ShaderSet* set)
+{
+	if (!set)
+		return;
+
+	for (size_t i = 0; i < set->pipelines.size(); i++)
+		vkDestroyPipeline(device, set->pipelines[i], NULL);
+	for (size_t i = 0; i < set->modules.size(); i++)
+		vkDestroyShaderModule(device, set->modules[i], NULL);
+	delete set;
+}
@@ -0,0 +1,141 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "FileWatcher.h"
+#include "LayoutCache.h"
+#include "ShaderBatch.h"
+#include "SpirvReflection.h"
+
+// Editors write a file in a few steps, so after the first change
+// we wait until nothing has changed for this long before compiling
+#define SHADER_RELOAD_SETTLE_MS 100
+
+// One version of every shader we were given, ready to draw with
+struct ShaderSet
+{
+	uint64_t generation;
+
+	// one module per shader, in the order they were given to start,
+	// and what each shader needs from the pipeline (SpirvReflection.h)
+	std::vector<VkShaderModule> modules;
+	std::vector<SpirvReflection> reflections;
+
+	// The layout made from the bindings of every shader in the set. It
+	// belongs to the LayoutCache, and it is null if there is no cache,
+	// or if the shaders do not agree about their bindings
+	const PipelineLayoutInfo* layout;
+
+	// whatever the PipelineBuilder made from the modules
+	std::vector<VkPipeline> pipelines;
+
+	// which shaders are new in this set, and how long it
+	// took from the first change until the set was ready
+	std::vector<std::string> reloaded;
+	double build_ms;
+};
+
+// Makes the pipelines of a ShaderSet from its modules and its layout.
+// It runs on the reload thread, never on the render thread
+typedef std::function<bool(VkDevice device, ShaderSet& set)> PipelineBuilder;
+
+// ShaderReloader compiles a list of shaders on a thread of its own,
+// and again whenever one of them, or any file that one of them
+// includes, changes on the disk. Every time it has compiled all of
+// the changed shaders, it makes a whole new ShaderSet (modules and
+// pipelines) and leaves it for the render thread, which picks it up
+// with swap at the start of a frame. The render thread never waits
+// for a compile, and it never sees half of a new set.
+//
+// If a shader does not compile, the errors are printed and the old
+// set stays in use, so a typo never breaks a running program
+class ShaderReloader
+{
+public:
+	ShaderReloader();
+	~ShaderReloader();
+
+	// Start compiling "shaders" in the background. "builder" can be
+	// empty, then the sets only have modules, and "layouts" can be
+	// null, then the sets have no layout
+	bool start(VkDevice device, const std::vector<ShaderSource>& shaders,
+		const std::vector<std::string>& include_directories, ShaderCache* cache,
+		LayoutCache* layouts, PipelineBuilder builder);
+
+	// Stop the reload thread, and destroy every set. The
+	// GPU must be done with all of them (vkDeviceWaitIdle)
+	void stop();
+
+	// Called by the render thread before it records a frame. If a
+	// new set is ready, it becomes the current one, and the old one
+	// is destroyed once every frame that might use it is done
+	// ("frame" is FrameRing::frames_submitted). Returns true if the
+	// current set changed
+	bool swap(uint64_t frame, uint32_t frames_in_flight);
+
+	// the set to draw with, null until the first one is ready
+	const ShaderSet* current() const { return active; }
+
+private:
+	void thread_main();
+	void build_with(ThreadPool& pool, const std::vector<size_t>& affected, uint64_t first_change_us);
+	void destroy(ShaderSet* set);
+
+	VkDevice device;
+	ShaderCache* cache;
+	LayoutCache* layouts;
+	PipelineBuilder builder;
+	std::vector<std::string> include_directories;
+
+	// only touched by the reload thread after start: the last
+	// SPIR-V that compiled, and the include graph, of every shader
+	std::vector<ShaderSource> shaders;
+	std::vector<std::vector<uint32_t>> spirv;
+	std::vector<SpirvReflection> reflections;
+	std::vector<std::vector<ShaderDependency>> dependencies;
+	uint64_t next_generation;
+
+	FileWatcher watcher;
+	std::thread thread;
+	std::atomic<bool> stopping;
+
+	// a set that is built, and that the render thread has
+	// not taken yet. Whoever swaps it out owns it
+	std::atomic<ShaderSet*> ready;
+
+	// only touched by the render thread
+	ShaderSet* active;
+	std::vector<std::pair<ShaderSet*, uint64_t>> retired;
+};
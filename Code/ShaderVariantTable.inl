@@ -0,0 +1,49 @@
+// Generated by gen_shader_variants.py from shader_variants.txt, do not edit by hand.
+
+#define SHADER_VARIANT_SHADER_COUNT 1
+#define SHADER_VARIANT_BUILD_COUNT 12
+
+static constexpr ShaderVariantShader shader_variant_shaders[] =
+{
+	{ 1, 0, 3, 0, 12 }, // Shaders/reduce.comp
+};
+
+static constexpr ShaderVariantAxis shader_variant_axes[] =
+{
+	{ 21, SHADER_AXIS_SPEC, 0, 0, SHADER_RULE_WORKGROUP, 0, 0, 4 }, // workgroup_size
+	{ 36, SHADER_AXIS_MACRO, 0, 50, SHADER_RULE_SUBGROUP, 0, 4, 3 }, // subgroup_size
+	{ 64, SHADER_AXIS_MACRO, 0, 71, SHADER_RULE_SHARED, 4, 7, 4 }, // unroll
+};
+
+static constexpr uint32_t shader_variant_values[] =
+{
+	64, 128, 256, 512, 16, 32, 64, 1,
+	2, 4, 8,
+};
+
+// one row per build, the index of the value of
+// each axis of the shader (always 0 for spec axes)
+static constexpr uint8_t shader_variant_builds[][SHADER_VARIANT_MAX_AXES] =
+{
+	{ 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ 0, 0, 1, 0, 0, 0, 0, 0 },
+	{ 0, 0, 2, 0, 0, 0, 0, 0 },
+	{ 0, 0, 3, 0, 0, 0, 0, 0 },
+	{ 0, 1, 0, 0, 0, 0, 0, 0 },
+	{ 0, 1, 1, 0, 0, 0, 0, 0 },
+	{ 0, 1, 2, 0, 0, 0, 0, 0 },
+	{ 0, 1, 3, 0, 0, 0, 0, 0 },
+	{ 0, 2, 0, 0, 0, 0, 0, 0 },
+	{ 0, 2, 1, 0, 0, 0, 0, 0 },
+	{ 0, 2, 2, 0, 0, 0, 0, 0 },
+	{ 0, 2, 3, 0, 0, 0, 0, 0 },
+};
+
+static constexpr char shader_variant_strings[78] =
+{
+	0x00, 0x53, 0x68, 0x61, 0x64, 0x65, 0x72, 0x73, 0x2F, 0x72, 0x65, 0x64, 0x75, 0x63, 0x65, 0x2E,
+	0x63, 0x6F, 0x6D, 0x70, 0x00, 0x77, 0x6F, 0x72, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x70, 0x5F, 0x73,
+	0x69, 0x7A, 0x65, 0x00, 0x73, 0x75, 0x62, 0x67, 0x72, 0x6F, 0x75, 0x70, 0x5F, 0x73, 0x69, 0x7A,
+	0x65, 0x00, 0x53, 0x55, 0x42, 0x47, 0x52, 0x4F, 0x55, 0x50, 0x5F, 0x53, 0x49, 0x5A, 0x45, 0x00,
+	0x75, 0x6E, 0x72, 0x6F, 0x6C, 0x6C, 0x00, 0x55, 0x4E, 0x52, 0x4F, 0x4C, 0x4C, 0x00,
+};
@@ -0,0 +1,297 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "ShaderVariants.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// shader_variant_shaders, shader_variant_axes, shader_variant_values,
+// shader_variant_builds, and shader_variant_strings
+#include "ShaderVariantTable.inl"
+
+// A workgroup of more subgroups than this seldom runs any faster, and
+// it leaves the GPU fewer ways to fit workgroups next to each other
+#define SHADER_WORKGROUP_MAX_SUBGROUPS 8
+
+ShaderVariant::ShaderVariant()
+{
+	shader = nullptr;
+	memset(values, 0, sizeof(values));
+	build = 0;
+}
+
+VkSpecializationInfo ShaderVariant::specialization() const
+{
+	VkSpecializationInfo info = {};
+	info.mapEntryCount = (uint32_t)map_entries.size();
+	info.pMapEntries = map_entries.data();
+	info.dataSize = constants.size() * sizeof(uint32_t);
+	info.pData = constants.data();
+	return info;
+}
+
+const char* shader_variant_string(uint32_t offset)
+{
+	return shader_variant_strings + offset;
+}
+
+const ShaderVariantAxis& shader_variant_axis(const ShaderVariantShader& shader, uint32_t axis)
+{
+	return shader_variant_axes[shader.first_axis + axis];
+}
+
+// true if "path" ends with "name", starting at a folder boundary.
+// Both kinds of slash are the same, so paths from Windows match
+static bool path_ends_with(const std::string& path, const char* name)
+{
+	size_t length = strlen(name);
+	if (path.size() < length)
+		return false;
+
+	size_t start = path.size() - length;
+	if (start > 0 && path[start - 1] != '/' && path[start - 1] != '\\')
+		return false;
+
+	for (size_t i = 0; i < length; i++)
+	{
+		char a = path[start + i] == '\\' ? '/' : path[start + i];
+		char b = name[i] == '\\' ? '/' : name[i];
+		if (a != b)
+			return false;
+	}
+	return true;
+}
+
+const ShaderVariantShader* find_shader_variants(const std::string& path)
+{
+	for (uint32_t i = 0; i < SHADER_VARIANT_SHADER_COUNT; i++)
+	{
+		if (path_ends_with(path, shader_variant_string(shader_variant_shaders[i].name)))
+			return &shader_variant_shaders[i];
+	}
+	return nullptr;
+}
+
+void shader_variant_macros(const ShaderVariantShader& shader, uint32_t build,
+	std::vector<std::pair<std::string, std::string>>& macros)
+{
+	const uint8_t* choices = shader_variant_builds[shader.first_build + build];
+	for (uint32_t a = 0; a < shader.axis_count; a++)
+	{
+		const ShaderVariantAxis& axis = shader_variant_axis(shader, a);
+		if (axis.kind != SHADER_AXIS_MACRO)
+			continue;
+
+		char value[16];
+		snprintf(value, sizeof(value), "%u", shader_variant_values[axis.first_value + choices[a]]);
+		macros.push_back(std::make_pair(std::string(shader_variant_string(axis.macro)), std::string(value)));
+	}
+}
+
+// The exact answer is in VkPhysicalDeviceSubgroupProperties, but that
+// needs Vulkan 1.1, our instance is 1.0, and inventory files do not
+// have it. These are the sizes that each vendor's drivers report
+static uint32_t vendor_subgroup_size(uint32_t vendor_id)
+{
+	switch (vendor_id)
+	{
+	case 0x10DE: return 32; // NVIDIA, one warp
+	case 0x1002: return 64; // AMD, one wavefront
+	case 0x8086: return 32; // Intel, the widest SIMD mode
+	default: return 0;
+	}
+}
+
+ShaderDeviceLimits shader_device_limits(const DeviceInventory& device)
+{
+	const VkPhysicalDeviceLimits& limits = device.properties.limits;
+
+	ShaderDeviceLimits out;
+	out.max_workgroup_invocations = limits.maxComputeWorkGroupInvocations;
+	out.max_workgroup_size_x = limits.maxComputeWorkGroupSize[0];
+	out.max_shared_memory = limits.maxComputeSharedMemorySize;
+	out.subgroup_size = vendor_subgroup_size(device.properties.vendorID);
+	return out;
+}
+
+// the index of the largest value that "fits", or
+// "count" if none of the values fit
+template <typename Fits>
+static uint32_t largest_value(const uint32_t* values, uint32_t count, Fits fits)
+{
+	uint32_t best = count;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (fits(values[i]) && (best == count || values[i] > values[best]))
+			best = i;
+	}
+	return best;
+}
+
+static uint32_t smallest_value(const uint32_t* values, uint32_t count)
+{
+	uint32_t best = 0;
+	for (uint32_t i = 1; i < count; i++)
+	{
+		if (values[i] < values[best])
+			best = i;
+	}
+	return best;
+}
+
+// The index of the value an axis should have on this GPU.
+// "subgroup" and "workgroup" are what was picked for the
+// axes that this one depends on
+static uint32_t pick_value(const ShaderVariantAxis& axis, const ShaderDeviceLimits& limits,
+	uint32_t subgroup, uint32_t workgroup)
+{
+	const uint32_t* values = shader_variant_values + axis.first_value;
+	uint32_t count = axis.value_count;
+	uint32_t picked = count;
+
+	switch (axis.rule)
+	{
+	case SHADER_RULE_SUBGROUP:
+		// if we do not know, the first value is the default
+		if (limits.subgroup_size == 0)
+			return 0;
+		picked = largest_value(values, count, [&](uint32_t v) { return v <= limits.subgroup_size; });
+		break;
+
+	case SHADER_RULE_WORKGROUP:
+	{
+		// Each thing we want is given up in turn, if no value has
+		// it: at most a few subgroups, then whole subgroups, and
+		// last of all, a size the GPU allows
+		auto allowed = [&](uint32_t v)
+		{
+			return v <= limits.max_workgroup_invocations && v <= limits.max_workgroup_size_x;
+		};
+		auto whole = [&](uint32_t v) { return allowed(v) && (subgroup == 0 || v % subgroup == 0); };
+		auto few = [&](uint32_t v)
+		{
+			return whole(v) && (subgroup == 0 || v <= subgroup * SHADER_WORKGROUP_MAX_SUBGROUPS);
+		};
+
+		picked = largest_value(values, count, few);
+		if (picked == count)
+			picked = largest_value(values, count, whole);
+		if (picked == count)
+			picked = largest_value(values, count, allowed);
+		break;
+	}
+
+	case SHADER_RULE_SHARED:
+	{
+		uint64_t step = (uint64_t)axis.rule_arg * workgroup;
+		picked = largest_value(values, count, [&](uint32_t v) { return v * step <= limits.max_shared_memory; });
+		break;
+	}
+
+	default:
+		return 0;
+	}
+
+	// nothing fits, so we get as close as we can
+	return picked == count ? smallest_value(values, count) : picked;
+}
+
+void select_shader_variant(const ShaderVariantShader& shader, const ShaderDeviceLimits& limits,
+	ShaderVariant& out)
+{
+	out = ShaderVariant();
+	out.shader = &shader;
+
+	// The rules depend on each other: a workgroup is made of whole
+	// subgroups, and shared memory is counted per workgroup. So the
+	// axes are picked in that order, whatever order they are listed in
+	static const uint32_t order[] =
+	{
+		SHADER_RULE_SUBGROUP, SHADER_RULE_WORKGROUP, SHADER_RULE_SHARED, SHADER_RULE_FIXED
+	};
+
+	uint32_t subgroup = limits.subgroup_size;
+	uint32_t workgroup = 1;
+	uint32_t choices[SHADER_VARIANT_MAX_AXES] = {};
+	for (uint32_t r = 0; r < sizeof(order) / sizeof(order[0]); r++)
+	{
+		for (uint32_t a = 0; a < shader.axis_count; a++)
+		{
+			const ShaderVariantAxis& axis = shader_variant_axis(shader, a);
+			if (axis.rule != order[r])
+				continue;
+
+			choices[a] = pick_value(axis, limits, subgroup, workgroup);
+			out.values[a] = shader_variant_values[axis.first_value + choices[a]];
+			if (axis.rule == SHADER_RULE_SUBGROUP)
+				subgroup = out.values[a];
+			else if (axis.rule == SHADER_RULE_WORKGROUP)
+				workgroup = out.values[a];
+		}
+	}
+
+	// the spec axes become the specialization info,
+	// and the macro axes tell us which build to use
+	for (uint32_t a = 0; a < shader.axis_count; a++)
+	{
+		const ShaderVariantAxis& axis = shader_variant_axis(shader, a);
+		if (axis.kind != SHADER_AXIS_SPEC)
+			continue;
+
+		VkSpecializationMapEntry entry;
+		entry.constantID = axis.spec_id;
+		entry.offset = (uint32_t)(out.constants.size() * sizeof(uint32_t));
+		entry.size = sizeof(uint32_t);
+		out.map_entries.push_back(entry);
+		out.constants.push_back(out.values[a]);
+	}
+
+	for (uint32_t b = 0; b < shader.build_count; b++)
+	{
+		const uint8_t* build = shader_variant_builds[shader.first_build + b];
+		bool same = true;
+		for (uint32_t a = 0; a < shader.axis_count; a++)
+		{
+			if (shader_variant_axis(shader, a).kind == SHADER_AXIS_MACRO && build[a] != choices[a])
+				same = false;
+		}
+		if (same)
+		{
+			out.build = b;
+			break;
+		}
+	}
+}
+
+void print_shader_variant(const ShaderVariant& variant)
+{
+	printf("%s:", shader_variant_string(variant.shader->name));
+	for (uint32_t a = 0; a < variant.shader->axis_count; a++)
+	{
+		const ShaderVariantAxis& axis = shader_variant_axis(*variant.shader, a);
+		printf("%s %s %u", a ? "," : "", shader_variant_string(axis.name), variant.values[a]);
+	}
+	printf("\n");
+}
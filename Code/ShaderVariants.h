@@ -0,0 +1,154 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Inventory.h"
+
+// A compute shader that is fast on one GPU can be slow on the next:
+// the best workgroup size, the subgroup size it was written for, how
+// far its loops are unrolled, all depend on the hardware. Rather than
+// keep a copy of the GLSL for each GPU, a shader lists the "axes" it
+// varies along in shader_variants.txt. gen_shader_variants.py turns
+// that list into constant tables (ShaderVariantTable.inl) when the
+// project is built, so nothing is parsed at run time.
+//
+// An axis is either a specialization constant, which costs nothing:
+// one SPIR-V takes every value, and the value is given when the
+// pipeline is made. Or it is a macro, for what a constant cannot do,
+// and then every combination of the macro values (a "build") is its
+// own compile. -compile-shaders compiles every build of a shader,
+// and puts each in the shader bundle under its own permutation.
+//
+// At startup, select_shader_variant picks a value for every axis from
+// the limits of the GPU we are using (or of the -profile device), and
+// the pipeline gets the module of the matching build, with the spec
+// axes in its VkSpecializationInfo.
+
+// must match MAX_AXES and MAX_BUILDS in gen_shader_variants.py
+#define SHADER_VARIANT_MAX_AXES 8
+#define SHADER_VARIANT_MAX_BUILDS 256
+
+enum ShaderAxisKind
+{
+	SHADER_AXIS_SPEC,
+	SHADER_AXIS_MACRO
+};
+
+// how the value of an axis is picked, see shader_variants.txt
+enum ShaderAxisRule
+{
+	SHADER_RULE_FIXED,
+	SHADER_RULE_SUBGROUP,
+	SHADER_RULE_WORKGROUP,
+	SHADER_RULE_SHARED
+};
+
+// The rows of the generated tables. Like the PCI ID table, names
+// are offsets into one block of strings, so the tables are plain
+// read-only data
+struct ShaderVariantAxis
+{
+	uint32_t name;
+	uint32_t kind;          // a ShaderAxisKind
+	uint32_t spec_id;       // the constant_id, for SHADER_AXIS_SPEC
+	uint32_t macro;         // the macro name, for SHADER_AXIS_MACRO
+	uint32_t rule;          // a ShaderAxisRule
+	uint32_t rule_arg;      // bytes per step, for SHADER_RULE_SHARED
+	uint32_t first_value;   // into the values table
+	uint32_t value_count;
+};
+
+struct ShaderVariantShader
+{
+	uint32_t name;
+	uint32_t first_axis;
+	uint32_t axis_count;
+	uint32_t first_build;
+	uint32_t build_count;
+};
+
+// What the rules need to know about a GPU
+struct ShaderDeviceLimits
+{
+	uint32_t max_workgroup_invocations;
+	uint32_t max_workgroup_size_x;
+	uint32_t max_shared_memory;
+
+	// 0 if we do not know it
+	uint32_t subgroup_size;
+};
+
+// One version of a shader, picked for one GPU
+struct ShaderVariant
+{
+	const ShaderVariantShader* shader;
+
+	// the value picked for each axis
+	uint32_t values[SHADER_VARIANT_MAX_AXES];
+
+	// the build that has the picked macro values
+	uint32_t build;
+
+	// the values of the spec axes, laid out for
+	// VkSpecializationInfo, see specialization()
+	std::vector<VkSpecializationMapEntry> map_entries;
+	std::vector<uint32_t> constants;
+
+	ShaderVariant();
+
+	// Points into map_entries and constants,
+	// so it is only good while this variant is
+	VkSpecializationInfo specialization() const;
+};
+
+// The variants of the shader at "path", or null if it has none.
+// The names in shader_variants.txt are matched against the end of
+// the path, so "Code/Shaders/reduce.comp" finds "Shaders/reduce.comp"
+const ShaderVariantShader* find_shader_variants(const std::string& path);
+
+const ShaderVariantAxis& shader_variant_axis(const ShaderVariantShader& shader, uint32_t axis);
+const char* shader_variant_string(uint32_t offset);
+
+// The macros a build is compiled with, added to "macros"
+void shader_variant_macros(const ShaderVariantShader& shader, uint32_t build,
+	std::vector<std::pair<std::string, std::string>>& macros);
+
+// The limits of a GPU, from its inventory, so a
+// device profile can stand in for the real GPU
+ShaderDeviceLimits shader_device_limits(const DeviceInventory& device);
+
+// Pick the value of every axis of "shader" for a GPU with these limits
+void select_shader_variant(const ShaderVariantShader& shader, const ShaderDeviceLimits& limits,
+	ShaderVariant& out);
+
+// "Shaders/reduce.comp: workgroup_size 256, subgroup_size 32, unroll 4"
+void print_shader_variant(const ShaderVariant& variant);
@@ -0,0 +1,866 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "SpirvReflection.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <unordered_map>
+
+#include <vulkan/spirv.hpp11>
+
+// a decoration that a SPIR-V ID does not have
+#define NO_VALUE 0xFFFFFFFF
+
+// deeper than this, a type must be pointing at itself
+#define MAX_TYPE_DEPTH 32
+
+// The most IDs a module can ask for. Tools that renumber IDs leave
+// gaps, so the bound can be larger than the module, but not this large
+#define MAX_SPIRV_BOUND (1u << 20)
+
+SpirvReflection::SpirvReflection()
+{
+	stage = VK_SHADER_STAGE_ALL;
+	push_constant_offset = 0;
+	push_constant_size = 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+		workgroup_size[i] = 0;
+		workgroup_size_spec_id[i] = SPIRV_NO_SPEC_ID;
+	}
+}
+
+// What we remember about one ID of the module. Every type, constant,
+// and variable gets an ID, and the module tells us how many there can
+// be, so we keep them in one flat array indexed by ID
+struct SpirvId
+{
+	// the instruction that made this ID, and the index of its
+	// first word, so that we can read its operands later
+	spv::Op op;
+	size_t first_word;
+
+	// from OpDecorate, NO_VALUE if the ID was not decorated
+	uint32_t set;
+	uint32_t binding;
+	uint32_t location;
+	uint32_t spec_id;
+	uint32_t builtin;
+	uint32_t array_stride;
+	bool block;
+	bool buffer_block;
+
+	// the value of OpConstant and OpSpecConstant
+	uint64_t value;
+
+	SpirvId()
+	{
+		op = spv::Op::OpNop;
+		first_word = 0;
+		set = binding = location = spec_id = builtin = array_stride = NO_VALUE;
+		block = buffer_block = false;
+		value = 0;
+	}
+};
+
+// from OpMemberDecorate, for working out the size of push constants
+struct SpirvMember
+{
+	uint32_t offset;
+	uint32_t matrix_stride;
+};
+
+struct SpirvReader
+{
+	const uint32_t* words;
+	size_t word_count;
+
+	std::vector<SpirvId> ids;
+
+	// from OpName, kept apart from "ids" because
+	// most IDs do not have a name
+	std::unordered_map<uint32_t, std::string> names;
+
+	// keyed by (struct ID << 32) | member index
+	std::unordered_map<uint64_t, SpirvMember> members;
+
+	std::string error;
+
+	// the ID of the function the first OpEntryPoint names
+	uint32_t entry_function;
+
+	// local_size_x_id and friends, which we can only
+	// look up once the constants have been read
+	uint32_t workgroup_size_ids[3];
+};
+
+// Strings in SPIR-V are packed four characters to a word, and end with
+// a zero byte. We never read past "end", in case the zero is missing
+static std::string read_string(const SpirvReader& reader, size_t first, size_t end)
+{
+	std::string text;
+	size_t i = first;
+	bool done = false;
+
+	for (; i < end && !done; i++)
+	{
+		uint32_t word = reader.words[i];
+		for (int b = 0; b < 4; b++)
+		{
+			char c = (char)((word >> (b * 8)) & 0xFF);
+			if (c == 0)
+			{
+				done = true;
+				break;
+			}
+			text += c;
+		}
+	}
+
+	return text;
+}
+
+// NULL if "id" is outside of the bound the module gave us
+static SpirvId* find_id(SpirvReader& reader, uint32_t id)
+{
+	if (id >= reader.ids.size())
+		return NULL;
+	return &reader.ids[id];
+}
+
+static std::string name_of(const SpirvReader& reader, uint32_t id)
+{
+	std::unordered_map<uint32_t, std::string>::const_iterator found = reader.names.find(id);
+	return found == reader.names.end() ? std::string() : found->second;
+}
+
+// operand "index" of the instruction that made "id", 0 if there is none
+static uint32_t operand(const SpirvReader& reader, const SpirvId& id, uint32_t index)
+{
+	// an ID that was used, but that no instruction made
+	size_t first = id.first_word;
+	if (first == 0)
+		return 0;
+
+	uint32_t count = reader.words[first] >> spv::WordCountShift;
+	if (index >= count)
+		return 0;
+	return reader.words[first + index];
+}
+
+// The number of bytes a type takes in a push constant block, using the
+// Offset, ArrayStride, and MatrixStride decorations that the compiler
+// wrote, rather than working out the std430 rules a second time
+static uint32_t type_size(SpirvReader& reader, uint32_t type, uint32_t matrix_stride, uint32_t depth)
+{
+	SpirvId* t = find_id(reader, type);
+	if (t == NULL || depth > MAX_TYPE_DEPTH)
+		return 0;
+
+	switch (t->op)
+	{
+	case spv::Op::OpTypeBool:
+		return 4;
+
+	case spv::Op::OpTypeInt:
+	case spv::Op::OpTypeFloat:
+		return operand(reader, *t, 2) / 8;
+
+	case spv::Op::OpTypeVector:
+		return operand(reader, *t, 3) * type_size(reader, operand(reader, *t, 2), 0, depth + 1);
+
+	case spv::Op::OpTypeMatrix:
+	{
+		uint32_t columns = operand(reader, *t, 3);
+		if (matrix_stride != NO_VALUE && matrix_stride != 0)
+			return columns * matrix_stride;
+		return columns * type_size(reader, operand(reader, *t, 2), 0, depth + 1);
+	}
+
+	case spv::Op::OpTypeArray:
+	{
+		SpirvId* length = find_id(reader, operand(reader, *t, 3));
+		uint32_t count = length ? (uint32_t)length->value : 0;
+		if (t->array_stride != NO_VALUE)
+			return count * t->array_stride;
+		return count * type_size(reader, operand(reader, *t, 2), matrix_stride, depth + 1);
+	}
+
+	case spv::Op::OpTypeStruct:
+	{
+		// the size of a struct is wherever its last member ends
+		uint32_t member_count = (reader.words[t->first_word] >> spv::WordCountShift) - 2;
+		uint32_t size = 0;
+
+		for (uint32_t m = 0; m < member_count; m++)
+		{
+			uint64_t key = ((uint64_t)type << 32) | m;
+			std::unordered_map<uint64_t, SpirvMember>::iterator layout = reader.members.find(key);
+
+			uint32_t offset = 0;
+			uint32_t stride = NO_VALUE;
+			if (layout != reader.members.end())
+			{
+				offset = layout->second.offset == NO_VALUE ? 0 : layout->second.offset;
+				stride = layout->second.matrix_stride;
+			}
+
+			uint32_t end = offset + type_size(reader, operand(reader, *t, 2 + m), stride, depth + 1);
+			size = std::max(size, end);
+		}
+
+		return size;
+	}
+
+	default:
+		// runtime arrays, pointers, and anything
+		// else that has no size of its own
+		return 0;
+	}
+}
+
+// the Vulkan format that matches a vertex shader input,
+// which is a scalar or a vector of ints or floats
+static VkFormat vertex_format(SpirvReader& reader, uint32_t type)
+{
+	SpirvId* t = find_id(reader, type);
+	if (t == NULL)
+		return VK_FORMAT_UNDEFINED;
+
+	uint32_t components = 1;
+	if (t->op == spv::Op::OpTypeVector)
+	{
+		components = operand(reader, *t, 3);
+		t = find_id(reader, operand(reader, *t, 2));
+		if (t == NULL)
+			return VK_FORMAT_UNDEFINED;
+	}
+
+	if (components < 1 || components > 4)
+		return VK_FORMAT_UNDEFINED;
+
+	uint32_t width = operand(reader, *t, 2);
+	uint32_t index = components - 1;
+
+	static const VkFormat float32[4] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+	static const VkFormat float64[4] = { VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT };
+	static const VkFormat float16[4] = { VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT };
+	static const VkFormat sint32[4] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+	static const VkFormat uint32[4] = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+	if (t->op == spv::Op::OpTypeFloat)
+	{
+		if (width == 32) return float32[index];
+		if (width == 64) return float64[index];
+		if (width == 16) return float16[index];
+	}
+	else if (t->op == spv::Op::OpTypeInt && width == 32)
+	{
+		bool is_signed = operand(reader, *t, 3) != 0;
+		return is_signed ? sint32[index] : uint32[index];
+	}
+
+	return VK_FORMAT_UNDEFINED;
+}
+
+// how many input locations a vertex input type takes up
+static uint32_t location_count(SpirvReader& reader, uint32_t type, uint32_t* column_type)
+{
+	SpirvId* t = find_id(reader, type);
+	*column_type = type;
+	if (t == NULL)
+		return 1;
+
+	// a matrix takes one location per column, and
+	// a matrix has from 2 to 4 columns
+	if (t->op == spv::Op::OpTypeMatrix)
+	{
+		*column_type = operand(reader, *t, 2);
+		return std::min(std::max(operand(reader, *t, 3), 1u), 4u);
+	}
+
+	return 1;
+}
+
+static VkShaderStageFlagBits stage_of(spv::ExecutionModel model)
+{
+	switch (model)
+	{
+	case spv::ExecutionModel::Vertex: return VK_SHADER_STAGE_VERTEX_BIT;
+	case spv::ExecutionModel::TessellationControl: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+	case spv::ExecutionModel::TessellationEvaluation: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+	case spv::ExecutionModel::Geometry: return VK_SHADER_STAGE_GEOMETRY_BIT;
+	case spv::ExecutionModel::Fragment: return VK_SHADER_STAGE_FRAGMENT_BIT;
+	case spv::ExecutionModel::GLCompute: return VK_SHADER_STAGE_COMPUTE_BIT;
+	case spv::ExecutionModel::TaskNV: return VK_SHADER_STAGE_TASK_BIT_NV;
+	case spv::ExecutionModel::MeshNV: return VK_SHADER_STAGE_MESH_BIT_NV;
+	case spv::ExecutionModel::RayGenerationNV: return VK_SHADER_STAGE_RAYGEN_BIT_NV;
+	case spv::ExecutionModel::IntersectionNV: return VK_SHADER_STAGE_INTERSECTION_BIT_NV;
+	case spv::ExecutionModel::AnyHitNV: return VK_SHADER_STAGE_ANY_HIT_BIT_NV;
+	case spv::ExecutionModel::ClosestHitNV: return VK_SHADER_STAGE_CLOSEST_HIT_BIT_NV;
+	case spv::ExecutionModel::MissNV: return VK_SHADER_STAGE_MISS_BIT_NV;
+	case spv::ExecutionModel::CallableNV: return VK_SHADER_STAGE_CALLABLE_BIT_NV;
+	default: return VK_SHADER_STAGE_ALL;
+	}
+}
+
+// Work out which kind of descriptor a variable needs, from its storage
+// class and its type. Returns false if the variable is not a descriptor
+static bool descriptor_type(SpirvReader& reader, spv::StorageClass storage, SpirvId* type, VkDescriptorType* out)
+{
+	if (type == NULL)
+		return false;
+
+	if (storage == spv::StorageClass::StorageBuffer)
+	{
+		*out = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		return true;
+	}
+
+	if (storage == spv::StorageClass::Uniform)
+	{
+		// before SPIR-V 1.3, storage buffers were
+		// Uniform blocks marked with BufferBlock
+		*out = type->buffer_block ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		return true;
+	}
+
+	if (storage != spv::StorageClass::UniformConstant)
+		return false;
+
+	switch (type->op)
+	{
+	case spv::Op::OpTypeSampler:
+		*out = VK_DESCRIPTOR_TYPE_SAMPLER;
+		return true;
+
+	case spv::Op::OpTypeAccelerationStructureNV:
+		*out = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_NV;
+		return true;
+
+	case spv::Op::OpTypeSampledImage:
+	{
+		// a samplerBuffer is a texel buffer, even
+		// though GLSL calls it a sampler
+		SpirvId* image = find_id(reader, operand(reader, *type, 2));
+		if (image && (spv::Dim)operand(reader, *image, 3) == spv::Dim::Buffer)
+			*out = VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+		else
+			*out = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		return true;
+	}
+
+	case spv::Op::OpTypeImage:
+	{
+		spv::Dim dim = (spv::Dim)operand(reader, *type, 3);
+
+		// 1 means the image is used with a sampler, 2 means
+		// it is read and written without one
+		bool sampled = operand(reader, *type, 7) == 1;
+
+		if (dim == spv::Dim::SubpassData)
+			*out = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		else if (dim == spv::Dim::Buffer)
+			*out = sampled ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+		else
+			*out = sampled ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		return true;
+	}
+
+	default:
+		return false;
+	}
+}
+
+// A global variable is either a descriptor, push constants,
+// a vertex input, or something we do not care about
+static bool reflect_variable(SpirvReader& reader, uint32_t variable_id, SpirvReflection& out)
+{
+	SpirvId& variable = reader.ids[variable_id];
+
+	spv::StorageClass storage = (spv::StorageClass)operand(reader, variable, 3);
+
+	SpirvId* pointer = find_id(reader, operand(reader, variable, 1));
+	if (pointer == NULL || pointer->op != spv::Op::OpTypePointer)
+	{
+		reader.error = "a variable does not have a pointer type";
+		return false;
+	}
+
+	uint32_t type_id = operand(reader, *pointer, 3);
+	SpirvId* type = find_id(reader, type_id);
+
+	if (storage == spv::StorageClass::PushConstant)
+	{
+		// the range starts at the first member, because
+		// the other stages might use the bytes before it
+		uint32_t size = type_size(reader, type_id, NO_VALUE, 0);
+		uint32_t offset = size;
+		uint32_t member_count = type ? (reader.words[type->first_word] >> spv::WordCountShift) - 2 : 0;
+
+		for (uint32_t m = 0; m < member_count; m++)
+		{
+			uint64_t key = ((uint64_t)type_id << 32) | m;
+			std::unordered_map<uint64_t, SpirvMember>::iterator layout = reader.members.find(key);
+			uint32_t member_offset = layout == reader.members.end() || layout->second.offset == NO_VALUE ? 0 : layout->second.offset;
+			offset = std::min(offset, member_offset);
+		}
+
+		out.push_constant_offset = offset;
+		out.push_constant_size = size - offset;
+		return true;
+	}
+
+	if (storage == spv::StorageClass::Input)
+	{
+		if (out.stage != VK_SHADER_STAGE_VERTEX_BIT || variable.location == NO_VALUE || variable.builtin != NO_VALUE)
+			return true;
+
+		uint32_t column_type = 0;
+		uint32_t locations = location_count(reader, type_id, &column_type);
+		for (uint32_t l = 0; l < locations; l++)
+		{
+			SpirvVertexInput input;
+			input.location = variable.location + l;
+			input.format = vertex_format(reader, column_type);
+			input.name = name_of(reader, variable_id);
+			out.vertex_inputs.push_back(input);
+		}
+		return true;
+	}
+
+	// arrays of descriptors, as in "uniform sampler2D textures[4]",
+	// use one binding with a count, and "textures[]" has no count
+	uint32_t count = 1;
+	for (uint32_t depth = 0; type && depth < MAX_TYPE_DEPTH; depth++)
+	{
+		if (type->op == spv::Op::OpTypeArray)
+		{
+			SpirvId* length = find_id(reader, operand(reader, *type, 3));
+			count *= length ? (uint32_t)length->value : 0;
+		}
+		else if (type->op == spv::Op::OpTypeRuntimeArray)
+		{
+			count = 0;
+		}
+		else
+		{
+			break;
+		}
+
+		type_id = operand(reader, *type, 2);
+		type = find_id(reader, type_id);
+	}
+
+	SpirvBinding binding;
+	if (!descriptor_type(reader, storage, type, &binding.type))
+		return true;
+
+	if (variable.binding == NO_VALUE)
+	{
+		reader.error = "\"" + name_of(reader, variable_id) + "\" has no binding";
+		return false;
+	}
+
+	binding.set = variable.set == NO_VALUE ? 0 : variable.set;
+	binding.binding = variable.binding;
+	binding.count = count;
+
+	// a uniform block without an instance name has
+	// no name itself, but its block type does
+	binding.name = name_of(reader, variable_id);
+	if (binding.name.empty() && type)
+		binding.name = name_of(reader, type_id);
+
+	out.bindings.push_back(binding);
+	return true;
+}
+
+// OpSpecConstant, OpSpecConstantTrue, and OpSpecConstantFalse
+static void reflect_spec_constant(SpirvReader& reader, uint32_t constant_id, SpirvReflection& out)
+{
+	SpirvId& constant = reader.ids[constant_id];
+
+	if (constant.spec_id == NO_VALUE)
+		return;
+
+	SpirvSpecConstant spec;
+	spec.constant_id = constant.spec_id;
+	spec.default_value = constant.value;
+	spec.name = name_of(reader, constant_id);
+
+	// booleans are given to Vulkan as a VkBool32
+	SpirvId* type = find_id(reader, operand(reader, constant, 1));
+	if (type && type->op != spv::Op::OpTypeBool)
+		spec.size = operand(reader, *type, 2) / 8;
+	else
+		spec.size = 4;
+
+	out.spec_constants.push_back(spec);
+}
+
+static bool binding_less(const SpirvBinding& a, const SpirvBinding& b)
+{
+	if (a.set != b.set) return a.set < b.set;
+	return a.binding < b.binding;
+}
+
+static bool input_less(const SpirvVertexInput& a, const SpirvVertexInput& b)
+{
+	return a.location < b.location;
+}
+
+static bool spec_less(const SpirvSpecConstant& a, const SpirvSpecConstant& b)
+{
+	return a.constant_id < b.constant_id;
+}
+
+bool reflect_spirv(const uint32_t* words, size_t word_count, SpirvReflection& out, std::string& error)
+{
+	out = SpirvReflection();
+
+	// the header is five words: the magic number, the version,
+	// who made it, one more than the largest ID, and zero
+	if (words == NULL || word_count < 5 || words[0] != spv::MagicNumber)
+	{
+		error = "this is not SPIR-V";
+		return false;
+	}
+
+	// the bound comes from the file, so we do not let
+	// a broken file ask for an enormous table
+	uint32_t bound = words[3];
+	if (bound > MAX_SPIRV_BOUND)
+	{
+		error = "the ID bound is too large";
+		return false;
+	}
+
+	SpirvReader reader;
+	reader.words = words;
+	reader.word_count = word_count;
+	reader.ids.resize(bound);
+	reader.entry_function = NO_VALUE;
+	for (int i = 0; i < 3; i++)
+		reader.workgroup_size_ids[i] = NO_VALUE;
+
+	bool found_entry_point = false;
+
+	// Every instruction starts with a word that holds its length in the
+	// top 16 bits, and its opcode in the bottom 16 bits. The module is in
+	// a fixed order: entry points, execution modes, names, decorations,
+	// then types, constants, and global variables, and then the code.
+	// By the time we reach a variable we already know its decorations
+	// and its type, so we can reflect it right away, and we stop as soon
+	// as the first function starts, without reading any of the code
+	size_t i = 5;
+	while (i < word_count)
+	{
+		uint32_t length = words[i] >> spv::WordCountShift;
+		spv::Op op = (spv::Op)(words[i] & spv::OpCodeMask);
+
+		if (length == 0 || i + length > word_count)
+		{
+			error = "an instruction runs past the end of the module";
+			return false;
+		}
+
+		if (op == spv::Op::OpFunction)
+			break;
+
+		size_t end = i + length;
+
+		switch (op)
+		{
+		case spv::Op::OpEntryPoint:
+		{
+			// a module can have more than one entry
+			// point, and we reflect the first one
+			if (found_entry_point || length < 4)
+				break;
+
+			found_entry_point = true;
+			out.stage = stage_of((spv::ExecutionModel)words[i + 1]);
+			reader.entry_function = words[i + 2];
+			out.entry_point = read_string(reader, i + 3, end);
+			break;
+		}
+
+		case spv::Op::OpExecutionMode:
+		case spv::Op::OpExecutionModeId:
+		{
+			if (length < 6 || words[i + 1] != reader.entry_function)
+				break;
+
+			spv::ExecutionMode mode = (spv::ExecutionMode)words[i + 2];
+			if (mode == spv::ExecutionMode::LocalSize)
+			{
+				for (int d = 0; d < 3; d++)
+					out.workgroup_size[d] = words[i + 3 + d];
+			}
+			else if (mode == spv::ExecutionMode::LocalSizeId)
+			{
+				for (int d = 0; d < 3; d++)
+					reader.workgroup_size_ids[d] = words[i + 3 + d];
+			}
+			break;
+		}
+
+		case spv::Op::OpName:
+		{
+			if (length >= 3 && find_id(reader, words[i + 1]))
+				reader.names[words[i + 1]] = read_string(reader, i + 2, end);
+			break;
+		}
+
+		case spv::Op::OpDecorate:
+		{
+			SpirvId* id = length >= 3 ? find_id(reader, words[i + 1]) : NULL;
+			if (id == NULL)
+				break;
+
+			uint32_t value = length >= 4 ? words[i + 3] : 0;
+			switch ((spv::Decoration)words[i + 2])
+			{
+			case spv::Decoration::DescriptorSet: id->set = value; break;
+			case spv::Decoration::Binding: id->binding = value; break;
+			case spv::Decoration::Location: id->location = value; break;
+			case spv::Decoration::SpecId: id->spec_id = value; break;
+			case spv::Decoration::BuiltIn: id->builtin = value; break;
+			case spv::Decoration::ArrayStride: id->array_stride = value; break;
+			case spv::Decoration::Block: id->block = true; break;
+			case spv::Decoration::BufferBlock: id->buffer_block = true; break;
+			default: break;
+			}
+			break;
+		}
+
+		case spv::Op::OpMemberDecorate:
+		{
+			if (length < 5)
+				break;
+
+			spv::Decoration decoration = (spv::Decoration)words[i + 3];
+			if (decoration != spv::Decoration::Offset && decoration != spv::Decoration::MatrixStride)
+				break;
+
+			uint64_t key = ((uint64_t)words[i + 1] << 32) | words[i + 2];
+			std::unordered_map<uint64_t, SpirvMember>::iterator member = reader.members.find(key);
+			if (member == reader.members.end())
+			{
+				SpirvMember empty = { NO_VALUE, NO_VALUE };
+				member = reader.members.insert(std::make_pair(key, empty)).first;
+			}
+
+			if (decoration == spv::Decoration::Offset)
+				member->second.offset = words[i + 4];
+			else
+				member->second.matrix_stride = words[i + 4];
+			break;
+		}
+
+		case spv::Op::OpTypeVoid:
+		case spv::Op::OpTypeBool:
+		case spv::Op::OpTypeInt:
+		case spv::Op::OpTypeFloat:
+		case spv::Op::OpTypeVector:
+		case spv::Op::OpTypeMatrix:
+		case spv::Op::OpTypeImage:
+		case spv::Op::OpTypeSampler:
+		case spv::Op::OpTypeSampledImage:
+		case spv::Op::OpTypeArray:
+		case spv::Op::OpTypeRuntimeArray:
+		case spv::Op::OpTypeStruct:
+		case spv::Op::OpTypePointer:
+		case spv::Op::OpTypeAccelerationStructureNV:
+		{
+			// types have their own ID as the first operand
+			SpirvId* id = length >= 2 ? find_id(reader, words[i + 1]) : NULL;
+			if (id)
+			{
+				id->op = op;
+				id->first_word = i;
+			}
+			break;
+		}
+
+		case spv::Op::OpConstant:
+		case spv::Op::OpSpecConstant:
+		case spv::Op::OpConstantTrue:
+		case spv::Op::OpConstantFalse:
+		case spv::Op::OpSpecConstantTrue:
+		case spv::Op::OpSpecConstantFalse:
+		{
+			// constants have their type first, then their own ID
+			SpirvId* id = length >= 3 ? find_id(reader, words[i + 2]) : NULL;
+			if (id == NULL)
+				break;
+
+			id->op = op;
+			id->first_word = i;
+
+			if (op == spv::Op::OpConstant || op == spv::Op::OpSpecConstant)
+			{
+				// 64 bit constants take two words, low word first
+				id->value = length >= 4 ? words[i + 3] : 0;
+				if (length >= 5)
+					id->value |= (uint64_t)words[i + 4] << 32;
+			}
+			else
+			{
+				id->value = (op == spv::Op::OpConstantTrue || op == spv::Op::OpSpecConstantTrue) ? 1 : 0;
+			}
+
+			if (op == spv::Op::OpSpecConstant || op == spv::Op::OpSpecConstantTrue || op == spv::Op::OpSpecConstantFalse)
+				reflect_spec_constant(reader, words[i + 2], out);
+			break;
+		}
+
+		case spv::Op::OpConstantComposite:
+		case spv::Op::OpSpecConstantComposite:
+		{
+			// "layout(local_size_x_id = 0) in;" turns into a vector
+			// decorated as the WorkgroupSize built in, which wins
+			// over the LocalSize execution mode
+			SpirvId* id = length >= 3 ? find_id(reader, words[i + 2]) : NULL;
+			if (id == NULL || id->builtin != (uint32_t)spv::BuiltIn::WorkgroupSize || length < 6)
+				break;
+
+			for (int d = 0; d < 3; d++)
+				reader.workgroup_size_ids[d] = words[i + 3 + d];
+			break;
+		}
+
+		case spv::Op::OpVariable:
+		{
+			SpirvId* id = length >= 4 ? find_id(reader, words[i + 2]) : NULL;
+			if (id == NULL)
+				break;
+
+			id->op = op;
+			id->first_word = i;
+			if (!reflect_variable(reader, words[i + 2], out))
+			{
+				error = reader.error;
+				return false;
+			}
+			break;
+		}
+
+		default:
+			break;
+		}
+
+		i = end;
+	}
+
+	if (!found_entry_point)
+	{
+		error = "the module has no entry point";
+		return false;
+	}
+
+	// now that every constant has been read,
+	// we can look up the workgroup size IDs
+	for (int d = 0; d < 3; d++)
+	{
+		SpirvId* size = reader.workgroup_size_ids[d] == NO_VALUE ? NULL : find_id(reader, reader.workgroup_size_ids[d]);
+		if (size == NULL)
+			continue;
+
+		out.workgroup_size[d] = (uint32_t)size->value;
+		out.workgroup_size_spec_id[d] = size->spec_id == NO_VALUE ? SPIRV_NO_SPEC_ID : size->spec_id;
+	}
+
+	std::sort(out.bindings.begin(), out.bindings.end(), binding_less);
+	std::sort(out.vertex_inputs.begin(), out.vertex_inputs.end(), input_less);
+	std::sort(out.spec_constants.begin(), out.spec_constants.end(), spec_less);
+	return true;
+}
+
+static const char* descriptor_type_name(VkDescriptorType type)
+{
+	switch (type)
+	{
+	case VK_DESCRIPTOR_TYPE_SAMPLER: return "sampler";
+	case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER: return "combined image sampler";
+	case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE: return "sampled image";
+	case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: return "storage image";
+	case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER: return "uniform texel buffer";
+	case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER: return "storage texel buffer";
+	case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER: return "uniform buffer";
+	case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER: return "storage buffer";
+	case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT: return "input attachment";
+	case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_NV: return "acceleration structure";
+	default: return "unknown";
+	}
+}
+
+void print_spirv_reflection(const char* name, const SpirvReflection& reflection)
+{
+	printf("%s: entry point %s, stage 0x%x\n", name, reflection.entry_point.c_str(), reflection.stage);
+
+	for (size_t i = 0; i < reflection.bindings.size(); i++)
+	{
+		const SpirvBinding& binding = reflection.bindings[i];
+		printf("    set %u binding %u: %s", binding.set, binding.binding, descriptor_type_name(binding.type));
+		if (binding.count != 1)
+			printf("[%s]", binding.count ? std::to_string(binding.count).c_str() : "");
+		printf(" %s\n", binding.name.c_str());
+	}
+
+	if (reflection.push_constant_size > 0)
+	{
+		printf("    push constants: bytes %u to %u\n", reflection.push_constant_offset,
+			reflection.push_constant_offset + reflection.push_constant_size);
+	}
+
+	for (size_t i = 0; i < reflection.spec_constants.size(); i++)
+	{
+		const SpirvSpecConstant& spec = reflection.spec_constants[i];
+		printf("    constant_id %u: %u bytes, default %llu %s\n", spec.constant_id, spec.size,
+			(unsigned long long)spec.default_value, spec.name.c_str());
+	}
+
+	if (reflection.stage == VK_SHADER_STAGE_COMPUTE_BIT)
+	{
+		printf("    workgroup size:");
+		for (int d = 0; d < 3; d++)
+		{
+			printf(" %u", reflection.workgroup_size[d]);
+			if (reflection.workgroup_size_spec_id[d] != SPIRV_NO_SPEC_ID)
+				printf(" (constant_id %u)", reflection.workgroup_size_spec_id[d]);
+		}
+		printf("\n");
+	}
+
+	for (size_t i = 0; i < reflection.vertex_inputs.size(); i++)
+	{
+		const SpirvVertexInput& input = reflection.vertex_inputs[i];
+		printf("    location %u: format %u %s\n", input.location, input.format, input.name.c_str());
+	}
+}
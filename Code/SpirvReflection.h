@@ -0,0 +1,105 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// Everything a pipeline needs to know about a shader, read straight
+// out of its SPIR-V, so that nobody has to write descriptor set
+// layouts by hand (and forget to change them when the shader changes)
+
+#define SPIRV_NO_SPEC_ID 0xFFFFFFFF
+
+// one descriptor (or array of descriptors) the shader uses
+struct SpirvBinding
+{
+	uint32_t set;
+	uint32_t binding;
+	VkDescriptorType type;
+
+	// how many descriptors, 0 for an array without a size
+	uint32_t count;
+
+	std::string name;
+};
+
+// a "layout(constant_id = N)" constant, which can
+// be changed when the pipeline is made
+struct SpirvSpecConstant
+{
+	uint32_t constant_id;
+	uint32_t size;
+	uint64_t default_value;
+	std::string name;
+};
+
+// one "layout(location = N) in" of a vertex shader
+struct SpirvVertexInput
+{
+	uint32_t location;
+	VkFormat format;
+	std::string name;
+};
+
+struct SpirvReflection
+{
+	VkShaderStageFlagBits stage;
+	std::string entry_point;
+
+	// sorted by set, then binding
+	std::vector<SpirvBinding> bindings;
+
+	// the bytes of push constants the shader reads, size 0 if none
+	uint32_t push_constant_offset;
+	uint32_t push_constant_size;
+
+	std::vector<SpirvSpecConstant> spec_constants;
+
+	// local_size_x/y/z of a compute shader. If a size comes from a
+	// specialization constant, its constant ID is here too, and the
+	// size is the default value of that constant
+	uint32_t workgroup_size[3];
+	uint32_t workgroup_size_spec_id[3];
+
+	// sorted by location
+	std::vector<SpirvVertexInput> vertex_inputs;
+
+	SpirvReflection();
+};
+
+// Read "words" (a whole SPIR-V module) into "out". The module is read
+// once from start to finish, and only up to the first function,
+// because everything we want is declared before the code starts.
+// Returns false, with the reason in "error", if the words are not
+// SPIR-V that we understand
+bool reflect_spirv(const uint32_t* words, size_t word_count, SpirvReflection& out, std::string& error);
+
+// print what "reflect_spirv" found, for "-reflect"
+void print_spirv_reflection(const char* name, const SpirvReflection& reflection);
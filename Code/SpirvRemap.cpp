@@ -0,0 +1,467 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "SpirvRemap.h"
+
+#include <string.h>
+#include <algorithm>
+
+// for HasResultAndType, which tells us which instructions
+// start with a result type and a result ID
+#define SPV_ENABLE_UTILITY_CODE
+#include <vulkan/spirv.hpp11>
+
+// a range of literal operands that goes on to the end of the instruction
+#define TO_END 0xFFFF
+
+SpirvRemapStats::SpirvRemapStats()
+{
+	words_before = 0;
+	words_after = 0;
+	bound_before = 0;
+	bound_after = 0;
+	stripped = 0;
+	renumbered = false;
+}
+
+// Which operands of an instruction are IDs. Most instructions only
+// have IDs, some have literal numbers (or strings) at fixed places,
+// and every word from literal_first up to literal_end is a literal.
+// If both are 0, every operand is an ID. The table covers a range of
+// opcodes in each entry, and it is sorted, so we can binary search it
+struct SpirvOperands
+{
+	spv::Op first;
+	spv::Op last;
+	uint16_t literal_first;
+	uint16_t literal_end;
+};
+
+static const SpirvOperands operand_table[] =
+{
+	{ spv::Op::OpNop, spv::Op::OpUndef, 0, 0 },
+	{ spv::Op::OpSourceContinued, spv::Op::OpSourceContinued, 1, TO_END },
+	{ spv::Op::OpSourceExtension, spv::Op::OpSourceExtension, 1, TO_END },
+	{ spv::Op::OpName, spv::Op::OpLine, 2, TO_END },
+	{ spv::Op::OpExtension, spv::Op::OpExtension, 1, TO_END },
+	{ spv::Op::OpExtInstImport, spv::Op::OpExtInstImport, 2, TO_END },
+	{ spv::Op::OpExtInst, spv::Op::OpExtInst, 4, 5 },
+	{ spv::Op::OpMemoryModel, spv::Op::OpMemoryModel, 1, TO_END },
+	{ spv::Op::OpExecutionMode, spv::Op::OpExecutionMode, 2, TO_END },
+	{ spv::Op::OpCapability, spv::Op::OpCapability, 1, TO_END },
+	{ spv::Op::OpTypeVoid, spv::Op::OpTypeBool, 0, 0 },
+	{ spv::Op::OpTypeInt, spv::Op::OpTypeFloat, 2, TO_END },
+	{ spv::Op::OpTypeVector, spv::Op::OpTypeMatrix, 3, 4 },
+	{ spv::Op::OpTypeImage, spv::Op::OpTypeImage, 3, TO_END },
+	{ spv::Op::OpTypeSampler, spv::Op::OpTypeStruct, 0, 0 },
+	{ spv::Op::OpTypeOpaque, spv::Op::OpTypeOpaque, 2, TO_END },
+	{ spv::Op::OpTypePointer, spv::Op::OpTypePointer, 2, 3 },
+	{ spv::Op::OpTypeFunction, spv::Op::OpTypeFunction, 0, 0 },
+	{ spv::Op::OpTypeForwardPointer, spv::Op::OpTypeForwardPointer, 2, 3 },
+	{ spv::Op::OpConstantTrue, spv::Op::OpConstantFalse, 0, 0 },
+	{ spv::Op::OpConstant, spv::Op::OpConstant, 3, TO_END },
+	{ spv::Op::OpConstantComposite, spv::Op::OpConstantComposite, 0, 0 },
+	{ spv::Op::OpConstantSampler, spv::Op::OpConstantSampler, 3, TO_END },
+	{ spv::Op::OpConstantNull, spv::Op::OpSpecConstantFalse, 0, 0 },
+	{ spv::Op::OpSpecConstant, spv::Op::OpSpecConstant, 3, TO_END },
+	{ spv::Op::OpSpecConstantComposite, spv::Op::OpSpecConstantComposite, 0, 0 },
+	{ spv::Op::OpFunction, spv::Op::OpFunction, 3, 4 },
+	{ spv::Op::OpFunctionParameter, spv::Op::OpFunctionCall, 0, 0 },
+	{ spv::Op::OpVariable, spv::Op::OpVariable, 3, 4 },
+	{ spv::Op::OpImageTexelPointer, spv::Op::OpImageTexelPointer, 0, 0 },
+	{ spv::Op::OpAccessChain, spv::Op::OpPtrAccessChain, 0, 0 },
+	{ spv::Op::OpArrayLength, spv::Op::OpArrayLength, 4, 5 },
+	{ spv::Op::OpGenericPtrMemSemantics, spv::Op::OpInBoundsPtrAccessChain, 0, 0 },
+	{ spv::Op::OpDecorate, spv::Op::OpMemberDecorate, 2, TO_END },
+	{ spv::Op::OpDecorationGroup, spv::Op::OpGroupDecorate, 0, 0 },
+	{ spv::Op::OpVectorExtractDynamic, spv::Op::OpVectorInsertDynamic, 0, 0 },
+	{ spv::Op::OpVectorShuffle, spv::Op::OpVectorShuffle, 5, TO_END },
+	{ spv::Op::OpCompositeConstruct, spv::Op::OpCompositeConstruct, 0, 0 },
+	{ spv::Op::OpCompositeExtract, spv::Op::OpCompositeExtract, 4, TO_END },
+	{ spv::Op::OpCompositeInsert, spv::Op::OpCompositeInsert, 5, TO_END },
+	{ spv::Op::OpCopyObject, spv::Op::OpTranspose, 0, 0 },
+	{ spv::Op::OpSampledImage, spv::Op::OpSampledImage, 0, 0 },
+
+	// for the image instructions, the literal is the image operands
+	// mask, and the operands after it (the LOD, offsets...) are IDs
+	{ spv::Op::OpImageSampleImplicitLod, spv::Op::OpImageSampleExplicitLod, 5, 6 },
+	{ spv::Op::OpImageSampleDrefImplicitLod, spv::Op::OpImageSampleDrefExplicitLod, 6, 7 },
+	{ spv::Op::OpImageSampleProjImplicitLod, spv::Op::OpImageSampleProjExplicitLod, 5, 6 },
+	{ spv::Op::OpImageSampleProjDrefImplicitLod, spv::Op::OpImageSampleProjDrefExplicitLod, 6, 7 },
+	{ spv::Op::OpImageFetch, spv::Op::OpImageFetch, 5, 6 },
+	{ spv::Op::OpImageGather, spv::Op::OpImageDrefGather, 6, 7 },
+	{ spv::Op::OpImageRead, spv::Op::OpImageRead, 5, 6 },
+	{ spv::Op::OpImageWrite, spv::Op::OpImageWrite, 4, 5 },
+	{ spv::Op::OpImage, spv::Op::OpImageQuerySamples, 0, 0 },
+	{ spv::Op::OpConvertFToU, spv::Op::OpGenericCastToPtr, 0, 0 },
+	{ spv::Op::OpGenericCastToPtrExplicit, spv::Op::OpGenericCastToPtrExplicit, 4, 5 },
+	{ spv::Op::OpBitcast, spv::Op::OpSMulExtended, 0, 0 },
+	{ spv::Op::OpAny, spv::Op::OpFUnordGreaterThanEqual, 0, 0 },
+	{ spv::Op::OpShiftRightLogical, spv::Op::OpBitCount, 0, 0 },
+	{ spv::Op::OpDPdx, spv::Op::OpFwidthCoarse, 0, 0 },
+	{ spv::Op::OpEmitVertex, spv::Op::OpEndStreamPrimitive, 0, 0 },
+	{ spv::Op::OpControlBarrier, spv::Op::OpMemoryBarrier, 0, 0 },
+	{ spv::Op::OpAtomicLoad, spv::Op::OpAtomicXor, 0, 0 },
+	{ spv::Op::OpPhi, spv::Op::OpPhi, 0, 0 },
+	{ spv::Op::OpLoopMerge, spv::Op::OpLoopMerge, 3, TO_END },
+	{ spv::Op::OpSelectionMerge, spv::Op::OpSelectionMerge, 2, TO_END },
+	{ spv::Op::OpLabel, spv::Op::OpBranch, 0, 0 },
+	{ spv::Op::OpBranchConditional, spv::Op::OpBranchConditional, 4, TO_END },
+	{ spv::Op::OpKill, spv::Op::OpUnreachable, 0, 0 },
+	{ spv::Op::OpLifetimeStart, spv::Op::OpLifetimeStop, 2, 3 },
+	{ spv::Op::OpGroupAll, spv::Op::OpGroupBroadcast, 0, 0 },
+
+	// the group operations have the kind of
+	// operation (reduce, scan...) as a literal
+	{ spv::Op::OpGroupIAdd, spv::Op::OpGroupSMax, 4, 5 },
+	{ spv::Op::OpImageSparseSampleImplicitLod, spv::Op::OpImageSparseSampleExplicitLod, 5, 6 },
+	{ spv::Op::OpImageSparseSampleDrefImplicitLod, spv::Op::OpImageSparseSampleDrefExplicitLod, 6, 7 },
+	{ spv::Op::OpImageSparseSampleProjImplicitLod, spv::Op::OpImageSparseSampleProjExplicitLod, 5, 6 },
+	{ spv::Op::OpImageSparseSampleProjDrefImplicitLod, spv::Op::OpImageSparseSampleProjDrefExplicitLod, 6, 7 },
+	{ spv::Op::OpImageSparseFetch, spv::Op::OpImageSparseFetch, 5, 6 },
+	{ spv::Op::OpImageSparseGather, spv::Op::OpImageSparseDrefGather, 6, 7 },
+	{ spv::Op::OpImageSparseTexelsResident, spv::Op::OpAtomicFlagClear, 0, 0 },
+	{ spv::Op::OpImageSparseRead, spv::Op::OpImageSparseRead, 5, 6 },
+	{ spv::Op::OpSizeOf, spv::Op::OpSizeOf, 0, 0 },
+	{ spv::Op::OpModuleProcessed, spv::Op::OpModuleProcessed, 1, TO_END },
+	{ spv::Op::OpExecutionModeId, spv::Op::OpDecorateId, 2, 3 },
+	{ spv::Op::OpGroupNonUniformElect, spv::Op::OpGroupNonUniformBallotBitExtract, 0, 0 },
+	{ spv::Op::OpGroupNonUniformBallotBitCount, spv::Op::OpGroupNonUniformBallotBitCount, 4, 5 },
+	{ spv::Op::OpGroupNonUniformBallotFindLSB, spv::Op::OpGroupNonUniformShuffleDown, 0, 0 },
+	{ spv::Op::OpGroupNonUniformIAdd, spv::Op::OpGroupNonUniformLogicalXor, 4, 5 },
+	{ spv::Op::OpGroupNonUniformQuadBroadcast, spv::Op::OpGroupNonUniformQuadSwap, 0, 0 },
+	{ spv::Op::OpCopyLogical, spv::Op::OpPtrDiff, 0, 0 },
+	{ spv::Op::OpSubgroupBallotKHR, spv::Op::OpSubgroupFirstInvocationKHR, 0, 0 },
+	{ spv::Op::OpSubgroupAllKHR, spv::Op::OpSubgroupReadInvocationKHR, 0, 0 },
+	{ spv::Op::OpGroupIAddNonUniformAMD, spv::Op::OpGroupSMaxNonUniformAMD, 4, 5 },
+	{ spv::Op::OpFragmentMaskFetchAMD, spv::Op::OpFragmentFetchAMD, 0, 0 },
+	{ spv::Op::OpImageSampleFootprintNV, spv::Op::OpImageSampleFootprintNV, 7, 8 },
+	{ spv::Op::OpGroupNonUniformPartitionNV, spv::Op::OpGroupNonUniformPartitionNV, 0, 0 },
+	{ spv::Op::OpWritePackedPrimitiveIndices4x8NV, spv::Op::OpWritePackedPrimitiveIndices4x8NV, 0, 0 },
+	{ spv::Op::OpReportIntersectionNV, spv::Op::OpTraceNV, 0, 0 },
+	{ spv::Op::OpTypeAccelerationStructureNV, spv::Op::OpTypeAccelerationStructureNV, 0, 0 },
+	{ spv::Op::OpExecuteCallableNV, spv::Op::OpExecuteCallableNV, 0, 0 },
+	{ spv::Op::OpBeginInvocationInterlockEXT, spv::Op::OpEndInvocationInterlockEXT, 0, 0 },
+	{ spv::Op::OpDemoteToHelperInvocationEXT, spv::Op::OpIsHelperInvocationEXT, 0, 0 },
+	{ spv::Op::OpDecorateStringGOOGLE, spv::Op::OpMemberDecorateStringGOOGLE, 2, TO_END },
+};
+
+static bool operands_before(const SpirvOperands& entry, spv::Op op)
+{
+	return entry.last < op;
+}
+
+// the index of the word after a string that starts at word "first"
+static uint32_t skip_string(const uint32_t* inst, uint32_t first, uint32_t length)
+{
+	uint32_t i = first;
+	while (i < length)
+	{
+		uint32_t word = inst[i++];
+		if ((word & 0xFF) == 0 || (word & 0xFF00) == 0 || (word & 0xFF0000) == 0 || (word & 0xFF000000) == 0)
+			break;
+	}
+	return i;
+}
+
+// The memory operands of OpLoad and friends start with a mask. Aligned
+// adds a literal, and MakePointerAvailable/Visible each add a scope ID
+static void mark_memory_access(const uint32_t* inst, uint32_t first, uint32_t length, std::vector<uint8_t>& is_id)
+{
+	uint32_t i = first;
+	while (i < length)
+	{
+		uint32_t mask = inst[i];
+		is_id[i++] = 0;
+
+		if ((mask & (uint32_t)spv::MemoryAccessMask::Aligned) && i < length)
+			is_id[i++] = 0;
+		if (mask & (uint32_t)spv::MemoryAccessMask::MakePointerAvailableKHR)
+			i++;
+		if (mask & (uint32_t)spv::MemoryAccessMask::MakePointerVisibleKHR)
+			i++;
+	}
+}
+
+// What we learn about the module as we go, that
+// later instructions need to find their IDs
+struct SpirvTypes
+{
+	// the result type of every ID that has one
+	std::vector<uint32_t> type_of;
+
+	// for every OpTypeInt, how many words its literals take
+	std::vector<uint8_t> int_words;
+};
+
+// Set is_id[w] for every word "w" of the instruction that is an ID.
+// Returns false for an instruction we do not know the operands of
+static bool find_ids(const uint32_t* inst, uint32_t length, const SpirvTypes& types, std::vector<uint8_t>& is_id)
+{
+	spv::Op op = (spv::Op)(inst[0] & spv::OpCodeMask);
+	is_id.assign(length, 1);
+	is_id[0] = 0;
+
+	switch (op)
+	{
+	case spv::Op::OpEntryPoint:
+	{
+		// the execution model, the function, the name, and
+		// then the IDs of the variables that the shader uses
+		is_id[1] = 0;
+		uint32_t end = skip_string(inst, 3, length);
+		for (uint32_t w = 3; w < end; w++)
+			is_id[w] = 0;
+		return true;
+	}
+
+	case spv::Op::OpSource:
+		// language, version, then the file (an ID), then the source text
+		for (uint32_t w = 1; w < length; w++)
+			is_id[w] = w == 3;
+		return true;
+
+	case spv::Op::OpLoad:
+	case spv::Op::OpCopyMemorySized:
+		mark_memory_access(inst, 4, length, is_id);
+		return true;
+
+	case spv::Op::OpStore:
+	case spv::Op::OpCopyMemory:
+		mark_memory_access(inst, 3, length, is_id);
+		return true;
+
+	case spv::Op::OpGroupMemberDecorate:
+		// the group, then pairs of (struct ID, member number)
+		for (uint32_t w = 2; w < length; w++)
+			is_id[w] = w % 2 == 0;
+		return true;
+
+	case spv::Op::OpSpecConstantOp:
+	{
+		// The opcode of the operation, then its operands, which are
+		// the operands of that instruction without its result type
+		// and result ID. CompositeExtract, CompositeInsert, and
+		// VectorShuffle have literal indices among them, so we look
+		// the operation up as if it were an instruction of its own,
+		// one word shorter, and move what we find one word along
+		if (length < 4)
+			return false;
+
+		spv::Op inner_op = (spv::Op)(inst[3] & spv::OpCodeMask);
+		if (inner_op == spv::Op::OpSpecConstantOp)
+			return false;
+
+		std::vector<uint32_t> inner(inst, inst + length - 1);
+		inner[0] = ((length - 1) << spv::WordCountShift) | (uint32_t)inner_op;
+		for (uint32_t w = 3; w < length - 1; w++)
+			inner[w] = inst[w + 1];
+
+		std::vector<uint8_t> inner_is_id;
+		if (!find_ids(inner.data(), length - 1, types, inner_is_id))
+			return false;
+
+		is_id[3] = 0;
+		for (uint32_t w = 4; w < length; w++)
+			is_id[w] = inner_is_id[w - 1];
+		return true;
+	}
+
+	case spv::Op::OpSwitch:
+	{
+		// The selector and the default label, then pairs of a case value
+		// and a label. The case values are as wide as the selector, so
+		// 64 bit selectors have two word values
+		uint32_t selector = length > 1 ? inst[1] : 0;
+		uint32_t type = selector < types.type_of.size() ? types.type_of[selector] : 0;
+		uint32_t value_words = type < types.int_words.size() && types.int_words[type] ? types.int_words[type] : 1;
+
+		uint32_t w = 3;
+		while (w < length)
+		{
+			for (uint32_t v = 0; v < value_words && w < length; v++)
+				is_id[w++] = 0;
+			w++;
+		}
+		return true;
+	}
+
+	default:
+		break;
+	}
+
+	const SpirvOperands* end = operand_table + sizeof(operand_table) / sizeof(operand_table[0]);
+	const SpirvOperands* entry = std::lower_bound(operand_table, end, op, operands_before);
+	if (entry == end || op < entry->first)
+		return false;
+
+	uint32_t literal_end = std::min((uint32_t)entry->literal_end, length);
+	for (uint32_t w = entry->literal_first; w < literal_end; w++)
+		is_id[w] = 0;
+	return true;
+}
+
+// Number every ID again, in the order that it first appears. Returns
+// false, and leaves the module alone, if we cannot find every ID
+static bool renumber_ids(std::vector<uint32_t>& module)
+{
+	uint32_t bound = module[3];
+	std::vector<uint32_t> new_ids(bound, 0);
+	uint32_t next_id = 1;
+
+	SpirvTypes types;
+	types.type_of.assign(bound, 0);
+	types.int_words.assign(bound, 0);
+
+	std::vector<uint32_t> renumbered = module;
+	std::vector<uint8_t> is_id;
+
+	for (size_t i = 5; i < module.size(); )
+	{
+		const uint32_t* inst = &module[i];
+		uint32_t length = inst[0] >> spv::WordCountShift;
+		spv::Op op = (spv::Op)(inst[0] & spv::OpCodeMask);
+
+		if (!find_ids(inst, length, types, is_id))
+			return false;
+
+		// OpSwitch needs to know how wide its selector is
+		bool has_result = false, has_type = false;
+		spv::HasResultAndType(op, &has_result, &has_type);
+		if (has_type && has_result && length >= 3 && inst[2] < bound)
+			types.type_of[inst[2]] = inst[1];
+		if (op == spv::Op::OpTypeInt && length >= 3 && inst[1] < bound)
+			types.int_words[inst[1]] = inst[2] > 32 ? 2 : 1;
+
+		for (uint32_t w = 1; w < length; w++)
+		{
+			if (!is_id[w])
+				continue;
+
+			uint32_t id = inst[w];
+			if (id == 0 || id >= bound)
+				return false;
+
+			if (new_ids[id] == 0)
+				new_ids[id] = next_id++;
+			renumbered[i + w] = new_ids[id];
+		}
+
+		i += length;
+	}
+
+	renumbered[3] = next_id;
+	module.swap(renumbered);
+	return true;
+}
+
+// the instructions that only a debugger reads
+static bool is_debug_instruction(spv::Op op, bool keep_strings)
+{
+	switch (op)
+	{
+	case spv::Op::OpSourceContinued:
+	case spv::Op::OpSource:
+	case spv::Op::OpSourceExtension:
+	case spv::Op::OpName:
+	case spv::Op::OpMemberName:
+	case spv::Op::OpLine:
+	case spv::Op::OpNoLine:
+	case spv::Op::OpModuleProcessed:
+		return true;
+
+	case spv::Op::OpString:
+		return !keep_strings;
+
+	default:
+		return false;
+	}
+}
+
+bool remap_spirv(std::vector<uint32_t>& words, uint32_t flags, SpirvRemapStats* stats, std::string& error)
+{
+	SpirvRemapStats local_stats;
+	SpirvRemapStats& s = stats ? *stats : local_stats;
+	s = SpirvRemapStats();
+
+	if (words.size() < 5 || words[0] != spv::MagicNumber)
+	{
+		error = "this is not SPIR-V";
+		return false;
+	}
+
+	s.words_before = words.size();
+	s.bound_before = words[3];
+
+	// First we make sure every instruction fits, so the rest of
+	// this file never has to worry about reading past the end.
+	// An extended instruction set for debug info (like
+	// OpenCL.DebugInfo.100) uses OpString for its file names,
+	// so then the strings have to stay
+	bool keep_strings = false;
+	for (size_t i = 5; i < words.size(); )
+	{
+		uint32_t length = words[i] >> spv::WordCountShift;
+		if (length == 0 || i + length > words.size())
+		{
+			error = "an instruction runs past the end of the module";
+			return false;
+		}
+
+		if ((spv::Op)(words[i] & spv::OpCodeMask) == spv::Op::OpExtInstImport && length > 2)
+		{
+			const char* name = (const char*)&words[i + 2];
+			size_t name_size = (length - 2) * sizeof(uint32_t);
+			if (name_size >= 9 && (memcmp(name, "OpenCL.De", 9) == 0 || memcmp(name, "NonSemant", 9) == 0))
+				keep_strings = true;
+		}
+
+		i += length;
+	}
+
+	std::vector<uint32_t> module;
+	module.reserve(words.size());
+	module.insert(module.end(), words.begin(), words.begin() + 5);
+
+	for (size_t i = 5; i < words.size(); )
+	{
+		uint32_t length = words[i] >> spv::WordCountShift;
+		spv::Op op = (spv::Op)(words[i] & spv::OpCodeMask);
+
+		if ((flags & SPIRV_STRIP_DEBUG) && is_debug_instruction(op, keep_strings))
+			s.stripped++;
+		else
+			module.insert(module.end(), words.begin() + i, words.begin() + i + length);
+
+		i += length;
+	}
+
+	if (flags & SPIRV_CANONICAL_IDS)
+		s.renumbered = renumber_ids(module);
+
+	s.words_after = module.size();
+	s.bound_after = module[3];
+	words.swap(module);
+	return true;
+}
@@ -0,0 +1,75 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// The SPIR-V that shaderc makes carries a lot of things that only a
+// debugger needs: the name of every variable and function, the line
+// each instruction came from, and the whole GLSL source. None of it
+// changes what the shader does, it only makes the file bigger, so
+// every module we load, hash, and cache is bigger than it needs to be.
+//
+// Compilers also number their IDs however they like, so two shaders
+// that do exactly the same thing can still be different words. After
+// remap_spirv gives every ID a new number, in the order the IDs first
+// appear in the module, two modules that only differed in their IDs
+// are the same words, and hash to the same key.
+//
+// This does in our own program what Bin/spirv-remap.exe does on
+// Windows, so it works the same on every platform we build on
+
+// take out OpName, OpLine, OpSource, and the other debug instructions
+#define SPIRV_STRIP_DEBUG 0x1
+
+// number the IDs again, in the order they first appear,
+// with no gaps (this also makes the ID bound smaller)
+#define SPIRV_CANONICAL_IDS 0x2
+
+struct SpirvRemapStats
+{
+	size_t words_before;
+	size_t words_after;
+
+	uint32_t bound_before;
+	uint32_t bound_after;
+
+	// debug instructions that were taken out
+	uint32_t stripped;
+
+	// false if the module has an instruction that we do not know
+	// the operands of. We never guess which words are IDs, so such
+	// a module is stripped, but keeps the IDs it had
+	bool renumbered;
+
+	SpirvRemapStats();
+};
+
+// Strip and/or renumber "words" (a whole module) in place. Returns
+// false, and leaves "words" as it was, if the module is broken
+bool remap_spirv(std::vector<uint32_t>& words, uint32_t flags, SpirvRemapStats* stats, std::string& error);
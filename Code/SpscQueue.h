@@ -0,0 +1,96 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// SpscQueue is a ring buffer for exactly one thread that pushes
+// ("single producer") and exactly one thread that pops ("single
+// consumer"). With only one thread on each side, neither side ever
+// needs a lock: the producer is the only one that moves "tail", the
+// consumer is the only one that moves "head", and each one only
+// reads the other's position to see if the ring is full or empty.
+// Capacity has to be a power of two, so that we can wrap around
+// with a mask instead of a division
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+	SpscQueue() : head(0), tail(0) {}
+
+	// producer thread only. Returns false if the queue is full
+	bool push(const T& item)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) == Capacity)
+			return false;
+
+		slots[t & (Capacity - 1)] = item;
+
+		// "release" makes sure the consumer sees the item
+		// before it sees the new tail
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer thread only. Returns false if the queue is empty
+	bool pop(T& out)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire))
+			return false;
+
+		out = slots[h & (Capacity - 1)];
+
+		// and this makes sure the producer does not reuse
+		// the slot before we are done reading it
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const
+	{
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+
+private:
+	T slots[Capacity];
+
+	// head and tail are on their own cache lines, so the two
+	// threads are not fighting over one line of memory. We keep
+	// them apart with padding rather than alignas(64): an aligned
+	// member would make every class that holds a queue over-aligned,
+	// and "new" in C++14 does not promise that alignment. Anything
+	// 64 bytes apart can never share a 64 byte line
+	char pad_before_head[64];
+	std::atomic<size_t> head;
+	char pad_before_tail[64 - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> tail;
+	char pad_after_tail[64 - sizeof(std::atomic<size_t>)];
+};
@@ -0,0 +1,142 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "StartupGraph.h"
+
+#include <stdio.h>
+
+#include "ThreadPool.h"
+
+StartupGraph::StartupGraph()
+{
+	remaining = 0;
+	total = 0;
+}
+
+StartupGraph::TaskId StartupGraph::add(const char* name, std::function<void()> work, bool main_thread,
+	std::initializer_list<TaskId> after)
+{
+	TaskId id = (TaskId)tasks.size();
+
+	Task task;
+	task.name = name;
+	task.work = work;
+	task.main_thread = main_thread;
+	task.waiting_for = 0;
+	task.start_ms = 0;
+	task.end_ms = 0;
+	tasks.push_back(task);
+
+	for (TaskId before : after)
+	{
+		tasks[before].dependents.push_back(id);
+		tasks[id].waiting_for++;
+	}
+
+	return id;
+}
+
+double StartupGraph::now_ms() const
+{
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	return elapsed.count();
+}
+
+// called with "lock" held, once everything the task waits for is done
+void StartupGraph::dispatch(TaskId id, ThreadPool& pool)
+{
+	if (tasks[id].main_thread)
+	{
+		main_ready.push_back(id);
+		main_wake.notify_one();
+	}
+	else
+	{
+		pool.submit([this, id, &pool]() { execute(id, pool); });
+	}
+}
+
+void StartupGraph::execute(TaskId id, ThreadPool& pool)
+{
+	Task& task = tasks[id];
+
+	task.start_ms = now_ms();
+	task.work();
+	task.end_ms = now_ms();
+
+	// everything that was waiting for this task is one step closer,
+	// and the main thread may be waiting for the last task to finish
+	std::lock_guard<std::mutex> hold(lock);
+	for (TaskId dependent : task.dependents)
+	{
+		if (--tasks[dependent].waiting_for == 0)
+			dispatch(dependent, pool);
+	}
+
+	remaining--;
+	main_wake.notify_one();
+}
+
+void StartupGraph::run(ThreadPool& pool)
+{
+	start = std::chrono::high_resolution_clock::now();
+
+	std::unique_lock<std::mutex> hold(lock);
+	remaining = (uint32_t)tasks.size();
+	for (TaskId id = 0; id < tasks.size(); id++)
+	{
+		if (tasks[id].waiting_for == 0)
+			dispatch(id, pool);
+	}
+
+	// The main thread works through its own tasks as soon as they
+	// are ready, and sleeps while only the pool has work to do
+	while (remaining > 0)
+	{
+		main_wake.wait(hold, [this]() { return remaining == 0 || !main_ready.empty(); });
+		if (main_ready.empty())
+			break;
+
+		TaskId id = main_ready.front();
+		main_ready.pop_front();
+
+		hold.unlock();
+		execute(id, pool);
+		hold.lock();
+	}
+
+	total = now_ms();
+}
+
+void StartupGraph::print_timeline() const
+{
+	printf("Startup took %.2f ms:\n", total);
+	for (size_t i = 0; i < tasks.size(); i++)
+	{
+		const Task& task = tasks[i];
+		printf("  %-20s %8.2f -> %8.2f ms  (%s)\n", task.name.c_str(), task.start_ms, task.end_ms,
+			task.main_thread ? "main thread" : "worker");
+	}
+	printf("\n");
+}
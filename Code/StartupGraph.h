@@ -0,0 +1,90 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// StartupGraph runs the steps of starting the program as a small
+// graph of tasks. Every task says which tasks it has to wait for,
+// and everything that does not have to wait runs at the same time.
+// Some work has to stay on the main thread (in Win32, a window
+// belongs to the thread that created it, and its messages only go
+// to that thread), so tasks can ask for the main thread, and those
+// run inside run(), while every other task goes to the thread pool
+class StartupGraph
+{
+public:
+	typedef uint32_t TaskId;
+
+	StartupGraph();
+
+	// A task can only wait for tasks that were added before it,
+	// which means that the graph can never have a cycle
+	TaskId add(const char* name, std::function<void()> work, bool main_thread,
+		std::initializer_list<TaskId> after = {});
+
+	// Run every task, and return when all of them are done.
+	// This has to be called from the main thread
+	void run(ThreadPool& pool);
+
+	// when each task started and finished, and on which thread
+	void print_timeline() const;
+
+	// how long run() took, in milliseconds
+	double total_ms() const { return total; }
+
+private:
+	struct Task
+	{
+		std::string name;
+		std::function<void()> work;
+		bool main_thread;
+		std::vector<TaskId> dependents;
+		uint32_t waiting_for;
+		double start_ms, end_ms;
+	};
+
+	void dispatch(TaskId id, ThreadPool& pool);
+	void execute(TaskId id, ThreadPool& pool);
+	double now_ms() const;
+
+	std::vector<Task> tasks;
+	std::deque<TaskId> main_ready;
+	std::mutex lock;
+	std::condition_variable main_wake;
+	uint32_t remaining;
+	std::chrono::high_resolution_clock::time_point start;
+	double total;
+};
@@ -0,0 +1,128 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "Swapchain.h"
+
+#include <string.h>
+#include <algorithm>
+
+bool parse_present_policy(const char* text, PresentPolicy& out)
+{
+	if (!strcmp(text, "latency"))
+		out = PRESENT_LATENCY;
+	else if (!strcmp(text, "immediate"))
+		out = PRESENT_IMMEDIATE;
+	else if (!strcmp(text, "power"))
+		out = PRESENT_POWER;
+	else if (!strcmp(text, "relaxed"))
+		out = PRESENT_RELAXED;
+	else
+		return false;
+	return true;
+}
+
+const char* present_mode_name(VkPresentModeKHR mode)
+{
+	switch (mode)
+	{
+	case VK_PRESENT_MODE_IMMEDIATE_KHR:    return "IMMEDIATE";
+	case VK_PRESENT_MODE_MAILBOX_KHR:      return "MAILBOX";
+	case VK_PRESENT_MODE_FIFO_KHR:         return "FIFO";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO_RELAXED";
+	default:                               return "OTHER";
+	}
+}
+
+VkPresentModeKHR choose_present_mode(const std::vector<VkPresentModeKHR>& available, PresentPolicy policy)
+{
+	static const VkPresentModeKHR latency[] = { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR };
+	static const VkPresentModeKHR immediate[] = { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR };
+	static const VkPresentModeKHR relaxed[] = { VK_PRESENT_MODE_FIFO_RELAXED_KHR };
+
+	const VkPresentModeKHR* wanted = NULL;
+	size_t wanted_count = 0;
+	switch (policy)
+	{
+	case PRESENT_LATENCY:   wanted = latency; wanted_count = 2; break;
+	case PRESENT_IMMEDIATE: wanted = immediate; wanted_count = 2; break;
+	case PRESENT_RELAXED:   wanted = relaxed; wanted_count = 1; break;
+	case PRESENT_POWER:     break;
+	}
+
+	for (size_t i = 0; i < wanted_count; i++)
+	{
+		if (std::find(available.begin(), available.end(), wanted[i]) != available.end())
+			return wanted[i];
+	}
+
+	// every surface has to support FIFO
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+VkSurfaceFormatKHR choose_surface_format(const std::vector<VkSurfaceFormatKHR>& available)
+{
+	VkSurfaceFormatKHR chosen;
+	chosen.format = VK_FORMAT_B8G8R8A8_UNORM;
+	chosen.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+
+	// an empty list, or one UNDEFINED format,
+	// means that we can pick whatever we want
+	if (available.empty() || (available.size() == 1 && available[0].format == VK_FORMAT_UNDEFINED))
+		return chosen;
+
+	for (size_t i = 0; i < available.size(); i++)
+	{
+		if (available[i].format == VK_FORMAT_B8G8R8A8_UNORM || available[i].format == VK_FORMAT_R8G8B8A8_UNORM)
+			return available[i];
+	}
+
+	return available[0];
+}
+
+uint32_t choose_image_count(const VkSurfaceCapabilitiesKHR& caps, VkPresentModeKHR mode, uint32_t frame_lag)
+{
+	uint32_t count = frame_lag + 1;
+	if (mode == VK_PRESENT_MODE_MAILBOX_KHR)
+		count++;
+
+	count = std::max(count, caps.minImageCount);
+
+	// a maximum of zero means "no maximum"
+	if (caps.maxImageCount > 0)
+		count = std::min(count, caps.maxImageCount);
+
+	return count;
+}
+
+VkExtent2D choose_extent(const VkSurfaceCapabilitiesKHR& caps, uint32_t width, uint32_t height)
+{
+	// 0xFFFFFFFF means that the surface has no size of its own
+	if (caps.currentExtent.width != 0xFFFFFFFFu)
+		return caps.currentExtent;
+
+	VkExtent2D extent;
+	extent.width = std::min(std::max(width, caps.minImageExtent.width), caps.maxImageExtent.width);
+	extent.height = std::min(std::max(height, caps.minImageExtent.height), caps.maxImageExtent.height);
+	return extent;
+}
@@ -0,0 +1,76 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+// The choices we make when we build a swapchain. They only look
+// at what the surface supports, and never call Vulkan themselves,
+// so that they can be tested without a GPU.
+
+// What we care about most when we show a frame
+enum PresentPolicy
+{
+	// Show every frame as soon as possible without tearing (MAILBOX),
+	// or with tearing if that is all we can get (IMMEDIATE)
+	PRESENT_LATENCY,
+
+	// Show every frame as soon as possible, even if the screen tears
+	PRESENT_IMMEDIATE,
+
+	// Wait for the screen to refresh (FIFO). The GPU only draws as
+	// many frames as the screen can show, which saves power
+	PRESENT_POWER,
+
+	// Like PRESENT_POWER, but a late frame is shown straight away
+	// instead of waiting for the next refresh (FIFO_RELAXED)
+	PRESENT_RELAXED
+};
+
+// "latency", "immediate", "power", or "relaxed",
+// returns false for anything else
+bool parse_present_policy(const char* text, PresentPolicy& out);
+const char* present_mode_name(VkPresentModeKHR mode);
+
+// The first mode on our list for this policy that the surface
+// supports. FIFO is always supported, so that is where every list ends
+VkPresentModeKHR choose_present_mode(const std::vector<VkPresentModeKHR>& available, PresentPolicy policy);
+
+// B8G8R8A8_UNORM if we can have it, otherwise what the surface likes
+VkSurfaceFormatKHR choose_surface_format(const std::vector<VkSurfaceFormatKHR>& available);
+
+// One image on the screen, plus one for each frame that we let the
+// CPU get ahead by (frame_lag). MAILBOX needs one more, because the
+// presentation engine keeps an image for the screen and one waiting
+// to replace it, and we still need one to draw into
+uint32_t choose_image_count(const VkSurfaceCapabilitiesKHR& caps, VkPresentModeKHR mode, uint32_t frame_lag);
+
+// The size of the swapchain images. Most surfaces tell us their size,
+// but some (like headless surfaces) let us pick, so then we use the
+// size of the window
+VkExtent2D choose_extent(const VkSurfaceCapabilitiesKHR& caps, uint32_t width, uint32_t height);
@@ -0,0 +1,98 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(uint32_t thread_count)
+{
+	jobs_in_flight = 0;
+	stopping = false;
+
+	// hardware_concurrency can return zero if
+	// the number of cores cannot be determined
+	if (thread_count == 0)
+		thread_count = std::thread::hardware_concurrency();
+	if (thread_count == 0)
+		thread_count = 1;
+
+	for (uint32_t i = 0; i < thread_count; i++)
+		workers.emplace_back(&ThreadPool::worker_main, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	job_ready.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		jobs.push_back(std::move(job));
+		jobs_in_flight++;
+	}
+	job_ready.notify_one();
+}
+
+void ThreadPool::wait_idle()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	all_done.wait(guard, [this] { return jobs_in_flight == 0; });
+}
+
+void ThreadPool::worker_main()
+{
+	while (true)
+	{
+		std::function<void()> job;
+
+		{
+			// sleep until there is a job, or until we are told to stop
+			std::unique_lock<std::mutex> guard(lock);
+			job_ready.wait(guard, [this] { return stopping || !jobs.empty(); });
+
+			if (jobs.empty())
+				return;
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			jobs_in_flight--;
+			if (jobs_in_flight == 0)
+				all_done.notify_all();
+		}
+	}
+}
@@ -0,0 +1,62 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ThreadPool keeps a fixed number of worker threads alive,
+// so that we do not pay the cost of creating a thread every
+// time we want to run something in parallel. We "submit" jobs,
+// the workers take jobs off of the queue one at a time, and
+// "wait_idle" blocks until every submitted job has finished
+class ThreadPool
+{
+public:
+	// A thread_count of zero means "one thread per CPU core"
+	explicit ThreadPool(uint32_t thread_count = 0);
+	~ThreadPool();
+
+	void submit(std::function<void()> job);
+	void wait_idle();
+
+	uint32_t size() const { return (uint32_t)workers.size(); }
+
+private:
+	void worker_main();
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex lock;
+	std::condition_variable job_ready;
+	std::condition_variable all_done;
+	uint32_t jobs_in_flight;
+	bool stopping;
+};
@@ -0,0 +1,301 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+#include "vkinventory.h"
+#include "Inventory.h"
+#include "ThreadPool.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <new>
+
+// The context is only a snapshot, so the instance that we
+// use to take it is destroyed straight away, and nothing
+// in here ever changes after vkinv_create_context returns
+struct vkinv_context_t
+{
+	Inventory inventory;
+};
+
+// No C++ exception may leave a C function, the program calling
+// us could not catch it. Every entry point catches everything,
+// and this turns the exception being handled into a result
+static vkinv_result exception_result()
+{
+	try
+	{
+		throw;
+	}
+	catch (const std::bad_alloc&)
+	{
+		return VKINV_ERROR_OUT_OF_MEMORY;
+	}
+	catch (...)
+	{
+		return VKINV_ERROR_INTERNAL;
+	}
+}
+
+uint32_t vkinv_get_api_version(void)
+{
+	return VKINV_API_VERSION;
+}
+
+vkinv_result vkinv_create_context(vkinv_context* out_context)
+{
+	if (!out_context)
+		return VKINV_ERROR_INVALID_ARGUMENT;
+	*out_context = nullptr;
+
+	vkinv_context context = new (std::nothrow) vkinv_context_t;
+	if (!context)
+		return VKINV_ERROR_OUT_OF_MEMORY;
+
+	// This is the same as Demo::prepare_instance, but without
+	// layers or a window: we only need to look at the GPUs
+	VkInstanceCreateInfo inst_info = {};
+	inst_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+
+	VkInstance inst = VK_NULL_HANDLE;
+	if (vkCreateInstance(&inst_info, NULL, &inst) != VK_SUCCESS)
+	{
+		delete context;
+		return VKINV_ERROR_NO_VULKAN;
+	}
+
+	try
+	{
+		// and this is the same as Demo::prepare_physical_device
+		uint32_t gpu_count = 0;
+		vkEnumeratePhysicalDevices(inst, &gpu_count, NULL);
+
+		std::vector<VkPhysicalDevice> gpus(gpu_count);
+		vkEnumeratePhysicalDevices(inst, &gpu_count, gpus.data());
+
+		// every GPU is asked on its own thread, see collect_inventory
+		context->inventory.node = local_node_name();
+		if (gpu_count > 1)
+		{
+			ThreadPool pool(gpu_count);
+			collect_inventory(gpus.data(), gpu_count, context->inventory.devices, &pool);
+		}
+		else
+		{
+			collect_inventory(gpus.data(), gpu_count, context->inventory.devices, nullptr);
+		}
+	}
+	catch (...)
+	{
+		vkDestroyInstance(inst, NULL);
+		delete context;
+		return exception_result();
+	}
+
+	vkDestroyInstance(inst, NULL);
+
+	*out_context = context;
+	return VKINV_SUCCESS;
+}
+
+void vkinv_destroy_context(vkinv_context context)
+{
+	delete context;
+}
+
+vkinv_result vkinv_get_device_count(vkinv_context context, uint32_t* out_count)
+{
+	try
+	{
+		if (!context || !out_count)
+			return VKINV_ERROR_INVALID_ARGUMENT;
+
+		*out_count = (uint32_t)context->inventory.devices.size();
+		return VKINV_SUCCESS;
+	}
+	catch (...)
+	{
+		return exception_result();
+	}
+}
+
+// look up a device, checking the context and the index
+static vkinv_result find_device(vkinv_context context, uint32_t index, const DeviceInventory** out)
+{
+	if (!context)
+		return VKINV_ERROR_INVALID_ARGUMENT;
+	if (index >= context->inventory.devices.size())
+		return VKINV_ERROR_OUT_OF_RANGE;
+
+	*out = &context->inventory.devices[index];
+	return VKINV_SUCCESS;
+}
+
+vkinv_result vkinv_get_device_info(vkinv_context context, uint32_t index, vkinv_device_info* out_info)
+{
+	try
+	{
+		// an older caller may pass a smaller structure, so we
+		// fill in a full one and only copy what they have room for
+		if (!out_info || out_info->struct_size < offsetof(vkinv_device_info, name) + 1)
+			return VKINV_ERROR_INVALID_ARGUMENT;
+
+		const DeviceInventory* device;
+		vkinv_result result = find_device(context, index, &device);
+		if (result != VKINV_SUCCESS)
+			return result;
+
+		vkinv_device_info info;
+		memset(&info, 0, sizeof(info));
+		info.vendor_id = device->properties.vendorID;
+		info.device_id = device->properties.deviceID;
+		info.driver_version = device->properties.driverVersion;
+		info.api_version = device->properties.apiVersion;
+		info.device_type = (uint32_t)device->properties.deviceType;
+		memcpy(info.pipeline_cache_uuid, device->properties.pipelineCacheUUID, VKINV_UUID_SIZE);
+		snprintf(info.name, sizeof(info.name), "%s", device->properties.deviceName);
+
+		for (uint32_t h = 0; h < device->memory.memoryHeapCount; h++)
+		{
+			if (device->memory.memoryHeaps[h].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+				info.device_local_bytes += device->memory.memoryHeaps[h].size;
+		}
+
+		// a heap counts as host visible if any memory type in it is
+		for (uint32_t h = 0; h < device->memory.memoryHeapCount; h++)
+		{
+			for (uint32_t t = 0; t < device->memory.memoryTypeCount; t++)
+			{
+				if (device->memory.memoryTypes[t].heapIndex == h &&
+					(device->memory.memoryTypes[t].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+				{
+					info.host_visible_bytes += device->memory.memoryHeaps[h].size;
+					break;
+				}
+			}
+		}
+
+		uint32_t size = out_info->struct_size < sizeof(info) ? out_info->struct_size : (uint32_t)sizeof(info);
+		info.struct_size = size;
+		memcpy(out_info, &info, size);
+
+		// the name might have been cut off, keep it terminated
+		if (size < sizeof(info))
+			((char*)out_info)[size - 1] = 0;
+
+		return VKINV_SUCCESS;
+	}
+	catch (...)
+	{
+		return exception_result();
+	}
+}
+
+vkinv_result vkinv_get_device_name(vkinv_context context, uint32_t index, char* buffer, size_t* size)
+{
+	try
+	{
+		if (!size)
+			return VKINV_ERROR_INVALID_ARGUMENT;
+
+		const DeviceInventory* device;
+		vkinv_result result = find_device(context, index, &device);
+		if (result != VKINV_SUCCESS)
+			return result;
+
+		size_t needed = strlen(device->properties.deviceName) + 1;
+		if (!buffer || *size < needed)
+		{
+			*size = needed;
+			return buffer ? VKINV_ERROR_BUFFER_TOO_SMALL : VKINV_SUCCESS;
+		}
+
+		memcpy(buffer, device->properties.deviceName, needed);
+		*size = needed;
+		return VKINV_SUCCESS;
+	}
+	catch (...)
+	{
+		return exception_result();
+	}
+}
+
+vkinv_result vkinv_get_memory_heaps(vkinv_context context, uint32_t index,
+	uint64_t* heap_sizes, uint32_t* heap_flags, uint32_t* count)
+{
+	try
+	{
+		if (!count)
+			return VKINV_ERROR_INVALID_ARGUMENT;
+
+		const DeviceInventory* device;
+		vkinv_result result = find_device(context, index, &device);
+		if (result != VKINV_SUCCESS)
+			return result;
+
+		uint32_t needed = device->memory.memoryHeapCount;
+		if (!heap_sizes && !heap_flags)
+		{
+			*count = needed;
+			return VKINV_SUCCESS;
+		}
+
+		uint32_t copied = *count < needed ? *count : needed;
+		for (uint32_t h = 0; h < copied; h++)
+		{
+			if (heap_sizes)
+				heap_sizes[h] = device->memory.memoryHeaps[h].size;
+			if (heap_flags)
+				heap_flags[h] = device->memory.memoryHeaps[h].flags;
+		}
+
+		*count = copied < needed ? needed : copied;
+		return copied < needed ? VKINV_ERROR_BUFFER_TOO_SMALL : VKINV_SUCCESS;
+	}
+	catch (...)
+	{
+		return exception_result();
+	}
+}
+
+vkinv_result vkinv_write_inventory(vkinv_context context, const char* path)
+{
+	if (!context || !path)
+		return VKINV_ERROR_INVALID_ARGUMENT;
+
+	size_t length = strlen(path);
+	bool binary = length >= 4 && !strcmp(path + length - 4, ".bin");
+
+	try
+	{
+		bool written = binary ?
+			write_inventory_binary(path, context->inventory) :
+			write_inventory_json(path, context->inventory);
+
+		return written ? VKINV_SUCCESS : VKINV_ERROR_IO;
+	}
+	catch (...)
+	{
+		return exception_result();
+	}
+}
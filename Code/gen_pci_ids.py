@@ -0,0 +1,134 @@
+# Turns pci_ids.txt into PciIdTable.inl, a read-only table that
+# PciIds.cpp can search without parsing anything at run time.
+#
+# The devices are placed with a "hash and displace" perfect hash:
+# every key goes into a bucket with one hash, and every bucket gets
+# its own seed for a second hash, chosen so that no two keys in the
+# whole table land in the same slot. Looking a device up is then two
+# hashes and one comparison, no matter how big the table gets.
+#
+# usage: python gen_pci_ids.py pci_ids.txt PciIdTable.inl
+
+import sys
+
+MASK64 = (1 << 64) - 1
+
+
+# must match pci_hash() in PciIds.cpp
+def pci_hash(key, seed):
+    x = (key ^ (seed * 0x9E3779B97F4A7C15)) & MASK64
+    x = ((x ^ (x >> 33)) * 0xFF51AFD7ED558CCD) & MASK64
+    x = ((x ^ (x >> 33)) * 0xC4CEB9FE1A85EC53) & MASK64
+    return x ^ (x >> 33)
+
+
+def c_string(text):
+    return '"' + text.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+
+def main(source, output):
+    vendors = []
+    devices = []
+
+    with open(source) as f:
+        for number, line in enumerate(f, 1):
+            line = line.split('#')[0].strip()
+            if not line:
+                continue
+            words = line.split()
+            if words[0] == 'vendor':
+                vendors.append((int(words[1], 16), ' '.join(words[2:])))
+            else:
+                if len(words) < 5:
+                    sys.exit('%s:%d: expected vendor, device, architecture, generation, name' % (source, number))
+                devices.append((int(words[0], 16), int(words[1], 16),
+                                words[2].replace('_', ' '), int(words[3]), ' '.join(words[4:])))
+
+    # a device without a vendor line would have no vendor name
+    known_vendors = set(v for v, _ in vendors)
+    for v, d, _, _, name in devices:
+        if v not in known_vendors:
+            sys.exit('%s: %s (0x%X 0x%04X) has no vendor line for 0x%X' % (source, name, v, d, v))
+
+    keys = [(v << 32) | d for v, d, _, _, _ in devices]
+    if len(set(keys)) != len(keys):
+        sys.exit('%s: a vendor/device pair is listed twice' % source)
+
+    # about four keys per bucket keeps the seed search short
+    slot_count = max(len(devices), 1)
+    bucket_count = max(slot_count // 4, 1)
+
+    buckets = [[] for _ in range(bucket_count)]
+    for i, key in enumerate(keys):
+        buckets[pci_hash(key, 0) % bucket_count].append(i)
+
+    # place the biggest buckets first, while the table is emptiest
+    seeds = [0] * bucket_count
+    slots = [None] * slot_count
+    for b in sorted(range(bucket_count), key=lambda b: -len(buckets[b])):
+        if not buckets[b]:
+            continue
+        seed = 1
+        while True:
+            wanted = [pci_hash(keys[i], seed) % slot_count for i in buckets[b]]
+            if len(set(wanted)) == len(wanted) and all(slots[s] is None for s in wanted):
+                break
+            seed += 1
+        seeds[b] = seed
+        for i, s in zip(buckets[b], wanted):
+            slots[s] = i
+
+    # every string is stored once, in one big block
+    strings = bytearray(b'\0')
+    offsets = {'': 0}
+
+    def intern(text):
+        if text not in offsets:
+            offsets[text] = len(strings)
+            strings.extend(text.encode('utf-8') + b'\0')
+        return offsets[text]
+
+    out = []
+    out.append('// Generated by gen_pci_ids.py from pci_ids.txt, do not edit by hand.')
+    out.append('')
+    out.append('#define PCI_DEVICE_COUNT %d' % slot_count)
+    out.append('#define PCI_BUCKET_COUNT %d' % bucket_count)
+    out.append('#define PCI_VENDOR_COUNT %d' % len(vendors))
+    out.append('')
+    out.append('static const uint32_t pci_bucket_seeds[PCI_BUCKET_COUNT] =')
+    out.append('{')
+    for i in range(0, bucket_count, 8):
+        out.append('\t' + ' '.join('%u,' % s for s in seeds[i:i + 8]))
+    out.append('};')
+    out.append('')
+    out.append('static const PciDeviceEntry pci_devices[PCI_DEVICE_COUNT] =')
+    out.append('{')
+    for s in range(slot_count):
+        if slots[s] is None:
+            out.append('\t{ 0xFFFFFFFF, 0xFFFFFFFF, 0, 0, 0 },')
+            continue
+        v, d, arch, gen, name = devices[slots[s]]
+        out.append('\t{ 0x%X, 0x%04X, %u, %u, %u }, // %s' % (v, d, intern(name), intern(arch), gen, name))
+    out.append('};')
+    out.append('')
+    out.append('static const PciVendorEntry pci_vendors[PCI_VENDOR_COUNT] =')
+    out.append('{')
+    for v, name in sorted(vendors):
+        out.append('\t{ 0x%X, %u }, // %s' % (v, intern(name), name))
+    out.append('};')
+    out.append('')
+    out.append('static const char pci_strings[%d] =' % len(strings))
+    out.append('{')
+    for i in range(0, len(strings), 16):
+        out.append('\t' + ' '.join('0x%02X,' % b for b in strings[i:i + 16]))
+    out.append('};')
+    out.append('')
+
+    with open(output, 'w', newline='\r\n') as f:
+        f.write('\n'.join(out))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit('usage: gen_pci_ids.py pci_ids.txt PciIdTable.inl')
+    main(sys.argv[1], sys.argv[2])
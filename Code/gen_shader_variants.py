@@ -0,0 +1,181 @@
+# Turns shader_variants.txt into ShaderVariantTable.inl, read-only
+# tables that ShaderVariants.cpp uses without parsing anything at
+# run time.
+#
+# Besides the axes and their values, the table lists every build of
+# every shader: each combination of the values of its macro axes,
+# because each of those has to be compiled on its own. Specialization
+# constants are left out of the builds, every value of a "spec" axis
+# is the same SPIR-V.
+#
+# usage: python gen_shader_variants.py shader_variants.txt ShaderVariantTable.inl
+
+import itertools
+import re
+import sys
+
+# must match SHADER_VARIANT_MAX_AXES and
+# SHADER_VARIANT_MAX_BUILDS in ShaderVariants.h
+MAX_AXES = 8
+MAX_BUILDS = 256
+
+KINDS = {'spec': 'SHADER_AXIS_SPEC', 'macro': 'SHADER_AXIS_MACRO'}
+RULES = {'fixed': 'SHADER_RULE_FIXED', 'subgroup': 'SHADER_RULE_SUBGROUP',
+         'workgroup': 'SHADER_RULE_WORKGROUP', 'shared': 'SHADER_RULE_SHARED'}
+
+
+def parse(source):
+    shaders = []
+
+    def fail(number, message):
+        sys.exit('%s:%d: %s' % (source, number, message))
+
+    with open(source) as f:
+        for number, line in enumerate(f, 1):
+            line = line.split('#')[0].strip()
+            if not line:
+                continue
+            words = line.split()
+            if words[0] == 'shader':
+                if len(words) != 2:
+                    fail(number, 'expected shader <file>')
+                if any(s['name'] == words[1] for s in shaders):
+                    fail(number, '%s is listed twice' % words[1])
+                shaders.append({'name': words[1], 'axes': []})
+                continue
+
+            if not shaders:
+                fail(number, 'an axis has to come after a shader line')
+            if len(words) < 5 or words[1] not in KINDS:
+                fail(number, 'expected <axis> spec|macro <id or NAME> <rule> <values...>')
+
+            axis = {'name': words[0], 'kind': words[1], 'spec_id': 0, 'macro': '', 'rule_arg': 0}
+            if axis['kind'] == 'spec':
+                if not words[2].isdigit():
+                    fail(number, 'a spec axis needs a constant_id, not %s' % words[2])
+                axis['spec_id'] = int(words[2])
+            else:
+                if not re.match(r'^[A-Za-z_][A-Za-z0-9_]*$', words[2]):
+                    fail(number, '%s is not a macro name' % words[2])
+                axis['macro'] = words[2]
+
+            rest = words[3:]
+            if rest[0] not in RULES:
+                fail(number, 'unknown rule %s' % rest[0])
+            axis['rule'] = rest[0]
+            rest = rest[1:]
+            if axis['rule'] == 'shared':
+                if not rest or not rest[0].isdigit() or int(rest[0]) == 0:
+                    fail(number, 'the shared rule needs the bytes each step keeps per invocation')
+                axis['rule_arg'] = int(rest[0])
+                rest = rest[1:]
+
+            if not rest or not all(v.isdigit() and int(v) > 0 for v in rest):
+                fail(number, 'the values of an axis are whole numbers above zero')
+            axis['values'] = [int(v) for v in rest]
+            if len(axis['values']) > 256:
+                fail(number, 'an axis can have at most 256 values')
+            if len(set(axis['values'])) != len(axis['values']):
+                fail(number, 'a value is listed twice')
+
+            axes = shaders[-1]['axes']
+            if any(a['name'] == axis['name'] for a in axes):
+                fail(number, 'the axis %s is listed twice' % axis['name'])
+            if axis['kind'] == 'spec' and any(a['kind'] == 'spec' and a['spec_id'] == axis['spec_id'] for a in axes):
+                fail(number, 'constant_id %d is used by two axes' % axis['spec_id'])
+            if axis['kind'] == 'macro' and any(a['macro'] == axis['macro'] for a in axes):
+                fail(number, 'the macro %s is used by two axes' % axis['macro'])
+            if len(axes) == MAX_AXES:
+                fail(number, 'a shader can have at most %d axes' % MAX_AXES)
+            axes.append(axis)
+
+    for shader in shaders:
+        if not shader['axes']:
+            sys.exit('%s: %s has no axes' % (source, shader['name']))
+    return shaders
+
+
+def main(source, output):
+    shaders = parse(source)
+
+    strings = bytearray(b'\0')
+    offsets = {'': 0}
+
+    def intern(text):
+        if text not in offsets:
+            offsets[text] = len(strings)
+            strings.extend(text.encode('utf-8') + b'\0')
+        return offsets[text]
+
+    shader_rows = []
+    axis_rows = []
+    values = []
+    builds = []
+    for shader in shaders:
+        axes = shader['axes']
+
+        # every combination of the macro axes, and the first
+        # value (unused) for the spec axes
+        choices = [range(len(a['values'])) if a['kind'] == 'macro' else [0] for a in axes]
+        combinations = list(itertools.product(*choices))
+        if len(combinations) > MAX_BUILDS:
+            sys.exit('%s: %s needs %d builds, more than %d' % (source, shader['name'], len(combinations), MAX_BUILDS))
+
+        shader_rows.append('\t{ %u, %u, %u, %u, %u }, // %s' % (intern(shader['name']), len(axis_rows),
+                           len(axes), len(builds), len(combinations), shader['name']))
+        for axis in axes:
+            axis_rows.append('\t{ %u, %s, %u, %u, %s, %u, %u, %u }, // %s' % (
+                intern(axis['name']), KINDS[axis['kind']], axis['spec_id'], intern(axis['macro']),
+                RULES[axis['rule']], axis['rule_arg'], len(values), len(axis['values']), axis['name']))
+            values.extend(axis['values'])
+        for combination in combinations:
+            builds.append(combination)
+
+    # C++ has no arrays of size zero, so an empty
+    # list still gets one row, that is never used
+    out = []
+    out.append('// Generated by gen_shader_variants.py from shader_variants.txt, do not edit by hand.')
+    out.append('')
+    out.append('#define SHADER_VARIANT_SHADER_COUNT %d' % len(shader_rows))
+    out.append('#define SHADER_VARIANT_BUILD_COUNT %d' % len(builds))
+    out.append('')
+    out.append('static constexpr ShaderVariantShader shader_variant_shaders[] =')
+    out.append('{')
+    out.extend(shader_rows or ['\t{ 0, 0, 0, 0, 0 },'])
+    out.append('};')
+    out.append('')
+    out.append('static constexpr ShaderVariantAxis shader_variant_axes[] =')
+    out.append('{')
+    out.extend(axis_rows or ['\t{ 0, SHADER_AXIS_SPEC, 0, 0, SHADER_RULE_FIXED, 0, 0, 0 },'])
+    out.append('};')
+    out.append('')
+    out.append('static constexpr uint32_t shader_variant_values[] =')
+    out.append('{')
+    for i in range(0, max(len(values), 1), 8):
+        out.append('\t' + ' '.join('%u,' % v for v in (values[i:i + 8] or [0])))
+    out.append('};')
+    out.append('')
+    out.append('// one row per build, the index of the value of')
+    out.append('// each axis of the shader (always 0 for spec axes)')
+    out.append('static constexpr uint8_t shader_variant_builds[][SHADER_VARIANT_MAX_AXES] =')
+    out.append('{')
+    for build in builds or [()]:
+        row = list(build) + [0] * (MAX_AXES - len(build))
+        out.append('\t{ ' + ', '.join('%u' % v for v in row) + ' },')
+    out.append('};')
+    out.append('')
+    out.append('static constexpr char shader_variant_strings[%d] =' % len(strings))
+    out.append('{')
+    for i in range(0, len(strings), 16):
+        out.append('\t' + ' '.join('0x%02X,' % b for b in strings[i:i + 16]))
+    out.append('};')
+    out.append('')
+
+    with open(output, 'w', newline='\r\n') as f:
+        f.write('\n'.join(out))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit('usage: gen_shader_variants.py shader_variants.txt ShaderVariantTable.inl')
+    main(sys.argv[1], sys.argv[2])
@@ -0,0 +1,125 @@
+/*
+Copyright 2019
+Original authors: Niko Procopi
+Written under the supervision of David I. Schwartz, Ph.D., and
+supported by a professional development seed grant from the B. Thomas
+Golisano College of Computing & Information Sciences
+(https://www.rit.edu/gccis) at the Rochester Institute of Technology.
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+This program is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+<http://www.gnu.org/licenses/>.
+
+Special Thanks to Exzap from Team Cemu,
+he gave me advice on how to optimize Vulkan
+graphics, he is working on a Wii U emulator
+that utilizes Vulkan, see more at http://cemu.info
+*/
+
+/*
+ vkinventory.h is the public interface of the VkInventory library.
+ It lets another program ask about the GPUs in this computer without
+ starting this program, and without knowing anything about Vulkan.
+
+ The interface is plain C, so that it can be used from any language,
+ and it will stay compatible between versions:
+   - functions are only ever added, never changed or removed
+   - structures that the caller fills start with "struct_size",
+     so new members can be added to the end later
+   - the caller owns every buffer, the library never hands out
+     memory that the caller has to free (except the context)
+
+ A context is a snapshot of every GPU, taken when it is created.
+ There is no global state: every function works only on the context
+ it is given, and a context is never changed after it is created,
+ so any number of threads can query the same context at once.
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+  #ifdef VKINV_BUILD
+    #define VKINV_API __declspec(dllexport)
+  #else
+    #define VKINV_API __declspec(dllimport)
+  #endif
+#else
+  #define VKINV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VKINV_API_VERSION 1
+#define VKINV_NAME_SIZE 256
+#define VKINV_UUID_SIZE 16
+
+typedef struct vkinv_context_t* vkinv_context;
+
+typedef enum vkinv_result
+{
+	VKINV_SUCCESS = 0,
+	VKINV_ERROR_INVALID_ARGUMENT = -1,
+	VKINV_ERROR_NO_VULKAN = -2,        // no Vulkan loader or driver
+	VKINV_ERROR_OUT_OF_RANGE = -3,     // device index too big
+	VKINV_ERROR_BUFFER_TOO_SMALL = -4, // the needed size was written back
+	VKINV_ERROR_OUT_OF_MEMORY = -5,
+	VKINV_ERROR_IO = -6,
+	VKINV_ERROR_INTERNAL = -7          // anything else that went wrong inside the library
+} vkinv_result;
+
+typedef struct vkinv_device_info
+{
+	uint32_t struct_size;  // set to sizeof(vkinv_device_info) before calling
+	uint32_t vendor_id;
+	uint32_t device_id;
+	uint32_t driver_version;
+	uint32_t api_version;
+	uint32_t device_type;  // VkPhysicalDeviceType
+	uint8_t pipeline_cache_uuid[VKINV_UUID_SIZE];
+	uint64_t device_local_bytes;
+	uint64_t host_visible_bytes;
+	char name[VKINV_NAME_SIZE];
+} vkinv_device_info;
+
+// The version of the library that is loaded, which may be newer
+// than the VKINV_API_VERSION this program was compiled with
+VKINV_API uint32_t vkinv_get_api_version(void);
+
+// Take a snapshot of every GPU. Returns VKINV_ERROR_NO_VULKAN if
+// Vulkan is not available; a computer with no GPUs still gets a
+// context, with a device count of zero
+VKINV_API vkinv_result vkinv_create_context(vkinv_context* out_context);
+VKINV_API void vkinv_destroy_context(vkinv_context context);
+
+VKINV_API vkinv_result vkinv_get_device_count(vkinv_context context, uint32_t* out_count);
+
+VKINV_API vkinv_result vkinv_get_device_info(vkinv_context context, uint32_t index, vkinv_device_info* out_info);
+
+// Copy the name of a GPU into "buffer". "size" is the size of the
+// buffer going in, and the size needed (with the terminator) coming
+// out. Pass a null buffer to only ask for the size
+VKINV_API vkinv_result vkinv_get_device_name(vkinv_context context, uint32_t index, char* buffer, size_t* size);
+
+// Copy the sizes and VkMemoryHeapFlags of the memory heaps of a GPU.
+// "count" works like "size" in vkinv_get_device_name
+VKINV_API vkinv_result vkinv_get_memory_heaps(vkinv_context context, uint32_t index,
+	uint64_t* heap_sizes, uint32_t* heap_flags, uint32_t* count);
+
+// Write the whole snapshot as an inventory file (see Inventory.h),
+// as binary if the path ends in ".bin", otherwise as JSON
+VKINV_API vkinv_result vkinv_write_inventory(vkinv_context context, const char* path);
+
+#ifdef __cplusplus
+}
+#endif